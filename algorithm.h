@@ -0,0 +1,662 @@
+/***********************************************************************
+ * Header:
+ *    ALGORITHM
+ * Summary:
+ *    Linear scans over contiguous arithmetic data: find, count,
+ *    contains, min_element and max_element. When the elements are
+ *    arithmetic and contiguous (a pointer range, a vector, or a pair
+ *    of vector iterators) the scan
+ *    uses AVX2 or SSE4.1, whichever the CPU supports, comparing 16 or
+ *    32 bytes at a time. Everything else gets the plain scalar loop.
+ *
+ *    This will contain the definition of:
+ *        find         : The first element equal to a value
+ *        count        : The number of elements equal to a value
+ *        contains     : Is there an element equal to a value?
+ *        min_element  : The first smallest element
+ *        max_element  : The first largest element
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "vector.h"      // for the vector overloads
+#include <cstdint>       // for uint32_t
+#include <type_traits>   // for std::is_arithmetic and std::void_t
+#include <utility>       // for std::declval
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CUSTOM_SIMD_X86
+#include <immintrin.h>   // for the SSE4.1 and AVX2 intrinsics
+#ifdef _MSC_VER
+#include <intrin.h>      // for __cpuid
+#define CUSTOM_TARGET_SSE4
+#define CUSTOM_TARGET_AVX2
+#else
+#define CUSTOM_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define CUSTOM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif // x86
+
+class TestAlgorithm;     // forward declaration for unit tests
+
+namespace custom
+{
+namespace simd
+{
+
+/*****************************************
+ * LEVEL
+ * The widest instruction set this CPU supports
+ ****************************************/
+enum level { SCALAR, SSE4, AVX2 };
+
+inline level detect()
+{
+#ifdef CUSTOM_SIMD_X86
+#ifdef _MSC_VER
+   int info[4];
+   __cpuid(info, 0);
+   int maxLeaf = info[0];
+   if (maxLeaf < 1)
+      return SCALAR;
+   __cpuid(info, 1);
+   bool sse4 = (info[2] & (1 << 19)) != 0;
+   bool osxsave = (info[2] & (1 << 27)) != 0;
+   bool avx = osxsave && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+   if (avx && maxLeaf >= 7)
+   {
+      // AVX2 is reported in leaf 7, which older CPUs do not have
+      __cpuidex(info, 7, 0);
+      if ((info[1] & (1 << 5)) != 0)
+         return AVX2;
+   }
+   return sse4 ? SSE4 : SCALAR;
+#else
+   if (__builtin_cpu_supports("avx2"))
+      return AVX2;
+   if (__builtin_cpu_supports("sse4.1"))
+      return SSE4;
+   return SCALAR;
+#endif
+#else
+   return SCALAR;
+#endif // CUSTOM_SIMD_X86
+}
+
+// detect once, the first time we are asked
+inline level cpu_level()
+{
+   static const level cpuLevel = detect();
+   return cpuLevel;
+}
+
+/*****************************************
+ * CONTIGUOUS
+ * Iterators which are really pointers: a raw pointer, or any
+ * iterator with a to_address() found by argument-dependent
+ * lookup, such as vector::iterator. address() unwraps one
+ * and the iterator can be rebuilt from the pointer.
+ ****************************************/
+template <class Iterator, class = void>
+struct contiguous
+{
+   static const bool value = false;
+};
+
+template <class T>
+struct contiguous <T *, void>
+{
+   static const bool value = true;
+   typedef typename std::remove_cv<T>::type element;
+   static T * address(T * p) { return p; }
+};
+
+template <class Iterator>
+struct contiguous <Iterator, std::void_t<
+   typename std::enable_if<!std::is_pointer<Iterator>::value>::type,
+   decltype(to_address(std::declval<const Iterator &>()))>>
+{
+   typedef decltype(to_address(std::declval<const Iterator &>())) pointer;
+   static const bool value = std::is_pointer<pointer>::value &&
+                             std::is_constructible<Iterator, pointer>::value;
+   typedef typename std::remove_cv<typename std::remove_pointer<pointer>::type>::type element;
+   static pointer address(const Iterator & it) { return to_address(it); }
+};
+
+/*****************************************
+ * VECTORIZABLE
+ * Arithmetic types with a 1, 2, 4, or 8 byte lane
+ ****************************************/
+template <typename T>
+struct vectorizable
+{
+   static const bool value = std::is_arithmetic<T>::value &&
+      (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+};
+
+// min and max exist for the integer lanes up to 32 bits
+template <typename T>
+struct vectorizable_minmax
+{
+   static const bool value = std::is_integral<T>::value && sizeof(T) <= 4 &&
+                             !std::is_same<T, bool>::value;
+};
+
+/*****************************************
+ * SCALAR
+ * The fallback for every scan
+ ****************************************/
+template <typename T>
+size_t find_scalar(const T * p, size_t num, T value)
+{
+   for (size_t i = 0; i < num; i++)
+      if (p[i] == value)
+         return i;
+   return num;
+}
+
+template <typename T>
+size_t count_scalar(const T * p, size_t num, T value)
+{
+   size_t n = 0;
+   for (size_t i = 0; i < num; i++)
+      n += (p[i] == value) ? 1 : 0;
+   return n;
+}
+
+// is a better than b? Smaller for min, larger for max
+template <bool Max>
+struct better
+{
+   template <typename T>
+   bool operator () (const T & a, const T & b) const { return Max ? b < a : a < b; }
+};
+
+template <typename T, typename Better>
+T extreme_scalar(const T * p, size_t num, Better isBetter)
+{
+   T best = p[0];
+   for (size_t i = 1; i < num; i++)
+      if (isBetter(p[i], best))
+         best = p[i];
+   return best;
+}
+
+#ifdef CUSTOM_SIMD_X86
+
+/*****************************************
+ * BIT HELPERS
+ * Lowest set bit and number of set bits in a movemask
+ ****************************************/
+inline unsigned lowest_bit(uint32_t mask)
+{
+#ifdef _MSC_VER
+   unsigned long index;
+   _BitScanForward(&index, mask);
+   return (unsigned)index;
+#else
+   return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+inline unsigned count_bits(uint32_t mask)
+{
+#ifdef _MSC_VER
+   unsigned n = 0;
+   for (; mask; mask &= mask - 1)
+      n++;
+   return n;
+#else
+   return (unsigned)__builtin_popcount(mask);
+#endif
+}
+
+/*****************************************
+ * LANE
+ * How to broadcast, load and compare one kind of element.
+ * eq128 and eq256 return a byte mask: every byte of an
+ * equal lane is 0xFF.
+ ****************************************/
+template <typename T,
+          size_t Size = sizeof(T),
+          bool Float = std::is_floating_point<T>::value>
+struct lane;
+
+template <typename T>
+struct lane <T, 1, false>
+{
+   CUSTOM_TARGET_SSE4 static __m128i set128(T t) { return _mm_set1_epi8((char)t); }
+   CUSTOM_TARGET_SSE4 static __m128i eq128(const T * p, __m128i v)
+   {
+      return _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), v);
+   }
+   CUSTOM_TARGET_AVX2 static __m256i set256(T t) { return _mm256_set1_epi8((char)t); }
+   CUSTOM_TARGET_AVX2 static __m256i eq256(const T * p, __m256i v)
+   {
+      return _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), v);
+   }
+};
+
+template <typename T>
+struct lane <T, 2, false>
+{
+   CUSTOM_TARGET_SSE4 static __m128i set128(T t) { return _mm_set1_epi16((short)t); }
+   CUSTOM_TARGET_SSE4 static __m128i eq128(const T * p, __m128i v)
+   {
+      return _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)p), v);
+   }
+   CUSTOM_TARGET_AVX2 static __m256i set256(T t) { return _mm256_set1_epi16((short)t); }
+   CUSTOM_TARGET_AVX2 static __m256i eq256(const T * p, __m256i v)
+   {
+      return _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)p), v);
+   }
+};
+
+template <typename T>
+struct lane <T, 4, false>
+{
+   CUSTOM_TARGET_SSE4 static __m128i set128(T t) { return _mm_set1_epi32((int)t); }
+   CUSTOM_TARGET_SSE4 static __m128i eq128(const T * p, __m128i v)
+   {
+      return _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)p), v);
+   }
+   CUSTOM_TARGET_AVX2 static __m256i set256(T t) { return _mm256_set1_epi32((int)t); }
+   CUSTOM_TARGET_AVX2 static __m256i eq256(const T * p, __m256i v)
+   {
+      return _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)p), v);
+   }
+};
+
+template <typename T>
+struct lane <T, 8, false>
+{
+   CUSTOM_TARGET_SSE4 static __m128i set128(T t) { return _mm_set1_epi64x((long long)t); }
+   CUSTOM_TARGET_SSE4 static __m128i eq128(const T * p, __m128i v)
+   {
+      return _mm_cmpeq_epi64(_mm_loadu_si128((const __m128i *)p), v);
+   }
+   CUSTOM_TARGET_AVX2 static __m256i set256(T t) { return _mm256_set1_epi64x((long long)t); }
+   CUSTOM_TARGET_AVX2 static __m256i eq256(const T * p, __m256i v)
+   {
+      return _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)p), v);
+   }
+};
+
+// floating point compares by value: 0.0 == -0.0 and NaN != NaN
+template <>
+struct lane <float, 4, true>
+{
+   CUSTOM_TARGET_SSE4 static __m128 set128(float t) { return _mm_set1_ps(t); }
+   CUSTOM_TARGET_SSE4 static __m128i eq128(const float * p, __m128 v)
+   {
+      return _mm_castps_si128(_mm_cmpeq_ps(_mm_loadu_ps(p), v));
+   }
+   CUSTOM_TARGET_AVX2 static __m256 set256(float t) { return _mm256_set1_ps(t); }
+   CUSTOM_TARGET_AVX2 static __m256i eq256(const float * p, __m256 v)
+   {
+      return _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(p), v, _CMP_EQ_OQ));
+   }
+};
+
+template <>
+struct lane <double, 8, true>
+{
+   CUSTOM_TARGET_SSE4 static __m128d set128(double t) { return _mm_set1_pd(t); }
+   CUSTOM_TARGET_SSE4 static __m128i eq128(const double * p, __m128d v)
+   {
+      return _mm_castpd_si128(_mm_cmpeq_pd(_mm_loadu_pd(p), v));
+   }
+   CUSTOM_TARGET_AVX2 static __m256d set256(double t) { return _mm256_set1_pd(t); }
+   CUSTOM_TARGET_AVX2 static __m256i eq256(const double * p, __m256d v)
+   {
+      return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_loadu_pd(p), v, _CMP_EQ_OQ));
+   }
+};
+
+/*****************************************
+ * FIND and COUNT: SSE4.1 and AVX2
+ * Compare a register of elements at a time and turn
+ * the result into a bit per byte with movemask
+ ****************************************/
+template <typename T>
+CUSTOM_TARGET_SSE4 size_t find_sse4(const T * p, size_t num, T value)
+{
+   const size_t per = 16 / sizeof(T);
+   auto v = lane<T>::set128(value);
+   size_t i = 0;
+   for (; i + per <= num; i += per)
+   {
+      uint32_t mask = (uint32_t)_mm_movemask_epi8(lane<T>::eq128(p + i, v));
+      if (mask)
+         return i + lowest_bit(mask) / sizeof(T);
+   }
+   return i + find_scalar(p + i, num - i, value);
+}
+
+template <typename T>
+CUSTOM_TARGET_AVX2 size_t find_avx2(const T * p, size_t num, T value)
+{
+   const size_t per = 32 / sizeof(T);
+   auto v = lane<T>::set256(value);
+   size_t i = 0;
+   for (; i + per <= num; i += per)
+   {
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(lane<T>::eq256(p + i, v));
+      if (mask)
+         return i + lowest_bit(mask) / sizeof(T);
+   }
+   return i + find_scalar(p + i, num - i, value);
+}
+
+template <typename T>
+CUSTOM_TARGET_SSE4 size_t count_sse4(const T * p, size_t num, T value)
+{
+   const size_t per = 16 / sizeof(T);
+   auto v = lane<T>::set128(value);
+   size_t n = 0;
+   size_t i = 0;
+   for (; i + per <= num; i += per)
+      n += count_bits((uint32_t)_mm_movemask_epi8(lane<T>::eq128(p + i, v)));
+   return n / sizeof(T) + count_scalar(p + i, num - i, value);
+}
+
+template <typename T>
+CUSTOM_TARGET_AVX2 size_t count_avx2(const T * p, size_t num, T value)
+{
+   const size_t per = 32 / sizeof(T);
+   auto v = lane<T>::set256(value);
+   size_t n = 0;
+   size_t i = 0;
+   for (; i + per <= num; i += per)
+      n += count_bits((uint32_t)_mm256_movemask_epi8(lane<T>::eq256(p + i, v)));
+   return n / sizeof(T) + count_scalar(p + i, num - i, value);
+}
+
+/*****************************************
+ * MIN and MAX LANES
+ * Element-wise min or max for the integer lanes
+ ****************************************/
+template <typename T,
+          size_t Size = sizeof(T),
+          bool Signed = std::is_signed<T>::value>
+struct lane_minmax;
+
+#define CUSTOM_LANE_MINMAX(SIZE, SIGNED, SUFFIX)                                      \
+template <typename T>                                                                 \
+struct lane_minmax <T, SIZE, SIGNED>                                                  \
+{                                                                                     \
+   CUSTOM_TARGET_SSE4 static __m128i min128(__m128i a, __m128i b) { return _mm_min_##SUFFIX(a, b); }    \
+   CUSTOM_TARGET_SSE4 static __m128i max128(__m128i a, __m128i b) { return _mm_max_##SUFFIX(a, b); }    \
+   CUSTOM_TARGET_AVX2 static __m256i min256(__m256i a, __m256i b) { return _mm256_min_##SUFFIX(a, b); } \
+   CUSTOM_TARGET_AVX2 static __m256i max256(__m256i a, __m256i b) { return _mm256_max_##SUFFIX(a, b); } \
+};
+CUSTOM_LANE_MINMAX(1, true,  epi8)
+CUSTOM_LANE_MINMAX(1, false, epu8)
+CUSTOM_LANE_MINMAX(2, true,  epi16)
+CUSTOM_LANE_MINMAX(2, false, epu16)
+CUSTOM_LANE_MINMAX(4, true,  epi32)
+CUSTOM_LANE_MINMAX(4, false, epu32)
+#undef CUSTOM_LANE_MINMAX
+
+/*****************************************
+ * EXTREME: SSE4.1 and AVX2
+ * The smallest (Max == false) or largest value. Reduce
+ * whole registers, then finish the lanes and the tail
+ * with the scalar loop
+ ****************************************/
+template <bool Max, typename T>
+CUSTOM_TARGET_SSE4 T extreme_sse4(const T * p, size_t num)
+{
+   const size_t per = 16 / sizeof(T);
+   if (num < per)
+      return extreme_scalar(p, num, better<Max>());
+   __m128i best = _mm_loadu_si128((const __m128i *)p);
+   size_t i = per;
+   for (; i + per <= num; i += per)
+   {
+      __m128i x = _mm_loadu_si128((const __m128i *)(p + i));
+      best = Max ? lane_minmax<T>::max128(best, x) : lane_minmax<T>::min128(best, x);
+   }
+   T lanes[16 / sizeof(T)];
+   _mm_storeu_si128((__m128i *)lanes, best);
+   T value = extreme_scalar(lanes, per, better<Max>());
+   for (; i < num; i++)
+      if (better<Max>()(p[i], value))
+         value = p[i];
+   return value;
+}
+
+template <bool Max, typename T>
+CUSTOM_TARGET_AVX2 T extreme_avx2(const T * p, size_t num)
+{
+   const size_t per = 32 / sizeof(T);
+   if (num < per)
+      return extreme_scalar(p, num, better<Max>());
+   __m256i best = _mm256_loadu_si256((const __m256i *)p);
+   size_t i = per;
+   for (; i + per <= num; i += per)
+   {
+      __m256i x = _mm256_loadu_si256((const __m256i *)(p + i));
+      best = Max ? lane_minmax<T>::max256(best, x) : lane_minmax<T>::min256(best, x);
+   }
+   T lanes[32 / sizeof(T)];
+   _mm256_storeu_si256((__m256i *)lanes, best);
+   T value = extreme_scalar(lanes, per, better<Max>());
+   for (; i < num; i++)
+      if (better<Max>()(p[i], value))
+         value = p[i];
+   return value;
+}
+
+#endif // CUSTOM_SIMD_X86
+
+/*****************************************
+ * DISPATCH
+ * Pick the kernel for a given level. The public functions
+ * pass cpu_level(); the unit tests try every level
+ ****************************************/
+template <typename T>
+size_t find(const T * p, size_t num, T value, level lvl)
+{
+#ifdef CUSTOM_SIMD_X86
+   if (lvl == AVX2)
+      return find_avx2(p, num, value);
+   if (lvl == SSE4)
+      return find_sse4(p, num, value);
+#endif
+   return find_scalar(p, num, value);
+}
+
+template <typename T>
+size_t count(const T * p, size_t num, T value, level lvl)
+{
+#ifdef CUSTOM_SIMD_X86
+   if (lvl == AVX2)
+      return count_avx2(p, num, value);
+   if (lvl == SSE4)
+      return count_sse4(p, num, value);
+#endif
+   return count_scalar(p, num, value);
+}
+
+// index of the first smallest (Max == false) or largest element
+template <bool Max, typename T>
+size_t extreme(const T * p, size_t num, level lvl)
+{
+   if (num == 0)
+      return 0;
+   T best;
+#ifdef CUSTOM_SIMD_X86
+   if (lvl == AVX2)
+      best = extreme_avx2<Max>(p, num);
+   else if (lvl == SSE4)
+      best = extreme_sse4<Max>(p, num);
+   else
+#endif
+   best = extreme_scalar(p, num, better<Max>());
+   return find(p, num, best, lvl);
+}
+
+} // namespace simd
+
+/*****************************************
+ * FIND
+ * The first element in [first, last) equal to value,
+ * or last when there is none
+ ****************************************/
+template <class Iterator, typename T>
+Iterator find(Iterator first, Iterator last, const T & value)
+{
+   // SIMD only when the value means the same thing as an element
+   typedef simd::contiguous<Iterator> C;
+   if constexpr (C::value)
+   {
+      typedef typename C::element E;
+      if constexpr (simd::vectorizable<E>::value)
+         if ((E)value == value)
+         {
+            auto p = C::address(first);
+            size_t num = (size_t)(C::address(last) - p);
+            return Iterator(p + simd::find(p, num, (E)value, simd::cpu_level()));
+         }
+   }
+
+   for (; first != last; ++first)
+      if (*first == value)
+         return first;
+   return last;
+}
+
+/*****************************************
+ * COUNT
+ * The number of elements in [first, last) equal to value
+ ****************************************/
+template <class Iterator, typename T>
+size_t count(Iterator first, Iterator last, const T & value)
+{
+   // SIMD only when the value means the same thing as an element
+   typedef simd::contiguous<Iterator> C;
+   if constexpr (C::value)
+   {
+      typedef typename C::element E;
+      if constexpr (simd::vectorizable<E>::value)
+         if ((E)value == value)
+         {
+            auto p = C::address(first);
+            size_t num = (size_t)(C::address(last) - p);
+            return simd::count(p, num, (E)value, simd::cpu_level());
+         }
+   }
+
+   size_t n = 0;
+   for (; first != last; ++first)
+      if (*first == value)
+         n++;
+   return n;
+}
+
+/*****************************************
+ * CONTAINS
+ * Is there an element in [first, last) equal to value?
+ ****************************************/
+template <class Iterator, typename T>
+bool contains(Iterator first, Iterator last, const T & value)
+{
+   return custom::find(first, last, value) != last;
+}
+
+/*****************************************
+ * MIN ELEMENT and MAX ELEMENT
+ * The first smallest or largest element in [first, last),
+ * or last when the range is empty
+ ****************************************/
+template <class Iterator>
+Iterator min_element(Iterator first, Iterator last)
+{
+   typedef simd::contiguous<Iterator> C;
+   if constexpr (C::value)
+   {
+      if constexpr (simd::vectorizable_minmax<typename C::element>::value)
+      {
+         if (first == last)
+            return last;
+         auto p = C::address(first);
+         size_t num = (size_t)(C::address(last) - p);
+         return Iterator(p + simd::extreme<false>(p, num, simd::cpu_level()));
+      }
+   }
+
+   Iterator best = first;
+   if (first != last)
+      for (++first; first != last; ++first)
+         if (*first < *best)
+            best = first;
+   return best;
+}
+
+template <class Iterator>
+Iterator max_element(Iterator first, Iterator last)
+{
+   typedef simd::contiguous<Iterator> C;
+   if constexpr (C::value)
+   {
+      if constexpr (simd::vectorizable_minmax<typename C::element>::value)
+      {
+         if (first == last)
+            return last;
+         auto p = C::address(first);
+         size_t num = (size_t)(C::address(last) - p);
+         return Iterator(p + simd::extreme<true>(p, num, simd::cpu_level()));
+      }
+   }
+
+   Iterator best = first;
+   if (first != last)
+      for (++first; first != last; ++first)
+         if (*best < *first)
+            best = first;
+   return best;
+}
+
+/*****************************************
+ * VECTOR OVERLOADS
+ * A vector is contiguous, so scan its buffer directly
+ ****************************************/
+template <typename T, typename G, typename A>
+typename vector <T, G, A> ::iterator find(vector <T, G, A> & v, const T & value)
+{
+   T * p = v.empty() ? nullptr : &v[0];
+   return typename vector <T, G, A> ::iterator(custom::find(p, p + v.size(), value));
+}
+
+template <typename T, typename G, typename A>
+size_t count(const vector <T, G, A> & v, const T & value)
+{
+   const T * p = v.empty() ? nullptr : &v[0];
+   return custom::count(p, p + v.size(), value);
+}
+
+template <typename T, typename G, typename A>
+bool contains(const vector <T, G, A> & v, const T & value)
+{
+   const T * p = v.empty() ? nullptr : &v[0];
+   return custom::contains(p, p + v.size(), value);
+}
+
+template <typename T, typename G, typename A>
+typename vector <T, G, A> ::iterator min_element(vector <T, G, A> & v)
+{
+   T * p = v.empty() ? nullptr : &v[0];
+   return typename vector <T, G, A> ::iterator(custom::min_element(p, p + v.size()));
+}
+
+template <typename T, typename G, typename A>
+typename vector <T, G, A> ::iterator max_element(vector <T, G, A> & v)
+{
+   T * p = v.empty() ? nullptr : &v[0];
+   return typename vector <T, G, A> ::iterator(custom::max_element(p, p + v.size()));
+}
+
+} // namespace custom
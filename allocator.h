@@ -0,0 +1,118 @@
+/***********************************************************************
+ * Header:
+ *    ALLOCATOR
+ * Summary:
+ *    Allocators which control where a container's buffer lives.
+ *    Both follow the std::allocator interface so vector and the
+ *    unordered_set bucket array can use them interchangeably.
+ *
+ *    This will contain the class definition of:
+ *        aligned_allocator      : Buffers start on an Align boundary
+ *        huge_page_allocator    : Large buffers are backed by 2 MB pages
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <new>       // for std::align_val_t and std::bad_alloc
+
+#if defined(__linux__)
+#include <sys/mman.h>  // for madvise
+#endif
+
+namespace custom
+{
+
+const size_t CACHE_LINE_BYTES = 64;                 // bytes in an L1 cache line
+const size_t PAGE_BYTES       = 4096;               // bytes in a (small) page
+const size_t HUGE_PAGE_BYTES  = 2 * 1024 * 1024;    // bytes in a huge page
+
+/*****************************************
+ * ALIGNED ALLOCATOR
+ * Every buffer starts on an Align-byte boundary. The default
+ * keeps a buffer from sharing its first cache line with
+ * anything else.
+ ****************************************/
+template <typename T, size_t Align = CACHE_LINE_BYTES>
+class aligned_allocator
+{
+public:
+   typedef T value_type;
+   template <typename U>
+   struct rebind { typedef aligned_allocator<U, Align> other; };
+
+   aligned_allocator() noexcept {}
+   template <typename U>
+   aligned_allocator(const aligned_allocator<U, Align> &) noexcept {}
+
+   T * allocate(size_t num)
+   {
+      return (T *)::operator new(num * sizeof(T), std::align_val_t(alignment()));
+   }
+   void deallocate(T * p, size_t) noexcept
+   {
+      ::operator delete(p, std::align_val_t(alignment()));
+   }
+
+   // never weaker than what T itself requires
+   static constexpr size_t alignment()
+   {
+      return Align > alignof(T) ? Align : alignof(T);
+   }
+
+   template <typename U>
+   bool operator == (const aligned_allocator<U, Align> &) const noexcept { return true;  }
+   template <typename U>
+   bool operator != (const aligned_allocator<U, Align> &) const noexcept { return false; }
+};
+
+/*****************************************
+ * HUGE PAGE ALLOCATOR
+ * Buffers of at least a huge page are aligned to, and padded
+ * out to, whole 2 MB pages and handed to the kernel for
+ * transparent huge page backing. A random access into such a
+ * buffer needs one TLB entry per 2 MB rather than per 4 KB.
+ * Smaller buffers are simply cache line aligned.
+ ****************************************/
+template <typename T>
+class huge_page_allocator
+{
+public:
+   typedef T value_type;
+   template <typename U>
+   struct rebind { typedef huge_page_allocator<U> other; };
+
+   huge_page_allocator() noexcept {}
+   template <typename U>
+   huge_page_allocator(const huge_page_allocator<U> &) noexcept {}
+
+   T * allocate(size_t num)
+   {
+      size_t numBytes = num * sizeof(T);
+      if (numBytes < HUGE_PAGE_BYTES)
+         return (T *)::operator new(numBytes, std::align_val_t(CACHE_LINE_BYTES));
+
+      numBytes = (numBytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+      void * p = ::operator new(numBytes, std::align_val_t(HUGE_PAGE_BYTES));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+      madvise(p, numBytes, MADV_HUGEPAGE);   // only a hint; ignore failure
+#endif
+      return (T *)p;
+   }
+   void deallocate(T * p, size_t num) noexcept
+   {
+      if (num * sizeof(T) < HUGE_PAGE_BYTES)
+         ::operator delete(p, std::align_val_t(CACHE_LINE_BYTES));
+      else
+         ::operator delete(p, std::align_val_t(HUGE_PAGE_BYTES));
+   }
+
+   template <typename U>
+   bool operator == (const huge_page_allocator<U> &) const noexcept { return true;  }
+   template <typename U>
+   bool operator != (const huge_page_allocator<U> &) const noexcept { return false; }
+};
+
+} // namespace custom
@@ -0,0 +1,67 @@
+/***********************************************************************
+ * Header:
+ *    BENCH ALLOCATOR
+ * Summary:
+ *    Random-access latency through a large vector with the default
+ *    allocator versus the huge page allocator
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "vector.h"
+#include "benchmark.h"
+
+class BenchAllocator : public Benchmark
+{
+public:
+   void run()
+   {
+      bench_randomAccess<std::allocator<uint64_t>>("std::allocator");
+      bench_randomAccess<custom::aligned_allocator<uint64_t>>("aligned_allocator");
+      bench_randomAccess<custom::huge_page_allocator<uint64_t>>("huge_page_allocator");
+   }
+
+   /*************************************************************
+    * RANDOM ACCESS
+    * Chase a single random cycle through a 256 MB vector. Every
+    * load depends on the one before it, so the time per hop is
+    * the latency of a cache (and usually TLB) miss.
+    *************************************************************/
+   template <class A>
+   void bench_randomAccess(const char * variant)
+   {
+      const size_t numElements = (256 * 1024 * 1024) / sizeof(uint64_t);
+      const size_t numHops     = 10 * 1000 * 1000;
+
+      custom::vector<uint64_t, custom::growth_double, A> v;
+      v.resize(numElements);
+
+      // Sattolo's algorithm: one cycle through every element
+      for (size_t i = 0; i < numElements; i++)
+         v[i] = i;
+      uint64_t state = 88172645463325252ULL;
+      for (size_t i = numElements - 1; i > 0; i--)
+      {
+         size_t j = (size_t)(random(state) % i);
+         uint64_t temp = v[i];
+         v[i] = v[j];
+         v[j] = temp;
+      }
+
+      uint64_t index = 0;
+      double ns = time([&]()
+      {
+         for (size_t i = 0; i < numHops; i++)
+            index = v[(size_t)index];
+      }, numHops);
+      keep(index);
+
+      report("RandomAccess", variant, ns);
+   }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,132 @@
+/***********************************************************************
+ * Header:
+ *    BENCH HASH
+ * Summary:
+ *    Throughput of std::hash versus custom::hash: integers per
+ *    nanosecond, and bytes per nanosecond for strings of a few sizes.
+ *    Then the cost of turning a hash into a bucket number.
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "hash.h"
+#include "hashFunction.h"
+#include "benchmark.h"
+
+#include <functional> // for std::hash
+#include <string>     // for std::string
+
+class BenchHash : public Benchmark
+{
+public:
+   void run()
+   {
+      bench_integer<std::hash<uint64_t>>("std::hash");
+      bench_integer<custom::hash<uint64_t>>("custom::hash");
+      bench_integer<custom::seeded_hash<uint64_t>>("seeded_hash");
+
+      for (size_t len = 8; len <= 4096; len *= 8)
+      {
+         bench_string<std::hash<std::string>>(len, "std::hash");
+         bench_string<custom::hash<std::string>>(len, "custom::hash");
+      }
+
+      bench_reduce<ReduceDivide>("% (divide)");
+      bench_reduce<custom::reduce_modulo<1000>>("reduce_modulo");
+      bench_reduce<custom::reduce_mask<1024>>("reduce_mask");
+      bench_reduce<custom::reduce_fastrange<1000>>("reduce_fastrange");
+   }
+
+   /*************************************************************
+    * REDUCE DIVIDE
+    * The baseline: a bucket count only known at run time, so
+    * the % has to be a real divide
+    *************************************************************/
+   struct ReduceDivide
+   {
+      static size_t index(size_t hash)
+      {
+         static volatile size_t numBuckets = 1000;
+         return hash % numBuckets;
+      }
+   };
+
+   /*************************************************************
+    * INTEGER
+    * Hash a run of random keys, summing the results so that no
+    * hash can be skipped. Each hash is independent of the last,
+    * so this is throughput rather than latency.
+    *************************************************************/
+   template <class H>
+   void bench_integer(const char * variant)
+   {
+      const size_t numKeys = 50 * 1000 * 1000;
+
+      H hasher;
+      uint64_t state = 88172645463325252ULL;
+      uint64_t sum = 0;
+      double ns = time([&]()
+      {
+         for (size_t i = 0; i < numKeys; i++)
+            sum += hasher(random(state));
+      }, numKeys);
+      keep(sum);
+
+      report("HashInteger", variant, ns, "ns/key");
+   }
+
+   /*************************************************************
+    * STRING
+    * Hash the same string over and over, a byte changed each
+    * time so the work cannot be hoisted out of the loop
+    *************************************************************/
+   template <class H>
+   void bench_string(size_t len, const char * variant)
+   {
+      const size_t numBytes = 500 * 1000 * 1000;
+      const size_t numHashes = numBytes / len;
+
+      H hasher;
+      std::string s(len, 'x');
+      uint64_t sum = 0;
+      double ns = time([&]()
+      {
+         for (size_t i = 0; i < numHashes; i++)
+         {
+            s[i % len] = (char)i;
+            sum += hasher(s);
+         }
+      }, numHashes);
+      keep(sum);
+
+      std::string name = "HashString " + std::to_string(len);
+      report(name.c_str(), variant, (double)len / ns, "bytes/ns");
+   }
+
+   /*************************************************************
+    * REDUCE
+    * Bucket numbers for a run of random hashes
+    *************************************************************/
+   template <class R>
+   void bench_reduce(const char * variant)
+   {
+      const size_t numKeys = 50 * 1000 * 1000;
+
+      uint64_t state = 88172645463325252ULL;
+      uint64_t sum = 0;
+      double ns = time([&]()
+      {
+         for (size_t i = 0; i < numKeys; i++)
+            sum += R::index((size_t)random(state));
+      }, numKeys);
+      keep(sum);
+
+      report("Reduce", variant, ns, "ns/key");
+   }
+};
+
+#endif // BENCHMARK
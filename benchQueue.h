@@ -0,0 +1,104 @@
+/***********************************************************************
+ * Header:
+ *    BENCH QUEUE
+ * Summary:
+ *    Throughput of a work queue between several producer threads and
+ *    one consumer: a list guarded by a mutex versus mpsc_queue
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "list.h"
+#include "mpscQueue.h"
+#include "benchmark.h"
+
+#include <mutex>     // for std::mutex
+#include <string>    // for std::to_string
+#include <thread>    // for std::thread
+#include <vector>
+
+class BenchQueue : public Benchmark
+{
+public:
+   void run()
+   {
+      for (int numProducers = 1; numProducers <= 4; numProducers *= 2)
+      {
+         bench_throughput<ListQueue>(numProducers, "mutex + list");
+         bench_throughput<custom::mpsc_queue<uint64_t>>(numProducers, "mpsc_queue");
+      }
+   }
+
+   /*************************************************************
+    * LIST QUEUE
+    * The baseline: a list with a lock around every operation
+    *************************************************************/
+   class ListQueue
+   {
+   public:
+      void push(const uint64_t & value)
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         items.push_back(value);
+      }
+      bool pop(uint64_t & value)
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         if (items.empty())
+            return false;
+         value = items.front();
+         items.pop_front();
+         return true;
+      }
+   private:
+      std::mutex mutex;
+      custom::list<uint64_t> items;
+   };
+
+   /*************************************************************
+    * THROUGHPUT
+    * Every producer pushes its share of the items as fast as it
+    * can while one consumer pops them all. Report the time per
+    * item from the first push to the last pop.
+    *************************************************************/
+   template <class Queue>
+   void bench_throughput(int numProducers, const char * variant)
+   {
+      const size_t numItems = 4 * 1000 * 1000;
+      const size_t numEach  = numItems / numProducers;
+
+      Queue queue;
+      uint64_t sum = 0;
+      double ns = time([&]()
+      {
+         std::vector<std::thread> producers;
+         for (int p = 0; p < numProducers; p++)
+            producers.push_back(std::thread([&queue, numEach]()
+            {
+               for (size_t i = 0; i < numEach; i++)
+                  queue.push(i);
+            }));
+
+         uint64_t value;
+         for (size_t numPopped = 0; numPopped < numEach * numProducers; )
+            if (queue.pop(value))
+            {
+               sum += value;
+               numPopped++;
+            }
+
+         for (std::thread & t : producers)
+            t.join();
+      }, numEach * numProducers);
+      keep(sum);
+
+      std::string name = "Queue " + std::to_string(numProducers) + "P1C";
+      report(name.c_str(), variant, ns, "ns/item");
+   }
+};
+
+#endif // BENCHMARK
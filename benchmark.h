@@ -0,0 +1,72 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK
+ * Summary:
+ *    The base class to all the benchmark classes. Much like a unit
+ *    test, but each case reports how long an operation took rather
+ *    than whether it was correct.
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include <iostream>  // for std::cout
+#include <chrono>    // for std::chrono::steady_clock
+#include <cstdint>   // for uint64_t
+
+class Benchmark
+{
+protected:
+   /*************************************************************
+    * TIME
+    * Run the operation once and return the number of nanoseconds
+    * it took per repetition
+    *************************************************************/
+   template <class Operation>
+   double time(Operation operation, size_t numRepetitions)
+   {
+      auto begin = std::chrono::steady_clock::now();
+      operation();
+      auto end = std::chrono::steady_clock::now();
+      double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+      return numRepetitions ? ns / (double)numRepetitions : ns;
+   }
+
+   /*************************************************************
+    * REPORT
+    * Display one measurement
+    *************************************************************/
+   void report(const char * name, const char * variant, double value,
+               const char * units = "ns/op")
+   {
+      std::cout.setf(std::ios::fixed | std::ios::showpoint);
+      std::cout.precision(2);
+      std::cout << name << ":\t" << variant << "\t" << value << " " << units << "\n";
+   }
+
+   /*************************************************************
+    * RANDOM
+    * A small, fast, repeatable generator (xorshift64*)
+    *************************************************************/
+   static uint64_t random(uint64_t & state)
+   {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return state * 0x2545F4914F6CDD1DULL;
+   }
+
+   // keep the optimizer from discarding a result
+   static void keep(uint64_t value)
+   {
+      sink = value;
+   }
+
+private:
+   static inline volatile uint64_t sink = 0;   // where keep() writes
+};
+
+#endif // BENCHMARK
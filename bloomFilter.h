@@ -0,0 +1,306 @@
+/***********************************************************************
+ * Header:
+ *    BLOOM FILTER
+ * Summary:
+ *    A blocked Bloom filter: a compact answer to "could this be in
+ *    the set?" which is never wrong when it says no. Put one in front
+ *    of a set whose lookups mostly miss and most misses never reach
+ *    the set at all.
+ *
+ *    The bits are split into 32 byte blocks, half a cache line each.
+ *    An element sets exactly one bit in each of the block's eight
+ *    32-bit words, all in the one block its hash picks, so a lookup
+ *    reads one cache line however many bits it tests:
+ *
+ *        hash:   [ block (top 32 bits) | pattern (low 32 bits) ]
+ *        bit in word i = (pattern * SALT[i]) >> 27
+ *
+ *    Computing the eight bits and testing them is eight independent
+ *    lanes of the same arithmetic, which AVX2 does in a handful of
+ *    instructions; other CPUs get the plain loop.
+ *
+ *    The filter is sized from the number of elements expected and the
+ *    false positive rate wanted. Bits cannot be cleared, so erasing
+ *    from a filtered_set leaves the filter a little staler until
+ *    rebuild().
+ *
+ *    This will contain the class definitions of:
+ *        blocked_bloom_filter   : The filter itself
+ *        filtered_set           : A set with a filter in front of find()
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "algorithm.h"  // for simd::level and the target macros
+#include "allocator.h"  // for aligned_allocator
+#include "hash.h"       // for unordered_set, the default behind a filter
+#include "vector.h"     // for the blocks
+#include <cmath>        // for std::log and std::ceil
+#include <cstdint>      // for uint32_t and uint64_t
+#include <functional>   // for std::hash
+#include <utility>      // for std::declval
+
+class TestBloomFilter;  // forward declaration for unit tests
+
+namespace custom
+{
+namespace simd
+{
+
+/*****************************************
+ * BLOOM SALT
+ * One odd multiplier per word of a block
+ ****************************************/
+alignas(32) static const uint32_t BLOOM_SALT[8] =
+{
+   0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+   0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+/*****************************************
+ * BLOOM SCALAR
+ * Set or test the eight bits of a pattern in a block
+ ****************************************/
+inline void bloom_insert_scalar(uint32_t * words, uint32_t pattern)
+{
+   for (size_t i = 0; i < 8; i++)
+      words[i] |= 1U << ((pattern * BLOOM_SALT[i]) >> 27);
+}
+
+inline bool bloom_contains_scalar(const uint32_t * words, uint32_t pattern)
+{
+   for (size_t i = 0; i < 8; i++)
+   {
+      uint32_t bit = 1U << ((pattern * BLOOM_SALT[i]) >> 27);
+      if ((words[i] & bit) == 0)
+         return false;
+   }
+   return true;
+}
+
+#ifdef CUSTOM_SIMD_X86
+
+/*****************************************
+ * BLOOM AVX2
+ * All eight words at once: multiply, shift, and test
+ * that every bit of the mask is in the block
+ ****************************************/
+CUSTOM_TARGET_AVX2 inline __m256i bloom_mask_avx2(uint32_t pattern)
+{
+   __m256i salt = _mm256_load_si256((const __m256i *)BLOOM_SALT);
+   __m256i shift = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)pattern), salt), 27);
+   return _mm256_sllv_epi32(_mm256_set1_epi32(1), shift);
+}
+
+CUSTOM_TARGET_AVX2 inline void bloom_insert_avx2(uint32_t * words, uint32_t pattern)
+{
+   __m256i block = _mm256_load_si256((const __m256i *)words);
+   _mm256_store_si256((__m256i *)words, _mm256_or_si256(block, bloom_mask_avx2(pattern)));
+}
+
+CUSTOM_TARGET_AVX2 inline bool bloom_contains_avx2(const uint32_t * words, uint32_t pattern)
+{
+   __m256i block = _mm256_load_si256((const __m256i *)words);
+   return _mm256_testc_si256(block, bloom_mask_avx2(pattern)) != 0;
+}
+
+#endif // CUSTOM_SIMD_X86
+
+} // namespace simd
+
+/************************************************
+ * BLOCKED BLOOM FILTER
+ * insert() and contains() are O(1) and touch one
+ * block. contains() may say yes for an element never
+ * inserted, at about the rate asked for.
+ ************************************************/
+template <typename T, typename H = std::hash<T>>
+class blocked_bloom_filter
+{
+   friend class ::TestBloomFilter;   // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+   blocked_bloom_filter(size_t numExpected = 1024, double falsePositive = 0.01,
+                        const H & hasher = H());
+
+   //
+   // Insert
+   //
+   void insert(const T & t)
+   {
+      uint64_t hash = hash_of(t);
+      uint32_t * words = blocks[block_of(hash)].words;
+#ifdef CUSTOM_SIMD_X86
+      if (simd::cpu_level() == simd::AVX2)
+      {
+         simd::bloom_insert_avx2(words, (uint32_t)hash);
+         return;
+      }
+#endif
+      simd::bloom_insert_scalar(words, (uint32_t)hash);
+   }
+
+   //
+   // Access
+   //
+   bool contains(const T & t) const { return contains(t, simd::cpu_level()); }
+   bool contains(const T & t, simd::level lvl) const
+   {
+      uint64_t hash = hash_of(t);
+      const uint32_t * words = blocks[block_of(hash)].words;
+#ifdef CUSTOM_SIMD_X86
+      if (lvl == simd::AVX2)
+         return simd::bloom_contains_avx2(words, (uint32_t)hash);
+#endif
+      return simd::bloom_contains_scalar(words, (uint32_t)hash);
+   }
+
+   //
+   // Remove
+   //
+   void clear()
+   {
+      for (size_t i = 0; i < blocks.size(); i++)
+         blocks[i] = Block();
+   }
+
+   //
+   // Status
+   //
+   size_t block_count() const { return blocks.size();                }
+   size_t bytes()       const { return blocks.size() * sizeof(Block); }
+
+private:
+   /*************************************************
+    * BLOCK
+    * 256 bits: eight words, one bit from each per element
+    *************************************************/
+   struct alignas(32) Block
+   {
+      Block() : words() {}
+      uint32_t words[8];
+   };
+
+   // mix the bits: std::hash of an integer is often the integer
+   uint64_t hash_of(const T & t) const
+   {
+      uint64_t h = (uint64_t)hasher(t);
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdull;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ull;
+      h ^= h >> 33;
+      return h;
+   }
+
+   // the top 32 bits scaled to [0, block_count()) with a multiply
+   size_t block_of(uint64_t hash) const
+   {
+      return (size_t)(((hash >> 32) * (uint64_t)blocks.size()) >> 32);
+   }
+
+   vector <Block, growth_double, aligned_allocator<Block>> blocks;
+   H hasher;
+};
+
+/*****************************************
+ * BLOCKED BLOOM FILTER :: CONSTRUCTOR
+ * The classic n ln(1/p) / ln(2)^2 bits, in whole blocks.
+ * Keeping each element's bits in one block costs a little
+ * accuracy, so give it a quarter more.
+ ****************************************/
+template <typename T, typename H>
+blocked_bloom_filter <T, H> ::blocked_bloom_filter(size_t numExpected, double falsePositive,
+                                                   const H & hasher)
+   : hasher(hasher)
+{
+   if (falsePositive <= 0.0 || falsePositive >= 1.0)
+      throw "ERROR: the false positive rate must be between 0 and 1";
+
+   const double ln2 = std::log(2.0);
+   double bits = 1.25 * (double)numExpected * -std::log(falsePositive) / (ln2 * ln2);
+   size_t numBlocks = (size_t)std::ceil(bits / (8.0 * sizeof(Block)));
+   blocks.resize(numBlocks ? numBlocks : 1);
+}
+
+/************************************************
+ * FILTERED SET
+ * A set behind a Bloom filter. find() on an element
+ * the filter has never seen does not touch the set.
+ ************************************************/
+template <typename T, typename Set = unordered_set<T>, typename H = std::hash<T>>
+class filtered_set
+{
+   friend class ::TestBloomFilter;   // give unit tests access to the privates
+public:
+   typedef typename Set::iterator iterator;
+
+   //
+   // Construct
+   //
+   filtered_set(size_t numExpected = 1024, double falsePositive = 0.01)
+      : filter(numExpected, falsePositive), numFiltered(0) {}
+
+   //
+   // Iterator
+   //
+   iterator begin() { return set.begin(); }
+   iterator end()   { return set.end();   }
+
+   //
+   // Access
+   //
+   iterator find(const T & t)
+   {
+      if (!filter.contains(t))
+      {
+         numFiltered++;
+         return set.end();
+      }
+      return set.find(t);
+   }
+   size_t count(const T & t) { return find(t) != end() ? 1 : 0; }
+
+   //
+   // Insert
+   //
+   auto insert(const T & t) -> decltype(std::declval<Set &>().insert(t))
+   {
+      filter.insert(t);
+      return set.insert(t);
+   }
+
+   //
+   // Remove
+   //
+   iterator erase(const T & t) { return set.erase(t); }
+   void clear()
+   {
+      set.clear();
+      filter.clear();
+   }
+   void rebuild()
+   {
+      filter.clear();
+      for (iterator it = set.begin(); it != set.end(); ++it)
+         filter.insert(*it);
+   }
+
+   //
+   // Status
+   //
+   size_t size()     const { return set.size();  }
+   bool   empty()    const { return set.empty(); }
+   size_t filtered() const { return numFiltered; }   // finds the filter answered
+
+private:
+   Set set;
+   blocked_bloom_filter<T, H> filter;
+   size_t numFiltered;
+};
+
+} // namespace custom
@@ -0,0 +1,652 @@
+/***********************************************************************
+ * Header:
+ *    CUCKOO SET
+ * Summary:
+ *    A hash set whose lookups have a fixed worst case. Every element
+ *    lives in one of exactly two buckets, chosen by its hash, so find()
+ *    looks in those two and nowhere else. There are no chains to grow.
+ *
+ *    Each bucket is one cache line holding four slots and a one byte
+ *    tag per slot, taken from the top of the element's (mixed) hash. find()
+ *    compares the tags first and only compares the elements whose tags
+ *    match. The second bucket comes from the first and the tag alone,
+ *    so an element can be moved to its other bucket without hashing
+ *    it again:
+ *
+ *        i1 = hash & mask
+ *        i2 = (i1 ^ tag * 0x5bd1e995) & mask      and back again
+ *
+ *    When both buckets are full, insert() searches breadth first for
+ *    the shortest chain of moves that opens a slot, then makes them.
+ *    If there is no such chain, the element goes to a tiny stash, and
+ *    when the stash is full the bucket array doubles. find() only looks
+ *    in the stash when it is not empty.
+ *    Elements whose hashes are all the same share the same two
+ *    buckets at every size, so growing cannot help them: when the
+ *    thirteenth such element arrives, or when MAX_GROW doublings in a
+ *    row still leave no room, insert() throws instead.
+ *
+ *    This will contain the class definition of:
+ *        cuckoo_set             : A bucketized cuckoo hash set
+ *        cuckoo_set::iterator   : An iterator through the set
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "pair.h"       // for the result of insert
+#include "vector.h"     // for the stash
+#include "allocator.h"  // for CACHE_LINE_BYTES
+#include <cassert>      // because I am paranoid
+#include <functional>   // for std::hash and std::equal_to
+#include <new>          // for placement new and std::align_val_t
+#include <utility>      // for std::move and std::swap
+
+class TestCuckooSet;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * CUCKOO SET
+ * The same insert/find/erase as unordered_set. A
+ * bucket is one cache line as long as four elements
+ * and their tags fit, about 15 bytes an element.
+ ************************************************/
+template <typename T, typename H = std::hash<T>, typename E = std::equal_to<T>>
+class cuckoo_set
+{
+   friend class ::TestCuckooSet;   // give unit tests access to the privates
+public:
+   static const size_t SLOTS     = 4;     // elements in a bucket
+   static const size_t STASH     = 4;     // elements in the stash before we grow
+   static const size_t MAX_PATH  = 256;   // buckets the displacement search may visit
+   static const size_t MAX_GROW  = 3;     // doublings one insert may make
+
+   //
+   // Construct
+   //
+   cuckoo_set(size_t numBuckets = 8, const H & hasher = H(), const E & equal = E());
+   cuckoo_set(const cuckoo_set & rhs);
+   cuckoo_set(cuckoo_set && rhs) : cuckoo_set(1, rhs.hasher, rhs.equal)
+   {
+      swap(rhs);
+   }
+  ~cuckoo_set();
+
+   //
+   // Assign
+   //
+   cuckoo_set & operator = (cuckoo_set rhs)
+   {
+      swap(rhs);
+      return *this;
+   }
+   void swap(cuckoo_set & rhs)
+   {
+      std::swap(buckets, rhs.buckets);
+      std::swap(numBuckets, rhs.numBuckets);
+      std::swap(numElements, rhs.numElements);
+      stash.swap(rhs.stash);
+      std::swap(hasher, rhs.hasher);
+      std::swap(equal, rhs.equal);
+   }
+
+   //
+   // Iterator
+   //
+   class iterator;
+   iterator begin();
+   iterator end() { return iterator(this, numBuckets + 1, 0); }
+
+   //
+   // Access
+   //
+   iterator find(const T & t);
+   size_t count(const T & t) { return find(t) != end() ? 1 : 0; }
+
+   //
+   // Insert
+   //
+   custom::pair<iterator, bool> insert(const T & t);
+   custom::pair<iterator, bool> insert(T && t);
+
+   //
+   // Remove
+   //
+   iterator erase(const T & t);
+   void clear() noexcept;
+
+   //
+   // Status
+   //
+   size_t size()         const { return numElements;      }
+   bool   empty()        const { return numElements == 0; }
+   size_t bucket_count() const { return numBuckets;       }
+   double load_factor()  const { return (double)numElements / (double)(numBuckets * SLOTS); }
+
+private:
+   /*************************************************
+    * BUCKET
+    * Four slots on one cache line. A tag of 0 means the
+    * slot is empty; an element's tag is never 0.
+    *************************************************/
+   struct alignas(CACHE_LINE_BYTES) Bucket
+   {
+      Bucket() : tags() {}
+      T * slot(size_t i) { return reinterpret_cast<T *>(storage[i]); }
+
+      unsigned char tags[SLOTS];
+      alignas(T) unsigned char storage[SLOTS][sizeof(T)];
+   };
+
+   /*************************************************
+    * STEP
+    * One bucket reached by the displacement search:
+    * the element in slot parentSlot of the parent's
+    * bucket can move here
+    *************************************************/
+   struct Step
+   {
+      size_t bucket;
+      int parent;         // index of the step before, or -1 for i1 and i2
+      size_t parentSlot;
+   };
+
+   iterator add(T && t);
+   bool place(T && t, size_t hash, iterator & it);
+   bool displace(size_t i1, size_t i2, size_t & iBucket, size_t & iSlot);
+   void grow();
+   bool hopeless(size_t hash);
+   void destroyBuckets();
+
+   // mix the bits of the hash: std::hash of an integer is often
+   // the integer, which leaves the top (the tag) and the low bits
+   // (the bucket) far too alike
+   size_t hash_of(const T & t) const
+   {
+      size_t h = hasher(t);
+      h ^= h >> 33;
+      h *= (size_t)0xff51afd7ed558ccdull;
+      h ^= h >> 33;
+      h *= (size_t)0xc4ceb9fe1a85ec53ull;
+      h ^= h >> 33;
+      return h;
+   }
+
+   // the tag and the two buckets for a hash
+   unsigned char tag_of(size_t hash) const
+   {
+      unsigned char tag = (unsigned char)(hash >> (sizeof(size_t) * 8 - 8));
+      return tag ? tag : 1;
+   }
+   size_t index_of(size_t hash) const
+   {
+      return hash & (numBuckets - 1);
+   }
+   size_t alternate(size_t iBucket, unsigned char tag) const
+   {
+      return (iBucket ^ ((size_t)tag * 0x5bd1e995)) & (numBuckets - 1);
+   }
+   static int free_slot(const Bucket & b)
+   {
+      for (size_t i = 0; i < SLOTS; i++)
+         if (b.tags[i] == 0)
+            return (int)i;
+      return -1;
+   }
+
+   Bucket * buckets;        // numBuckets of them
+   size_t numBuckets;       // a power of two
+   size_t numElements;      // including the stash
+   vector<T> stash;         // what would not fit, at most STASH
+   H hasher;
+   E equal;
+};
+
+/************************************************
+ * CUCKOO SET ITERATOR
+ * A bucket and a slot. Bucket numBuckets is the
+ * stash, and numBuckets + 1 is the end.
+ ************************************************/
+template <typename T, typename H, typename E>
+class cuckoo_set <T, H, E> ::iterator
+{
+   friend class ::TestCuckooSet;   // give unit tests access to the privates
+   template <class TT, class HH, class EE>
+   friend class custom::cuckoo_set;
+public:
+   //
+   // Construct
+   //
+   iterator() : pSet(nullptr), iBucket(0), iSlot(0) {}
+   iterator(cuckoo_set * pSet, size_t iBucket, size_t iSlot)
+      : pSet(pSet), iBucket(iBucket), iSlot(iSlot) {}
+
+   //
+   // Compare
+   //
+   bool operator == (const iterator & rhs) const
+   {
+      return iBucket == rhs.iBucket && iSlot == rhs.iSlot;
+   }
+   bool operator != (const iterator & rhs) const
+   {
+      return !(*this == rhs);
+   }
+
+   //
+   // Access
+   //
+   T & operator * ()
+   {
+      if (iBucket == pSet->numBuckets)
+         return pSet->stash[iSlot];
+      return *pSet->buckets[iBucket].slot(iSlot);
+   }
+   T * operator -> () { return &**this; }
+
+   //
+   // Arithmetic
+   //
+   iterator & operator ++ ();
+   iterator operator ++ (int postfix)
+   {
+      iterator tmp(*this);
+      ++*this;
+      return tmp;
+   }
+
+private:
+   // move forward, if need be, to the first element at or after here
+   void skip();
+
+   cuckoo_set * pSet;
+   size_t iBucket;
+   size_t iSlot;
+};
+
+/*****************************************
+ * CUCKOO SET :: CONSTRUCTOR
+ * Round the buckets up to a power of two
+ ****************************************/
+template <typename T, typename H, typename E>
+cuckoo_set <T, H, E> ::cuckoo_set(size_t numBuckets, const H & hasher, const E & equal)
+   : numBuckets(1), numElements(0), hasher(hasher), equal(equal)
+{
+   while (this->numBuckets < numBuckets)
+      this->numBuckets *= 2;
+   buckets = static_cast<Bucket *>(::operator new(sizeof(Bucket) * this->numBuckets,
+                                                  std::align_val_t(alignof(Bucket))));
+   for (size_t i = 0; i < this->numBuckets; i++)
+      new (buckets + i) Bucket;
+}
+
+/*****************************************
+ * CUCKOO SET :: COPY CONSTRUCTOR
+ * Same number of buckets, so every element lands in the
+ * same place it had in rhs
+ ****************************************/
+template <typename T, typename H, typename E>
+cuckoo_set <T, H, E> ::cuckoo_set(const cuckoo_set & rhs)
+   : cuckoo_set(rhs.numBuckets, rhs.hasher, rhs.equal)
+{
+   for (size_t i = 0; i < numBuckets; i++)
+      for (size_t j = 0; j < SLOTS; j++)
+         if (rhs.buckets[i].tags[j])
+         {
+            new (buckets[i].slot(j)) T(*const_cast<Bucket &>(rhs.buckets[i]).slot(j));
+            buckets[i].tags[j] = rhs.buckets[i].tags[j];
+         }
+   stash = rhs.stash;
+   numElements = rhs.numElements;
+}
+
+/*****************************************
+ * CUCKOO SET :: DESTRUCTOR
+ ****************************************/
+template <typename T, typename H, typename E>
+cuckoo_set <T, H, E> ::~cuckoo_set()
+{
+   destroyBuckets();
+}
+
+/*****************************************
+ * CUCKOO SET :: DESTROY BUCKETS
+ * Destroy every element in the buckets and free them
+ ****************************************/
+template <typename T, typename H, typename E>
+void cuckoo_set <T, H, E> ::destroyBuckets()
+{
+   if (buckets == nullptr)
+      return;
+   for (size_t i = 0; i < numBuckets; i++)
+      for (size_t j = 0; j < SLOTS; j++)
+         if (buckets[i].tags[j])
+            buckets[i].slot(j)->~T();
+   ::operator delete(buckets, std::align_val_t(alignof(Bucket)));
+   buckets = nullptr;
+}
+
+/*****************************************
+ * CUCKOO SET :: BEGIN
+ ****************************************/
+template <typename T, typename H, typename E>
+typename cuckoo_set <T, H, E> ::iterator cuckoo_set <T, H, E> ::begin()
+{
+   iterator it(this, 0, 0);
+   it.skip();
+   return it;
+}
+
+/*****************************************
+ * CUCKOO SET :: FIND
+ * Look in the two buckets, comparing tags before
+ * elements, then in the stash if there is one
+ *    COST   : two cache lines, plus the stash when in use
+ ****************************************/
+template <typename T, typename H, typename E>
+typename cuckoo_set <T, H, E> ::iterator cuckoo_set <T, H, E> ::find(const T & t)
+{
+   size_t hash = hash_of(t);
+   unsigned char tag = tag_of(hash);
+   size_t i1 = index_of(hash);
+   size_t i2 = alternate(i1, tag);
+
+   for (size_t i : { i1, i2 })
+   {
+      Bucket & b = buckets[i];
+      for (size_t j = 0; j < SLOTS; j++)
+         if (b.tags[j] == tag && equal(*b.slot(j), t))
+            return iterator(this, i, j);
+   }
+
+   for (size_t j = 0; j < stash.size(); j++)
+      if (equal(stash[j], t))
+         return iterator(this, numBuckets, j);
+   return end();
+}
+
+/*****************************************
+ * CUCKOO SET :: INSERT
+ * Copy t in, unless it is already here
+ ****************************************/
+template <typename T, typename H, typename E>
+custom::pair<typename cuckoo_set <T, H, E> ::iterator, bool>
+cuckoo_set <T, H, E> ::insert(const T & t)
+{
+   iterator it = find(t);
+   if (it != end())
+      return custom::pair<iterator, bool>(it, false);
+   T copy(t);
+   return custom::pair<iterator, bool>(add(std::move(copy)), true);
+}
+
+/*****************************************
+ * CUCKOO SET :: INSERT MOVE
+ * Move t in, unless it is already here
+ ****************************************/
+template <typename T, typename H, typename E>
+custom::pair<typename cuckoo_set <T, H, E> ::iterator, bool>
+cuckoo_set <T, H, E> ::insert(T && t)
+{
+   iterator it = find(t);
+   if (it != end())
+      return custom::pair<iterator, bool>(it, false);
+   return custom::pair<iterator, bool>(add(std::move(t)), true);
+}
+
+/*****************************************
+ * CUCKOO SET :: ADD
+ * Put t, which is not here yet, in one of its buckets,
+ * moving others out of the way if need be, or in the
+ * stash, or grow and try again. Give up rather than
+ * double the buckets forever.
+ ****************************************/
+template <typename T, typename H, typename E>
+typename cuckoo_set <T, H, E> ::iterator cuckoo_set <T, H, E> ::add(T && t)
+{
+   iterator it;
+   size_t hash = hash_of(t);
+   size_t numGrows = 0;
+   while (!place(std::move(t), hash, it))
+   {
+      if (numGrows++ == MAX_GROW || hopeless(hash))
+         throw "ERROR: too many elements of the cuckoo set hash alike";
+      grow();
+   }
+   numElements++;
+   return it;
+}
+
+/*****************************************
+ * CUCKOO SET :: PLACE
+ * Put t somewhere without growing
+ *    OUTPUT : false if the table is too full for t;
+ *             otherwise where it went
+ ****************************************/
+template <typename T, typename H, typename E>
+bool cuckoo_set <T, H, E> ::place(T && t, size_t hash, iterator & it)
+{
+   unsigned char tag = tag_of(hash);
+   size_t i1 = index_of(hash);
+   size_t i2 = alternate(i1, tag);
+
+   // a free slot in either bucket, or one we make
+   size_t iBucket;
+   size_t iSlot;
+   int i;
+   if ((i = free_slot(buckets[i1])) >= 0)
+   {
+      iBucket = i1;
+      iSlot = i;
+   }
+   else if ((i = free_slot(buckets[i2])) >= 0)
+   {
+      iBucket = i2;
+      iSlot = i;
+   }
+   else if (!displace(i1, i2, iBucket, iSlot))
+   {
+      if (stash.size() == STASH)
+         return false;
+      stash.push_back(std::move(t));
+      it = iterator(this, numBuckets, stash.size() - 1);
+      return true;
+   }
+
+   new (buckets[iBucket].slot(iSlot)) T(std::move(t));
+   buckets[iBucket].tags[iSlot] = tag;
+   it = iterator(this, iBucket, iSlot);
+   return true;
+}
+
+/*****************************************
+ * CUCKOO SET :: DISPLACE
+ * Search breadth first from i1 and i2 for an element
+ * whose other bucket has room, then move each element
+ * on the way back to its other bucket, last one first.
+ *    OUTPUT : the slot opened up in i1 or i2, or false
+ *             if none is within MAX_PATH buckets
+ ****************************************/
+template <typename T, typename H, typename E>
+bool cuckoo_set <T, H, E> ::displace(size_t i1, size_t i2, size_t & iBucket, size_t & iSlot)
+{
+   Step steps[MAX_PATH];
+   size_t numSteps = 0;
+   steps[numSteps++] = Step{ i1, -1, 0 };
+   if (i2 != i1)
+      steps[numSteps++] = Step{ i2, -1, 0 };
+
+   for (size_t iStep = 0; iStep < numSteps; iStep++)
+   {
+      Bucket & b = buckets[steps[iStep].bucket];
+      for (size_t j = 0; j < SLOTS; j++)
+      {
+         size_t iAlt = alternate(steps[iStep].bucket, b.tags[j]);
+         int iFree = free_slot(buckets[iAlt]);
+         if (iFree < 0)
+         {
+            if (numSteps < MAX_PATH)
+               steps[numSteps++] = Step{ iAlt, (int)iStep, j };
+            continue;
+         }
+
+         // found one: walk back to the root moving each element
+         // into the slot the one after it just left
+         size_t iToBucket = iAlt;
+         size_t iToSlot = (size_t)iFree;
+         size_t iFromSlot = j;
+         for (int s = (int)iStep; s >= 0; s = steps[s].parent)
+         {
+            Bucket & from = buckets[steps[s].bucket];
+            Bucket & to = buckets[iToBucket];
+            new (to.slot(iToSlot)) T(std::move(*from.slot(iFromSlot)));
+            to.tags[iToSlot] = from.tags[iFromSlot];
+            from.slot(iFromSlot)->~T();
+            from.tags[iFromSlot] = 0;
+
+            iToBucket = steps[s].bucket;
+            iToSlot = iFromSlot;
+            iFromSlot = steps[s].parentSlot;
+         }
+         iBucket = iToBucket;
+         iSlot = iToSlot;
+         return true;
+      }
+   }
+   return false;
+}
+
+/*****************************************
+ * CUCKOO SET :: GROW
+ * Double the buckets and put everything back,
+ * the stash included
+ ****************************************/
+template <typename T, typename H, typename E>
+void cuckoo_set <T, H, E> ::grow()
+{
+   cuckoo_set bigger(numBuckets * 2, hasher, equal);
+   for (size_t i = 0; i < numBuckets; i++)
+      for (size_t j = 0; j < SLOTS; j++)
+         if (buckets[i].tags[j])
+            bigger.add(std::move(*buckets[i].slot(j)));
+   for (size_t j = 0; j < stash.size(); j++)
+      bigger.add(std::move(stash[j]));
+   swap(bigger);
+}
+
+/*****************************************
+ * CUCKOO SET :: HOPELESS
+ * Does everything in the two buckets and the stash
+ * have exactly this hash? Then they follow it to the
+ * same two buckets however big we grow, and it will
+ * never fit.
+ ****************************************/
+template <typename T, typename H, typename E>
+bool cuckoo_set <T, H, E> ::hopeless(size_t hash)
+{
+   size_t both[2];
+   both[0] = index_of(hash);
+   both[1] = alternate(both[0], tag_of(hash));
+   for (size_t iBucket : both)
+      for (size_t j = 0; j < SLOTS; j++)
+         if (!buckets[iBucket].tags[j] || hash_of(*buckets[iBucket].slot(j)) != hash)
+            return false;
+   for (size_t j = 0; j < stash.size(); j++)
+      if (hash_of(stash[j]) != hash)
+         return false;
+   return true;
+}
+
+/*****************************************
+ * CUCKOO SET :: ERASE
+ * Empty the slot by clearing its tag; a stash element
+ * is replaced by the last one
+ *    OUTPUT : the element after the one erased
+ ****************************************/
+template <typename T, typename H, typename E>
+typename cuckoo_set <T, H, E> ::iterator cuckoo_set <T, H, E> ::erase(const T & t)
+{
+   iterator it = find(t);
+   if (it == end())
+      return it;
+
+   if (it.iBucket == numBuckets)
+   {
+      if (it.iSlot != stash.size() - 1)
+         stash[it.iSlot] = std::move(stash[stash.size() - 1]);
+      stash.pop_back();
+   }
+   else
+   {
+      buckets[it.iBucket].slot(it.iSlot)->~T();
+      buckets[it.iBucket].tags[it.iSlot] = 0;
+   }
+   numElements--;
+   it.skip();
+   return it;
+}
+
+/*****************************************
+ * CUCKOO SET :: CLEAR
+ * Empty every slot but keep the buckets
+ ****************************************/
+template <typename T, typename H, typename E>
+void cuckoo_set <T, H, E> ::clear() noexcept
+{
+   for (size_t i = 0; i < numBuckets; i++)
+      for (size_t j = 0; j < SLOTS; j++)
+         if (buckets[i].tags[j])
+         {
+            buckets[i].slot(j)->~T();
+            buckets[i].tags[j] = 0;
+         }
+   stash.clear();
+   numElements = 0;
+}
+
+/*****************************************
+ * CUCKOO SET :: ITERATOR :: SKIP
+ * Stay put if we are on an element, otherwise move
+ * to the next one, or to the end
+ ****************************************/
+template <typename T, typename H, typename E>
+void cuckoo_set <T, H, E> ::iterator::skip()
+{
+   for (; iBucket < pSet->numBuckets; iBucket++, iSlot = 0)
+      for (; iSlot < SLOTS; iSlot++)
+         if (pSet->buckets[iBucket].tags[iSlot])
+            return;
+   if (iBucket == pSet->numBuckets && iSlot < pSet->stash.size())
+      return;
+   iBucket = pSet->numBuckets + 1;
+   iSlot = 0;
+}
+
+/*****************************************
+ * CUCKOO SET :: ITERATOR :: INCREMENT
+ * Advance by one element
+ ****************************************/
+template <typename T, typename H, typename E>
+typename cuckoo_set <T, H, E> ::iterator & cuckoo_set <T, H, E> ::iterator::operator ++ ()
+{
+   if (iBucket > pSet->numBuckets)
+      return *this;
+   iSlot++;
+   skip();
+   return *this;
+}
+
+/*****************************************
+ * SWAP
+ * Stand-alone cuckoo set swap
+ ****************************************/
+template <typename T, typename H, typename E>
+void swap(cuckoo_set<T, H, E>& lhs, cuckoo_set<T, H, E>& rhs)
+{
+   lhs.swap(rhs);
+}
+
+} // namespace custom
@@ -0,0 +1,479 @@
+/***********************************************************************
+ * Header:
+ *    DEQUE
+ * Summary:
+ *    Our custom implementation of std::deque: a double-ended queue
+ *    with O(1) push and pop at both ends.
+ *
+ *    The elements live in fixed-size blocks. A vector of pointers,
+ *    the map, says which block holds which stretch of the deque:
+ *
+ *         map:  [ ][*][*][*][ ]
+ *                   |  |  |
+ *                   |  |  +--> [f g h - ]
+ *                   |  +-----> [b c d e ]
+ *                   +--------> [- - - a ]    iFront is a's slot
+ *
+ *    Growing the deque only ever adds a block or moves the block
+ *    pointers in the map, never the elements, so a reference to an
+ *    element stays good until that element is popped. One emptied
+ *    block is kept as a spare, so pushing and popping back and forth
+ *    across a block boundary does not allocate every time.
+ *
+ *    This will contain the class definition of:
+ *        deque                  : A class that represents a deque
+ *        deque::iterator        : A random access iterator through deque
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "vector.h"     // for the map of blocks
+#include "span.h"       // for handing out a block at a time
+#include <cassert>      // because I am paranoid
+#include <cstddef>      // for ptrdiff_t
+#include <initializer_list>
+#include <iterator>     // for std::random_access_iterator_tag
+#include <memory>       // for std::allocator
+#include <new>          // for placement new
+#include <utility>      // for std::move and std::swap
+
+class TestDeque;        // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************
+ * DEQUE BLOCK
+ * The number of elements in a block: a power of two
+ * close to 4 KB worth, but never fewer than 16
+ ****************************************/
+template <typename T>
+constexpr size_t deque_block()
+{
+   size_t num = 16;
+   while (num * 2 * sizeof(T) <= 4096)
+      num *= 2;
+   return num;
+}
+
+/**************************************************
+ * DEQUE
+ * Just like std::deque
+ **************************************************/
+template <typename T, typename A = std::allocator<T>>
+class deque
+{
+   friend class ::TestDeque; // give unit tests access to the privates
+public:
+   static constexpr size_t BLOCK = deque_block<T>();   // elements in a block
+
+   //
+   // Construct
+   //
+
+   deque() : iFront(0), numElements(0), pSpare(nullptr) {}
+   deque(size_t num) : deque(num, T()) {}
+   deque(size_t num, const T & t) : deque()
+   {
+      for (size_t i = 0; i < num; i++)
+         push_back(t);
+   }
+   deque(const std::initializer_list<T> & il) : deque()
+   {
+      for (const T & t : il)
+         push_back(t);
+   }
+   deque(const deque & rhs) : deque()
+   {
+      *this = rhs;
+   }
+   deque(deque && rhs) : deque()
+   {
+      swap(rhs);
+   }
+  ~deque()
+   {
+      clear();
+      if (pSpare)
+         std::allocator_traits<A>::deallocate(alloc, pSpare, BLOCK);
+   }
+
+   //
+   // Assign
+   //
+
+   deque & operator = (const deque & rhs)
+   {
+      if (this != &rhs)
+      {
+         clear();
+         for (size_t i = 0; i < rhs.numElements; i++)
+            push_back(rhs[i]);
+      }
+      return *this;
+   }
+   deque & operator = (deque && rhs)
+   {
+      clear();
+      swap(rhs);
+      return *this;
+   }
+   void swap(deque & rhs)
+   {
+      map.swap(rhs.map);
+      std::swap(iFront, rhs.iFront);
+      std::swap(numElements, rhs.numElements);
+      std::swap(pSpare, rhs.pSpare);
+      std::swap(alloc, rhs.alloc);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() { return iterator(this, 0);           }
+   iterator end()   { return iterator(this, numElements); }
+
+   //
+   // Access
+   //
+
+   T & operator [] (size_t index)
+   {
+      assert(index < numElements);
+      return *slot(iFront + index);
+   }
+   const T & operator [] (size_t index) const
+   {
+      assert(index < numElements);
+      return *slot(iFront + index);
+   }
+   T & front()
+   {
+      if (empty())
+         throw "ERROR: unable to access data from an empty deque";
+      return (*this)[0];
+   }
+   T & back()
+   {
+      if (empty())
+         throw "ERROR: unable to access data from an empty deque";
+      return (*this)[numElements - 1];
+   }
+
+   // the deque as a series of contiguous runs, one per block
+   size_t chunk_count() const;
+   span <T> chunk(size_t iChunk);
+
+   //
+   // Insert
+   //
+
+   void push_back(const T & t)  { emplace_back(t);             }
+   void push_back(T && t)       { emplace_back(std::move(t));  }
+   void push_front(const T & t) { emplace_front(t);            }
+   void push_front(T && t)      { emplace_front(std::move(t)); }
+   template <class ... Args>
+   T & emplace_back(Args && ... args);
+   template <class ... Args>
+   T & emplace_front(Args && ... args);
+
+   //
+   // Remove
+   //
+
+   void pop_back();
+   void pop_front();
+   void clear()
+   {
+      while (numElements)
+         pop_back();
+   }
+
+   //
+   // Status
+   //
+
+   size_t size()  const { return numElements;      }
+   bool   empty() const { return numElements == 0; }
+
+private:
+   // where absolute slot i lives: block i / BLOCK, offset i % BLOCK
+   T * slot(size_t i) const { return map[i / BLOCK] + i % BLOCK; }
+
+   void allocateBlock(size_t iBlock);
+   void deallocateBlock(size_t iBlock);
+   void growMap();
+
+   A alloc;                // where the blocks come from
+   vector <T *> map;       // one pointer per block, null if not allocated
+   size_t iFront;          // the absolute slot of the front element
+   size_t numElements;     // the number of elements in the deque
+   T * pSpare;             // an emptied block kept for the next one we need
+};
+
+/**************************************************
+ * DEQUE ITERATOR
+ * A position in a deque. Random access: jumping ahead
+ * any distance is as cheap as stepping by one
+ *************************************************/
+template <typename T, typename A>
+class deque <T, A> ::iterator
+{
+   friend class ::TestDeque; // give unit tests access to the privates
+public:
+   // so the standard algorithms know what we can do
+   typedef std::random_access_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef ptrdiff_t                       difference_type;
+   typedef T *                             pointer;
+   typedef T &                             reference;
+
+   iterator() : pDeque(nullptr), index(0) {}
+   iterator(deque * pDeque, size_t index) : pDeque(pDeque), index(index) {}
+
+   // compare
+   bool operator == (const iterator & rhs) const { return index == rhs.index; }
+   bool operator != (const iterator & rhs) const { return index != rhs.index; }
+   bool operator <  (const iterator & rhs) const { return index <  rhs.index; }
+   bool operator >  (const iterator & rhs) const { return index >  rhs.index; }
+   bool operator <= (const iterator & rhs) const { return index <= rhs.index; }
+   bool operator >= (const iterator & rhs) const { return index >= rhs.index; }
+
+   // dereference
+   T & operator * ()
+   {
+      if (pDeque == nullptr)
+         throw "ERROR: Trying to dereference a NULL pointer";
+      return (*pDeque)[index];
+   }
+   T * operator -> () { return &**this; }
+   T & operator [] (ptrdiff_t offset) { return *(*this + offset); }
+
+   // step
+   iterator & operator ++ ()            { index++; return *this; }
+   iterator & operator -- ()            { index--; return *this; }
+   iterator   operator ++ (int postfix) { iterator old(*this); index++; return old; }
+   iterator   operator -- (int postfix) { iterator old(*this); index--; return old; }
+
+   // jump
+   iterator & operator += (ptrdiff_t offset) { index += offset; return *this; }
+   iterator & operator -= (ptrdiff_t offset) { index -= offset; return *this; }
+   iterator   operator +  (ptrdiff_t offset) const { return iterator(pDeque, index + offset); }
+   iterator   operator -  (ptrdiff_t offset) const { return iterator(pDeque, index - offset); }
+   ptrdiff_t  operator -  (const iterator & rhs) const
+   {
+      return (ptrdiff_t)index - (ptrdiff_t)rhs.index;
+   }
+
+private:
+   deque * pDeque;     // the deque we walk through
+   size_t index;       // 0 is the front, size() is the end
+};
+
+/*****************************************
+ * DEQUE :: ALLOCATE BLOCK
+ * Get raw memory for one block, the spare if we have
+ * it. Nothing is constructed: the elements are made one
+ * at a time as they are pushed
+ ****************************************/
+template <typename T, typename A>
+void deque <T, A> ::allocateBlock(size_t iBlock)
+{
+   assert(map[iBlock] == nullptr);
+   if (pSpare)
+   {
+      map[iBlock] = pSpare;
+      pSpare = nullptr;
+   }
+   else
+      map[iBlock] = std::allocator_traits<A>::allocate(alloc, BLOCK);
+}
+
+/*****************************************
+ * DEQUE :: DEALLOCATE BLOCK
+ * Take away a block whose elements are all gone. It
+ * becomes the spare unless we already have one
+ ****************************************/
+template <typename T, typename A>
+void deque <T, A> ::deallocateBlock(size_t iBlock)
+{
+   assert(map[iBlock] != nullptr);
+   if (pSpare == nullptr)
+      pSpare = map[iBlock];
+   else
+      std::allocator_traits<A>::deallocate(alloc, map[iBlock], BLOCK);
+   map[iBlock] = nullptr;
+}
+
+/*****************************************
+ * DEQUE :: GROW MAP
+ * Make room for another block at either end. The block
+ * pointers are moved to the middle of a new map, twice
+ * the size unless the old one was mostly empty. The
+ * elements themselves never move.
+ ****************************************/
+template <typename T, typename A>
+void deque <T, A> ::growMap()
+{
+   size_t iFirstBlock = iFront / BLOCK;
+   size_t numBlocks = numElements ? (iFront + numElements - 1) / BLOCK - iFirstBlock + 1 : 0;
+
+   size_t newSize = map.size() < 8 ? 8 : map.size();
+   if (numBlocks * 2 + 2 > newSize)
+      newSize *= 2;
+
+   vector <T *> newMap;
+   newMap.resize(newSize);      // all nullptr
+   size_t iNewFirst = (newSize - numBlocks) / 2;
+   for (size_t i = 0; i < numBlocks; i++)
+      newMap[iNewFirst + i] = map[iFirstBlock + i];
+
+   map.swap(newMap);
+   iFront = iNewFirst * BLOCK + iFront % BLOCK;
+}
+
+/*****************************************
+ * DEQUE :: EMPLACE BACK
+ * Construct a new element after the last one. If the
+ * constructor throws, a block made for it is given back
+ *    COST   : O(1) amortized
+ ****************************************/
+template <typename T, typename A>
+template <class ... Args>
+T & deque <T, A> ::emplace_back(Args && ... args)
+{
+   if (iFront + numElements == map.size() * BLOCK)
+      growMap();
+
+   size_t i = iFront + numElements;
+   bool newBlock = map[i / BLOCK] == nullptr;
+   if (newBlock)
+      allocateBlock(i / BLOCK);
+   T * p = slot(i);
+   try
+   {
+      new (p) T(std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      if (newBlock)
+         deallocateBlock(i / BLOCK);
+      throw;
+   }
+   numElements++;
+   return *p;
+}
+
+/*****************************************
+ * DEQUE :: EMPLACE FRONT
+ * Construct a new element before the first one. If the
+ * constructor throws, a block made for it is given back
+ *    COST   : O(1) amortized
+ ****************************************/
+template <typename T, typename A>
+template <class ... Args>
+T & deque <T, A> ::emplace_front(Args && ... args)
+{
+   if (iFront == 0)
+      growMap();
+
+   size_t i = iFront - 1;
+   bool newBlock = map[i / BLOCK] == nullptr;
+   if (newBlock)
+      allocateBlock(i / BLOCK);
+   T * p = slot(i);
+   try
+   {
+      new (p) T(std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      if (newBlock)
+         deallocateBlock(i / BLOCK);
+      throw;
+   }
+   iFront = i;
+   numElements++;
+   return *p;
+}
+
+/*****************************************
+ * DEQUE :: POP BACK
+ * Destroy the last element, and its block if it was
+ * the only one left there
+ ****************************************/
+template <typename T, typename A>
+void deque <T, A> ::pop_back()
+{
+   if (empty())
+      return;
+   size_t i = iFront + numElements - 1;
+   slot(i)->~T();
+   numElements--;
+   if (i % BLOCK == 0 || numElements == 0)
+      deallocateBlock(i / BLOCK);
+}
+
+/*****************************************
+ * DEQUE :: POP FRONT
+ * Destroy the first element, and its block if it was
+ * the only one left there
+ ****************************************/
+template <typename T, typename A>
+void deque <T, A> ::pop_front()
+{
+   if (empty())
+      return;
+   size_t i = iFront;
+   slot(i)->~T();
+   iFront++;
+   numElements--;
+   if (i % BLOCK == BLOCK - 1 || numElements == 0)
+      deallocateBlock(i / BLOCK);
+}
+
+/*****************************************
+ * DEQUE :: CHUNK COUNT
+ * How many blocks hold at least one element
+ ****************************************/
+template <typename T, typename A>
+size_t deque <T, A> ::chunk_count() const
+{
+   if (numElements == 0)
+      return 0;
+   return (iFront + numElements - 1) / BLOCK - iFront / BLOCK + 1;
+}
+
+/*****************************************
+ * DEQUE :: CHUNK
+ * The elements in one block, in order. Walking the chunks
+ * visits every element with plain pointer increments
+ ****************************************/
+template <typename T, typename A>
+span <T> deque <T, A> ::chunk(size_t iChunk)
+{
+   assert(iChunk < chunk_count());
+   size_t iBegin = (iFront / BLOCK + iChunk) * BLOCK;
+   size_t iEnd = iBegin + BLOCK;
+   if (iBegin < iFront)
+      iBegin = iFront;
+   if (iEnd > iFront + numElements)
+      iEnd = iFront + numElements;
+   return span <T> (slot(iBegin), iEnd - iBegin);
+}
+
+/*****************************************
+ * SWAP
+ * Stand-alone deque swap
+ ****************************************/
+template <typename T, typename A>
+void swap(deque <T, A> & lhs, deque <T, A> & rhs)
+{
+   lhs.swap(rhs);
+}
+
+} // namespace custom
@@ -11,6 +11,8 @@
  *    |_____|  '.____.'   '.____.'  /_/
  *
  *    This will contain the class definition of:
+ *        reduce_*                : How a hash picks its bucket
+ *        hash_stats              : How full and how lopsided a hash is
  *        unordered_set           : A class that represents a hash
  *        unordered_set::iterator : An interator through hash
  * Author
@@ -19,21 +21,164 @@
 
 #pragma once
 
-#include "list.h"     // because this->buckets[0] is a list
+#include "list.h"     // because this->buckets[0] is a list by default
+#include "pair.h"     // for the result of insert
+#include "allocator.h" // for the bucket array allocators
+#include "hashFunction.h" // for mix_int, ahead of a mask or fastrange
+#include "instrument.h" // for CUSTOM_INSTRUMENT
 #include <memory>     // for std::allocator
 #include <functional> // for std::hash
 #include <cmath>      // for std::ceil
+#include <cstdint>    // for the fixed-size fields of a saved set
+#include <cstring>    // for std::memcpy
+#include <istream>    // for load
+#include <limits>     // for the most elements a set can count
+#include <ostream>    // for save
+#include <type_traits> // for std::is_trivially_copyable
+#include <typeinfo>   // for telling hashers and reduce_* policies apart
+#include <utility>    // for std::declval
+#include <vector>     // for the buffer behind a stream load
    
 
 class TestHash;             // forward declaration for Hash unit tests
 
 namespace custom
 {
+
+/*****************************************
+ * REDUCE MODULO
+ * N buckets, any N, picked by hash % N. N is a constant,
+ * so the compiler makes the % a multiply, a shift and a
+ * subtract rather than a divide. The default: 10 buckets
+ * of std::hash, which is what the tests expect.
+ ****************************************/
+template <size_t N>
+struct reduce_modulo
+{
+   static const size_t BUCKETS = N;
+   static size_t index(size_t hash)
+   {
+      return hash % N;
+   }
+};
+
+/*****************************************
+ * REDUCE MASK
+ * A power of two buckets, picked by the low bits: one
+ * AND. Low bits alone are only as good as the hash, so
+ * they are mixed first (std::hash of 16, 32, 48 ... would
+ * otherwise all land in bucket 0)
+ ****************************************/
+template <size_t N>
+struct reduce_mask
+{
+   static_assert(N != 0 && (N & (N - 1)) == 0, "reduce_mask needs a power of two");
+   static const size_t BUCKETS = N;
+   static size_t index(size_t hash)
+   {
+      return (size_t)mix_int(hash) & (N - 1);
+   }
+};
+
+/*****************************************
+ * REDUCE FASTRANGE
+ * Any N, picked by the high half of hash * N (Lemire):
+ * one multiply, no division, and N need not be a power
+ * of two. High bits alone are only as good as the hash,
+ * so it is mixed first.
+ ****************************************/
+template <size_t N>
+struct reduce_fastrange
+{
+   static const size_t BUCKETS = N;
+   static size_t index(size_t hash)
+   {
+      uint64_t lo = mix_int(hash);
+      uint64_t hi = N;
+      wy::multiply(lo, hi);
+      return (size_t)hi;
+   }
+};
+
+/*****************************************
+ * ALLOCATE BUCKETS and DEALLOCATE BUCKETS
+ * An array of num empty buckets from an allocator of
+ * buckets, and back again. Every hash here keeps its
+ * buckets this way
+ ****************************************/
+template <typename Bucket, typename Alloc>
+Bucket * allocate_buckets(Alloc & alloc, size_t num)
+{
+   Bucket * buckets = std::allocator_traits<Alloc>::allocate(alloc, num);
+   CUSTOM_INSTRUMENT_ALLOC();
+   for (size_t i = 0; i < num; i++)
+      new (buckets + i) Bucket;
+   return buckets;
+}
+
+template <typename Bucket, typename Alloc>
+void deallocate_buckets(Alloc & alloc, Bucket * & buckets, size_t num)
+{
+   if (buckets == nullptr)
+      return;
+   for (size_t i = 0; i < num; i++)
+      buckets[i].~Bucket();
+   std::allocator_traits<Alloc>::deallocate(alloc, buckets, num);
+   buckets = nullptr;
+}
+
+/*****************************************
+ * HASH STATS
+ * A snapshot of an unordered_set, from stats(). The
+ * probe and comparison counts cost a little on every
+ * lookup, so they are only kept when CUSTOM_HASH_STATS
+ * is defined; otherwise they are always 0.
+ ****************************************/
+struct hash_stats
+{
+   static constexpr size_t HISTOGRAM = 8;
+   size_t size          = 0;     // elements
+   size_t buckets       = 0;     // bucket_count()
+   double load_factor   = 0.0;   // elements per bucket
+   size_t max_chain     = 0;     // the longest bucket
+   double mean_chain    = 0.0;   // elements per non-empty bucket
+   double empty_ratio   = 0.0;   // the fraction of buckets with nothing in them
+   size_t histogram[HISTOGRAM] = {};   // buckets of each length; the last
+                                       // counts every longer bucket too
+   size_t bytes_buckets = 0;     // the bucket array
+   size_t bytes_nodes   = 0;     // what the buckets hold their elements in,
+                                 // or 0 when the bucket cannot say
+   size_t rehashes      = 0;     // always 0: the bucket count is fixed
+   size_t probes        = 0;     // buckets searched by find and insert
+   size_t comparisons   = 0;     // elements compared against the key
+};
+
+/*****************************************
+ * BUCKET KNOWS BYTES
+ * Whether a Bucket can say how much its nodes take.
+ * list, unrolled_list and tree_bucket all can.
+ ****************************************/
+template <typename Bucket, typename = void>
+struct bucket_knows_bytes : std::false_type {};
+
+template <typename Bucket>
+struct bucket_knows_bytes <Bucket, std::void_t<
+   decltype(std::declval<const Bucket &>().bytes_nodes())>> : std::true_type {};
+
 /************************************************
  * UNORDERED SET
- * A set implemented as a hash
+ * A set implemented as a hash. The array of buckets
+ * comes from the allocator A (see allocator.h). Each
+ * bucket is a Bucket: a list by default, or anything
+ * with the same interface such as unrolled_list or
+ * tree_bucket. The hasher H is std::hash by default;
+ * seeded_hash (see hashFunction.h) gives each set its
+ * own seed so no one set of keys is bad for all of them.
+ * R sets how many buckets there are and how a hash is
+ * turned into one of them; see reduce_* above
  ************************************************/
-template <typename T>
+template <typename T, typename A = std::allocator<T>, typename Bucket = custom::list<T>,
+          typename H = std::hash<T>, typename R = reduce_modulo<10>>
 class unordered_set
 {
    friend class ::TestHash;   // give unit tests access to the privates
@@ -43,31 +188,39 @@ public:
    //
    unordered_set() : numElements(0)
    {
+      allocateBuckets();
+   }
+   explicit unordered_set(const H & hasher) : hasher(hasher), numElements(0)
+   {
+      allocateBuckets();
    }
-   unordered_set(unordered_set&  rhs) : numElements(rhs.numElements)
+   unordered_set(unordered_set&  rhs) : hasher(rhs.hasher), numElements(rhs.numElements)
    {
-      for (size_t i = 0; i < 10; i++)
+      allocateBuckets();
+      for (size_t i = 0; i < bucket_count(); i++)
       {
          this->buckets[i] = rhs.buckets[i]; 
       }
    }
-   unordered_set(unordered_set&& rhs) : numElements(rhs.numElements)
+   unordered_set(unordered_set&& rhs) : numElements(0)
    {
-      for (size_t i = 0; i < 10; i++)
-      {
-         this->buckets[i] = rhs.buckets[i];
-      }
+      allocateBuckets();
+      swap(rhs);
    }
    template <class Iterator>
-   unordered_set(Iterator first, Iterator last)
+   unordered_set(Iterator first, Iterator last) : numElements(0)
    {
-      clear(); 
+      allocateBuckets();
        
       for (auto it = first; it != last; it++)
       {
          insert(*it);  
       } 
    }
+   ~unordered_set()
+   {
+      deallocateBuckets();
+   }
 
    //
    // Assign
@@ -76,8 +229,9 @@ public:
    {
       if (this != &rhs)
       {
+         hasher = rhs.hasher;
          numElements = rhs.numElements;
-         for (size_t i = 0; i < 10; i++)
+         for (size_t i = 0; i < bucket_count(); i++)
          {
             this->buckets[i] = rhs.buckets[i];
          }
@@ -88,13 +242,9 @@ public:
    {
       if (this != &rhs)
       {
-         numElements = rhs.numElements;
-         for (size_t i = 0; i < 10; i++)
-         {
-            this->buckets[i] = std::move(rhs.buckets[i]);
-         }
+         clear();
+         swap(rhs);
       }
-      rhs.numElements = 0; 
       return *this;
    }
    unordered_set& operator=(const std::initializer_list<T>& il)
@@ -104,12 +254,9 @@ public:
    void swap(unordered_set& rhs)
    {
       std::swap(numElements, rhs.numElements);
-      for (size_t i = 0; i < 10; i++)
-      {
-         custom::list<T> temp = buckets[i]; 
-         this->buckets[i] = rhs.buckets[i];
-         rhs.buckets[i] = temp; 
-      }
+      std::swap(buckets, rhs.buckets);
+      std::swap(alloc, rhs.alloc);
+      std::swap(hasher, rhs.hasher);
    }
 
    // 
@@ -119,16 +266,16 @@ public:
    class local_iterator;
    iterator begin()
    {
-      for (size_t i = 0; i < 10; i++)
+      for (size_t i = 0; i < bucket_count(); i++)
       {
          if (! this->buckets[i].empty())
-            return iterator(buckets + i, buckets + 10, buckets[i].begin());
+            return iterator(buckets + i, buckets + bucket_count(), buckets[i].begin());
       }
       return end();
    }
    iterator end()
    {
-      return iterator(buckets + 10, buckets + 10, buckets[0].end());
+      return iterator(buckets + bucket_count(), buckets + bucket_count(), typename Bucket::iterator());
    }
    local_iterator begin(size_t iBucket)
    {
@@ -144,8 +291,7 @@ public:
    //
    size_t bucket(const T& t)
    {
-      std::hash <T> hasher;
-      return hasher(t) % bucket_count();
+      return R::index(hasher(t));
    }
    iterator find(const T& t);
 
@@ -161,7 +307,7 @@ public:
    //
    void clear() noexcept
    {
-      for (size_t i = 0; i < 10; i++)
+      for (size_t i = 0; i < bucket_count(); i++)
       {
          this->buckets[i].clear();
       }
@@ -182,17 +328,68 @@ public:
    }
    size_t bucket_count() const 
    { 
-      return 10;
+      return R::BUCKETS;
    }
    size_t bucket_size(size_t i) const
    {
       return buckets[i].size();
    }
+   hash_stats stats() const;
+
+   //
+   // Save and load: only for a trivially copyable T and H
+   //
+   size_t save_size() const;
+   size_t save(void * pBuffer) const;
+   void save(std::ostream & out) const;
+   void load(const void * pBuffer, size_t numBytes);
+   void load(std::istream & in);
 
 private:
+   typedef typename std::allocator_traits<A>::template
+      rebind_alloc<Bucket> BucketAllocator;
+
+   /*************************************************
+    * SAVE HEADER
+    * The front of a saved set. Then comes the hasher,
+    * then each bucket: its size and its elements.
+    *************************************************/
+   struct SaveHeader
+   {
+      uint32_t magic;          // SAVE_MAGIC
+      uint32_t sizeElement;    // sizeof(T)
+      uint32_t sizeHasher;     // sizeof(H)
+      uint32_t tagHasher;      // type_tag<H>()
+      uint32_t tagReduce;      // type_tag<R>()
+      uint32_t reserved;
+      uint64_t numBuckets;     // bucket_count() of the set saved
+      uint64_t numElements;
+   };
+   static const uint32_t SAVE_MAGIC = 0x48534332;   // "2CSH"
+
+   // FNV-1a of the type's name: enough to tell two types apart
+   // within one build, which is all save and load promise
+   template <typename X>
+   static uint32_t type_tag()
+   {
+      uint32_t tag = 2166136261u;
+      for (const char * p = typeid(X).name(); *p; p++)
+         tag = (tag ^ (unsigned char)*p) * 16777619u;
+      return tag;
+   }
 
-   custom::list<T> buckets [10];   // exactly 10 buckets
+   void allocateBuckets();
+   void deallocateBuckets();
+   typename Bucket::iterator locate(size_t iBucket, const T & t);
+
+   BucketAllocator alloc;          // where the bucket array comes from
+   H hasher;                       // which bucket an element goes in
+   Bucket * buckets;               // exactly bucket_count() buckets
    int numElements;                // number of elements in the Hash
+#ifdef CUSTOM_HASH_STATS
+   size_t numProbes = 0;           // calls to locate()
+   size_t numComparisons = 0;      // elements locate() looked at
+#endif
 };
 
 
@@ -200,11 +397,11 @@ private:
  * UNORDERED SET ITERATOR
  * Iterator for an unordered set
  ************************************************/
-template <typename T>
-class unordered_set <T> ::iterator
+template <typename T, typename A, typename Bucket, typename H, typename R>
+class unordered_set <T, A, Bucket, H, R> ::iterator
 {
    friend class ::TestHash;   // give unit tests access to the privates
-   template <class TT>
+   template <class TT, class AA, class BB, class HH, class RR>
    friend class custom::unordered_set;
 public:
    // 
@@ -213,9 +410,9 @@ public:
    iterator() : pBucket(nullptr), pBucketEnd(nullptr)
    {  
    }
-   iterator(typename custom::list<T>* pBucket,
-            typename custom::list<T>* pBucketEnd,
-            typename custom::list<T>::iterator itList)
+   iterator(Bucket* pBucket,
+            Bucket* pBucketEnd,
+            typename Bucket::iterator itList)
       : pBucket(pBucket), pBucketEnd(pBucketEnd), itList(itList)
    {
    }
@@ -267,9 +464,9 @@ public:
    }
 
 private:
-   custom::list<T> *pBucket;
-   custom::list<T> *pBucketEnd;
-   typename list<T>::iterator itList;
+   Bucket *pBucket;
+   Bucket *pBucketEnd;
+   typename Bucket::iterator itList;
 };
 
 
@@ -277,12 +474,12 @@ private:
  * UNORDERED SET LOCAL ITERATOR
  * Iterator for a single bucket in an unordered set
  ************************************************/
-template <typename T>
-class unordered_set <T> ::local_iterator
+template <typename T, typename A, typename Bucket, typename H, typename R>
+class unordered_set <T, A, Bucket, H, R> ::local_iterator
 {
    friend class ::TestHash;   // give unit tests access to the privates
 
-   template <class TT>
+   template <class TT, class AA, class BB, class HH, class RR>
    friend class custom::unordered_set;
 public:
    // 
@@ -291,7 +488,7 @@ public:
    local_iterator()  
    {
    }
-   local_iterator(const typename custom::list<T>::iterator& itList) 
+   local_iterator(const typename Bucket::iterator& itList) 
    {
    }
    local_iterator(const local_iterator& rhs) 
@@ -343,91 +540,382 @@ public:
    }
 
 private:
-   typename list<T>::iterator itList;
+   typename Bucket::iterator itList;
 };
 
 
 /*****************************************
- * UNORDERED SET :: ERASE
- * Remove one element from the unordered set
+ * UNORDERED SET :: ALLOCATE BUCKETS
+ * Get the array of empty buckets from the allocator
  ****************************************/
-template <typename T>
-typename unordered_set <T> ::iterator unordered_set<T>::erase(const T& t)
+template <typename T, typename A, typename Bucket, typename H, typename R>
+void unordered_set <T, A, Bucket, H, R> ::allocateBuckets()
 {
- 
-   auto itErase = find(t);
-   if (itErase == end())
-      return itErase;
+   buckets = allocate_buckets<Bucket>(alloc, bucket_count());
+}
 
+/*****************************************
+ * UNORDERED SET :: DEALLOCATE BUCKETS
+ * Free every bucket and give the array back
+ ****************************************/
+template <typename T, typename A, typename Bucket, typename H, typename R>
+void unordered_set <T, A, Bucket, H, R> ::deallocateBuckets()
+{
+   deallocate_buckets(alloc, buckets, bucket_count());
+}
 
-   auto itReturn = itErase;
-   ++itReturn;
+/*****************************************
+ * UNORDERED SET :: SAVE SIZE
+ * How many bytes save() will write
+ ****************************************/
+template <typename T, typename A, typename Bucket, typename H, typename R>
+size_t unordered_set <T, A, Bucket, H, R> ::save_size() const
+{
+   return sizeof(SaveHeader) + sizeof(H) +
+          bucket_count() * sizeof(uint64_t) + size() * sizeof(T);
+}
 
+/*****************************************
+ * UNORDERED SET :: SAVE
+ * Write the set, bucket by bucket, to a buffer of at
+ * least save_size() bytes. The hasher goes along too:
+ * a seeded_hash must come back with the same seed or
+ * nothing would be in the bucket it hashes to.
+ *    OUTPUT : the number of bytes written
+ ****************************************/
+template <typename T, typename A, typename Bucket, typename H, typename R>
+size_t unordered_set <T, A, Bucket, H, R> ::save(void * pBuffer) const
+{
+   static_assert(std::is_trivially_copyable<T>::value, "save needs a trivially copyable T");
+   static_assert(std::is_trivially_copyable<H>::value, "save needs a trivially copyable hasher");
+
+   unsigned char * p = static_cast<unsigned char *>(pBuffer);
+   SaveHeader header = { SAVE_MAGIC, (uint32_t)sizeof(T), (uint32_t)sizeof(H),
+                         type_tag<H>(), type_tag<R>(), 0,
+                         (uint64_t)bucket_count(), (uint64_t)size() };
+   std::memcpy(p, &header, sizeof(header));
+   p += sizeof(header);
+   std::memcpy(p, (const void *)&hasher, sizeof(H));
+   p += sizeof(H);
+
+   for (size_t i = 0; i < bucket_count(); i++)
+   {
+      uint64_t num = buckets[i].size();
+      std::memcpy(p, &num, sizeof(num));
+      p += sizeof(num);
+      for (auto it = buckets[i].begin(); it != buckets[i].end(); ++it)
+      {
+         std::memcpy(p, (const void *)&*it, sizeof(T));
+         p += sizeof(T);
+      }
+   }
+   return p - static_cast<unsigned char *>(pBuffer);
+}
+
+/*****************************************
+ * UNORDERED SET :: SAVE
+ * The same, to a stream, in one write
+ ****************************************/
+template <typename T, typename A, typename Bucket, typename H, typename R>
+void unordered_set <T, A, Bucket, H, R> ::save(std::ostream & out) const
+{
+   std::vector<unsigned char> buffer(save_size());
+   save(buffer.data());
+   if (!out.write((const char *)buffer.data(), (std::streamsize)buffer.size()))
+      throw "ERROR: unable to write the set";
+}
+
+/*****************************************
+ * UNORDERED SET :: LOAD
+ * Replace the contents with a saved set. Nothing is
+ * hashed and nothing is checked for duplicates: each
+ * element goes straight to the back of the bucket it
+ * was saved from. Only a set saved with a different
+ * number of buckets or a different reduce_* policy has
+ * to be hashed again. A set saved with a different
+ * hasher is refused: its bytes mean nothing to this one.
+ *    COST   : O(n), one push_back per element
+ ****************************************/
+template <typename T, typename A, typename Bucket, typename H, typename R>
+void unordered_set <T, A, Bucket, H, R> ::load(const void * pBuffer, size_t numBytes)
+{
+   static_assert(std::is_trivially_copyable<T>::value, "load needs a trivially copyable T");
+   static_assert(std::is_trivially_copyable<H>::value, "load needs a trivially copyable hasher");
+
+   const unsigned char * p = static_cast<const unsigned char *>(pBuffer);
+   const unsigned char * pEnd = p + numBytes;
+
+   SaveHeader header;
+   if (numBytes < sizeof(header) + sizeof(H))
+      throw "ERROR: the saved set is truncated";
+   std::memcpy(&header, p, sizeof(header));
+   p += sizeof(header);
+   if (header.magic != SAVE_MAGIC)
+      throw "ERROR: this is not a saved set";
+   if (header.sizeElement != sizeof(T) || header.sizeHasher != sizeof(H))
+      throw "ERROR: the saved set holds a different type";
+   if (header.tagHasher != type_tag<H>())
+      throw "ERROR: the saved set used a different hasher";
+   if (header.numElements > (uint64_t)std::numeric_limits<int>::max())
+      throw "ERROR: the saved set is too large";
+
+   clear();
+   std::memcpy((void *)&hasher, p, sizeof(H));
+   p += sizeof(H);
+
+   bool sameLayout = header.numBuckets == bucket_count() &&
+                     header.tagReduce == type_tag<R>();
+   uint64_t numLoaded = 0;
+   for (uint64_t i = 0; i < header.numBuckets; i++)
+   {
+      uint64_t num;
+      if ((size_t)(pEnd - p) < sizeof(num))
+      {
+         clear();
+         throw "ERROR: the saved set is truncated";
+      }
+      std::memcpy(&num, p, sizeof(num));
+      p += sizeof(num);
+      if ((size_t)(pEnd - p) / sizeof(T) < num)
+      {
+         clear();
+         throw "ERROR: the saved set is truncated";
+      }
+
+      for (uint64_t j = 0; j < num; j++)
+      {
+         T t;
+         std::memcpy((void *)&t, p, sizeof(T));
+         p += sizeof(T);
+         buckets[sameLayout ? (size_t)i : bucket(t)].push_back(t);
+      }
+      numLoaded += num;
+   }
+   if (numLoaded != header.numElements)
+   {
+      clear();
+      throw "ERROR: the saved set does not hold as many elements as it says";
+   }
+   numElements = (int)numLoaded;
+}
+
+/*****************************************
+ * UNORDERED SET :: LOAD
+ * The same, from a stream: the header says how much
+ * more there is, so read the rest into one buffer. A
+ * header asking for more than the stream holds is
+ * refused before anything is allocated for it.
+ ****************************************/
+template <typename T, typename A, typename Bucket, typename H, typename R>
+void unordered_set <T, A, Bucket, H, R> ::load(std::istream & in)
+{
+   SaveHeader header;
+   if (!in.read((char *)&header, sizeof(header)))
+      throw "ERROR: the saved set is truncated";
+   if (header.magic != SAVE_MAGIC)
+      throw "ERROR: this is not a saved set";
+   if (header.sizeElement != sizeof(T) || header.sizeHasher != sizeof(H))
+      throw "ERROR: the saved set holds a different type";
+
+   // how much is left to read, when the stream can say
+   std::istream::pos_type posHere = in.tellg();
+   uint64_t numLeft = std::numeric_limits<size_t>::max() / 2;
+   bool measured = false;
+   if (posHere != std::istream::pos_type(-1))
+   {
+      if (in.seekg(0, std::ios::end))
+      {
+         uint64_t numEnd = (uint64_t)(in.tellg() - posHere);
+         if (numEnd < numLeft)
+            numLeft = numEnd;
+         measured = true;
+      }
+      in.clear();
+      in.seekg(posHere);
+   }
+   if (numLeft < sizeof(H) ||
+       header.numBuckets > (numLeft - sizeof(H)) / sizeof(uint64_t) ||
+       header.numElements > (numLeft - sizeof(H) -
+                             header.numBuckets * sizeof(uint64_t)) / sizeof(T))
+      throw "ERROR: the saved set is truncated";
+
+   size_t numTotal = sizeof(header) + sizeof(H) +
+                     (size_t)header.numBuckets * sizeof(uint64_t) +
+                     (size_t)header.numElements * sizeof(T);
+   std::vector<unsigned char> buffer(sizeof(header));
+   std::memcpy(buffer.data(), &header, sizeof(header));
+   if (measured)
+      buffer.reserve(numTotal);
+
+   // a stream that cannot say how long it is gets read a piece at
+   // a time, so the buffer is never bigger than what arrived
+   const size_t SIZE_PIECE = 65536;
+   while (buffer.size() < numTotal)
+   {
+      size_t numHave = buffer.size();
+      size_t numPiece = numTotal - numHave < SIZE_PIECE ? numTotal - numHave : SIZE_PIECE;
+      buffer.resize(numHave + numPiece);
+      if (!in.read((char *)buffer.data() + numHave, (std::streamsize)numPiece))
+         throw "ERROR: the saved set is truncated";
+   }
+   load(buffer.data(), buffer.size());
+}
+
+/*****************************************
+ * UNORDERED SET :: ERASE
+ * Remove one element from the unordered set. This asks
+ * the bucket directly rather than going through find(),
+ * so an erase is not also counted as a find. The element
+ * after it comes from the bucket's own erase: an
+ * unrolled_list shifts and merges its nodes, so an
+ * iterator taken before the erase may not survive it
+ ****************************************/
+template <typename T, typename A, typename Bucket, typename H, typename R>
+typename unordered_set <T, A, Bucket, H, R> ::iterator unordered_set<T, A, Bucket, H, R>::erase(const T& t)
+{
+   CUSTOM_INSTRUMENT_SCOPE(SET_ERASE);
    size_t iBucket = bucket(t);
-   buckets[iBucket].erase(itErase.itList);
+   auto itList = locate(iBucket, t);
+   if (itList == buckets[iBucket].end())
+      return end();
+
+   auto itNext = buckets[iBucket].erase(itList);
    numElements--;
+   if (itNext != buckets[iBucket].end())
+      return iterator(&buckets[iBucket], buckets + bucket_count(), itNext);
 
-   return itReturn;
+   // that was the last in its bucket: on to the next with anything in it
+   for (size_t i = iBucket + 1; i < bucket_count(); i++)
+      if (!buckets[i].empty())
+         return iterator(buckets + i, buckets + bucket_count(), buckets[i].begin());
+   return end();
 }
 
 /*****************************************
  * UNORDERED SET :: INSERT
- * Insert one element into the hash
+ * Insert one element into the hash. The bucket looks for
+ * a duplicate itself, so a tree_bucket need not scan.
  ****************************************/
-template <typename T>
-custom::pair<typename custom::unordered_set<T>::iterator, bool> unordered_set<T>::insert(const T& t)
+template <typename T, typename A, typename Bucket, typename H, typename R>
+custom::pair<typename custom::unordered_set<T, A, Bucket, H, R>::iterator, bool> unordered_set<T, A, Bucket, H, R>::insert(const T& t)
 {
+   CUSTOM_INSTRUMENT_SCOPE(SET_INSERT);
    size_t iBucket = bucket(t); 
    
-   for (auto it = buckets[iBucket].begin(); it != buckets[iBucket].end(); it++)
+   if (locate(iBucket, t) != buckets[iBucket].end())
    {
-      if (*it == t)
-      {
-         return custom::pair<custom::unordered_set<T>::iterator, bool>(iterator(&buckets[iBucket], buckets + 10, buckets[iBucket].begin()), false);
-      }
+      return custom::pair<custom::unordered_set<T, A, Bucket, H, R>::iterator, bool>(iterator(&buckets[iBucket], buckets + bucket_count(), buckets[iBucket].begin()), false);
    }
 
    buckets[iBucket].push_back(t);
    numElements++; 
 
  
-   return custom::pair<custom::unordered_set<T>::iterator, bool>(iterator(&buckets[iBucket], buckets + 10, buckets[iBucket].begin()), true);
+   return custom::pair<custom::unordered_set<T, A, Bucket, H, R>::iterator, bool>(iterator(&buckets[iBucket], buckets + bucket_count(), buckets[iBucket].begin()), true);
 }
-template <typename T>
-void unordered_set<T>::insert(const std::initializer_list<T> & il)
+template <typename T, typename A, typename Bucket, typename H, typename R>
+void unordered_set<T, A, Bucket, H, R>::insert(const std::initializer_list<T> & il)
 {
 }
-//return custom::pair<custom::unordered_set<T>::iterator, bool>(iterator(buckets + iBucket, buckets + 10, buckets[0].begin()), true);
+//return custom::pair<custom::unordered_set<T, A, Bucket>::iterator, bool>(iterator(buckets + iBucket, buckets + 10, buckets[0].begin()), true);
 
 /*****************************************
  * UNORDERED SET :: FIND
- * Find an element in an unordered set
+ * Find an element in an unordered set by asking its
+ * bucket: a list walks, a tree_bucket may search a tree
  ****************************************/
-template <typename T>
-typename unordered_set <T> ::iterator unordered_set<T>::find(const T& t)
+template <typename T, typename A, typename Bucket, typename H, typename R>
+typename unordered_set <T, A, Bucket, H, R> ::iterator unordered_set<T, A, Bucket, H, R>::find(const T& t)
 {
+   CUSTOM_INSTRUMENT_SCOPE(SET_FIND);
    size_t iBucket = bucket(t);
 
-   auto itList = buckets[iBucket].begin();
+   auto itList = locate(iBucket, t);
+   if (itList != buckets[iBucket].end())
+      return iterator(&buckets[iBucket], buckets + bucket_count(), itList);
+
+   return end();
+}
 
-   while (itList != buckets[iBucket].end()) 
+/*****************************************
+ * UNORDERED SET :: LOCATE
+ * Find t in its bucket. Counting the comparisons means
+ * walking the bucket here rather than asking it, so with
+ * CUSTOM_HASH_STATS or CUSTOM_INSTRUMENT a tree_bucket is
+ * walked as a list.
+ ****************************************/
+template <typename T, typename A, typename Bucket, typename H, typename R>
+typename Bucket::iterator unordered_set <T, A, Bucket, H, R> ::locate(size_t iBucket, const T & t)
+{
+#if defined(CUSTOM_HASH_STATS) || defined(CUSTOM_INSTRUMENT)
+#ifdef CUSTOM_HASH_STATS
+   numProbes++;
+#endif
+   size_t num = 0;
+   for (auto it = buckets[iBucket].begin(); it != buckets[iBucket].end(); ++it)
    {
-      if (*itList == t) 
+      num++;
+      if (*it == t)
       {
-         return iterator(&buckets[iBucket], buckets + 10, itList);
+#ifdef CUSTOM_HASH_STATS
+         numComparisons += num;
+#endif
+         CUSTOM_INSTRUMENT_PROBE(num);
+         return it;
       }
-      ++itList;
    }
+#ifdef CUSTOM_HASH_STATS
+   numComparisons += num;
+#endif
+   CUSTOM_INSTRUMENT_PROBE(num);
+   return buckets[iBucket].end();
+#else
+   return buckets[iBucket].find(t);
+#endif
+}
 
-   return end();
+/*****************************************
+ * UNORDERED SET :: STATS
+ * Walk the bucket array once and describe it
+ *    COST   : O(bucket_count())
+ ****************************************/
+template <typename T, typename A, typename Bucket, typename H, typename R>
+hash_stats unordered_set <T, A, Bucket, H, R> ::stats() const
+{
+   hash_stats s;
+   size_t numEmpty = 0;
+   for (size_t i = 0; i < bucket_count(); i++)
+   {
+      size_t length = buckets[i].size();
+      if (length == 0)
+         numEmpty++;
+      if (length > s.max_chain)
+         s.max_chain = length;
+      s.histogram[length < hash_stats::HISTOGRAM ? length : hash_stats::HISTOGRAM - 1]++;
+   }
+
+   s.size = size();
+   s.buckets = bucket_count();
+   s.load_factor = (double)s.size / (double)s.buckets;
+   s.mean_chain = numEmpty < s.buckets ? (double)s.size / (double)(s.buckets - numEmpty) : 0.0;
+   s.empty_ratio = (double)numEmpty / (double)s.buckets;
+   s.bytes_buckets = s.buckets * sizeof(Bucket);
+   if constexpr (bucket_knows_bytes<Bucket>::value)
+      for (size_t i = 0; i < bucket_count(); i++)
+         s.bytes_nodes += buckets[i].bytes_nodes();
+#ifdef CUSTOM_HASH_STATS
+   s.probes = numProbes;
+   s.comparisons = numComparisons;
+#endif
+   return s;
 }
 
 /*****************************************
  * UNORDERED SET :: ITERATOR :: INCREMENT
  * Advance by one element in an unordered set
  ****************************************/
-template <typename T>
-typename unordered_set <T> ::iterator & unordered_set<T>::iterator::operator ++ ()
+template <typename T, typename A, typename Bucket, typename H, typename R>
+typename unordered_set <T, A, Bucket, H, R> ::iterator & unordered_set<T, A, Bucket, H, R>::iterator::operator ++ ()
 {
 
    if (pBucket == pBucketEnd)
@@ -446,7 +934,7 @@ typename unordered_set <T> ::iterator & unordered_set<T>::iterator::operator ++
    if (pBucket != pBucketEnd)
       itList = pBucket->begin();
    else
-      *this = unordered_set<T>::iterator(pBucketEnd, pBucketEnd, typename custom::list<T>::iterator());
+      *this = unordered_set<T, A, Bucket, H, R>::iterator(pBucketEnd, pBucketEnd, typename Bucket::iterator());
 
    return *this;
 }
@@ -455,8 +943,8 @@ typename unordered_set <T> ::iterator & unordered_set<T>::iterator::operator ++
  * SWAP
  * Stand-alone unordered set swap
  ****************************************/
-template <typename T>
-void swap(unordered_set<T>& lhs, unordered_set<T>& rhs)
+template <typename T, typename A, typename Bucket, typename H, typename R>
+void swap(unordered_set<T, A, Bucket, H, R>& lhs, unordered_set<T, A, Bucket, H, R>& rhs)
 {
    lhs.swap(rhs); 
 }
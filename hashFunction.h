@@ -0,0 +1,388 @@
+/***********************************************************************
+ * Header:
+ *    HASH FUNCTION
+ * Summary:
+ *    Hashers to use in place of std::hash. std::hash of an integer
+ *    is the integer itself, so keys which share a factor with the
+ *    bucket count (IDs which are all multiples of 10, in a table of
+ *    10 buckets) all land in the same bucket.
+ *
+ *    seeded_hash runs whatever the inner hasher returns through a
+ *    strong 64-bit finalizer, keyed by a seed. Every default
+ *    constructed seeded_hash draws a fresh seed, so every table
+ *    spreads the same keys differently and nobody can pick keys
+ *    ahead of time which collide in it.
+ *
+ *    custom::hash is a drop-in for std::hash which is good with
+ *    % bucket_count(). Integers go through a multiply-xorshift mixer.
+ *    Strings and spans go through a wyhash-style byte hasher which
+ *    eats 32 bytes a round in two independent lanes, each a 64x64
+ *    -> 128 bit multiply, so the lanes overlap in the pipeline:
+ *
+ *        [ 8 | 8 | 8 | 8 ][ 8 | 8 | 8 | 8 ] ... [ last 16 ]
+ *          lane 0  lane 1   lane 0  lane 1
+ *
+ *    Tuples and std::pair combine the hashes of their members.
+ *    custom::pair compares only its first, so only first is hashed.
+ *
+ *    This will contain the definitions of:
+ *        mix64                  : A 64-bit finalizer (every bit counts)
+ *        mix_int                : A cheaper mixer for integer keys
+ *        hash_bytes             : A fast hash of a run of bytes
+ *        hash_combine           : Fold one hash into another
+ *        random_seed            : A different seed on every call
+ *        seeded_hash            : A hasher with a per-instance seed
+ *        hash                   : Like std::hash, but well mixed
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "pair.h"       // for hashing custom::pair
+#include "span.h"       // for hashing a span
+#include <atomic>       // for the seed counter
+#include <chrono>       // for a little more entropy
+#include <cstdint>      // for uint64_t
+#include <cstring>      // for std::memcpy
+#include <functional>   // for std::hash
+#include <random>       // for std::random_device
+#include <string>       // for std::string
+#include <string_view>  // for std::string_view
+#include <tuple>        // for std::tuple
+#include <type_traits>  // for std::enable_if
+#include <utility>      // for std::pair
+
+class TestHashFunction; // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************
+ * MIX 64
+ * The MurmurHash3 finalizer: a bijection on 64 bits in
+ * which every input bit flips each output bit with
+ * probability about one half
+ ****************************************/
+inline uint64_t mix64(uint64_t h)
+{
+   h ^= h >> 33;
+   h *= 0xff51afd7ed558ccdull;
+   h ^= h >> 33;
+   h *= 0xc4ceb9fe1a85ec53ull;
+   h ^= h >> 33;
+   return h;
+}
+
+/*****************************************
+ * MIX INT
+ * Two rounds of xorshift-multiply: enough that the low
+ * digits of the result depend on every bit of the key
+ ****************************************/
+inline uint64_t mix_int(uint64_t x)
+{
+   x ^= x >> 32;
+   x *= 0xd6e8feb86659fd93ull;
+   x ^= x >> 32;
+   x *= 0xd6e8feb86659fd93ull;
+   x ^= x >> 32;
+   return x;
+}
+
+namespace wy
+{
+
+static const uint64_t SECRET[4] =
+{
+   0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+   0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+};
+
+/*****************************************
+ * MULTIPLY
+ * The full 128 bit product of a and b, in two halves
+ ****************************************/
+inline void multiply(uint64_t & a, uint64_t & b)
+{
+#ifdef __SIZEOF_INT128__
+   __uint128_t r = (__uint128_t)a * b;
+   a = (uint64_t)r;
+   b = (uint64_t)(r >> 64);
+#else
+   uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+   uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+   uint64_t t = rl + (rm0 << 32);
+   uint64_t c = t < rl;
+   uint64_t lo = t + (rm1 << 32);
+   c += lo < t;
+   a = lo;
+   b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+// multiply and fold the halves together
+inline uint64_t mix(uint64_t a, uint64_t b)
+{
+   multiply(a, b);
+   return a ^ b;
+}
+
+inline uint64_t read64(const unsigned char * p)
+{
+   uint64_t v;
+   std::memcpy(&v, p, 8);
+   return v;
+}
+
+inline uint64_t read32(const unsigned char * p)
+{
+   uint32_t v;
+   std::memcpy(&v, p, 4);
+   return v;
+}
+
+} // namespace wy
+
+/*****************************************
+ * HASH BYTES
+ * Short keys are read as at most four overlapping words,
+ * so there is no loop and no branch per byte. Long keys
+ * run 32 bytes a round through two lanes, then the last
+ * 16 bytes (which may overlap the rounds) finish it off.
+ *    COST   : O(len), a little over one multiply per 16 bytes
+ ****************************************/
+inline uint64_t hash_bytes(const void * pData, size_t len, uint64_t seed = 0)
+{
+   const unsigned char * p = static_cast<const unsigned char *>(pData);
+   seed ^= wy::mix(seed ^ wy::SECRET[0], wy::SECRET[1]);
+
+   uint64_t a;
+   uint64_t b;
+   if (len <= 16)
+   {
+      if (len >= 4)
+      {
+         size_t offset = (len >> 3) << 2;
+         a = (wy::read32(p) << 32) | wy::read32(p + offset);
+         b = (wy::read32(p + len - 4) << 32) | wy::read32(p + len - 4 - offset);
+      }
+      else if (len > 0)
+      {
+         a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+         b = 0;
+      }
+      else
+         a = b = 0;
+   }
+   else
+   {
+      size_t i = len;
+      if (i > 32)
+      {
+         uint64_t seed1 = seed;
+         do
+         {
+            seed  = wy::mix(wy::read64(p)      ^ wy::SECRET[1], wy::read64(p + 8)  ^ seed);
+            seed1 = wy::mix(wy::read64(p + 16) ^ wy::SECRET[2], wy::read64(p + 24) ^ seed1);
+            p += 32;
+            i -= 32;
+         }
+         while (i > 32);
+         seed ^= seed1;
+      }
+      while (i > 16)
+      {
+         seed = wy::mix(wy::read64(p) ^ wy::SECRET[1], wy::read64(p + 8) ^ seed);
+         p += 16;
+         i -= 16;
+      }
+      a = wy::read64(p + i - 16);
+      b = wy::read64(p + i - 8);
+   }
+
+   a ^= wy::SECRET[1];
+   b ^= seed;
+   wy::multiply(a, b);
+   return wy::mix(a ^ wy::SECRET[0] ^ len, b ^ wy::SECRET[1]);
+}
+
+/*****************************************
+ * HASH COMBINE
+ * Fold the hash of one more member into seed. The order
+ * matters: (a, b) and (b, a) hash differently.
+ ****************************************/
+inline uint64_t hash_combine(uint64_t seed, uint64_t h)
+{
+   return wy::mix(seed ^ wy::SECRET[2], h ^ wy::SECRET[3]);
+}
+
+/*****************************************
+ * RANDOM SEED
+ * The OS is asked for entropy once per process. After that
+ * each call steps a counter by the golden ratio and mixes
+ * it, which is cheap and never repeats.
+ ****************************************/
+inline uint64_t random_seed()
+{
+   static const uint64_t base = []()
+   {
+      std::random_device device;
+      uint64_t bits = ((uint64_t)device() << 32) ^ (uint64_t)device();
+      return bits ^ (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+   }();
+   static std::atomic<uint64_t> counter(0);
+   uint64_t n = counter.fetch_add(1, std::memory_order_relaxed);
+   return mix64(base + n * 0x9e3779b97f4a7c15ull);
+}
+
+/*****************************************
+ * SEEDED HASH
+ * Finalize the inner hash with the seed folded in. Copies
+ * share the seed, as they must: a table and its copy have
+ * to agree on where everything goes.
+ ****************************************/
+template <typename T, typename H = std::hash<T>>
+class seeded_hash
+{
+   friend class ::TestHashFunction; // give unit tests access to the privates
+public:
+   seeded_hash() : seed(random_seed()) {}
+   explicit seeded_hash(uint64_t seed, const H & hasher = H()) : hasher(hasher), seed(seed) {}
+
+   size_t operator()(const T & t) const
+   {
+      return (size_t)mix64((uint64_t)hasher(t) ^ seed);
+   }
+
+   uint64_t get_seed() const { return seed; }
+
+private:
+   H hasher;
+   uint64_t seed;
+};
+
+/************************************************
+ * HASH
+ * Anything std::hash takes, with the result mixed.
+ * The specializations below skip std::hash entirely.
+ ************************************************/
+template <typename T, typename Enable = void>
+struct hash
+{
+   size_t operator()(const T & t) const
+   {
+      return (size_t)mix_int((uint64_t)std::hash<T>()(t));
+   }
+};
+
+/*****************************************
+ * HASH : INTEGER
+ * Integers, enums and pointers are their own bits
+ ****************************************/
+template <typename T>
+struct hash <T, typename std::enable_if<std::is_integral<T>::value ||
+                                        std::is_enum<T>::value ||
+                                        std::is_pointer<T>::value>::type>
+{
+   size_t operator()(T t) const
+   {
+      uint64_t bits;
+      if constexpr (std::is_pointer<T>::value)
+         bits = (uint64_t)(uintptr_t)t;
+      else
+         bits = (uint64_t)t;
+      return (size_t)mix_int(bits);
+   }
+};
+
+/*****************************************
+ * HASH : STRING
+ * A std::string and a std::string_view of the same
+ * characters hash alike
+ ****************************************/
+template <>
+struct hash <std::string>
+{
+   size_t operator()(const std::string & s) const
+   {
+      return (size_t)hash_bytes(s.data(), s.size());
+   }
+};
+
+template <>
+struct hash <std::string_view>
+{
+   size_t operator()(std::string_view s) const
+   {
+      return (size_t)hash_bytes(s.data(), s.size());
+   }
+};
+
+/*****************************************
+ * HASH : SPAN
+ * The bytes of the elements, for elements without
+ * padding; anything else is combined one at a time
+ ****************************************/
+template <typename T>
+struct hash <span<T>>
+{
+   size_t operator()(const span<T> & s) const
+   {
+      typedef typename std::remove_const<T>::type U;
+      if constexpr (std::has_unique_object_representations<U>::value)
+         return (size_t)hash_bytes(s.data(), s.size_bytes());
+      else
+      {
+         uint64_t seed = s.size();
+         for (const U & u : s)
+            seed = hash_combine(seed, hash<U>()(u));
+         return (size_t)seed;
+      }
+   }
+};
+
+/*****************************************
+ * HASH : PAIR AND TUPLE
+ * Every member, in order
+ ****************************************/
+template <typename T1, typename T2>
+struct hash <std::pair<T1, T2>>
+{
+   size_t operator()(const std::pair<T1, T2> & p) const
+   {
+      return (size_t)hash_combine(hash<T1>()(p.first), hash<T2>()(p.second));
+   }
+};
+
+template <typename ... Ts>
+struct hash <std::tuple<Ts...>>
+{
+   size_t operator()(const std::tuple<Ts...> & t) const
+   {
+      return combine(t, std::index_sequence_for<Ts...>());
+   }
+private:
+   template <size_t ... I>
+   static size_t combine(const std::tuple<Ts...> & t, std::index_sequence<I...>)
+   {
+      uint64_t seed = sizeof...(Ts);
+      ((seed = hash_combine(seed, hash<Ts>()(std::get<I>(t)))), ...);
+      return (size_t)seed;
+   }
+};
+
+/*****************************************
+ * HASH : CUSTOM PAIR
+ * Two custom::pairs are equal when their firsts are,
+ * so the second cannot be part of the hash
+ ****************************************/
+template <typename T1, typename T2, typename C>
+struct hash <custom::pair<T1, T2, C>>
+{
+   size_t operator()(const custom::pair<T1, T2, C> & p) const
+   {
+      return hash<T1>()(p.first);
+   }
+};
+
+} // namespace custom
@@ -0,0 +1,415 @@
+/***********************************************************************
+ * Header:
+ *    INSTRUMENT
+ * Summary:
+ *    Opt-in counters for the hot paths, in the spirit of spy.h: where
+ *    a Spy counts what is done to an element, this counts what the
+ *    containers themselves do. Each instrumented operation records,
+ *    per call, how long it took, how many elements it probed and how
+ *    many allocations it made.
+ *
+ *    Define CUSTOM_INSTRUMENT before including any container to turn
+ *    it on. Without it the macros below are empty and the containers
+ *    compile to exactly what they were.
+ *
+ *    Every thread records into its own recorder, so recording takes
+ *    no lock and shares no cache line. The recorders are linked onto
+ *    a global list as threads first use them and are never freed, so
+ *    dump() can merge every thread there has ever been.
+ *
+ *    The histograms are HDR-style: exact below 8, and above that
+ *    eight sub-buckets per power of two, so any value is recorded to
+ *    within 12.5% in 496 counters which cover all of uint64_t:
+ *
+ *        value:   0 1 .. 7 | 8 9 .. 15 | 16 18 .. 30 | 32 36 .. 60 | ...
+ *        index:   0 1 .. 7 | 8 9 .. 15 | 16 17 .. 23 | 24 25 .. 31 | ...
+ *
+ *    Latency is in cycles (rdtsc) on x86 and nanoseconds elsewhere.
+ *
+ *    This will contain the definitions of:
+ *        CUSTOM_INSTRUMENT_*    : The hooks the containers call
+ *        instrument::histogram  : Counts of values, log-linear
+ *        instrument::recorder   : One thread's histograms, per operation
+ *        instrument::scope      : Times one call and records it
+ *        instrument::dump       : Print every operation seen so far
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>       // for the counters and the list of recorders
+#include <chrono>       // for the time where there is no rdtsc
+#include <cstdint>      // for uint64_t
+#include <ostream>      // for dump
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // for __rdtsc
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>     // for __rdtsc and _BitScanReverse64
+#endif
+
+#ifdef CUSTOM_INSTRUMENT
+#define CUSTOM_INSTRUMENT_SCOPE(which) \
+   custom::instrument::scope instrumentScope(custom::instrument::which)
+#define CUSTOM_INSTRUMENT_PROBE(num)   (custom::instrument::local().probes += (num))
+#define CUSTOM_INSTRUMENT_ALLOC()      (custom::instrument::local().allocs++)
+#else
+#define CUSTOM_INSTRUMENT_SCOPE(which)
+#define CUSTOM_INSTRUMENT_PROBE(num)
+#define CUSTOM_INSTRUMENT_ALLOC()
+#endif // CUSTOM_INSTRUMENT
+
+class TestInstrument;   // forward declaration for unit tests
+
+namespace custom
+{
+namespace instrument
+{
+
+/*****************************************
+ * OP
+ * Every operation with a hook in it
+ ****************************************/
+enum op { SET_INSERT,        // 0  unordered_set::insert
+          SET_FIND,          // 1  unordered_set::find
+          SET_ERASE,         // 2  unordered_set::erase
+          LIST_PUSH_BACK,    // 3  list::push_back
+          LIST_PUSH_FRONT,   // 4  list::push_front
+          LIST_INSERT,       // 5  list::insert
+          LIST_ERASE,        // 6  list::erase
+          LIST_POP_BACK,     // 7  list::pop_back
+          LIST_POP_FRONT,    // 8  list::pop_front
+          VECTOR_PUSH_BACK,  // 9  vector::push_back
+          VECTOR_RESERVE,    // 10 vector::reserve
+          VECTOR_RESIZE,     // 11 vector::resize
+          VECTOR_SHRINK,     // 12 vector::shrink_to_fit
+          NUM_OPS };
+
+inline const char * op_name(op which)
+{
+   static const char * names[NUM_OPS] =
+   {
+      "unordered_set::insert", "unordered_set::find", "unordered_set::erase",
+      "list::push_back", "list::push_front", "list::insert", "list::erase",
+      "list::pop_back", "list::pop_front",
+      "vector::push_back", "vector::reserve", "vector::resize", "vector::shrink_to_fit"
+   };
+   return names[which];
+}
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+inline const char * tick_units() { return "cycles"; }
+inline uint64_t ticks()          { return (uint64_t)__rdtsc(); }
+#else
+inline const char * tick_units() { return "ns"; }
+inline uint64_t ticks()
+{
+   return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+/************************************************
+ * HISTOGRAM
+ * One thread writes, any thread may read. A write
+ * is a relaxed load and store, not a locked add,
+ * because there is only ever the one writer.
+ ************************************************/
+class histogram
+{
+   friend class ::TestInstrument;   // give unit tests access to the privates
+public:
+   static constexpr size_t SUB_BITS = 3;
+   static constexpr size_t SUB = size_t(1) << SUB_BITS;
+   static constexpr size_t NUM = (64 - SUB_BITS + 1) * SUB;
+
+   histogram() : numValues(0), total(0), largest(0)
+   {
+      for (size_t i = 0; i < NUM; i++)
+         counts[i].store(0, std::memory_order_relaxed);
+   }
+
+   //
+   // Where a value goes, and the smallest value which goes there
+   //
+   static size_t index(uint64_t value)
+   {
+      if (value < SUB)
+         return (size_t)value;
+      size_t shift = msb(value) - SUB_BITS;
+      return (shift + 1) * SUB + (size_t)((value >> shift) & (SUB - 1));
+   }
+   static uint64_t lowest(size_t i)
+   {
+      if (i < SUB)
+         return i;
+      size_t shift = i / SUB - 1;
+      return (uint64_t)(SUB + i % SUB) << shift;
+   }
+
+   //
+   // Write: only from the thread which owns this histogram
+   //
+   void record(uint64_t value)
+   {
+      bump(counts[index(value)], 1);
+      bump(numValues, 1);
+      bump(total, value);
+      if (value > largest.load(std::memory_order_relaxed))
+         largest.store(value, std::memory_order_relaxed);
+   }
+
+   //
+   // Read: from any thread
+   //
+   uint64_t count()    const { return numValues.load(std::memory_order_relaxed); }
+   uint64_t sum()      const { return total.load(std::memory_order_relaxed);     }
+   uint64_t max()      const { return largest.load(std::memory_order_relaxed);   }
+   uint64_t count_at(size_t i) const { return counts[i].load(std::memory_order_relaxed); }
+   uint64_t percentile(double p) const;
+
+   //
+   // Merge and reset
+   //
+   void add(const histogram & rhs);
+   void clear();
+
+private:
+   static void bump(std::atomic<uint64_t> & counter, uint64_t by)
+   {
+      counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+   }
+   static size_t msb(uint64_t value)
+   {
+#ifdef _MSC_VER
+      unsigned long i;
+      _BitScanReverse64(&i, value);
+      return (size_t)i;
+#else
+      return (size_t)(63 - __builtin_clzll(value));
+#endif
+   }
+
+   std::atomic<uint64_t> counts[NUM];
+   std::atomic<uint64_t> numValues;
+   std::atomic<uint64_t> total;
+   std::atomic<uint64_t> largest;
+};
+
+/*****************************************
+ * HISTOGRAM :: PERCENTILE
+ * The lowest value of the sub-bucket holding the pth
+ * percentile: never more than 12.5% under the truth
+ ****************************************/
+inline uint64_t histogram::percentile(double p) const
+{
+   uint64_t num = count();
+   if (num == 0)
+      return 0;
+   uint64_t rank = (uint64_t)(p / 100.0 * (double)num);
+   if (rank >= num)
+      rank = num - 1;
+   uint64_t seen = 0;
+   for (size_t i = 0; i < NUM; i++)
+   {
+      seen += count_at(i);
+      if (seen > rank)
+         return lowest(i);
+   }
+   return max();
+}
+
+/*****************************************
+ * HISTOGRAM :: ADD
+ * Fold another histogram into this one
+ ****************************************/
+inline void histogram::add(const histogram & rhs)
+{
+   for (size_t i = 0; i < NUM; i++)
+      bump(counts[i], rhs.count_at(i));
+   bump(numValues, rhs.count());
+   bump(total, rhs.sum());
+   if (rhs.max() > max())
+      largest.store(rhs.max(), std::memory_order_relaxed);
+}
+
+/*****************************************
+ * HISTOGRAM :: CLEAR
+ ****************************************/
+inline void histogram::clear()
+{
+   for (size_t i = 0; i < NUM; i++)
+      counts[i].store(0, std::memory_order_relaxed);
+   numValues.store(0, std::memory_order_relaxed);
+   total.store(0, std::memory_order_relaxed);
+   largest.store(0, std::memory_order_relaxed);
+}
+
+/************************************************
+ * RECORDER
+ * One thread's record of every operation
+ ************************************************/
+struct recorder
+{
+   recorder() : pNext(nullptr)
+   {
+      for (size_t i = 0; i < NUM_OPS; i++)
+         allocs[i].store(0, std::memory_order_relaxed);
+   }
+
+   histogram latency[NUM_OPS];            // ticks per call
+   histogram probes[NUM_OPS];             // elements looked at per call
+   std::atomic<uint64_t> allocs[NUM_OPS]; // allocations, all calls together
+   recorder * pNext;                      // the next thread's recorder
+};
+
+/*****************************************
+ * RECORDERS
+ * The head of the list of every thread's recorder
+ ****************************************/
+inline std::atomic<recorder *> & recorders()
+{
+   static std::atomic<recorder *> pHead(nullptr);
+   return pHead;
+}
+
+/*****************************************
+ * LOCAL
+ * This thread's running totals, which a scope reads
+ * on the way in and out, and its recorder, made and
+ * pushed onto the list the first time it is needed
+ ****************************************/
+struct thread_state
+{
+   uint64_t probes = 0;
+   uint64_t allocs = 0;
+   recorder * pRecorder = nullptr;
+};
+
+inline thread_state & local()
+{
+   thread_local thread_state state;
+   return state;
+}
+
+inline recorder & local_recorder()
+{
+   thread_state & state = local();
+   if (state.pRecorder == nullptr)
+   {
+      recorder * pNew = new recorder;
+      pNew->pNext = recorders().load(std::memory_order_relaxed);
+      while (!recorders().compare_exchange_weak(pNew->pNext, pNew,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed))
+         ;
+      state.pRecorder = pNew;
+   }
+   return *state.pRecorder;
+}
+
+/************************************************
+ * SCOPE
+ * Lives for the length of one call. Whatever the
+ * thread probed and allocated in the meantime,
+ * including in calls nested inside this one, is
+ * charged to this call.
+ ************************************************/
+class scope
+{
+public:
+   explicit scope(op which)
+      : which(which), probes(local().probes), allocs(local().allocs), start(ticks()) {}
+  ~scope()
+   {
+      uint64_t end = ticks();
+      thread_state & state = local();
+      recorder & r = local_recorder();
+      r.latency[which].record(end - start);
+      r.probes[which].record(state.probes - probes);
+      r.allocs[which].store(r.allocs[which].load(std::memory_order_relaxed) +
+                            (state.allocs - allocs), std::memory_order_relaxed);
+   }
+   scope(const scope &) = delete;
+   scope & operator = (const scope &) = delete;
+
+private:
+   op which;
+   uint64_t probes;
+   uint64_t allocs;
+   uint64_t start;
+};
+
+/************************************************
+ * SUMMARY
+ * Every thread's record of one operation, merged
+ ************************************************/
+struct summary
+{
+   summary() : allocs(0) {}
+   histogram latency;
+   histogram probes;
+   uint64_t allocs;
+};
+
+inline void merge(op which, summary & s)
+{
+   for (recorder * p = recorders().load(std::memory_order_acquire); p; p = p->pNext)
+   {
+      s.latency.add(p->latency[which]);
+      s.probes.add(p->probes[which]);
+      s.allocs += p->allocs[which].load(std::memory_order_relaxed);
+   }
+}
+
+/*****************************************
+ * RESET
+ * Zero every thread's record. Calls in flight on other
+ * threads may still land afterwards.
+ ****************************************/
+inline void reset()
+{
+   for (recorder * p = recorders().load(std::memory_order_acquire); p; p = p->pNext)
+      for (size_t i = 0; i < NUM_OPS; i++)
+      {
+         p->latency[i].clear();
+         p->probes[i].clear();
+         p->allocs[i].store(0, std::memory_order_relaxed);
+      }
+}
+
+/*****************************************
+ * DUMP
+ * One line for every operation which has been called:
+ * how often, what it allocated, and the distributions
+ * of its probes and latency
+ ****************************************/
+inline void dump(std::ostream & out)
+{
+   for (size_t i = 0; i < NUM_OPS; i++)
+   {
+      summary * pSummary = new summary;
+      merge((op)i, *pSummary);
+      const histogram & latency = pSummary->latency;
+      const histogram & probes = pSummary->probes;
+      uint64_t calls = latency.count();
+      if (calls)
+      {
+         out << op_name((op)i) << ":\t"
+             << calls << " calls\t"
+             << (double)pSummary->allocs / (double)calls << " allocs/call\t"
+             << "probes p50 " << probes.percentile(50)
+             << " p99 " << probes.percentile(99)
+             << " max " << probes.max() << "\t"
+             << tick_units() << " p50 " << latency.percentile(50)
+             << " p90 " << latency.percentile(90)
+             << " p99 " << latency.percentile(99)
+             << " max " << latency.max() << "\n";
+      }
+      delete pSummary;
+   }
+}
+
+} // namespace instrument
+} // namespace custom
@@ -0,0 +1,636 @@
+/***********************************************************************
+ * Header:
+ *    INTRUSIVE
+ * Summary:
+ *    Containers which link objects that already live somewhere
+ *    else (an arena, a pool, the stack). The links are a hook
+ *    member inside the object itself, so linking and unlinking
+ *    never allocate and never copy. Given just a reference to an
+ *    object, it can be unlinked in O(1).
+ *
+ *    The containers do not own their objects: an object must be
+ *    erased before it is destroyed, and clearing a container only
+ *    unlinks.
+ *
+ *        struct Order
+ *        {
+ *           int id;
+ *           custom::list_hook byTime;
+ *           custom::set_hook  byId;
+ *        };
+ *        custom::intrusive_list<Order, &Order::byTime> queue;
+ *        custom::intrusive_unordered_set<Order, &Order::byId, ById, SameId> index;
+ *
+ *    This will contain the class definition of:
+ *        list_hook               : The links an object needs to be in a list
+ *        intrusive_list          : A list of objects linked through a hook
+ *        set_hook                : The links and cached hash for a set
+ *        intrusive_unordered_set : A hash of objects linked through a hook
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "pair.h"      // for the result of insert
+#include <cassert>     // because I am paranoid
+#include <functional>  // for std::hash and std::equal_to
+#include <utility>     // for std::swap
+
+class TestIntrusive;   // forward declaration for unit tests
+
+namespace custom
+{
+
+// defined after the hooks, which give it their owners
+template <typename T, typename H>
+T * owner_of(H * pHook);
+
+/*****************************************
+ * LIST HOOK
+ * Embed one of these in an object for every intrusive_list
+ * it may be on at the same time. Copying an object does not
+ * copy its links: the copy starts out unlinked.
+ ****************************************/
+class list_hook
+{
+   friend class ::TestIntrusive;
+   template <typename T, list_hook T::*Hook>
+   friend class intrusive_list;
+   template <typename T, typename H>
+   friend T * owner_of(H * pHook);
+public:
+   list_hook() : pNext(nullptr), pPrev(nullptr), pOwner(nullptr) {}
+   list_hook(const list_hook &) : list_hook() {}
+   list_hook & operator = (const list_hook &) { return *this; }
+  ~list_hook()
+   {
+      assert(!is_linked());   // erase an object before destroying it
+   }
+
+   bool is_linked() const { return pOwner != nullptr; }
+
+private:
+   list_hook * pNext;
+   list_hook * pPrev;
+   void *      pOwner;   // the object we are part of, while linked
+};
+
+/**************************************************
+ * INTRUSIVE LIST
+ * Just like list, except the nodes are the objects
+ * themselves: push_back(t) links t, it does not copy it
+ **************************************************/
+template <typename T, list_hook T::*Hook>
+class intrusive_list
+{
+   friend class ::TestIntrusive; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   intrusive_list() : numElements(0), pHead(nullptr), pTail(nullptr) {}
+   intrusive_list(intrusive_list && rhs) : intrusive_list()
+   {
+      swap(rhs);
+   }
+  ~intrusive_list()
+   {
+      clear();
+   }
+   intrusive_list & operator = (intrusive_list && rhs)
+   {
+      clear();
+      swap(rhs);
+      return *this;
+   }
+   void swap(intrusive_list & rhs)
+   {
+      std::swap(numElements, rhs.numElements);
+      std::swap(pHead, rhs.pHead);
+      std::swap(pTail, rhs.pTail);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() { return iterator(pHead);   }
+   iterator end()   { return iterator(nullptr); }
+   iterator iterator_to(T & t) { return iterator(&(t.*Hook)); }
+
+   //
+   // Access
+   //
+
+   T & front()
+   {
+      if (empty())
+         throw "ERROR: unable to access data from an empty list";
+      return *owner_of<T>(pHead);
+   }
+   T & back()
+   {
+      if (empty())
+         throw "ERROR: unable to access data from an empty list";
+      return *owner_of<T>(pTail);
+   }
+
+   //
+   // Insert
+   //
+
+   void push_back(T & t)  { insert(end(), t);   }
+   void push_front(T & t) { insert(begin(), t); }
+   iterator insert(iterator it, T & t);
+
+   //
+   // Remove
+   //
+
+   void pop_back()  { if (pTail) erase(*owner_of<T>(pTail)); }
+   void pop_front() { if (pHead) erase(*owner_of<T>(pHead)); }
+   iterator erase(iterator it);
+   void erase(T & t);
+   void clear();
+
+   //
+   // Status
+   //
+
+   bool   empty() const { return numElements == 0; }
+   size_t size()  const { return numElements;      }
+
+private:
+   // not copyable: an object can only be linked into one list per hook
+   intrusive_list(const intrusive_list &) = delete;
+   intrusive_list & operator = (const intrusive_list &) = delete;
+
+   size_t numElements;
+   list_hook * pHead;
+   list_hook * pTail;
+};
+
+/*************************************************
+ * INTRUSIVE LIST ITERATOR
+ * Walks the hooks, hands out the objects
+ ************************************************/
+template <typename T, list_hook T::*Hook>
+class intrusive_list <T, Hook> ::iterator
+{
+   friend class ::TestIntrusive;
+   friend class intrusive_list;
+public:
+   iterator() : p(nullptr) {}
+   iterator(list_hook * p) : p(p) {}
+
+   bool operator == (const iterator & rhs) const { return p == rhs.p; }
+   bool operator != (const iterator & rhs) const { return p != rhs.p; }
+
+   T & operator * ()
+   {
+      if (p == nullptr)
+         throw "ERROR: Trying to dereference a nullptr pointer";
+      return *owner_of<T>(p);
+   }
+   T * operator -> () { return &**this; }
+
+   iterator & operator ++ ()
+   {
+      if (p)
+         p = p->pNext;
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator old(*this);
+      ++(*this);
+      return old;
+   }
+   iterator & operator -- ()
+   {
+      if (p)
+         p = p->pPrev;
+      return *this;
+   }
+   iterator operator -- (int postfix)
+   {
+      iterator old(*this);
+      --(*this);
+      return old;
+   }
+
+private:
+   list_hook * p;
+};
+
+/*****************************************
+ * INTRUSIVE LIST :: INSERT
+ * Link t in front of it
+ *     COST   : O(1) and no allocation
+ ****************************************/
+template <typename T, list_hook T::*Hook>
+typename intrusive_list <T, Hook> ::iterator intrusive_list <T, Hook> ::insert(iterator it, T & t)
+{
+   list_hook * pNew = &(t.*Hook);
+   if (pNew->is_linked())
+      throw "ERROR: the object is already in a list";
+
+   list_hook * pBefore = it.p ? it.p->pPrev : pTail;
+   pNew->pPrev = pBefore;
+   pNew->pNext = it.p;
+   if (pBefore)
+      pBefore->pNext = pNew;
+   else
+      pHead = pNew;
+   if (it.p)
+      it.p->pPrev = pNew;
+   else
+      pTail = pNew;
+   pNew->pOwner = &t;
+   numElements++;
+   return iterator(pNew);
+}
+
+/*****************************************
+ * INTRUSIVE LIST :: ERASE
+ * Unlink t using nothing but its own hook
+ *     COST   : O(1) and no deallocation
+ ****************************************/
+template <typename T, list_hook T::*Hook>
+void intrusive_list <T, Hook> ::erase(T & t)
+{
+   list_hook * p = &(t.*Hook);
+   assert(p->is_linked());
+   if (p->pPrev)
+      p->pPrev->pNext = p->pNext;
+   else
+      pHead = p->pNext;
+   if (p->pNext)
+      p->pNext->pPrev = p->pPrev;
+   else
+      pTail = p->pPrev;
+   p->pNext = p->pPrev = nullptr;
+   p->pOwner = nullptr;
+   numElements--;
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list <T, Hook> ::iterator intrusive_list <T, Hook> ::erase(iterator it)
+{
+   if (it.p == nullptr)
+      return end();
+   iterator itNext(it.p->pNext);
+   erase(*it);
+   return itNext;
+}
+
+/*****************************************
+ * INTRUSIVE LIST :: CLEAR
+ * Unlink everything. The objects are left alone
+ ****************************************/
+template <typename T, list_hook T::*Hook>
+void intrusive_list <T, Hook> ::clear()
+{
+   for (list_hook * p = pHead; p; )
+   {
+      list_hook * pNext = p->pNext;
+      p->pNext = p->pPrev = nullptr;
+      p->pOwner = nullptr;
+      p = pNext;
+   }
+   pHead = pTail = nullptr;
+   numElements = 0;
+}
+
+/*****************************************
+ * SET HOOK
+ * Embed one of these in an object to put it in an
+ * intrusive_unordered_set. The hash is computed once, on
+ * insert, and kept here so that growing the table never
+ * hashes anything again.
+ ****************************************/
+class set_hook
+{
+   friend class ::TestIntrusive;
+   template <typename T, set_hook T::*Hook, typename H, typename E>
+   friend class intrusive_unordered_set;
+   template <typename T, typename H>
+   friend T * owner_of(H * pHook);
+public:
+   set_hook() : pNext(nullptr), ppPrev(nullptr), pOwner(nullptr), hash(0) {}
+   set_hook(const set_hook &) : set_hook() {}
+   set_hook & operator = (const set_hook &) { return *this; }
+  ~set_hook()
+   {
+      assert(!is_linked());   // erase an object before destroying it
+   }
+
+   bool is_linked() const { return ppPrev != nullptr; }
+
+private:
+   set_hook *  pNext;    // the next object in this bucket
+   set_hook ** ppPrev;   // whatever points to us: a bucket or a pNext
+   void *      pOwner;   // the object we are part of, set when inserted
+   size_t      hash;     // our hash, cached when we were inserted
+};
+
+/*****************************************
+ * OWNER OF
+ * From a pointer to the hook member of some T, get back
+ * to the T. Each hook remembers its object when it is
+ * linked, so no member offset is ever computed.
+ ****************************************/
+template <typename T, typename H>
+T * owner_of(H * pHook)
+{
+   return static_cast<T *>(pHook->pOwner);
+}
+
+/************************************************
+ * INTRUSIVE UNORDERED SET
+ * A hash whose chains run through the objects' own
+ * set_hooks. The only allocation is the bucket array,
+ * which doubles when there are more objects than buckets.
+ ************************************************/
+template <typename T, set_hook T::*Hook,
+          typename H = std::hash<T>, typename E = std::equal_to<T>>
+class intrusive_unordered_set
+{
+   friend class ::TestIntrusive;   // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   intrusive_unordered_set(size_t numBuckets = 8, const H & hasher = H(), const E & equal = E())
+      : numElements(0), numBuckets(numBuckets ? numBuckets : 1),
+        hasher(hasher), equal(equal)
+   {
+      buckets = new set_hook * [this->numBuckets]();
+   }
+  ~intrusive_unordered_set()
+   {
+      clear();
+      delete [] buckets;
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin();
+   iterator end() { return iterator(buckets + numBuckets, buckets + numBuckets, nullptr); }
+
+   //
+   // Access
+   //
+
+   template <typename K>
+   iterator find(const K & key);
+
+   //
+   // Insert
+   //
+
+   custom::pair<iterator, bool> insert(T & t);
+
+   //
+   // Remove
+   //
+
+   void erase(T & t);
+   iterator erase(iterator it);
+   void clear();
+
+   //
+   // Status
+   //
+
+   size_t size()         const { return numElements;      }
+   bool   empty()        const { return numElements == 0; }
+   size_t bucket_count() const { return numBuckets;       }
+   size_t bucket_size(size_t i) const
+   {
+      size_t num = 0;
+      for (set_hook * p = buckets[i]; p; p = p->pNext)
+         num++;
+      return num;
+   }
+
+private:
+   intrusive_unordered_set(const intrusive_unordered_set &) = delete;
+   intrusive_unordered_set & operator = (const intrusive_unordered_set &) = delete;
+
+   void link(set_hook * p);
+   void rehash(size_t newBuckets);
+
+   set_hook ** buckets;     // the head of each chain
+   size_t numElements;
+   size_t numBuckets;
+   H hasher;
+   E equal;
+};
+
+/************************************************
+ * INTRUSIVE UNORDERED SET ITERATOR
+ * Walks every chain in every bucket
+ ************************************************/
+template <typename T, set_hook T::*Hook, typename H, typename E>
+class intrusive_unordered_set <T, Hook, H, E> ::iterator
+{
+   friend class ::TestIntrusive;
+   friend class intrusive_unordered_set;
+public:
+   iterator() : pBucket(nullptr), pBucketEnd(nullptr), p(nullptr) {}
+   iterator(set_hook ** pBucket, set_hook ** pBucketEnd, set_hook * p)
+      : pBucket(pBucket), pBucketEnd(pBucketEnd), p(p) {}
+
+   bool operator == (const iterator & rhs) const { return p == rhs.p; }
+   bool operator != (const iterator & rhs) const { return p != rhs.p; }
+
+   T & operator * ()
+   {
+      if (p == nullptr)
+         throw "ERROR: Trying to dereference a nullptr pointer";
+      return *owner_of<T>(p);
+   }
+   T * operator -> () { return &**this; }
+
+   iterator & operator ++ ()
+   {
+      if (p == nullptr)
+         return *this;
+      p = p->pNext;
+      while (p == nullptr && ++pBucket != pBucketEnd)
+         p = *pBucket;
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator old(*this);
+      ++(*this);
+      return old;
+   }
+
+private:
+   set_hook ** pBucket;
+   set_hook ** pBucketEnd;
+   set_hook *  p;
+};
+
+/*****************************************
+ * INTRUSIVE UNORDERED SET :: BEGIN
+ ****************************************/
+template <typename T, set_hook T::*Hook, typename H, typename E>
+typename intrusive_unordered_set <T, Hook, H, E> ::iterator
+intrusive_unordered_set <T, Hook, H, E> ::begin()
+{
+   for (size_t i = 0; i < numBuckets; i++)
+      if (buckets[i])
+         return iterator(buckets + i, buckets + numBuckets, buckets[i]);
+   return end();
+}
+
+/*****************************************
+ * INTRUSIVE UNORDERED SET :: FIND
+ * Look for an object equal to key. The key need not
+ * be a T, so long as H and E accept it
+ ****************************************/
+template <typename T, set_hook T::*Hook, typename H, typename E>
+template <typename K>
+typename intrusive_unordered_set <T, Hook, H, E> ::iterator
+intrusive_unordered_set <T, Hook, H, E> ::find(const K & key)
+{
+   size_t hash = hasher(key);
+   size_t iBucket = hash % numBuckets;
+   for (set_hook * p = buckets[iBucket]; p; p = p->pNext)
+      if (p->hash == hash && equal(*owner_of<T>(p), key))
+         return iterator(buckets + iBucket, buckets + numBuckets, p);
+   return end();
+}
+
+/*****************************************
+ * INTRUSIVE UNORDERED SET :: LINK
+ * Put a hook whose hash is already set at the front
+ * of its bucket
+ ****************************************/
+template <typename T, set_hook T::*Hook, typename H, typename E>
+void intrusive_unordered_set <T, Hook, H, E> ::link(set_hook * p)
+{
+   set_hook ** ppBucket = buckets + p->hash % numBuckets;
+   p->pNext = *ppBucket;
+   if (p->pNext)
+      p->pNext->ppPrev = &p->pNext;
+   p->ppPrev = ppBucket;
+   *ppBucket = p;
+}
+
+/*****************************************
+ * INTRUSIVE UNORDERED SET :: INSERT
+ * Link t unless an equal object is already here
+ *    OUTPUT : where t (or its equal) is, and whether t was linked
+ *    COST   : O(1) expected; the only allocation is when
+ *             the bucket array grows
+ ****************************************/
+template <typename T, set_hook T::*Hook, typename H, typename E>
+custom::pair<typename intrusive_unordered_set <T, Hook, H, E> ::iterator, bool>
+intrusive_unordered_set <T, Hook, H, E> ::insert(T & t)
+{
+   set_hook * p = &(t.*Hook);
+   if (p->is_linked())
+      throw "ERROR: the object is already in a set";
+
+   iterator it = find(t);
+   if (it != end())
+      return custom::pair<iterator, bool>(it, false);
+
+   if (numElements >= numBuckets)
+      rehash(numBuckets * 2);
+
+   p->hash = hasher(t);
+   p->pOwner = &t;
+   link(p);
+   numElements++;
+   size_t iBucket = p->hash % numBuckets;
+   return custom::pair<iterator, bool>(iterator(buckets + iBucket, buckets + numBuckets, p), true);
+}
+
+/*****************************************
+ * INTRUSIVE UNORDERED SET :: ERASE
+ * Unlink t using nothing but its own hook
+ *     COST   : O(1), no hashing and no searching
+ ****************************************/
+template <typename T, set_hook T::*Hook, typename H, typename E>
+void intrusive_unordered_set <T, Hook, H, E> ::erase(T & t)
+{
+   set_hook * p = &(t.*Hook);
+   assert(p->is_linked());
+   *p->ppPrev = p->pNext;
+   if (p->pNext)
+      p->pNext->ppPrev = p->ppPrev;
+   p->pNext = nullptr;
+   p->ppPrev = nullptr;
+   numElements--;
+}
+
+template <typename T, set_hook T::*Hook, typename H, typename E>
+typename intrusive_unordered_set <T, Hook, H, E> ::iterator
+intrusive_unordered_set <T, Hook, H, E> ::erase(iterator it)
+{
+   if (it.p == nullptr)
+      return end();
+   iterator itNext = it;
+   ++itNext;
+   erase(*it);
+   return itNext;
+}
+
+/*****************************************
+ * INTRUSIVE UNORDERED SET :: CLEAR
+ * Unlink every object; the objects are left alone
+ ****************************************/
+template <typename T, set_hook T::*Hook, typename H, typename E>
+void intrusive_unordered_set <T, Hook, H, E> ::clear()
+{
+   for (size_t i = 0; i < numBuckets; i++)
+   {
+      for (set_hook * p = buckets[i]; p; )
+      {
+         set_hook * pNext = p->pNext;
+         p->pNext = nullptr;
+         p->ppPrev = nullptr;
+         p = pNext;
+      }
+      buckets[i] = nullptr;
+   }
+   numElements = 0;
+}
+
+/*****************************************
+ * INTRUSIVE UNORDERED SET :: REHASH
+ * Move every hook into a new bucket array using the
+ * hash it already carries
+ ****************************************/
+template <typename T, set_hook T::*Hook, typename H, typename E>
+void intrusive_unordered_set <T, Hook, H, E> ::rehash(size_t newBuckets)
+{
+   set_hook ** oldBuckets = buckets;
+   size_t oldNum = numBuckets;
+   buckets = new set_hook * [newBuckets]();
+   numBuckets = newBuckets;
+
+   for (size_t i = 0; i < oldNum; i++)
+      for (set_hook * p = oldBuckets[i]; p; )
+      {
+         set_hook * pNext = p->pNext;
+         link(p);
+         p = pNext;
+      }
+   delete [] oldBuckets;
+}
+
+} // namespace custom
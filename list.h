@@ -23,6 +23,10 @@
 #include <iostream>    // for nullptr
 #include <new>         // std::bad_alloc
 #include <memory>      // for std::allocator
+#include <functional>  // for std::less
+#include <iterator>    // for std::iterator_traits
+#include <type_traits> // for std::is_base_of
+#include "instrument.h" // for CUSTOM_INSTRUMENT
 
 class TestList;        // forward declaration for unit tests
 class TestHash;        // to be used later
@@ -30,6 +34,20 @@ class TestHash;        // to be used later
 namespace custom
 {
 
+   /**************************************************
+    * IS MULTIPASS
+    * Whether a range can be walked twice: once to count
+    * it and once to copy it
+    **************************************************/
+   template <class Iterator, class = void>
+   struct is_multipass : std::false_type {};
+
+   template <class Iterator>
+   struct is_multipass <Iterator,
+      std::void_t<typename std::iterator_traits<Iterator>::iterator_category>>
+      : std::is_base_of<std::forward_iterator_tag,
+                        typename std::iterator_traits<Iterator>::iterator_category> {};
+
    /**************************************************
     * LIST
     * Just like std::list
@@ -51,7 +69,8 @@ namespace custom
       list(size_t num, const T& t);
       list(size_t num);
       list(const std::initializer_list<T>& il);
-      template <class Iterator>
+      template <class Iterator,
+                class = typename std::iterator_traits<Iterator>::value_type>
       list(Iterator first, Iterator last);
       ~list()
       {
@@ -94,6 +113,8 @@ namespace custom
       void push_back(T&& data);
       iterator insert(iterator it, const T& data);
       iterator insert(iterator it, T&& data);
+      template <class Iterator>
+      iterator insert(iterator it, Iterator first, Iterator last);
 
       //
       // Remove
@@ -104,12 +125,30 @@ namespace custom
       void clear();
       iterator erase(const iterator& it);
 
+      //
+      // Reorder: relink nodes, never allocate or copy a T
+      //
+
+      void splice(iterator it, list <T>& rhs);
+      void splice(iterator it, list <T>& rhs, iterator itRHS);
+      void splice(iterator it, list <T>& rhs, iterator first, iterator last);
+      void splice(iterator it, list <T>& rhs, iterator first, iterator last, size_t num);
+      void merge(list <T>& rhs) { merge(rhs, std::less<T>()); }
+      template <class Compare>
+      void merge(list <T>& rhs, Compare isLess);
+      void sort() { sort(std::less<T>()); }
+      template <class Compare>
+      void sort(Compare isLess);
+      void reverse();
+      size_t unique();
+
       // 
       // Status
       //
 
       bool empty()  const { return pHead == NULL; }
       size_t size() const { return numElements; }
+      size_t bytes_nodes() const { return numElements * Node::stride(); }
 
 
 
@@ -117,6 +156,24 @@ namespace custom
       // nested linked list class
       class Node;
 
+      // the front of an allocation holding many nodes; the
+      // last of them to be deleted frees it
+      struct Block
+      {
+         size_t numLive;   // nodes constructed and not yet deleted
+      };
+
+      // build a detached chain of copies for the bulk insert
+      template <class Iterator>
+      static Node* copyChain(Iterator first, Iterator last, Node*& pLast, size_t& num);
+
+      // relinking helpers for splice, merge, and sort
+      void unlink(Node* pFirst, Node* pLast);
+      void link(Node* pPos, Node* pFirst, Node* pLast);
+      void relinkPrevious();
+      template <class Compare>
+      static Node* mergeRuns(Node* pLeft, Node* pRight, Compare isLess);
+
       // member variables
       size_t numElements; // though we could count, it is faster to keep a variable
       Node* pHead;    // pointer to the beginning of the list
@@ -151,7 +208,82 @@ namespace custom
          pPrev = pNext = nullptr;
       }
 
+      //
+      // Allocate: in front of every node is a slot naming the
+      // Block it was carved from, or nullptr when the node is an
+      // allocation of its own. So delete works on either kind and
+      // no other code needs to know which is which.
+      //
+      static void * operator new(size_t size)
+      {
+         char * pSlot = static_cast<char *>(rawAllocate(prefix() + size));
+         *reinterpret_cast<Block **>(pSlot) = nullptr;
+         return pSlot + prefix();
+      }
+      static void * operator new(size_t, void * p) { return p; }
+      static void operator delete(void * p)
+      {
+         char * pSlot = static_cast<char *>(p) - prefix();
+         Block * pBlock = *reinterpret_cast<Block **>(pSlot);
+         if (pBlock == nullptr)
+            rawFree(pSlot);
+         else if (--pBlock->numLive == 0)
+            rawFree(pBlock);
+      }
+      static void operator delete(void *, void *) {}
 
+      // room for num nodes after one Block
+      static Block * allocateBlock(size_t num)
+      {
+         Block * pBlock = static_cast<Block *>(rawAllocate(header() + num * stride()));
+         pBlock->numLive = 0;
+         return pBlock;
+      }
+      static void freeBlock(Block * pBlock) { rawFree(pBlock); }
+
+      // construct the i-th node of a block
+      template <class U>
+      static Node * construct(Block * pBlock, size_t i, U && data)
+      {
+         char * pSlot = reinterpret_cast<char *>(pBlock) + header() + i * stride();
+         *reinterpret_cast<Block **>(pSlot) = pBlock;
+         Node * pNode = new (pSlot + prefix()) Node(std::forward<U>(data));
+         pBlock->numLive++;
+         return pNode;
+      }
+
+      // the bytes one node takes, its slot included
+      static constexpr size_t stride() { return prefix() + sizeof(Node); }
+
+      // the Block a node was carved from, or nullptr
+      static Block * blockOf(const Node * p)
+      {
+         return *reinterpret_cast<Block * const *>(reinterpret_cast<const char *>(p) - prefix());
+      }
+
+   private:
+      static constexpr size_t roundUp(size_t n)
+      {
+         return (n + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+      }
+      static constexpr size_t prefix() { return roundUp(sizeof(Block *)); }
+      static constexpr size_t header() { return roundUp(sizeof(Block));   }
+      static void * rawAllocate(size_t size)
+      {
+         if constexpr (alignof(Node) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return ::operator new(size, std::align_val_t(alignof(Node)));
+         else
+            return ::operator new(size);
+      }
+      static void rawFree(void * p)
+      {
+         if constexpr (alignof(Node) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(p, std::align_val_t(alignof(Node)));
+         else
+            ::operator delete(p);
+      }
+
+   public:
       //
       // Data
       //
@@ -173,6 +305,12 @@ namespace custom
       template <typename TT>
       friend class custom::list;
    public:
+      typedef std::bidirectional_iterator_tag iterator_category;
+      typedef T                               value_type;
+      typedef std::ptrdiff_t                  difference_type;
+      typedef T*                              pointer;
+      typedef T&                              reference;
+
       // constructors, destructors, and assignment operator
       iterator() : p(nullptr)
       {
@@ -284,11 +422,11 @@ namespace custom
     * Create a list initialized to a set of values
     ****************************************/
    template <typename T>
-   template <class Iterator>
+   template <class Iterator, class>
    list <T> ::list(Iterator first, Iterator last)
+      : numElements(0), pHead(nullptr), pTail(nullptr)
    {
-      for (auto it = first; it != last; ++it)
-         push_back(*it); 
+      insert(end(), first, last);
    }
 
    /*****************************************
@@ -410,8 +548,7 @@ namespace custom
 
       if (itRHS != rhs.end())
       {
-         for (; itRHS != rhs.end(); ++itRHS)
-            push_back(*itRHS);
+         insert(end(), itRHS, rhs.end());
       }
 
       else if (rhs.empty())
@@ -459,8 +596,7 @@ namespace custom
 
       if (itRHS != rhs.end())
       {
-         for (; itRHS != rhs.end(); ++itRHS)
-            push_back(*itRHS);
+         insert(end(), itRHS, rhs.end());
       }
 
       else if (rhs.size() == 0)
@@ -519,9 +655,11 @@ namespace custom
    template <typename T>
    void list <T> ::push_back(const T& data)
    {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_PUSH_BACK);
 
       // Create a new node with the provided data
       Node* newNode = new Node(data);
+      CUSTOM_INSTRUMENT_ALLOC();
 
       newNode->pPrev = pTail;
 
@@ -544,8 +682,11 @@ namespace custom
    template <typename T>
    void list <T> ::push_back(T&& data)
    {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_PUSH_BACK);
+
       // Create a new node with the provided data
       Node* newNode = new Node(data);
+      CUSTOM_INSTRUMENT_ALLOC();
 
       newNode->pPrev = pTail;
 
@@ -575,8 +716,11 @@ namespace custom
    template <typename T>
    void list <T> ::push_front(const T& data)
    {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_PUSH_FRONT);
+
       // Create a new node with the provided data
       Node* pNew = new Node(data);
+      CUSTOM_INSTRUMENT_ALLOC();
 
       // If the list is empty, set the new node as both head and tail
       if (pHead == NULL) {
@@ -594,8 +738,11 @@ namespace custom
    template <typename T>
    void list <T> ::push_front(T&& data)
    {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_PUSH_FRONT);
+
       // Create a new node with the provided data
       Node* pNew = new Node(data);
+      CUSTOM_INSTRUMENT_ALLOC();
 
       // If the list is empty, set the new node as both head and tail
       if (pHead == NULL) {
@@ -621,6 +768,7 @@ namespace custom
    template <typename T>
    void list <T> ::pop_back()
    {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_POP_BACK);
       if (pTail == nullptr) {
          return;
       }
@@ -648,6 +796,7 @@ namespace custom
    template <typename T>
    void list <T> ::pop_front()
    {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_POP_FRONT);
       if (pHead == nullptr) {
          return;
       }
@@ -719,6 +868,7 @@ namespace custom
    template <typename T>
    typename list <T> ::iterator  list <T> ::erase(const list <T> ::iterator& it)
    {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_ERASE);
       assert(numElements >= 0); 
       list <T> ::iterator itNext = end(); 
 
@@ -762,9 +912,11 @@ namespace custom
    typename list <T> ::iterator list <T> ::insert(list <T> ::iterator it,
       const T& data)
    {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_INSERT);
       if (empty())
       {
          pHead = pTail = new list <T> ::Node(data); 
+         CUSTOM_INSTRUMENT_ALLOC();
          numElements = 1; 
          return begin(); 
       }
@@ -772,6 +924,7 @@ namespace custom
       try
       {
          list <T> ::Node* pNew = new list <T> ::Node(data); 
+         CUSTOM_INSTRUMENT_ALLOC();
 
          if (it == end())
          {
@@ -810,9 +963,11 @@ namespace custom
    typename list <T> ::iterator list <T> ::insert(list <T> ::iterator it,
       T&& data)
    {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_INSERT);
       if (empty())
       {
          pHead = pTail = new list <T> ::Node(std::move(data));
+         CUSTOM_INSTRUMENT_ALLOC();
          numElements = 1;
          return begin();
       }
@@ -820,6 +975,7 @@ namespace custom
       try
       {
          list <T> ::Node* pNew = new list <T> ::Node(std::move(data));
+         CUSTOM_INSTRUMENT_ALLOC();
 
          if (it == end())
          {
@@ -854,6 +1010,352 @@ namespace custom
       return it;
    }
 
+   /******************************************
+    * LIST :: COPY CHAIN
+    * copy first..last into a new chain of nodes which is
+    * not yet part of any list. A range which can be walked
+    * twice is counted first so all its nodes come from one
+    * Block: one allocation instead of one per element. If
+    * a copy throws, the nodes made so far are freed and the
+    * exception passes on.
+    *     INPUT  : the range to copy
+    *     OUTPUT : the first node, the last node, and the count
+    *     COST   : O(n), one pass, or two for a block
+    ******************************************/
+   template <typename T>
+   template <class Iterator>
+   typename list <T> ::Node* list <T> ::copyChain(Iterator first, Iterator last,
+                                                  Node*& pLast, size_t& num)
+   {
+      Node* pFirst = nullptr;
+      pLast = nullptr;
+      num = 0;
+
+      size_t numBlock = 0;
+      if constexpr (is_multipass<Iterator>::value)
+         for (Iterator it = first; it != last; ++it)
+            numBlock++;
+      Block* pBlock = nullptr;
+      if (numBlock > 1)
+      {
+         pBlock = Node::allocateBlock(numBlock);
+         CUSTOM_INSTRUMENT_ALLOC();
+      }
+
+      try
+      {
+         for (; first != last; ++first)
+         {
+            Node* pNew;
+            if (pBlock && num < numBlock)
+               pNew = Node::construct(pBlock, num, *first);
+            else
+            {
+               pNew = new Node(*first);
+               CUSTOM_INSTRUMENT_ALLOC();
+            }
+            pNew->pPrev = pLast;
+            if (pLast)
+               pLast->pNext = pNew;
+            else
+               pFirst = pNew;
+            pLast = pNew;
+            num++;
+         }
+      }
+      catch (...)
+      {
+         // the block goes with its last node, unless it never had one
+         if (pBlock && num == 0)
+            Node::freeBlock(pBlock);
+         while (pFirst)
+         {
+            Node* pNext = pFirst->pNext;
+            delete pFirst;
+            pFirst = pNext;
+         }
+         throw;
+      }
+      return pFirst;
+   }
+
+   /******************************************
+    * LIST :: INSERT RANGE
+    * copy first..last in front of it. The copies are made
+    * off to the side and then linked in all at once, so
+    * the list is untouched if a copy throws.
+    *     INPUT  : where to insert, the range to copy
+    *     OUTPUT : the first element inserted, or it if none
+    *     COST   : O(range)
+    ******************************************/
+   template <typename T>
+   template <class Iterator>
+   typename list <T> ::iterator list <T> ::insert(iterator it, Iterator first, Iterator last)
+   {
+      CUSTOM_INSTRUMENT_SCOPE(LIST_INSERT);
+      Node* pLast = nullptr;
+      size_t num = 0;
+      Node* pFirst = copyChain(first, last, pLast, num);
+      if (pFirst == nullptr)
+         return it;
+      link(it.p, pFirst, pLast);
+      numElements += num;
+      return iterator(pFirst);
+   }
+
+   /******************************************
+    * LIST :: UNLINK
+    * detach the chain pFirst..pLast from this list. The
+    * nodes keep their links to each other.
+    *     INPUT  : the first and last nodes of the chain
+    *     COST   : O(1)
+    ******************************************/
+   template <typename T>
+   void list <T> ::unlink(Node* pFirst, Node* pLast)
+   {
+      assert(pFirst && pLast);
+      if (pFirst->pPrev)
+         pFirst->pPrev->pNext = pLast->pNext;
+      else
+         pHead = pLast->pNext;
+      if (pLast->pNext)
+         pLast->pNext->pPrev = pFirst->pPrev;
+      else
+         pTail = pFirst->pPrev;
+      pFirst->pPrev = nullptr;
+      pLast->pNext = nullptr;
+   }
+
+   /******************************************
+    * LIST :: LINK
+    * hook the chain pFirst..pLast in front of pPos,
+    * or onto the end when pPos is nullptr
+    *     INPUT  : the node to go before, the chain
+    *     COST   : O(1)
+    ******************************************/
+   template <typename T>
+   void list <T> ::link(Node* pPos, Node* pFirst, Node* pLast)
+   {
+      assert(pFirst && pLast);
+      Node* pBefore = pPos ? pPos->pPrev : pTail;
+      pFirst->pPrev = pBefore;
+      pLast->pNext = pPos;
+      if (pBefore)
+         pBefore->pNext = pFirst;
+      else
+         pHead = pFirst;
+      if (pPos)
+         pPos->pPrev = pLast;
+      else
+         pTail = pLast;
+   }
+
+   /******************************************
+    * LIST :: SPLICE
+    * move nodes out of rhs and in front of it. Nothing
+    * is allocated, copied, or destroyed.
+    *     INPUT  : where they go, where they come from
+    *     COST   : O(1) for a whole list, one node, or a range
+    *              whose size is given; O(range) otherwise
+    ******************************************/
+   template <typename T>
+   void list <T> ::splice(iterator it, list <T>& rhs)
+   {
+      if (&rhs == this || rhs.empty())
+         return;
+      link(it.p, rhs.pHead, rhs.pTail);
+      numElements += rhs.numElements;
+      rhs.pHead = rhs.pTail = nullptr;
+      rhs.numElements = 0;
+   }
+
+   template <typename T>
+   void list <T> ::splice(iterator it, list <T>& rhs, iterator itRHS)
+   {
+      Node* p = itRHS.p;
+      if (p == nullptr || p == it.p)
+         return;
+      rhs.unlink(p, p);
+      rhs.numElements--;
+      link(it.p, p, p);
+      numElements++;
+   }
+
+   template <typename T>
+   void list <T> ::splice(iterator it, list <T>& rhs, iterator first, iterator last)
+   {
+      size_t num = 0;
+      if (&rhs != this)
+         for (iterator itCount = first; itCount != last; ++itCount)
+            num++;
+      splice(it, rhs, first, last, num);
+   }
+
+   template <typename T>
+   void list <T> ::splice(iterator it, list <T>& rhs, iterator first, iterator last,
+                          size_t num)
+   {
+      if (first == last)
+         return;
+      Node* pFirst = first.p;
+      Node* pLast = last.p ? last.p->pPrev : rhs.pTail;
+      rhs.unlink(pFirst, pLast);
+      rhs.numElements -= num;
+      link(it.p, pFirst, pLast);
+      numElements += num;
+   }
+
+   /******************************************
+    * LIST :: MERGE RUNS
+    * merge two sorted chains linked only through pNext.
+    * Ties go to pLeft so the merge is stable.
+    *     INPUT  : two sorted chains, the ordering
+    *     OUTPUT : the merged chain
+    *     COST   : O(n) and no allocation
+    ******************************************/
+   template <typename T>
+   template <class Compare>
+   typename list <T> ::Node* list <T> ::mergeRuns(Node* pLeft, Node* pRight,
+                                                  Compare isLess)
+   {
+      Node* pFirst = nullptr;
+      Node** ppNext = &pFirst;
+      while (pLeft && pRight)
+      {
+         if (isLess(pRight->data, pLeft->data))
+         {
+            *ppNext = pRight;
+            pRight = pRight->pNext;
+         }
+         else
+         {
+            *ppNext = pLeft;
+            pLeft = pLeft->pNext;
+         }
+         ppNext = &(*ppNext)->pNext;
+      }
+      *ppNext = pLeft ? pLeft : pRight;
+      return pFirst;
+   }
+
+   /******************************************
+    * LIST :: RELINK PREVIOUS
+    * after the pNext links were rewritten starting from
+    * pHead, rebuild every pPrev and find pTail
+    *     COST   : O(n)
+    ******************************************/
+   template <typename T>
+   void list <T> ::relinkPrevious()
+   {
+      Node* pPrevious = nullptr;
+      for (Node* p = pHead; p; p = p->pNext)
+      {
+         p->pPrev = pPrevious;
+         pPrevious = p;
+      }
+      pTail = pPrevious;
+   }
+
+   /******************************************
+    * LIST :: MERGE
+    * move every node of the sorted rhs into this sorted list
+    *     INPUT  : a sorted list, the ordering
+    *     COST   : O(n + m) and no allocation
+    ******************************************/
+   template <typename T>
+   template <class Compare>
+   void list <T> ::merge(list <T>& rhs, Compare isLess)
+   {
+      if (&rhs == this || rhs.empty())
+         return;
+      pHead = mergeRuns(pHead, rhs.pHead, isLess);
+      relinkPrevious();
+      numElements += rhs.numElements;
+      rhs.pHead = rhs.pTail = nullptr;
+      rhs.numElements = 0;
+   }
+
+   /******************************************
+    * LIST :: SORT
+    * bottom-up merge sort of the nodes themselves. Run i
+    * holds 2^i sorted nodes; each new node is carried up
+    * through the runs like binary addition. Stable.
+    *     INPUT  : the ordering
+    *     COST   : O(n log n), O(1) extra space, no allocation
+    ******************************************/
+   template <typename T>
+   template <class Compare>
+   void list <T> ::sort(Compare isLess)
+   {
+      if (numElements < 2)
+         return;
+
+      Node* runs[64] = {};     // runs[i] is earlier in the list than runs[i-1]
+      Node* pNext = nullptr;
+      for (Node* p = pHead; p; p = pNext)
+      {
+         pNext = p->pNext;
+         p->pNext = nullptr;
+
+         Node* pCarry = p;
+         size_t i = 0;
+         for (; runs[i]; i++)
+         {
+            pCarry = mergeRuns(runs[i], pCarry, isLess);
+            runs[i] = nullptr;
+         }
+         runs[i] = pCarry;
+      }
+
+      Node* pSorted = nullptr;
+      for (size_t i = 0; i < 64; i++)
+         if (runs[i])
+            pSorted = pSorted ? mergeRuns(runs[i], pSorted, isLess) : runs[i];
+
+      pHead = pSorted;
+      relinkPrevious();
+   }
+
+   /******************************************
+    * LIST :: REVERSE
+    * turn the list around by swapping every node's links
+    *     COST   : O(n)
+    ******************************************/
+   template <typename T>
+   void list <T> ::reverse()
+   {
+      for (Node* p = pHead; p; p = p->pPrev)
+         std::swap(p->pNext, p->pPrev);
+      std::swap(pHead, pTail);
+   }
+
+   /******************************************
+    * LIST :: UNIQUE
+    * remove every element equal to the one before it
+    *     OUTPUT : the number of elements removed
+    *     COST   : O(n)
+    ******************************************/
+   template <typename T>
+   size_t list <T> ::unique()
+   {
+      size_t numRemoved = 0;
+      if (pHead == nullptr)
+         return numRemoved;
+      Node* pNext = nullptr;
+      for (Node* p = pHead->pNext; p; p = pNext)
+      {
+         pNext = p->pNext;
+         if (p->data == p->pPrev->data)
+         {
+            unlink(p, p);
+            delete p;
+            numRemoved++;
+         }
+      }
+      numElements -= numRemoved;
+      return numRemoved;
+   }
+
    /**********************************************
     * LIST :: assignment operator - MOVE
     * Copy one list onto another
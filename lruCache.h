@@ -0,0 +1,337 @@
+/***********************************************************************
+ * Header:
+ *    LRU CACHE
+ * Summary:
+ *    A cache which, when full, forgets whatever was used least
+ *    recently. It is the usual pairing of a list in recency order
+ *    with a hash index into that list:
+ *
+ *        index:   key --> entry
+ *        recent:  [most recent] <--> ... <--> [least recent]
+ *
+ *    Both are intrusive: each entry carries its own list_hook and
+ *    set_hook, so get() and put() are O(1) and never search the list.
+ *    An entry which is evicted or erased is not freed but kept for
+ *    the next put(), so once the cache has filled it no longer
+ *    allocates.
+ *
+ *    The capacity is a number of entries, or, given a weigher, a
+ *    total weight such as bytes.
+ *
+ *    This will contain the class definition of:
+ *        lru_cache              : A least recently used cache
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "intrusive.h"  // for intrusive_list and intrusive_unordered_set
+#include <cassert>      // because I am paranoid
+#include <functional>   // for std::function, std::hash and std::equal_to
+#include <new>          // for placement new
+#include <utility>      // for std::move and std::forward
+
+class TestLruCache;     // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * LRU CACHE
+ * get() and put() make a key the most recent; a put()
+ * which would go over the capacity first evicts from
+ * the least recent end.
+ **************************************************/
+template <typename K, typename V,
+          typename H = std::hash<K>, typename E = std::equal_to<K>>
+class lru_cache
+{
+   friend class ::TestLruCache; // give unit tests access to the privates
+public:
+   typedef std::function<size_t(const K &, const V &)> weigher;   // the cost of an entry
+   typedef std::function<void(const K &, V &)>         evictor;   // told of each eviction
+
+   //
+   // Construct
+   //
+
+   lru_cache(size_t capacity, const weigher & weigh = weigher());
+  ~lru_cache();
+
+   //
+   // Access
+   //
+
+   V * get(const K & key);
+   V * peek(const K & key);
+   bool contains(const K & key) { return peek(key) != nullptr; }
+
+   //
+   // Insert
+   //
+
+   void put(const K & key, const V & value) { emplace(key, value);            }
+   void put(const K & key, V && value)      { emplace(key, std::move(value)); }
+   void on_evict(const evictor & callback)  { this->callback = callback;      }
+
+   //
+   // Remove
+   //
+
+   bool erase(const K & key);
+   void clear();
+
+   //
+   // Status
+   //
+
+   size_t size()     const { return recent.size();  }
+   bool   empty()    const { return recent.empty(); }
+   size_t capacity() const { return maxWeight;      }
+   size_t weight()   const { return numWeight;      }
+
+private:
+   lru_cache(const lru_cache &) = delete;
+   lru_cache & operator = (const lru_cache &) = delete;
+
+   /*************************************************
+    * ENTRY
+    * One key and its value, linked into both the list
+    * and the index. The key and value are constructed
+    * when the entry is used and destroyed when it is
+    * evicted, so a spare entry holds neither.
+    *************************************************/
+   struct Entry
+   {
+      K & key()   { return *reinterpret_cast<K *>(keyStorage);   }
+      V & value() { return *reinterpret_cast<V *>(valueStorage); }
+      const K & key() const { return *reinterpret_cast<const K *>(keyStorage); }
+
+      list_hook byUse;      // in recent, or in spares
+      set_hook  byKey;      // in index while in recent
+      size_t    cost;       // what weigh() said when it was put
+      alignas(K) unsigned char keyStorage[sizeof(K)];
+      alignas(V) unsigned char valueStorage[sizeof(V)];
+   };
+
+   // hash and compare entries by their keys
+   struct EntryHash
+   {
+      EntryHash(const H & hash = H()) : hash(hash) {}
+      size_t operator()(const K & key)   const { return hash(key);     }
+      size_t operator()(const Entry & e) const { return hash(e.key()); }
+      H hash;
+   };
+   struct EntryEqual
+   {
+      EntryEqual(const E & equal = E()) : equal(equal) {}
+      bool operator()(const Entry & e, const K & key)     const { return equal(e.key(), key);     }
+      bool operator()(const Entry & e, const Entry & rhs) const { return equal(e.key(), rhs.key()); }
+      E equal;
+   };
+
+   template <typename U>
+   void emplace(const K & key, U && value);
+   void evict();
+   void release(Entry & e);
+
+   intrusive_list<Entry, &Entry::byUse> recent;   // most recent at the front
+   intrusive_list<Entry, &Entry::byUse> spares;   // emptied entries to reuse
+   intrusive_unordered_set<Entry, &Entry::byKey, EntryHash, EntryEqual> index;
+   size_t maxWeight;       // the capacity
+   size_t numWeight;       // the total cost of the entries in recent
+   weigher weigh;          // when empty, every entry costs 1
+   evictor callback;       // may be empty
+};
+
+/*****************************************
+ * LRU CACHE :: CONSTRUCTOR
+ * The index starts small and doubles as entries arrive,
+ * so a large capacity costs nothing until it is used
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+lru_cache <K, V, H, E> ::lru_cache(size_t capacity, const weigher & weigh)
+   : index(8),
+     maxWeight(capacity), numWeight(0), weigh(weigh)
+{
+}
+
+/*****************************************
+ * LRU CACHE :: DESTRUCTOR
+ * Nobody is told about entries destroyed with the cache
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+lru_cache <K, V, H, E> ::~lru_cache()
+{
+   clear();
+   while (!spares.empty())
+   {
+      Entry & e = spares.front();
+      spares.pop_front();
+      delete &e;
+   }
+}
+
+/*****************************************
+ * LRU CACHE :: GET
+ * Find a value and make it the most recent
+ *    OUTPUT : the value, or nullptr if it is not cached
+ *    COST   : O(1) expected
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+V * lru_cache <K, V, H, E> ::get(const K & key)
+{
+   auto it = index.find(key);
+   if (it == index.end())
+      return nullptr;
+
+   Entry & e = *it;
+   if (&recent.front() != &e)
+   {
+      recent.erase(e);
+      recent.push_front(e);
+   }
+   return &e.value();
+}
+
+/*****************************************
+ * LRU CACHE :: PEEK
+ * Find a value without changing the order
+ *    OUTPUT : the value, or nullptr if it is not cached
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+V * lru_cache <K, V, H, E> ::peek(const K & key)
+{
+   auto it = index.find(key);
+   return it == index.end() ? nullptr : &it->value();
+}
+
+/*****************************************
+ * LRU CACHE :: EMPLACE
+ * Replace the value of a cached key, or make room and
+ * cache a new one. Either way it becomes the most recent.
+ * An entry which costs more than the capacity empties the
+ * cache and is then kept by itself.
+ *    COST   : O(1) expected, plus O(1) per eviction
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+template <typename U>
+void lru_cache <K, V, H, E> ::emplace(const K & key, U && value)
+{
+   size_t cost = weigh ? weigh(key, value) : 1;
+
+   // already here: replace the value in place
+   auto it = index.find(key);
+   if (it != index.end())
+   {
+      Entry & e = *it;
+      recent.erase(e);
+      numWeight -= e.cost;
+      while (!recent.empty() && numWeight + cost > maxWeight)
+         evict();
+      e.value() = std::forward<U>(value);
+      e.cost = cost;
+      numWeight += cost;
+      recent.push_front(e);
+      return;
+   }
+
+   // make room; what is evicted goes to spares for us to reuse
+   while (!recent.empty() && numWeight + cost > maxWeight)
+      evict();
+
+   Entry * p;
+   if (spares.empty())
+      p = new Entry;
+   else
+   {
+      p = &spares.front();
+      spares.pop_front();
+   }
+   // if the value, the key or the index throws, the entry goes
+   // back to spares holding neither key nor value
+   bool hasValue = false;
+   bool hasKey = false;
+   try
+   {
+      new (p->valueStorage) V(std::forward<U>(value));
+      hasValue = true;
+      new (p->keyStorage) K(key);
+      hasKey = true;
+      index.insert(*p);
+   }
+   catch (...)
+   {
+      if (hasKey)
+         p->key().~K();
+      if (hasValue)
+         p->value().~V();
+      spares.push_front(*p);
+      throw;
+   }
+   p->cost = cost;
+   numWeight += cost;
+   recent.push_front(*p);
+}
+
+/*****************************************
+ * LRU CACHE :: EVICT
+ * Tell the callback about the least recent entry, then
+ * let it go
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+void lru_cache <K, V, H, E> ::evict()
+{
+   assert(!recent.empty());
+   Entry & e = recent.back();
+   if (callback)
+      callback(e.key(), e.value());
+   release(e);
+}
+
+/*****************************************
+ * LRU CACHE :: RELEASE
+ * Unlink an entry, destroy its key and value, and keep
+ * the entry itself as a spare
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+void lru_cache <K, V, H, E> ::release(Entry & e)
+{
+   index.erase(e);
+   recent.erase(e);
+   numWeight -= e.cost;
+   e.key().~K();
+   e.value().~V();
+   spares.push_front(e);
+}
+
+/*****************************************
+ * LRU CACHE :: ERASE
+ * Forget a key without telling the callback
+ *    OUTPUT : whether it was cached
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+bool lru_cache <K, V, H, E> ::erase(const K & key)
+{
+   auto it = index.find(key);
+   if (it == index.end())
+      return false;
+   release(*it);
+   return true;
+}
+
+/*****************************************
+ * LRU CACHE :: CLEAR
+ * Forget everything without telling the callback. The
+ * entries are kept as spares.
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+void lru_cache <K, V, H, E> ::clear()
+{
+   while (!recent.empty())
+      release(recent.front());
+   assert(numWeight == 0);
+}
+
+} // namespace custom
@@ -0,0 +1,370 @@
+/***********************************************************************
+ * Header:
+ *    MAPPED SET
+ * Summary:
+ *    A frozen hash set in a file, queried where it lies. write()
+ *    builds the file once; open() maps it read-only and checks the
+ *    header, and from then on contains() and find() read straight
+ *    from the mapping. Nothing is read in or rebuilt, and every
+ *    process which maps the file shares the same pages.
+ *
+ *    Everything in the file is found by its offset from the start
+ *    of the file, never by a pointer, so the file means the same
+ *    thing wherever it is mapped:
+ *
+ *        0       header    magic, version, counts, seed, offsets
+ *        128     tags      one byte a slot: 0 empty, else 0x80 | 7 bits
+ *        64 * k  slots     one key (or heap reference) a slot
+ *        ...     heap      the characters of string keys, if any
+ *
+ *    The slots are open addressed with linear probing and at most
+ *    three quarters full. A lookup reads tags until the first empty
+ *    one and compares a key only where the tag matches.
+ *
+ *    Keys are trivially copyable types, stored as they are, or
+ *    std::string, stored in the heap and looked up by string_view.
+ *    The hash is custom::hash with the file's seed folded in, which
+ *    is the same in every process. The file is in the byte order of
+ *    the machine which wrote it.
+ *
+ *    This will contain the class definitions of:
+ *        mapped_key             : How a key is stored in the file
+ *        mapped_set             : A read-only hash set in a mapped file
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "hashFunction.h" // for custom::hash, hash_bytes and mix64
+#include "mappedVector.h" // for mapped_file
+#include <cstdint>        // for uint64_t
+#include <cstring>        // for std::memcpy and std::memcmp
+#include <string>         // for std::string
+#include <string_view>    // for looking up a string without a copy
+#include <type_traits>    // for std::is_trivially_copyable
+#include <utility>        // for std::move
+#include <vector>         // for building the file
+
+class TestMappedSet;      // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************
+ * MAPPED KEY
+ * A trivially copyable key is its own slot. find()
+ * hands back a pointer into the mapping.
+ ****************************************/
+template <typename T>
+struct mapped_key
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "mapped_set requires a trivially copyable key or std::string");
+
+   typedef T stored;
+   typedef T lookup;
+   typedef const T * result;
+
+   static uint64_t hash(const T & t, uint64_t seed)
+   {
+      return mix64((uint64_t)custom::hash<T>()(t) ^ seed);
+   }
+   static size_t heap_size(const T &) { return 0; }
+   static stored store(const T & t, char * /* pHeap */, size_t & /* numUsed */) { return t; }
+   static bool equal(const stored & s, const T & t, const char * /* pHeap */, size_t /* sizeHeap */)
+   {
+      return s == t;
+   }
+   static result get(const stored * pSlot, const char * /* pHeap */) { return pSlot; }
+   static result none() { return nullptr; }
+};
+
+/*****************************************
+ * MAPPED KEY : STRING
+ * The slot says where in the heap the characters are.
+ * find() hands back a view of them.
+ ****************************************/
+template <>
+struct mapped_key <std::string>
+{
+   struct stored
+   {
+      uint64_t offset;   // from the start of the heap
+      uint64_t length;
+   };
+   typedef std::string_view lookup;
+   typedef std::string_view result;
+
+   static uint64_t hash(std::string_view s, uint64_t seed)
+   {
+      return hash_bytes(s.data(), s.size(), seed);
+   }
+   static size_t heap_size(std::string_view s) { return s.size(); }
+   static stored store(std::string_view s, char * pHeap, size_t & numUsed)
+   {
+      stored slot = { (uint64_t)numUsed, (uint64_t)s.size() };
+      if (s.size())
+         std::memcpy(pHeap + numUsed, s.data(), s.size());
+      numUsed += s.size();
+      return slot;
+   }
+   // a slot pointing outside the heap matches nothing
+   static bool equal(const stored & slot, std::string_view s, const char * pHeap, size_t sizeHeap)
+   {
+      return slot.length == s.size() &&
+             slot.offset <= sizeHeap && slot.length <= sizeHeap - slot.offset &&
+             (s.empty() || std::memcmp(pHeap + slot.offset, s.data(), s.size()) == 0);
+   }
+   static result get(const stored * pSlot, const char * pHeap)
+   {
+      return std::string_view(pHeap + pSlot->offset, (size_t)pSlot->length);
+   }
+   static result none() { return std::string_view(); }
+};
+
+/************************************************
+ * MAPPED SET
+ * Read-only. Build the file with write(), then map
+ * it with open() as often as you like.
+ ************************************************/
+template <typename T>
+class mapped_set
+{
+   friend class ::TestMappedSet;   // give unit tests access to the privates
+   typedef mapped_key<T> Key;
+   typedef typename Key::stored Slot;
+public:
+   typedef typename Key::lookup lookup;
+   typedef typename Key::result result;
+
+   //
+   // Construct
+   //
+   mapped_set() : pHeader(nullptr), pTags(nullptr), pSlots(nullptr), pHeap(nullptr) {}
+   explicit mapped_set(const char * fileName) : mapped_set()
+   {
+      map(fileName);
+   }
+   mapped_set(mapped_set && rhs) noexcept : mapped_set()
+   {
+      *this = std::move(rhs);
+   }
+   mapped_set & operator = (mapped_set && rhs) noexcept
+   {
+      if (this != &rhs)
+      {
+         file = std::move(rhs.file);
+         pHeader = rhs.pHeader;
+         pTags   = rhs.pTags;
+         pSlots  = rhs.pSlots;
+         pHeap   = rhs.pHeap;
+         rhs.pHeader = nullptr;
+         rhs.pTags   = nullptr;
+         rhs.pSlots  = nullptr;
+         rhs.pHeap   = nullptr;
+      }
+      return *this;
+   }
+   static mapped_set open(const char * fileName)
+   {
+      return mapped_set(fileName);
+   }
+   template <class Iterator>
+   static void write(const char * fileName, Iterator first, Iterator last, uint64_t seed = 0);
+
+   //
+   // Access
+   //
+   bool contains(const lookup & t) const { return slot_of(t) != nullptr; }
+   result find(const lookup & t) const
+   {
+      const Slot * pSlot = slot_of(t);
+      return pSlot ? Key::get(pSlot, pHeap) : Key::none();
+   }
+
+   //
+   // Status
+   //
+   size_t size()       const { return pHeader ? (size_t)pHeader->numElements : 0; }
+   bool   empty()      const { return size() == 0;                                }
+   size_t slot_count() const { return pHeader ? (size_t)pHeader->numSlots : 0;    }
+   bool   is_open()    const { return pHeader != nullptr;                         }
+
+private:
+   /*************************************************
+    * HEADER
+    * The front of the file, padded to a cache line
+    *************************************************/
+   struct Header
+   {
+      uint32_t magic;          // MAGIC
+      uint32_t version;        // VERSION
+      uint32_t sizeSlot;       // sizeof(Slot)
+      uint32_t reserved;
+      uint64_t numSlots;       // a power of two
+      uint64_t numElements;
+      uint64_t seed;           // folded into every hash
+      uint64_t offsetTags;     // each offset is from the start of the file
+      uint64_t offsetSlots;
+      uint64_t offsetHeap;
+      uint64_t sizeHeap;
+   };
+   static const uint32_t MAGIC = 0x5453534d;   // "MSST"
+   static const uint32_t VERSION = 1;
+   static const size_t ALIGN = 64;             // every section starts a cache line
+
+   static size_t roundUp(size_t n) { return (n + ALIGN - 1) / ALIGN * ALIGN; }
+   static uint8_t tag_of(uint64_t hash) { return (uint8_t)(0x80 | (hash >> 57)); }
+
+   void map(const char * fileName);
+   const Slot * slot_of(const lookup & t) const;
+
+   mapped_file file;             // the mapping, read-only
+   const Header * pHeader;       // these all point into the mapping
+   const uint8_t * pTags;
+   const Slot * pSlots;
+   const char * pHeap;
+};
+
+/*****************************************
+ * MAPPED SET :: MAP
+ * Map the file and check that every section the header
+ * describes is really there before trusting any of it
+ ****************************************/
+template <typename T>
+void mapped_set <T> ::map(const char * fileName)
+{
+   file.open(fileName, true /*readOnly*/);
+   const char * pBase = static_cast<const char *>(file.data());
+   size_t numBytes = file.size();
+
+   const char * error = nullptr;
+   const Header * p = reinterpret_cast<const Header *>(pBase);
+   if (numBytes < sizeof(Header))
+      error = "ERROR: the mapped set is truncated";
+   else if (p->magic != MAGIC || p->version != VERSION)
+      error = "ERROR: this is not a mapped set";
+   else if (p->sizeSlot != sizeof(Slot))
+      error = "ERROR: the mapped set holds a different type";
+   else if (p->numSlots == 0 || (p->numSlots & (p->numSlots - 1)) != 0 ||
+            p->numElements >= p->numSlots)
+      error = "ERROR: the mapped set is corrupt";
+   else if (p->offsetTags % ALIGN || p->offsetSlots % ALIGN ||
+            p->offsetTags > numBytes || numBytes - p->offsetTags < p->numSlots ||
+            p->offsetSlots > numBytes ||
+            (numBytes - p->offsetSlots) / sizeof(Slot) < p->numSlots ||
+            p->offsetHeap > numBytes || numBytes - p->offsetHeap < p->sizeHeap)
+      error = "ERROR: the mapped set is truncated";
+
+   if (error)
+   {
+      file.close();
+      throw error;
+   }
+
+   pHeader = p;
+   pTags   = reinterpret_cast<const uint8_t *>(pBase + p->offsetTags);
+   pSlots  = reinterpret_cast<const Slot *>(pBase + p->offsetSlots);
+   pHeap   = pBase + p->offsetHeap;
+}
+
+/*****************************************
+ * MAPPED SET :: SLOT OF
+ * Probe from t's home slot to the first empty one. The
+ * header promises an empty slot, but a corrupt file
+ * cannot make us go round forever.
+ *    OUTPUT : t's slot in the mapping, or nullptr
+ ****************************************/
+template <typename T>
+const typename mapped_set <T> ::Slot * mapped_set <T> ::slot_of(const lookup & t) const
+{
+   if (pHeader == nullptr)
+      return nullptr;
+
+   uint64_t hash = Key::hash(t, pHeader->seed);
+   uint8_t tag = tag_of(hash);
+   size_t mask = (size_t)pHeader->numSlots - 1;
+   size_t sizeHeap = (size_t)pHeader->sizeHeap;
+   for (size_t i = (size_t)hash & mask, n = 0; n <= mask; i = (i + 1) & mask, n++)
+   {
+      if (pTags[i] == 0)
+         return nullptr;
+      if (pTags[i] == tag && Key::equal(pSlots[i], t, pHeap, sizeHeap))
+         return pSlots + i;
+   }
+   return nullptr;
+}
+
+/*****************************************
+ * MAPPED SET :: WRITE
+ * Build a file holding every distinct key in the range.
+ * The slots are laid out in memory first, then the file
+ * is sized once and filled through a writable mapping.
+ ****************************************/
+template <typename T>
+template <class Iterator>
+void mapped_set <T> ::write(const char * fileName, Iterator first, Iterator last, uint64_t seed)
+{
+   // no more than three quarters full, so probes stay short
+   std::vector<lookup> keys;
+   size_t sizeHeap = 0;
+   for (Iterator it = first; it != last; ++it)
+   {
+      keys.push_back(lookup(*it));
+      sizeHeap += Key::heap_size(keys.back());
+   }
+   size_t numSlots = 8;
+   while (numSlots * 3 < keys.size() * 4 + 4)
+      numSlots *= 2;
+
+   std::vector<uint8_t> tags(numSlots, 0);
+   std::vector<Slot> slots(numSlots);
+   std::vector<char> heap(sizeHeap);
+   size_t numUsed = 0;
+   size_t numElements = 0;
+   size_t mask = numSlots - 1;
+   for (const lookup & key : keys)
+   {
+      uint64_t hash = Key::hash(key, seed);
+      uint8_t tag = tag_of(hash);
+      size_t i = (size_t)hash & mask;
+      bool duplicate = false;
+      for (; tags[i]; i = (i + 1) & mask)
+         if (tags[i] == tag && Key::equal(slots[i], key, heap.data(), numUsed))
+         {
+            duplicate = true;
+            break;
+         }
+      if (duplicate)
+         continue;
+      tags[i] = tag;
+      slots[i] = Key::store(key, heap.data(), numUsed);
+      numElements++;
+   }
+
+   Header header = {};
+   header.magic       = MAGIC;
+   header.version     = VERSION;
+   header.sizeSlot    = sizeof(Slot);
+   header.numSlots    = numSlots;
+   header.numElements = numElements;
+   header.seed        = seed;
+   header.offsetTags  = roundUp(sizeof(Header));
+   header.offsetSlots = roundUp(header.offsetTags + numSlots);
+   header.offsetHeap  = header.offsetSlots + numSlots * sizeof(Slot);
+   header.sizeHeap    = numUsed;
+
+   mapped_file out(fileName);
+   out.resize((size_t)(header.offsetHeap + header.sizeHeap));
+   char * pBase = static_cast<char *>(out.data());
+   std::memset(pBase, 0, out.size());
+   std::memcpy(pBase, &header, sizeof(header));
+   std::memcpy(pBase + header.offsetTags, tags.data(), numSlots);
+   std::memcpy(pBase + header.offsetSlots, (const void *)slots.data(), numSlots * sizeof(Slot));
+   if (numUsed)
+      std::memcpy(pBase + header.offsetHeap, heap.data(), numUsed);
+   out.flush();
+}
+
+} // namespace custom
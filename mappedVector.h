@@ -0,0 +1,523 @@
+/***********************************************************************
+ * Header:
+ *    MAPPED VECTOR
+ * Summary:
+ *    A vector whose buffer is a memory-mapped file. Opening a file
+ *    of fixed-size records is a constant-time map: the operating
+ *    system pages the records in the first time they are touched.
+ *
+ *    The file is nothing but the raw array of records, so any file
+ *    written element-by-element can be mapped directly.
+ *
+ *    This will contain the class definition of:
+ *        mapped_file             : A file mapped into memory
+ *        mapped_vector           : A vector stored in a mapped file
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "vector.h"      // for vector::iterator and the growth policies
+#include <cassert>       // because I am paranoid
+#include <type_traits>   // for std::is_trivially_copyable
+#include <utility>       // for std::swap
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>     // for CreateFileMapping and MapViewOfFile
+#else
+#include <fcntl.h>       // for open
+#include <sys/mman.h>    // for mmap and munmap
+#include <sys/stat.h>    // for fstat
+#include <unistd.h>      // for ftruncate and close
+#endif
+
+class TestMappedVector;  // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************
+ * MAPPED FILE
+ * A file mapped into our address space. The mapping
+ * always covers the whole file; resize() changes the
+ * length of the file and maps it again.
+ ****************************************/
+class mapped_file
+{
+   friend class ::TestMappedVector;
+public:
+   //
+   // Construct
+   //
+
+   mapped_file() : pData(nullptr), numBytes(0), readOnly(true)
+#ifdef _WIN32
+      , hFile(INVALID_HANDLE_VALUE), hMapping(NULL)
+#else
+      , fd(-1)
+#endif
+   {
+   }
+   mapped_file(const char * fileName, bool readOnly = false) : mapped_file()
+   {
+      open(fileName, readOnly);
+   }
+   mapped_file(const mapped_file & rhs) = delete;
+   mapped_file(mapped_file && rhs) noexcept : mapped_file()
+   {
+      swap(rhs);
+   }
+   mapped_file & operator = (const mapped_file & rhs) = delete;
+   mapped_file & operator = (mapped_file && rhs) noexcept
+   {
+      if (this != &rhs)
+      {
+         close();
+         swap(rhs);
+      }
+      return *this;
+   }
+  ~mapped_file()
+   {
+      close();
+   }
+   void swap(mapped_file & rhs) noexcept
+   {
+      std::swap(pData, rhs.pData);
+      std::swap(numBytes, rhs.numBytes);
+      std::swap(readOnly, rhs.readOnly);
+#ifdef _WIN32
+      std::swap(hFile, rhs.hFile);
+      std::swap(hMapping, rhs.hMapping);
+#else
+      std::swap(fd, rhs.fd);
+#endif
+   }
+
+   /*****************************************
+    * MAPPED FILE :: OPEN
+    * Open (creating when writable) and map a file
+    ****************************************/
+   void open(const char * fileName, bool readOnly = false)
+   {
+      close();
+      this->readOnly = readOnly;
+#ifdef _WIN32
+      hFile = CreateFileA(fileName,
+                          readOnly ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE,
+                          FILE_SHARE_READ | (readOnly ? FILE_SHARE_WRITE : 0),
+                          NULL,
+                          readOnly ? OPEN_EXISTING : OPEN_ALWAYS,
+                          FILE_ATTRIBUTE_NORMAL, NULL);
+      if (hFile == INVALID_HANDLE_VALUE)
+         throw "ERROR: unable to open the file to map";
+      LARGE_INTEGER size;
+      GetFileSizeEx(hFile, &size);
+      numBytes = (size_t)size.QuadPart;
+#else
+      fd = ::open(fileName, readOnly ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+      if (fd < 0)
+         throw "ERROR: unable to open the file to map";
+      struct stat status;
+      if (fstat(fd, &status) != 0)
+      {
+         close();
+         throw "ERROR: unable to open the file to map";
+      }
+      numBytes = (size_t)status.st_size;
+#endif
+      map();
+   }
+
+   /*****************************************
+    * MAPPED FILE :: CLOSE
+    * Unmap the file and let it go
+    ****************************************/
+   void close()
+   {
+      unmap();
+#ifdef _WIN32
+      if (hFile != INVALID_HANDLE_VALUE)
+         CloseHandle(hFile);
+      hFile = INVALID_HANDLE_VALUE;
+#else
+      if (fd >= 0)
+         ::close(fd);
+      fd = -1;
+#endif
+      numBytes = 0;
+   }
+
+   /*****************************************
+    * MAPPED FILE :: CLOSE
+    * Unmap the file, cut it to newBytes, and let it go.
+    * Nothing is mapped again after the cut, and nothing
+    * is thrown, so a destructor may call this
+    *    OUTPUT : false if the file could not be cut
+    ****************************************/
+   bool close(size_t newBytes) noexcept
+   {
+      unmap();
+      bool cut = true;
+      if (is_open() && !readOnly && newBytes != numBytes)
+      {
+#ifdef _WIN32
+         LARGE_INTEGER size;
+         size.QuadPart = (LONGLONG)newBytes;
+         cut = SetFilePointerEx(hFile, size, NULL, FILE_BEGIN) && SetEndOfFile(hFile);
+#else
+         cut = ftruncate(fd, (off_t)newBytes) == 0;
+#endif
+      }
+      close();
+      return cut;
+   }
+
+   /*****************************************
+    * MAPPED FILE :: RESIZE
+    * Grow or shrink the file, then map it again. Any
+    * pointer into the old mapping is now invalid. If the
+    * file cannot be resized it is mapped again as it was
+    ****************************************/
+   void resize(size_t newBytes)
+   {
+      assert(is_open());
+      if (readOnly)
+         throw "ERROR: the mapped file is read-only";
+      unmap();
+#ifdef _WIN32
+      LARGE_INTEGER size;
+      size.QuadPart = (LONGLONG)newBytes;
+      bool resized = SetFilePointerEx(hFile, size, NULL, FILE_BEGIN) && SetEndOfFile(hFile);
+#else
+      bool resized = ftruncate(fd, (off_t)newBytes) == 0;
+#endif
+      if (!resized)
+      {
+         map();
+         throw "ERROR: unable to resize the mapped file";
+      }
+      numBytes = newBytes;
+      map();
+   }
+
+   /*****************************************
+    * MAPPED FILE :: FLUSH
+    * Write the dirty pages back to the file
+    ****************************************/
+   void flush()
+   {
+      if (pData == nullptr || readOnly)
+         return;
+#ifdef _WIN32
+      FlushViewOfFile(pData, numBytes);
+#else
+      msync(pData, numBytes, MS_SYNC);
+#endif
+   }
+
+   //
+   // Status
+   //
+
+   void *       data()            { return pData;           }
+   const void * data()      const { return pData;           }
+   size_t       size()      const { return numBytes;        }
+   bool         read_only() const { return readOnly;        }
+   bool         is_open()   const
+   {
+#ifdef _WIN32
+      return hFile != INVALID_HANDLE_VALUE;
+#else
+      return fd >= 0;
+#endif
+   }
+
+private:
+
+   /*****************************************
+    * MAPPED FILE :: MAP
+    * Map the whole file. An empty file is not mapped at all.
+    * A read-only file is mapped copy-on-write: a write through
+    * a pointer into it changes only our copy of the page, never
+    * the file. On failure nothing is mapped and the size is zero
+    ****************************************/
+   void map()
+   {
+      assert(pData == nullptr);
+      if (numBytes == 0)
+         return;
+#ifdef _WIN32
+      hMapping = CreateFileMappingA(hFile, NULL,
+                                    readOnly ? PAGE_WRITECOPY : PAGE_READWRITE,
+                                    0, 0, NULL);
+      if (hMapping != NULL)
+         pData = MapViewOfFile(hMapping,
+                               readOnly ? FILE_MAP_COPY : FILE_MAP_WRITE,
+                               0, 0, numBytes);
+#else
+      pData = mmap(nullptr, numBytes, PROT_READ | PROT_WRITE,
+                   readOnly ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+      if (pData == MAP_FAILED)
+         pData = nullptr;
+#endif
+      if (pData == nullptr)
+      {
+         numBytes = 0;
+         throw "ERROR: unable to map the file";
+      }
+   }
+
+   /*****************************************
+    * MAPPED FILE :: UNMAP
+    ****************************************/
+   void unmap()
+   {
+#ifdef _WIN32
+      if (pData)
+         UnmapViewOfFile(pData);
+      if (hMapping != NULL)
+         CloseHandle(hMapping);
+      hMapping = NULL;
+#else
+      if (pData)
+         munmap(pData, numBytes);
+#endif
+      pData = nullptr;
+   }
+
+   void * pData;        // the start of the mapping
+   size_t numBytes;     // the length of the file and the mapping
+   bool   readOnly;     // was the file opened read-only?
+#ifdef _WIN32
+   HANDLE hFile;        // the open file
+   HANDLE hMapping;     // the file mapping object
+#else
+   int    fd;           // the open file
+#endif
+};
+
+/*****************************************
+ * MAPPED VECTOR
+ * Just like vector, but the elements live in a file. Only
+ * trivially copyable types may be stored this way because
+ * the bytes in the file are the elements themselves.
+ *
+ * While the vector is open the file is numCapacity records
+ * long; closing it trims the file back to numElements records.
+ *
+ * A vector opened read-only refuses to change its size, and a
+ * write through operator[] or an iterator lands in a private
+ * copy of the page: the file itself is never changed.
+ ****************************************/
+template <typename T, typename Growth = growth_size_class>
+class mapped_vector
+{
+   friend class ::TestMappedVector; // give unit tests access to the privates
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "mapped_vector requires a trivially copyable type");
+public:
+
+   //
+   // Construct
+   //
+
+   mapped_vector() : numElements(0), numCapacity(0) {}
+   mapped_vector(const char * fileName, bool readOnly = false)
+      : numElements(0), numCapacity(0)
+   {
+      open(fileName, readOnly);
+   }
+  ~mapped_vector()
+   {
+      // close() throws when the file cannot be trimmed; here it is
+      // just left long
+      file.close(numElements * sizeof(T));
+   }
+
+   void open(const char * fileName, bool readOnly = false);
+   void close();
+   void flush() { file.flush(); }
+
+   //
+   // Iterator
+   //
+
+   typedef typename vector <T> ::iterator iterator;
+   iterator       begin() { return iterator(data());               }
+   iterator       end()   { return iterator(data() + numElements); }
+
+   //
+   // Access
+   //
+
+         T& operator [] (size_t index)
+   {
+      assert(index < numElements);
+      return data()[index];
+   }
+   const T& operator [] (size_t index) const
+   {
+      assert(index < numElements);
+      return data()[index];
+   }
+         T& front()       { assert(numElements > 0); return data()[0];               }
+   const T& front() const { assert(numElements > 0); return data()[0];               }
+         T& back()        { assert(numElements > 0); return data()[numElements - 1]; }
+   const T& back()  const { assert(numElements > 0); return data()[numElements - 1]; }
+         T* data()        { return (T *)file.data();       }
+   const T* data()  const { return (const T *)file.data(); }
+
+   //
+   // Insert
+   //
+
+   void push_back(const T& t);
+   void reserve(size_t newCapacity);
+   void resize(size_t newElements, const T& t = T());
+
+   //
+   // Remove
+   //
+
+   void clear()
+   {
+      checkWritable();
+      numElements = 0;
+   }
+   void pop_back()
+   {
+      checkWritable();
+      if (numElements)
+         --numElements;
+   }
+   void shrink_to_fit();
+
+   //
+   // Status
+   //
+
+   size_t size()      const { return numElements;      }
+   size_t capacity()  const { return numCapacity;      }
+   bool   empty()     const { return numElements == 0; }
+   bool   read_only() const { return file.read_only(); }
+
+private:
+   mapped_vector(const mapped_vector & rhs) = delete;
+   void checkWritable() const
+   {
+      if (file.read_only())
+         throw "ERROR: the mapped vector is read-only";
+   }
+
+   mapped_vector & operator = (const mapped_vector & rhs) = delete;
+
+   mapped_file file;      // the file holding the elements
+   size_t numElements;    // the number of items currently used
+   size_t numCapacity;    // the number of items the file can hold
+};
+
+/*****************************************
+ * MAPPED VECTOR :: OPEN
+ * Map the file. Every record already in the file becomes an
+ * element; nothing is read until it is touched
+ ****************************************/
+template <typename T, typename Growth>
+void mapped_vector <T, Growth> :: open(const char * fileName, bool readOnly)
+{
+   close();
+   file.open(fileName, readOnly);
+   if (file.size() % sizeof(T) != 0)
+   {
+      file.close();
+      throw "ERROR: the file is not a whole number of records";
+   }
+   numElements = numCapacity = file.size() / sizeof(T);
+}
+
+/*****************************************
+ * MAPPED VECTOR :: CLOSE
+ * Unmap the file and trim the unused capacity from it
+ ****************************************/
+template <typename T, typename Growth>
+void mapped_vector <T, Growth> :: close()
+{
+   if (!file.is_open())
+      return;
+   bool trimmed = file.close(numElements * sizeof(T));
+   numElements = numCapacity = 0;
+   if (!trimmed)
+      throw "ERROR: unable to trim the mapped file";
+}
+
+/***************************************
+ * MAPPED VECTOR :: RESERVE
+ * Lengthen the file to hold newCapacity records
+ **************************************/
+template <typename T, typename Growth>
+void mapped_vector <T, Growth> :: reserve(size_t newCapacity)
+{
+   checkWritable();
+   if (newCapacity <= numCapacity)
+      return;
+   if (!file.is_open())
+      throw "ERROR: the mapped vector is not open";
+   file.resize(newCapacity * sizeof(T));
+   numCapacity = newCapacity;
+}
+
+/***************************************
+ * MAPPED VECTOR :: RESIZE
+ * Grow or shrink the number of elements
+ **************************************/
+template <typename T, typename Growth>
+void mapped_vector <T, Growth> :: resize(size_t newElements, const T& t)
+{
+   checkWritable();
+   if (newElements > numCapacity)
+      reserve(newElements);
+   for (size_t i = numElements; i < newElements; i++)
+      data()[i] = t;
+   numElements = newElements;
+}
+
+/***************************************
+ * MAPPED VECTOR :: SHRINK TO FIT
+ * Give the unused records back to the file system
+ **************************************/
+template <typename T, typename Growth>
+void mapped_vector <T, Growth> :: shrink_to_fit()
+{
+   checkWritable();
+   if (numCapacity == numElements || !file.is_open())
+      return;
+   file.resize(numElements * sizeof(T));
+   numCapacity = numElements;
+}
+
+/***************************************
+ * MAPPED VECTOR :: PUSH BACK
+ * Add the element 't' to the end of the file, growing
+ * the file by the Growth policy as needed
+ **************************************/
+template <typename T, typename Growth>
+void mapped_vector <T, Growth> :: push_back(const T& t)
+{
+   checkWritable();
+
+   // t may live in the mapping we are about to move
+   T copy = t;
+   if (numElements == numCapacity)
+      reserve(Growth::grow(numCapacity, sizeof(T)));
+   assert(numElements < numCapacity);
+   data()[numElements++] = copy;
+}
+
+} // namespace custom
@@ -0,0 +1,236 @@
+/***********************************************************************
+ * Header:
+ *    MPSC QUEUE
+ * Summary:
+ *    A lock-free queue for any number of producer threads and one
+ *    consumer thread (Vyukov's intrusive node queue). Like list it is
+ *    a chain of nodes, each holding one value and a link, but the
+ *    link is atomic and only ever points forward.
+ *
+ *        producers --> pHead ... pTail --> consumer
+ *
+ *    push() is wait-free: one atomic exchange and one store. pop()
+ *    is lock-free and never waits on a producer; a push which has
+ *    swung pHead but not yet linked its node is simply not visible.
+ *
+ *    Popped nodes go back into a small pool so a steady stream of
+ *    items does not allocate. Neither side ever waits for the pool:
+ *    when another thread is using it, a producer allocates a node
+ *    and the consumer frees one.
+ *
+ *    This will contain the class definition of:
+ *        mpsc_queue             : A multiple producer, single consumer queue
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "allocator.h"  // for CACHE_LINE_BYTES
+#include <atomic>       // for std::atomic and std::atomic_flag
+#include <cassert>      // because I am paranoid
+#include <new>          // for placement new
+#include <utility>      // for std::move
+
+class TestMpscQueue;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * MPSC QUEUE
+ * Any thread may push. Only one thread at a time may
+ * pop, and only that thread may ask whether it is empty.
+ **************************************************/
+template <typename T>
+class mpsc_queue
+{
+   friend class ::TestMpscQueue; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   mpsc_queue(size_t maxPool = 1024);
+  ~mpsc_queue();
+
+   //
+   // Insert: any thread
+   //
+
+   void push(const T & t) { T copy(t); push(std::move(copy)); }
+   void push(T && t);
+
+   //
+   // Remove: the consumer only
+   //
+
+   bool pop(T & t);
+
+   //
+   // Status: the consumer only
+   //
+
+   bool empty() const
+   {
+      return pTail->pNext.load(std::memory_order_acquire) == nullptr;
+   }
+
+private:
+   mpsc_queue(const mpsc_queue &) = delete;
+   mpsc_queue & operator = (const mpsc_queue &) = delete;
+
+   /*************************************************
+    * NODE
+    * The list node with an atomic forward link. The
+    * value is constructed by push and destroyed by pop,
+    * so the stub (and a pooled node) holds none.
+    *************************************************/
+   struct Node
+   {
+      Node() : pNext(nullptr) {}
+      T * data() { return reinterpret_cast<T *>(storage); }
+
+      std::atomic<Node *> pNext;   // the next node, toward pHead
+      alignas(T) unsigned char storage[sizeof(T)];
+   };
+
+   Node * acquire();
+   void release(Node * p);
+
+   // the producers' end and the consumer's end on their own cache lines
+   alignas(CACHE_LINE_BYTES) std::atomic<Node *> pHead;   // the last node pushed
+   alignas(CACHE_LINE_BYTES) Node * pTail;                // the stub before the next value
+
+   // the pool of spare nodes, used by whoever gets the flag first
+   alignas(CACHE_LINE_BYTES) std::atomic_flag poolBusy;
+   Node * pPool;          // spare nodes linked through pNext
+   size_t numPool;        // the number of spare nodes
+   size_t maxPool;        // never keep more spares than this
+};
+
+/*****************************************
+ * MPSC QUEUE :: CONSTRUCTOR
+ * Start with just the stub: head and tail both point at it
+ ****************************************/
+template <typename T>
+mpsc_queue <T> ::mpsc_queue(size_t maxPool)
+   : pPool(nullptr), numPool(0), maxPool(maxPool)
+{
+   poolBusy.clear();
+   Node * pStub = new Node;
+   pHead.store(pStub, std::memory_order_relaxed);
+   pTail = pStub;
+}
+
+/*****************************************
+ * MPSC QUEUE :: DESTRUCTOR
+ * No thread may be pushing or popping by now
+ ****************************************/
+template <typename T>
+mpsc_queue <T> ::~mpsc_queue()
+{
+   // the values still queued, then the stub
+   Node * pNext;
+   while ((pNext = pTail->pNext.load(std::memory_order_relaxed)) != nullptr)
+   {
+      pNext->data()->~T();
+      delete pTail;
+      pTail = pNext;
+   }
+   delete pTail;
+
+   while (pPool)
+   {
+      pNext = pPool->pNext.load(std::memory_order_relaxed);
+      delete pPool;
+      pPool = pNext;
+   }
+}
+
+/*****************************************
+ * MPSC QUEUE :: ACQUIRE
+ * A spare node from the pool, or a new one if the pool is
+ * empty or another thread has it right now
+ ****************************************/
+template <typename T>
+typename mpsc_queue <T> ::Node * mpsc_queue <T> ::acquire()
+{
+   Node * p = nullptr;
+   if (!poolBusy.test_and_set(std::memory_order_acquire))
+   {
+      if (pPool)
+      {
+         p = pPool;
+         pPool = p->pNext.load(std::memory_order_relaxed);
+         numPool--;
+      }
+      poolBusy.clear(std::memory_order_release);
+   }
+   if (p == nullptr)
+      return new Node;
+   p->pNext.store(nullptr, std::memory_order_relaxed);
+   return p;
+}
+
+/*****************************************
+ * MPSC QUEUE :: RELEASE
+ * Keep a node for later, or free it if the pool is full
+ * or another thread has it right now
+ ****************************************/
+template <typename T>
+void mpsc_queue <T> ::release(Node * p)
+{
+   if (!poolBusy.test_and_set(std::memory_order_acquire))
+   {
+      if (numPool < maxPool)
+      {
+         p->pNext.store(pPool, std::memory_order_relaxed);
+         pPool = p;
+         numPool++;
+         p = nullptr;
+      }
+      poolBusy.clear(std::memory_order_release);
+   }
+   delete p;
+}
+
+/*****************************************
+ * MPSC QUEUE :: PUSH
+ * Swing pHead to the new node, then link the old head to
+ * it. Between the two steps the consumer sees the queue
+ * end at the old head.
+ *     COST   : wait-free, O(1)
+ ****************************************/
+template <typename T>
+void mpsc_queue <T> ::push(T && t)
+{
+   Node * pNew = acquire();
+   new (pNew->data()) T(std::move(t));
+   Node * pPrev = pHead.exchange(pNew, std::memory_order_acq_rel);
+   pPrev->pNext.store(pNew, std::memory_order_release);
+}
+
+/*****************************************
+ * MPSC QUEUE :: POP
+ * Take the value from the node after the stub; that node
+ * becomes the new stub and the old one goes to the pool
+ *     OUTPUT : false if nothing was ready
+ *     COST   : lock-free, O(1)
+ ****************************************/
+template <typename T>
+bool mpsc_queue <T> ::pop(T & t)
+{
+   Node * pNext = pTail->pNext.load(std::memory_order_acquire);
+   if (pNext == nullptr)
+      return false;
+
+   t = std::move(*pNext->data());
+   pNext->data()->~T();
+   Node * pOld = pTail;
+   pTail = pNext;
+   release(pOld);
+   return true;
+}
+
+} // namespace custom
@@ -0,0 +1,581 @@
+/***********************************************************************
+ * Header:
+ *    MULTI HASH
+ * Summary:
+ *    Hashes which keep every copy of a key: unordered_multiset and
+ *    unordered_multimap. They have buckets just like unordered_set,
+ *    but within a bucket all the elements equal to each other sit
+ *    side by side, as a group:
+ *
+ *        h[3] --> [ 43 ] [ 13 13 13 ] [ 63 63 ] [ 93 ]
+ *                         \________/
+ *                      equal_range(13)
+ *
+ *    Each bucket also keeps a short list of where its groups start,
+ *    one entry per distinct key, so finding a group compares against
+ *    one element of each group and never walks through duplicates:
+ *
+ *        heads[3] --> [ 43 ] [ 13 ] [ 63 ] [ 93 ]
+ *
+ *    So count() and equal_range() find the group and walk just it.
+ *    insert() links the new element in ahead of its group and makes
+ *    it the group's head; a key not yet in the bucket starts a new
+ *    group at the front.
+ *
+ *    This will contain the class definitions of:
+ *        unordered_multiset           : A hash which counts duplicates
+ *        unordered_multiset::iterator : An iterator through the hash
+ *        unordered_multimap           : Many values per key
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "hash.h"       // for reduce_modulo and friends
+#include "list.h"       // for the buckets
+#include "pair.h"       // for equal_range and the map's elements
+#include <functional>   // for std::hash
+#include <memory>       // for std::allocator
+#include <new>          // for placement new
+
+class TestMultiHash;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * UNORDERED MULTISET
+ * Like unordered_set, but insert() always inserts.
+ * A, H and R are as they are for unordered_set.
+ ************************************************/
+template <typename T, typename A = std::allocator<T>,
+          typename H = std::hash<T>, typename R = reduce_modulo<10>>
+class unordered_multiset
+{
+   friend class ::TestMultiHash;   // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+   unordered_multiset() : numElements(0)
+   {
+      allocateBuckets();
+   }
+   explicit unordered_multiset(const H & hasher) : hasher(hasher), numElements(0)
+   {
+      allocateBuckets();
+   }
+   unordered_multiset(const unordered_multiset & rhs) : hasher(rhs.hasher), numElements(0)
+   {
+      allocateBuckets();
+      *this = rhs;
+   }
+   unordered_multiset(unordered_multiset && rhs) : numElements(0)
+   {
+      allocateBuckets();
+      swap(rhs);
+   }
+   unordered_multiset(const std::initializer_list<T> & il) : numElements(0)
+   {
+      allocateBuckets();
+      for (const T & t : il)
+         insert(t);
+   }
+  ~unordered_multiset()
+   {
+      deallocateBuckets();
+   }
+
+   //
+   // Assign
+   //
+   unordered_multiset & operator = (const unordered_multiset & rhs);
+   unordered_multiset & operator = (unordered_multiset && rhs)
+   {
+      if (this != &rhs)
+      {
+         clear();
+         swap(rhs);
+      }
+      return *this;
+   }
+   void swap(unordered_multiset & rhs)
+   {
+      std::swap(numElements, rhs.numElements);
+      std::swap(buckets, rhs.buckets);
+      std::swap(heads, rhs.heads);
+      std::swap(alloc, rhs.alloc);
+      std::swap(allocHeads, rhs.allocHeads);
+      std::swap(hasher, rhs.hasher);
+   }
+
+   //
+   // Iterator
+   //
+   class iterator;
+   iterator begin();
+   iterator end()
+   {
+      return iterator(buckets + bucket_count(), buckets + bucket_count(),
+                      typename list<T>::iterator());
+   }
+
+   //
+   // Access
+   //
+   size_t bucket(const T & t) const
+   {
+      return R::index(hasher(t));
+   }
+   iterator find(const T & t);
+   size_t count(const T & t);
+   custom::pair<iterator, iterator> equal_range(const T & t);
+
+   //
+   // Insert
+   //
+   iterator insert(const T & t);
+
+   //
+   // Remove
+   //
+   iterator erase(const iterator & it);
+   size_t erase(const T & t);
+   void clear() noexcept
+   {
+      for (size_t i = 0; i < bucket_count(); i++)
+      {
+         buckets[i].clear();
+         heads[i].clear();
+      }
+      numElements = 0;
+   }
+
+   //
+   // Status
+   //
+   size_t size()         const { return numElements;      }
+   bool   empty()        const { return numElements == 0; }
+   size_t bucket_count() const { return R::BUCKETS;       }
+   size_t bucket_size(size_t i) const
+   {
+      return buckets[i].size();
+   }
+
+private:
+   typedef typename list<T>::iterator ListIterator;
+   typedef list<ListIterator> Heads;
+   typedef typename std::allocator_traits<A>::template
+      rebind_alloc<list<T>> BucketAllocator;
+   typedef typename std::allocator_traits<A>::template
+      rebind_alloc<Heads> HeadsAllocator;
+
+   void allocateBuckets()
+   {
+      buckets = allocate_buckets<list<T>>(alloc, bucket_count());
+      heads = allocate_buckets<Heads>(allocHeads, bucket_count());
+   }
+   void deallocateBuckets()
+   {
+      deallocate_buckets(alloc, buckets, bucket_count());
+      deallocate_buckets(allocHeads, heads, bucket_count());
+   }
+   typename Heads::iterator findGroup(size_t iBucket, const T & t);
+   void findHeads(size_t iBucket);
+
+   BucketAllocator alloc;          // where the bucket array comes from
+   HeadsAllocator allocHeads;      // where the array of group heads comes from
+   H hasher;                       // which bucket an element goes in
+   list<T> * buckets;              // exactly bucket_count() buckets
+   Heads * heads;                  // for each bucket, the first of each group
+   size_t numElements;             // counting every duplicate
+};
+
+/************************************************
+ * UNORDERED MULTISET ITERATOR
+ * Through the buckets in order, and through each
+ * bucket from front to back
+ ************************************************/
+template <typename T, typename A, typename H, typename R>
+class unordered_multiset <T, A, H, R> ::iterator
+{
+   friend class ::TestMultiHash;   // give unit tests access to the privates
+   template <class TT, class AA, class HH, class RR>
+   friend class custom::unordered_multiset;
+public:
+   //
+   // Construct
+   //
+   iterator() : pBucket(nullptr), pBucketEnd(nullptr) {}
+   iterator(list<T> * pBucket, list<T> * pBucketEnd,
+            const typename list<T>::iterator & itList)
+      : pBucket(pBucket), pBucketEnd(pBucketEnd), itList(itList) {}
+
+   //
+   // Compare
+   //
+   bool operator == (const iterator & rhs) const
+   {
+      return pBucket == rhs.pBucket && itList == rhs.itList;
+   }
+   bool operator != (const iterator & rhs) const
+   {
+      return !(*this == rhs);
+   }
+
+   //
+   // Access
+   //
+   T & operator * ()
+   {
+      return *itList;
+   }
+
+   //
+   // Arithmetic
+   //
+   iterator & operator ++ ();
+   iterator operator ++ (int)
+   {
+      iterator tmp(*this);
+      ++*this;
+      return tmp;
+   }
+
+private:
+   list<T> * pBucket;
+   list<T> * pBucketEnd;
+   typename list<T>::iterator itList;
+};
+
+/*****************************************
+ * UNORDERED MULTISET :: FIND GROUP
+ * The entry in heads for t's group, comparing t with
+ * the first element of each group in its bucket
+ *    COST   : the number of distinct keys in the bucket
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+typename unordered_multiset <T, A, H, R> ::Heads::iterator
+unordered_multiset <T, A, H, R> ::findGroup(size_t iBucket, const T & t)
+{
+   typename Heads::iterator it = heads[iBucket].begin();
+   for (; it != heads[iBucket].end(); ++it)
+      if (**it == t)
+         break;
+   return it;
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: FIND HEADS
+ * Work out where every group in a bucket starts, after
+ * the bucket has been copied wholesale
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+void unordered_multiset <T, A, H, R> ::findHeads(size_t iBucket)
+{
+   heads[iBucket].clear();
+   ListIterator itPrev = buckets[iBucket].end();
+   for (ListIterator it = buckets[iBucket].begin(); it != buckets[iBucket].end(); ++it)
+   {
+      if (itPrev == buckets[iBucket].end() || !(*itPrev == *it))
+         heads[iBucket].push_back(it);
+      itPrev = it;
+   }
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: ASSIGN
+ * Copy every bucket, groups and all
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+unordered_multiset <T, A, H, R> &
+unordered_multiset <T, A, H, R> ::operator = (const unordered_multiset & rhs)
+{
+   if (this == &rhs)
+      return *this;
+   hasher = rhs.hasher;
+   for (size_t i = 0; i < bucket_count(); i++)
+   {
+      // list's assignment takes a non-const reference, but only reads it
+      buckets[i] = const_cast<list<T> &>(rhs.buckets[i]);
+      findHeads(i);
+   }
+   numElements = rhs.numElements;
+   return *this;
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: BEGIN
+ * The front of the first bucket with anything in it
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+typename unordered_multiset <T, A, H, R> ::iterator
+unordered_multiset <T, A, H, R> ::begin()
+{
+   for (size_t i = 0; i < bucket_count(); i++)
+      if (!buckets[i].empty())
+         return iterator(buckets + i, buckets + bucket_count(), buckets[i].begin());
+   return end();
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: FIND
+ * The first element of t's group
+ *    COST   : the distinct keys in the bucket
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+typename unordered_multiset <T, A, H, R> ::iterator
+unordered_multiset <T, A, H, R> ::find(const T & t)
+{
+   size_t iBucket = bucket(t);
+   typename Heads::iterator itHead = findGroup(iBucket, t);
+   if (itHead == heads[iBucket].end())
+      return end();
+   return iterator(buckets + iBucket, buckets + bucket_count(), *itHead);
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: EQUAL RANGE
+ * From the first of t's group to whatever comes after
+ * its last, which may be in a later bucket
+ *    COST   : the distinct keys in the bucket, and the group
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+custom::pair<typename unordered_multiset <T, A, H, R> ::iterator,
+             typename unordered_multiset <T, A, H, R> ::iterator>
+unordered_multiset <T, A, H, R> ::equal_range(const T & t)
+{
+   iterator itFirst = find(t);
+   iterator itLast = itFirst;
+   if (itFirst != end())
+   {
+      typename list<T>::iterator itEnd = itFirst.pBucket->end();
+      while (itLast.itList != itEnd && *itLast.itList == t)
+         ++itLast.itList;
+      if (itLast.itList == itEnd)
+      {
+         // step back onto the bucket's last element and off it again
+         // so the iterator moves on to the next bucket properly
+         itLast.itList = itFirst.pBucket->rbegin();
+         ++itLast;
+      }
+   }
+   return custom::pair<iterator, iterator>(itFirst, itLast);
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: COUNT
+ * How many are in t's group
+ *    COST   : the distinct keys in the bucket, and the group
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+size_t unordered_multiset <T, A, H, R> ::count(const T & t)
+{
+   size_t iBucket = bucket(t);
+   typename Heads::iterator itHead = findGroup(iBucket, t);
+   if (itHead == heads[iBucket].end())
+      return 0;
+   ListIterator it = *itHead;
+   size_t num = 0;
+   for (; it != buckets[iBucket].end() && *it == t; ++it)
+      num++;
+   return num;
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: INSERT
+ * Join t's group at its front, or start a new group at
+ * the front of the bucket. Either way the new element
+ * heads its group
+ *    COST   : the distinct keys in the bucket, O(1) to link
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+typename unordered_multiset <T, A, H, R> ::iterator
+unordered_multiset <T, A, H, R> ::insert(const T & t)
+{
+   size_t iBucket = bucket(t);
+   list<T> & b = buckets[iBucket];
+   typename Heads::iterator itHead = findGroup(iBucket, t);
+   ListIterator itNew;
+   if (itHead != heads[iBucket].end())
+   {
+      itNew = b.insert(*itHead, t);
+      *itHead = itNew;
+   }
+   else
+   {
+      itNew = b.insert(b.begin(), t);
+      heads[iBucket].push_front(itNew);
+   }
+   numElements++;
+   return iterator(buckets + iBucket, buckets + bucket_count(), itNew);
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: ERASE
+ * Remove the one element at it. If it heads its group
+ * the next element takes over, or the group is gone
+ *    OUTPUT : the element after it
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+typename unordered_multiset <T, A, H, R> ::iterator
+unordered_multiset <T, A, H, R> ::erase(const iterator & it)
+{
+   iterator itNext = it;
+   ++itNext;
+
+   list<T> & b = *it.pBucket;
+   ListIterator itList = it.itList;
+   ListIterator itPrev = itList;
+   --itPrev;
+   if (itPrev == b.end() || !(*itPrev == *itList))
+   {
+      Heads & h = heads[it.pBucket - buckets];
+      typename Heads::iterator itHead = h.begin();
+      while (*itHead != itList)
+         ++itHead;
+      ListIterator itAfter = itList;
+      ++itAfter;
+      if (itAfter != b.end() && *itAfter == *itList)
+         *itHead = itAfter;
+      else
+         h.erase(itHead);
+   }
+
+   b.erase(itList);
+   numElements--;
+   return itNext;
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: ERASE
+ * Remove all of t's group
+ *    OUTPUT : how many were removed
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+size_t unordered_multiset <T, A, H, R> ::erase(const T & t)
+{
+   size_t iBucket = bucket(t);
+   list<T> & b = buckets[iBucket];
+   typename Heads::iterator itHead = findGroup(iBucket, t);
+   if (itHead == heads[iBucket].end())
+      return 0;
+   ListIterator it = *itHead;
+   heads[iBucket].erase(itHead);
+   size_t num = 0;
+   while (it != b.end() && *it == t)
+   {
+      it = b.erase(it);
+      num++;
+   }
+   numElements -= num;
+   return num;
+}
+
+/*****************************************
+ * UNORDERED MULTISET :: ITERATOR :: INCREMENT
+ * The next element in this bucket, else the front of
+ * the next bucket with anything in it
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+typename unordered_multiset <T, A, H, R> ::iterator &
+unordered_multiset <T, A, H, R> ::iterator::operator ++ ()
+{
+   if (pBucket == pBucketEnd)
+      return *this;
+
+   ++itList;
+   if (itList != pBucket->end())
+      return *this;
+
+   ++pBucket;
+   while (pBucket != pBucketEnd && pBucket->empty())
+      ++pBucket;
+   itList = pBucket != pBucketEnd ? pBucket->begin() : typename list<T>::iterator();
+   return *this;
+}
+
+/************************************************
+ * UNORDERED MULTIMAP
+ * Any number of values under one key. The elements
+ * are custom::pairs, which compare by first alone,
+ * so a multiset of them groups by key.
+ ************************************************/
+template <typename K, typename V,
+          typename A = std::allocator<custom::pair<K, V>>,
+          typename H = std::hash<K>, typename R = reduce_modulo<10>>
+class unordered_multimap
+{
+   friend class ::TestMultiHash;   // give unit tests access to the privates
+
+   // hash a pair by its key, as the key alone would hash
+   struct KeyHash
+   {
+      KeyHash(const H & hasher = H()) : hasher(hasher) {}
+      size_t operator()(const custom::pair<K, V> & p) const { return hasher(p.first); }
+      H hasher;
+   };
+   typedef unordered_multiset<custom::pair<K, V>, A, KeyHash, R> Set;
+public:
+   typedef custom::pair<K, V> value_type;
+   typedef typename Set::iterator iterator;
+
+   //
+   // Construct
+   //
+   unordered_multimap() {}
+   explicit unordered_multimap(const H & hasher) : elements(KeyHash(hasher)) {}
+
+   //
+   // Iterator
+   //
+   iterator begin() { return elements.begin(); }
+   iterator end()   { return elements.end();   }
+
+   //
+   // Access: these build a pair to look up by, so V must
+   // have a default constructor
+   //
+   iterator find(const K & k)     { return elements.find(value_type(k));        }
+   size_t count(const K & k)      { return elements.count(value_type(k));       }
+   custom::pair<iterator, iterator> equal_range(const K & k)
+   {
+      return elements.equal_range(value_type(k));
+   }
+
+   //
+   // Insert
+   //
+   iterator insert(const value_type & p)      { return elements.insert(p);                }
+   iterator insert(const K & k, const V & v)  { return elements.insert(value_type(k, v)); }
+
+   //
+   // Remove
+   //
+   iterator erase(const iterator & it) { return elements.erase(it);             }
+   size_t erase(const K & k)           { return elements.erase(value_type(k));  }
+   void clear() noexcept               { elements.clear();                      }
+
+   //
+   // Status
+   //
+   size_t size()         const { return elements.size();         }
+   bool   empty()        const { return elements.empty();        }
+   size_t bucket_count() const { return elements.bucket_count(); }
+
+private:
+   Set elements;
+};
+
+/*****************************************
+ * SWAP
+ * Stand-alone unordered multiset swap
+ ****************************************/
+template <typename T, typename A, typename H, typename R>
+void swap(unordered_multiset<T, A, H, R> & lhs, unordered_multiset<T, A, H, R> & rhs)
+{
+   lhs.swap(rhs);
+}
+
+} // namespace custom
@@ -0,0 +1,425 @@
+/***********************************************************************
+ * Header:
+ *    SHARDED CACHE
+ * Summary:
+ *    A cache many threads can share. The keys are spread by hash
+ *    over independent shards, each with its own lock, so threads
+ *    working on different keys seldom meet.
+ *
+ *    Within a shard the policy is CLOCK rather than true LRU. The
+ *    entries sit in a fixed ring of slots, each with a referenced
+ *    bit. get() only sets that bit, so any number of readers can
+ *    share the shard's lock; nothing is relinked. When put() needs
+ *    a slot, the hand sweeps the ring, clearing bits, and evicts
+ *    the first entry nobody has touched since the last sweep:
+ *
+ *        slots:  [a*][b ][c*][d*]      * = referenced
+ *                      ^
+ *                      hand: b is the one to go
+ *
+ *    Each shard counts its hits, misses and evictions.
+ *
+ *    This will contain the class definition of:
+ *        cache_stats            : The counters for a shard or a cache
+ *        sharded_cache          : A concurrent CLOCK cache
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "intrusive.h"  // for the index of each shard
+#include "vector.h"     // for the spare slots of each shard
+#include "allocator.h"  // for CACHE_LINE_BYTES
+#include <atomic>       // for the referenced bits and counters
+#include <cassert>      // because I am paranoid
+#include <functional>   // for std::hash and std::equal_to
+#include <mutex>        // for std::unique_lock
+#include <new>          // for placement new
+#include <shared_mutex> // for std::shared_mutex and std::shared_lock
+#include <utility>      // for std::move and std::forward
+
+class TestShardedCache; // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************
+ * CACHE STATS
+ * What a shard, or the whole cache, has done so far
+ ****************************************/
+struct cache_stats
+{
+   size_t hits      = 0;   // get() found it
+   size_t misses    = 0;   // get() did not
+   size_t evictions = 0;   // put() pushed something out
+   size_t size      = 0;   // entries cached right now
+};
+
+/**************************************************
+ * SHARDED CACHE
+ * Every member may be called from any thread
+ **************************************************/
+template <typename K, typename V,
+          typename H = std::hash<K>, typename E = std::equal_to<K>>
+class sharded_cache
+{
+   friend class ::TestShardedCache; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   sharded_cache(size_t capacity, size_t numShards = 16, const H & hash = H(), const E & equal = E());
+  ~sharded_cache();
+
+   //
+   // Access
+   //
+
+   bool get(const K & key, V & value);
+
+   //
+   // Insert
+   //
+
+   void put(const K & key, const V & value) { emplace(key, value);            }
+   void put(const K & key, V && value)      { emplace(key, std::move(value)); }
+
+   //
+   // Remove
+   //
+
+   bool erase(const K & key);
+
+   //
+   // Status
+   //
+
+   size_t size() const;
+   size_t capacity()    const { return numShards * numSlots; }
+   size_t shard_count() const { return numShards;            }
+   cache_stats stats(size_t iShard) const;
+   cache_stats stats() const;
+
+private:
+   sharded_cache(const sharded_cache &) = delete;
+   sharded_cache & operator = (const sharded_cache &) = delete;
+
+   /*************************************************
+    * SLOT
+    * One place in a shard's ring. The key and value are
+    * only constructed while the slot is in use.
+    *************************************************/
+   struct Slot
+   {
+      Slot() : referenced(false), used(false) {}
+      K & key()   { return *reinterpret_cast<K *>(keyStorage);   }
+      V & value() { return *reinterpret_cast<V *>(valueStorage); }
+      const K & key() const { return *reinterpret_cast<const K *>(keyStorage); }
+
+      set_hook byKey;                    // in the shard's index while used
+      std::atomic<bool> referenced;      // touched since the hand last passed
+      bool used;
+      alignas(K) unsigned char keyStorage[sizeof(K)];
+      alignas(V) unsigned char valueStorage[sizeof(V)];
+   };
+
+   // hash and compare slots by their keys
+   struct SlotHash
+   {
+      SlotHash(const H & hash = H()) : hash(hash) {}
+      size_t operator()(const K & key)    const { return hash(key);     }
+      size_t operator()(const Slot & s)   const { return hash(s.key()); }
+      H hash;
+   };
+   struct SlotEqual
+   {
+      SlotEqual(const E & equal = E()) : equal(equal) {}
+      bool operator()(const Slot & s, const K & key)     const { return equal(s.key(), key);       }
+      bool operator()(const Slot & s, const Slot & rhs)  const { return equal(s.key(), rhs.key()); }
+      E equal;
+   };
+
+   /*************************************************
+    * SHARD
+    * Everything one lock protects, on its own cache lines.
+    * The counters are atomic because readers bump them
+    * while sharing the lock.
+    *************************************************/
+   struct alignas(CACHE_LINE_BYTES) Shard
+   {
+      Shard(size_t numSlots, const H & hash, const E & equal)
+         : index(numSlots + 1, SlotHash(hash), SlotEqual(equal)),
+           slots(new Slot[numSlots]), hand(0),
+           hits(0), misses(0), evictions(0)
+      {
+         spare.reserve(numSlots);
+         for (size_t i = numSlots; i > 0; i--)
+            spare.push_back(i - 1);
+      }
+     ~Shard() { delete [] slots; }
+
+      mutable std::shared_mutex lock;
+      intrusive_unordered_set<Slot, &Slot::byKey, SlotHash, SlotEqual> index;
+      Slot * slots;                  // the ring
+      vector<size_t> spare;          // slots never used, or emptied by erase
+      size_t hand;                   // where the next sweep starts
+      std::atomic<size_t> hits;
+      std::atomic<size_t> misses;
+      std::atomic<size_t> evictions;
+   };
+
+   template <typename U>
+   void emplace(const K & key, U && value);
+   size_t victim(Shard & shard);
+   void release(Shard & shard, Slot & slot);
+
+   /*****************************************
+    * SHARD OF
+    * Mix the hash before taking its top bits, so the shard
+    * and the bucket within the shard do not both come from
+    * the same low bits
+    ****************************************/
+   Shard & shard_of(const K & key) const
+   {
+      if (shardBits == 0)
+         return shards[0];
+      size_t mixed = hash(key) * (size_t)0x9E3779B97F4A7C15ull;
+      return shards[mixed >> (sizeof(size_t) * 8 - shardBits)];
+   }
+
+   Shard * shards;         // numShards of them
+   size_t numShards;       // a power of two
+   size_t shardBits;       // log2(numShards)
+   size_t numSlots;        // the capacity of each shard
+   H hash;
+};
+
+/*****************************************
+ * SHARDED CACHE :: CONSTRUCTOR
+ * Round the shards up to a power of two and split the
+ * capacity between them, rounding up
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+sharded_cache <K, V, H, E> ::sharded_cache(size_t capacity, size_t numShards,
+                                           const H & hash, const E & equal)
+   : numShards(1), shardBits(0), hash(hash)
+{
+   while (this->numShards < numShards)
+   {
+      this->numShards *= 2;
+      shardBits++;
+   }
+   numSlots = (capacity + this->numShards - 1) / this->numShards;
+   if (numSlots == 0)
+      numSlots = 1;
+
+   // the shards are not copyable, so build them in place
+   shards = static_cast<Shard *>(::operator new(sizeof(Shard) * this->numShards,
+                                                std::align_val_t(alignof(Shard))));
+   for (size_t i = 0; i < this->numShards; i++)
+      new (shards + i) Shard(numSlots, hash, equal);
+}
+
+/*****************************************
+ * SHARDED CACHE :: DESTRUCTOR
+ * No thread may be using the cache by now
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+sharded_cache <K, V, H, E> ::~sharded_cache()
+{
+   for (size_t i = 0; i < numShards; i++)
+   {
+      for (size_t j = 0; j < numSlots; j++)
+         if (shards[i].slots[j].used)
+            release(shards[i], shards[i].slots[j]);
+      shards[i].~Shard();
+   }
+   ::operator delete(shards, std::align_val_t(alignof(Shard)));
+}
+
+/*****************************************
+ * SHARDED CACHE :: GET
+ * Copy out a value and mark it referenced. Readers share
+ * the shard's lock.
+ *    OUTPUT : whether it was cached; value is only set if so
+ *    COST   : O(1) expected
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+bool sharded_cache <K, V, H, E> ::get(const K & key, V & value)
+{
+   Shard & shard = shard_of(key);
+   std::shared_lock<std::shared_mutex> guard(shard.lock);
+
+   auto it = shard.index.find(key);
+   if (it == shard.index.end())
+   {
+      shard.misses.fetch_add(1, std::memory_order_relaxed);
+      return false;
+   }
+
+   it->referenced.store(true, std::memory_order_relaxed);
+   value = it->value();
+   shard.hits.fetch_add(1, std::memory_order_relaxed);
+   return true;
+}
+
+/*****************************************
+ * SHARDED CACHE :: EMPLACE
+ * Replace the value of a cached key, or put the key in a
+ * free slot, or in the slot the hand picks
+ *    COST   : O(1) expected, O(slots) for a sweep at worst
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+template <typename U>
+void sharded_cache <K, V, H, E> ::emplace(const K & key, U && value)
+{
+   Shard & shard = shard_of(key);
+   std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+   auto it = shard.index.find(key);
+   if (it != shard.index.end())
+   {
+      it->value() = std::forward<U>(value);
+      it->referenced.store(true, std::memory_order_relaxed);
+      return;
+   }
+
+   size_t iSlot;
+   if (!shard.spare.empty())
+   {
+      iSlot = shard.spare.back();
+      shard.spare.pop_back();
+   }
+   else
+   {
+      iSlot = victim(shard);
+      release(shard, shard.slots[iSlot]);
+      shard.evictions.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   // a new entry starts unreferenced: it must be used again to
+   // survive the next sweep
+   Slot & slot = shard.slots[iSlot];
+   new (slot.keyStorage)   K(key);
+   new (slot.valueStorage) V(std::forward<U>(value));
+   slot.referenced.store(false, std::memory_order_relaxed);
+   slot.used = true;
+   shard.index.insert(slot);
+}
+
+/*****************************************
+ * SHARDED CACHE :: VICTIM
+ * Sweep the ring from the hand, giving each referenced
+ * slot a second chance, until one has had its chance.
+ * The caller holds the shard's lock and the ring is full.
+ *    OUTPUT : the slot to evict; the hand is left after it
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+size_t sharded_cache <K, V, H, E> ::victim(Shard & shard)
+{
+   while (true)
+   {
+      size_t i = shard.hand;
+      shard.hand = (shard.hand + 1 == numSlots) ? 0 : shard.hand + 1;
+
+      Slot & slot = shard.slots[i];
+      assert(slot.used);
+      if (!slot.referenced.exchange(false, std::memory_order_relaxed))
+         return i;
+   }
+}
+
+/*****************************************
+ * SHARDED CACHE :: RELEASE
+ * Take a slot out of the index and destroy its key and
+ * value. The caller holds the shard's lock.
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+void sharded_cache <K, V, H, E> ::release(Shard & shard, Slot & slot)
+{
+   assert(slot.used);
+   shard.index.erase(slot);
+   slot.key().~K();
+   slot.value().~V();
+   slot.used = false;
+}
+
+/*****************************************
+ * SHARDED CACHE :: ERASE
+ * Forget a key; its slot is used before the hand's next
+ * victim
+ *    OUTPUT : whether it was cached
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+bool sharded_cache <K, V, H, E> ::erase(const K & key)
+{
+   Shard & shard = shard_of(key);
+   std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+   auto it = shard.index.find(key);
+   if (it == shard.index.end())
+      return false;
+   Slot & slot = *it;
+   release(shard, slot);
+   shard.spare.push_back(&slot - shard.slots);
+   return true;
+}
+
+/*****************************************
+ * SHARDED CACHE :: SIZE
+ * The entries in all the shards, each counted under its
+ * own lock, so the total may already be stale
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+size_t sharded_cache <K, V, H, E> ::size() const
+{
+   size_t num = 0;
+   for (size_t i = 0; i < numShards; i++)
+   {
+      std::shared_lock<std::shared_mutex> guard(shards[i].lock);
+      num += shards[i].index.size();
+   }
+   return num;
+}
+
+/*****************************************
+ * SHARDED CACHE :: STATS
+ * The counters of one shard
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+cache_stats sharded_cache <K, V, H, E> ::stats(size_t iShard) const
+{
+   assert(iShard < numShards);
+   const Shard & shard = shards[iShard];
+   std::shared_lock<std::shared_mutex> guard(shard.lock);
+
+   cache_stats s;
+   s.hits      = shard.hits.load(std::memory_order_relaxed);
+   s.misses    = shard.misses.load(std::memory_order_relaxed);
+   s.evictions = shard.evictions.load(std::memory_order_relaxed);
+   s.size      = shard.index.size();
+   return s;
+}
+
+/*****************************************
+ * SHARDED CACHE :: STATS
+ * The counters of every shard added up
+ ****************************************/
+template <typename K, typename V, typename H, typename E>
+cache_stats sharded_cache <K, V, H, E> ::stats() const
+{
+   cache_stats total;
+   for (size_t i = 0; i < numShards; i++)
+   {
+      cache_stats s = stats(i);
+      total.hits      += s.hits;
+      total.misses    += s.misses;
+      total.evictions += s.evictions;
+      total.size      += s.size;
+   }
+   return total;
+}
+
+} // namespace custom
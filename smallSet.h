@@ -0,0 +1,354 @@
+/***********************************************************************
+ * Header:
+ *    SMALL SET
+ * Summary:
+ *    A set for the common case of only a handful of elements. Up to
+ *    N of them are kept inline, in a flat array inside the set
+ *    itself, and found by a linear scan: for a few elements that
+ *    beats hashing, and an empty set owns no memory at all.
+ *
+ *    Only when the (N+1)th element arrives is an unordered_set
+ *    allocated and everything moved into it. From then on the set is
+ *    just that hash, until clear() puts it back inline.
+ *
+ *        small:   [a][b][c][ ][ ][ ][ ][ ]   pBig == nullptr
+ *        big:     pBig --> unordered_set { a b c d e f g h i }
+ *
+ *    This will contain the class definition of:
+ *        small_unordered_set           : A set which starts out inline
+ *        small_unordered_set::iterator : An iterator through either form
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "hash.h"       // for unordered_set, once we are big
+#include "pair.h"       // for the result of insert
+#include <cassert>      // because I am paranoid
+#include <memory>       // for std::allocator
+#include <new>          // for placement new
+#include <utility>      // for std::move and std::swap
+
+class TestSmallSet;     // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * SMALL UNORDERED SET
+ * The same interface as unordered_set. While there
+ * are at most N elements they live in the set itself.
+ ************************************************/
+template <typename T, size_t N = 8,
+          typename A = std::allocator<T>, typename Bucket = custom::list<T>>
+class small_unordered_set
+{
+   friend class ::TestSmallSet;   // give unit tests access to the privates
+   typedef unordered_set<T, A, Bucket> Big;
+public:
+   //
+   // Construct
+   //
+   small_unordered_set() : numInline(0), pBig(nullptr) {}
+   small_unordered_set(const small_unordered_set & rhs) : small_unordered_set()
+   {
+      *this = rhs;
+   }
+   small_unordered_set(small_unordered_set && rhs) : small_unordered_set()
+   {
+      *this = std::move(rhs);
+   }
+   small_unordered_set(const std::initializer_list<T> & il) : small_unordered_set()
+   {
+      for (const T & t : il)
+         insert(t);
+   }
+  ~small_unordered_set()
+   {
+      clear();
+   }
+
+   //
+   // Assign
+   //
+   small_unordered_set & operator = (const small_unordered_set & rhs);
+   small_unordered_set & operator = (small_unordered_set && rhs);
+   void swap(small_unordered_set & rhs)
+   {
+      small_unordered_set tmp(std::move(rhs));
+      rhs = std::move(*this);
+      *this = std::move(tmp);
+   }
+
+   //
+   // Iterator
+   //
+   class iterator;
+   iterator begin()
+   {
+      return pBig ? iterator(pBig->begin()) : iterator(data());
+   }
+   iterator end()
+   {
+      return pBig ? iterator(pBig->end()) : iterator(data() + numInline);
+   }
+
+   //
+   // Access
+   //
+   iterator find(const T & t);
+   size_t count(const T & t) { return find(t) != end() ? 1 : 0; }
+
+   //
+   // Insert
+   //
+   custom::pair<iterator, bool> insert(const T & t);
+
+   //
+   // Remove
+   //
+   iterator erase(const T & t);
+   void clear() noexcept;
+
+   //
+   // Status
+   //
+   size_t size()     const { return pBig ? pBig->size() : numInline; }
+   bool   empty()    const { return size() == 0;                      }
+   bool   is_small() const { return pBig == nullptr;                  }
+
+private:
+   T * data() { return reinterpret_cast<T *>(storage); }
+   void promote();
+
+   alignas(T) unsigned char storage[sizeof(T) * N];   // the inline elements
+   size_t numInline;                                  // how many are inline
+   Big * pBig;                                        // the hash, once we grow
+};
+
+/************************************************
+ * SMALL UNORDERED SET ITERATOR
+ * A pointer into the inline array, or an iterator
+ * through the hash. Which one depends on which form
+ * the set was in when the iterator was made.
+ ************************************************/
+template <typename T, size_t N, typename A, typename Bucket>
+class small_unordered_set <T, N, A, Bucket> ::iterator
+{
+   friend class ::TestSmallSet;   // give unit tests access to the privates
+   template <class TT, size_t NN, class AA, class BB>
+   friend class custom::small_unordered_set;
+public:
+   //
+   // Construct
+   //
+   iterator() : p(nullptr) {}
+   iterator(T * p) : p(p) {}
+   iterator(const typename Big::iterator & itBig) : p(nullptr), itBig(itBig) {}
+
+   //
+   // Compare
+   //
+   bool operator == (const iterator & rhs) const
+   {
+      return p ? p == rhs.p : (rhs.p == nullptr && itBig == rhs.itBig);
+   }
+   bool operator != (const iterator & rhs) const
+   {
+      return !(*this == rhs);
+   }
+
+   //
+   // Access
+   //
+   T & operator * ()
+   {
+      return p ? *p : *itBig;
+   }
+
+   //
+   // Arithmetic
+   //
+   iterator & operator ++ ()
+   {
+      if (p)
+         ++p;
+      else
+         ++itBig;
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator tmp(*this);
+      ++*this;
+      return tmp;
+   }
+
+private:
+   T * p;                            // when small
+   typename Big::iterator itBig;     // when big
+};
+
+/*****************************************
+ * SMALL UNORDERED SET :: ASSIGN
+ * Copy whichever form rhs is in
+ ****************************************/
+template <typename T, size_t N, typename A, typename Bucket>
+small_unordered_set <T, N, A, Bucket> &
+small_unordered_set <T, N, A, Bucket> ::operator = (const small_unordered_set & rhs)
+{
+   if (this == &rhs)
+      return *this;
+   clear();
+
+   // unordered_set has no const iterator, but we only read rhs
+   small_unordered_set & src = const_cast<small_unordered_set &>(rhs);
+   if (src.pBig)
+      pBig = new Big(*src.pBig);
+   else
+   {
+      for (size_t i = 0; i < src.numInline; i++)
+         new (data() + i) T(src.data()[i]);
+      numInline = src.numInline;
+   }
+   return *this;
+}
+
+/*****************************************
+ * SMALL UNORDERED SET :: ASSIGN MOVE
+ * A big rhs hands over its hash; a small one can only
+ * move its elements one at a time
+ ****************************************/
+template <typename T, size_t N, typename A, typename Bucket>
+small_unordered_set <T, N, A, Bucket> &
+small_unordered_set <T, N, A, Bucket> ::operator = (small_unordered_set && rhs)
+{
+   if (this == &rhs)
+      return *this;
+   clear();
+
+   if (rhs.pBig)
+   {
+      pBig = rhs.pBig;
+      rhs.pBig = nullptr;
+   }
+   else
+   {
+      for (size_t i = 0; i < rhs.numInline; i++)
+         new (data() + i) T(std::move(rhs.data()[i]));
+      numInline = rhs.numInline;
+      rhs.clear();
+   }
+   return *this;
+}
+
+/*****************************************
+ * SMALL UNORDERED SET :: FIND
+ * A linear scan while small
+ *    COST   : O(N) while small, then whatever the hash costs
+ ****************************************/
+template <typename T, size_t N, typename A, typename Bucket>
+typename small_unordered_set <T, N, A, Bucket> ::iterator
+small_unordered_set <T, N, A, Bucket> ::find(const T & t)
+{
+   if (pBig)
+      return iterator(pBig->find(t));
+
+   T * p = data();
+   for (size_t i = 0; i < numInline; i++)
+      if (p[i] == t)
+         return iterator(p + i);
+   return end();
+}
+
+/*****************************************
+ * SMALL UNORDERED SET :: INSERT
+ * Append to the inline array while there is room. The
+ * element which does not fit moves everything into a hash.
+ ****************************************/
+template <typename T, size_t N, typename A, typename Bucket>
+custom::pair<typename small_unordered_set <T, N, A, Bucket> ::iterator, bool>
+small_unordered_set <T, N, A, Bucket> ::insert(const T & t)
+{
+   if (pBig == nullptr)
+   {
+      iterator it = find(t);
+      if (it != end())
+         return custom::pair<iterator, bool>(it, false);
+      if (numInline < N)
+      {
+         new (data() + numInline) T(t);
+         return custom::pair<iterator, bool>(iterator(data() + numInline++), true);
+      }
+      promote();
+   }
+
+   auto result = pBig->insert(t);
+   return custom::pair<iterator, bool>(iterator(result.first), result.second);
+}
+
+/*****************************************
+ * SMALL UNORDERED SET :: PROMOTE
+ * Move the inline elements into a new hash
+ ****************************************/
+template <typename T, size_t N, typename A, typename Bucket>
+void small_unordered_set <T, N, A, Bucket> ::promote()
+{
+   assert(pBig == nullptr);
+   Big * pNew = new Big;
+   for (size_t i = 0; i < numInline; i++)
+      pNew->insert(data()[i]);
+   clear();
+   pBig = pNew;
+}
+
+/*****************************************
+ * SMALL UNORDERED SET :: ERASE
+ * While small, the last element fills the hole
+ *    OUTPUT : the element after the one erased
+ ****************************************/
+template <typename T, size_t N, typename A, typename Bucket>
+typename small_unordered_set <T, N, A, Bucket> ::iterator
+small_unordered_set <T, N, A, Bucket> ::erase(const T & t)
+{
+   if (pBig)
+      return iterator(pBig->erase(t));
+
+   iterator it = find(t);
+   if (it == end())
+      return it;
+
+   T * pLast = data() + numInline - 1;
+   if (it.p != pLast)
+      *it.p = std::move(*pLast);
+   pLast->~T();
+   numInline--;
+   return it;
+}
+
+/*****************************************
+ * SMALL UNORDERED SET :: CLEAR
+ * Empty the set and go back to being small
+ ****************************************/
+template <typename T, size_t N, typename A, typename Bucket>
+void small_unordered_set <T, N, A, Bucket> ::clear() noexcept
+{
+   for (size_t i = 0; i < numInline; i++)
+      data()[i].~T();
+   numInline = 0;
+   delete pBig;
+   pBig = nullptr;
+}
+
+/*****************************************
+ * SWAP
+ * Stand-alone small unordered set swap
+ ****************************************/
+template <typename T, size_t N, typename A, typename Bucket>
+void swap(small_unordered_set<T, N, A, Bucket>& lhs, small_unordered_set<T, N, A, Bucket>& rhs)
+{
+   lhs.swap(rhs);
+}
+
+} // namespace custom
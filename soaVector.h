@@ -0,0 +1,219 @@
+/***********************************************************************
+ * Header:
+ *    SOA VECTOR
+ * Summary:
+ *    A vector of records stored as a structure of arrays: each field
+ *    of the record lives in its own contiguous column. A pass over
+ *    one field only brings that field's column through the cache,
+ *    and the column is a plain array the compiler can vectorize.
+ *
+ *    This will contain the class definition of:
+ *        soa_vector             : A vector of records, one column per field
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "vector.h"    // each column is a vector
+#include "span.h"      // a column is handed out as a span
+#include <cassert>     // because I am paranoid
+#include <tuple>       // a record is a tuple of fields
+#include <utility>     // for std::index_sequence
+
+class TestSoaVector;   // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************
+ * SOA VECTOR
+ * Like vector <std::tuple <Fields...>>, except that
+ * field I of every record is stored together in column I
+ ****************************************/
+template <typename... Fields>
+class soa_vector
+{
+   friend class ::TestSoaVector; // give unit tests access to the privates
+public:
+   typedef std::tuple<Fields...> value_type;
+   template <size_t I>
+   using field = typename std::tuple_element<I, value_type>::type;
+
+   //
+   // Construct
+   //
+
+   soa_vector() : numElements(0) {}
+
+   //
+   // Access
+   //
+
+   // every value of field I, in record order
+   template <size_t I>
+   span<field<I>> column()
+   {
+      return span<field<I>>(numElements ? &std::get<I>(columns)[0] : nullptr, numElements);
+   }
+   template <size_t I>
+   span<const field<I>> column() const
+   {
+      return span<const field<I>>(numElements ? &std::get<I>(columns)[0] : nullptr, numElements);
+   }
+
+   // field I of one record
+   template <size_t I>
+   field<I> & get(size_t index)
+   {
+      assert(index < numElements);
+      return std::get<I>(columns)[index];
+   }
+   template <size_t I>
+   const field<I> & get(size_t index) const
+   {
+      assert(index < numElements);
+      return std::get<I>(columns)[index];
+   }
+
+   // one whole record, as references into the columns
+   std::tuple<Fields&...> operator [] (size_t index)
+   {
+      assert(index < numElements);
+      return row(index, indices());
+   }
+
+   //
+   // Insert
+   //
+
+   void push_back(const value_type & t)
+   {
+      push_back(t, indices());
+   }
+   void push_back(value_type && t)
+   {
+      push_back(std::move(t), indices());
+   }
+   // one argument per field
+   template <class... Args>
+   void emplace_back(Args&&... args)
+   {
+      static_assert(sizeof...(Args) == sizeof...(Fields),
+                    "emplace_back takes one argument per field");
+      push_back(value_type(std::forward<Args>(args)...), indices());
+   }
+   void reserve(size_t newCapacity)
+   {
+      reserve(newCapacity, indices());
+   }
+   void resize(size_t newElements)
+   {
+      resize(newElements, indices());
+      numElements = newElements;
+   }
+
+   //
+   // Remove
+   //
+
+   void pop_back()
+   {
+      if (numElements)
+      {
+         pop_back(indices());
+         --numElements;
+      }
+   }
+   void clear()
+   {
+      clear(indices());
+      numElements = 0;
+   }
+
+   //
+   // Status
+   //
+
+   size_t size()     const { return numElements;      }
+   bool   empty()    const { return numElements == 0; }
+   size_t capacity() const { return std::get<0>(columns).capacity(); }
+
+private:
+   typedef std::index_sequence_for<Fields...> indices;
+
+   // apply the operation to every column, one field at a time
+   template <size_t... I>
+   std::tuple<Fields&...> row(size_t index, std::index_sequence<I...>)
+   {
+      return std::tuple<Fields&...>(std::get<I>(columns)[index]...);
+   }
+   // if one column throws, the columns before it give their new
+   // element back so every column stays numElements long
+   template <size_t... I>
+   void push_back(const value_type & t, std::index_sequence<I...>)
+   {
+      try
+      {
+         (std::get<I>(columns).push_back(std::get<I>(t)), ...);
+      }
+      catch (...)
+      {
+         trim(indices());
+         throw;
+      }
+      numElements++;
+   }
+   template <size_t... I>
+   void push_back(value_type && t, std::index_sequence<I...>)
+   {
+      try
+      {
+         (std::get<I>(columns).push_back(std::move(std::get<I>(t))), ...);
+      }
+      catch (...)
+      {
+         trim(indices());
+         throw;
+      }
+      numElements++;
+   }
+   template <size_t... I>
+   void reserve(size_t newCapacity, std::index_sequence<I...>)
+   {
+      (std::get<I>(columns).reserve(newCapacity), ...);
+   }
+   template <size_t... I>
+   void resize(size_t newElements, std::index_sequence<I...>)
+   {
+      try
+      {
+         (std::get<I>(columns).resize(newElements), ...);
+      }
+      catch (...)
+      {
+         trim(indices());
+         throw;
+      }
+   }
+   template <size_t... I>
+   void trim(std::index_sequence<I...>)
+   {
+      (std::get<I>(columns).resize(numElements), ...);
+   }
+   template <size_t... I>
+   void pop_back(std::index_sequence<I...>)
+   {
+      (std::get<I>(columns).pop_back(), ...);
+   }
+   template <size_t... I>
+   void clear(std::index_sequence<I...>)
+   {
+      (std::get<I>(columns).clear(), ...);
+   }
+
+   std::tuple<vector<Fields>...> columns;   // one column per field
+   size_t numElements;                      // the number of records
+};
+
+} // namespace custom
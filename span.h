@@ -0,0 +1,72 @@
+/***********************************************************************
+ * Header:
+ *    SPAN
+ * Summary:
+ *    A view of a contiguous run of elements someone else owns:
+ *    just a pointer and a count
+ *
+ *    This will contain the class definition of:
+ *        span                   : A pointer and a number of elements
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>   // because I am paranoid
+#include <cstddef>   // for size_t
+
+namespace custom
+{
+
+/*****************************************
+ * SPAN
+ * Just like std::span <T> from C++20
+ ****************************************/
+template <typename T>
+class span
+{
+public:
+   //
+   // Construct
+   //
+
+   span() : pData(nullptr), numElements(0) {}
+   span(T * pData, size_t numElements) : pData(pData), numElements(numElements) {}
+   template <size_t N>
+   span(T (&array)[N]) : pData(array), numElements(N) {}
+
+   //
+   // Iterator
+   //
+
+   T * begin() const { return pData;               }
+   T * end()   const { return pData + numElements; }
+
+   //
+   // Access
+   //
+
+   T & operator [] (size_t index) const
+   {
+      assert(index < numElements);
+      return pData[index];
+   }
+   T & front() const { assert(numElements > 0); return pData[0];               }
+   T & back()  const { assert(numElements > 0); return pData[numElements - 1]; }
+   T * data()  const { return pData; }
+
+   //
+   // Status
+   //
+
+   size_t size()       const { return numElements;             }
+   size_t size_bytes() const { return numElements * sizeof(T); }
+   bool   empty()      const { return numElements == 0;        }
+
+private:
+   T *    pData;         // the first element
+   size_t numElements;   // how many elements follow
+};
+
+} // namespace custom
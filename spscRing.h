@@ -0,0 +1,198 @@
+/***********************************************************************
+ * Header:
+ *    SPSC RING
+ * Summary:
+ *    A bounded queue between exactly one producer thread and one
+ *    consumer thread. The slots are a vector sized to a power of two
+ *    so a position is found with a mask rather than a divide.
+ *
+ *    Each side owns one index and only reads the other's when it must:
+ *    the producer remembers the last head it saw and only reloads it
+ *    when the ring looks full; the consumer does the same with the
+ *    tail when the ring looks empty. Each index, and each side's
+ *    cached copy of the other, sits on its own cache line, so in the
+ *    steady state neither core writes a line the other is reading.
+ *
+ *    This will contain the class definition of:
+ *        spsc_ring              : A single producer, single consumer ring
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "vector.h"     // for the slots
+#include "allocator.h"  // for aligned_allocator and CACHE_LINE_BYTES
+#include <atomic>       // for std::atomic
+#include <cassert>      // because I am paranoid
+#include <utility>      // for std::move
+
+class TestSpscRing;     // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * SPSC RING
+ * head and tail count every item ever popped and pushed;
+ * tail - head is the number waiting and (index & mask)
+ * is the slot.
+ **************************************************/
+template <typename T>
+class spsc_ring
+{
+   friend class ::TestSpscRing; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   spsc_ring(size_t numCapacity = 1024);
+
+   //
+   // Insert: the producer only
+   //
+
+   bool push(const T & t) { return push_n(&t, 1) == 1; }
+   bool push(T && t);
+   size_t push_n(const T * p, size_t num);
+
+   //
+   // Remove: the consumer only
+   //
+
+   bool pop(T & t) { return pop_n(&t, 1) == 1; }
+   size_t pop_n(T * p, size_t num);
+
+   //
+   // Status: either side, though the answer may be stale
+   //
+
+   size_t size() const
+   {
+      // head first: tail only grows, so it is never behind a head read earlier
+      size_t h = head.load(std::memory_order_acquire);
+      size_t t = tail.load(std::memory_order_acquire);
+      return t - h;
+   }
+   bool   empty()    const { return size() == 0;   }
+   size_t capacity() const { return mask + 1;      }
+
+private:
+   spsc_ring(const spsc_ring &) = delete;
+   spsc_ring & operator = (const spsc_ring &) = delete;
+
+   size_t room(size_t num);
+   size_t waiting(size_t num);
+
+   vector <T, growth_double, aligned_allocator<T>> slots;   // capacity() of them
+   size_t mask;                                             // capacity() - 1
+
+   // the producer's line: its index and its copy of the consumer's
+   alignas(CACHE_LINE_BYTES) std::atomic<size_t> tail;   // next slot to fill
+   size_t headCached;                                     // the head when last looked
+
+   // the consumer's line: its index and its copy of the producer's
+   alignas(CACHE_LINE_BYTES) std::atomic<size_t> head;   // next slot to empty
+   size_t tailCached;                                     // the tail when last looked
+};
+
+/*****************************************
+ * SPSC RING :: CONSTRUCTOR
+ * Round the capacity up to a power of two
+ ****************************************/
+template <typename T>
+spsc_ring <T> ::spsc_ring(size_t numCapacity)
+   : tail(0), headCached(0), head(0), tailCached(0)
+{
+   size_t num = 1;
+   while (num < numCapacity)
+      num *= 2;
+   slots.resize(num);
+   mask = num - 1;
+}
+
+/*****************************************
+ * SPSC RING :: ROOM
+ * How many of num items the producer may push now. The
+ * consumer's head is only read when the cached copy says
+ * there is not enough room.
+ ****************************************/
+template <typename T>
+size_t spsc_ring <T> ::room(size_t num)
+{
+   size_t t = tail.load(std::memory_order_relaxed);
+   if (capacity() - (t - headCached) < num)
+      headCached = head.load(std::memory_order_acquire);
+   size_t free = capacity() - (t - headCached);
+   return num < free ? num : free;
+}
+
+/*****************************************
+ * SPSC RING :: WAITING
+ * How many of num items the consumer may pop now. The
+ * producer's tail is only read when the cached copy says
+ * there are not enough.
+ ****************************************/
+template <typename T>
+size_t spsc_ring <T> ::waiting(size_t num)
+{
+   size_t h = head.load(std::memory_order_relaxed);
+   if (tailCached - h < num)
+      tailCached = tail.load(std::memory_order_acquire);
+   size_t ready = tailCached - h;
+   return num < ready ? num : ready;
+}
+
+/*****************************************
+ * SPSC RING :: PUSH
+ * Move one item in, if there is room
+ ****************************************/
+template <typename T>
+bool spsc_ring <T> ::push(T && t)
+{
+   if (room(1) == 0)
+      return false;
+   size_t i = tail.load(std::memory_order_relaxed);
+   slots[i & mask] = std::move(t);
+   tail.store(i + 1, std::memory_order_release);
+   return true;
+}
+
+/*****************************************
+ * SPSC RING :: PUSH N
+ * Copy in as many of num items as fit, then publish them
+ * all with a single store
+ *    OUTPUT : the number pushed
+ ****************************************/
+template <typename T>
+size_t spsc_ring <T> ::push_n(const T * p, size_t num)
+{
+   num = room(num);
+   size_t i = tail.load(std::memory_order_relaxed);
+   for (size_t j = 0; j < num; j++)
+      slots[(i + j) & mask] = p[j];
+   if (num)
+      tail.store(i + num, std::memory_order_release);
+   return num;
+}
+
+/*****************************************
+ * SPSC RING :: POP N
+ * Move out as many of num items as are waiting, then hand
+ * their slots back with a single store
+ *    OUTPUT : the number popped
+ ****************************************/
+template <typename T>
+size_t spsc_ring <T> ::pop_n(T * p, size_t num)
+{
+   num = waiting(num);
+   size_t i = head.load(std::memory_order_relaxed);
+   for (size_t j = 0; j < num; j++)
+      p[j] = std::move(slots[(i + j) & mask]);
+   if (num)
+      head.store(i + num, std::memory_order_release);
+   return num;
+}
+
+} // namespace custom
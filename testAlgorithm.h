@@ -0,0 +1,326 @@
+/***********************************************************************
+ * Header:
+ *    TEST ALGORITHM
+ * Summary:
+ *    Unit tests for the SIMD scans in algorithm.h
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "algorithm.h"
+#include "list.h"
+#include "unitTest.h"
+
+#include <algorithm>   // for std::find, std::count, std::min_element
+#include <cstdint>     // for int8_t and friends
+#include <limits>      // for std::numeric_limits
+
+class TestAlgorithm : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Find
+      test_find_int32EveryPosition();
+      test_find_int8EveryPosition();
+      test_find_int16Missing();
+      test_find_uint64EveryPosition();
+      test_find_doubleSignedZero();
+      test_find_doubleNaN();
+      test_find_valueNotRepresentable();
+      test_find_empty();
+
+      // Count
+      test_count_int32();
+      test_count_uint8Tags();
+
+      // Min and max
+      test_minElement_int8();
+      test_minElement_uint8();
+      test_maxElement_int32First();
+      test_maxElement_uint32();
+      test_minElement_empty();
+
+      // Containers
+      test_vector_find();
+      test_vector_minMax();
+      test_vector_iterators();
+      test_list_scalar();
+
+      report("Algorithm");
+   }
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every length and every position, on every level this CPU has
+   void test_find_int32EveryPosition()
+   {
+      bool same = true;
+      int32_t data[70];
+      for (int level = 0; level <= custom::simd::cpu_level(); level++)
+         for (size_t num = 0; num <= 70; num++)
+            for (size_t pos = 0; pos <= num; pos++)
+            {
+               for (size_t i = 0; i < num; i++)
+                  data[i] = (int32_t)i + 100;
+               if (pos < num)
+                  data[pos] = -7;
+               size_t index = custom::simd::find(data, num, (int32_t)-7,
+                                                 (custom::simd::level)level);
+               same = same && index == pos;
+            }
+      assertUnit(same);
+   }
+
+   // bytes: the lane size of a flat hash table tag array
+   void test_find_int8EveryPosition()
+   {
+      bool same = true;
+      int8_t data[100];
+      for (int level = 0; level <= custom::simd::cpu_level(); level++)
+         for (size_t pos = 0; pos < 100; pos++)
+         {
+            for (size_t i = 0; i < 100; i++)
+               data[i] = (int8_t)(i % 50);
+            data[pos] = -1;
+            size_t index = custom::simd::find(data, 100, (int8_t)-1,
+                                              (custom::simd::level)level);
+            same = same && index == pos;
+         }
+      assertUnit(same);
+   }
+
+   // a missing value is the length
+   void test_find_int16Missing()
+   {
+      int16_t data[37];
+      for (size_t i = 0; i < 37; i++)
+         data[i] = (int16_t)i;
+      for (int level = 0; level <= custom::simd::cpu_level(); level++)
+         assertUnit(custom::simd::find(data, 37, (int16_t)99,
+                                       (custom::simd::level)level) == 37);
+      assertUnit(custom::find(data, data + 37, 99) == data + 37);
+   }
+
+   // 64-bit lanes, including values that only differ in the high half
+   void test_find_uint64EveryPosition()
+   {
+      bool same = true;
+      uint64_t data[19];
+      for (int level = 0; level <= custom::simd::cpu_level(); level++)
+         for (size_t pos = 0; pos < 19; pos++)
+         {
+            for (size_t i = 0; i < 19; i++)
+               data[i] = ((uint64_t)(i + 1) << 32) | 5;
+            data[pos] = 5;
+            size_t index = custom::simd::find(data, 19, (uint64_t)5,
+                                              (custom::simd::level)level);
+            same = same && index == pos;
+         }
+      assertUnit(same);
+   }
+
+   // floating point compares values, not bits: 0.0 == -0.0
+   void test_find_doubleSignedZero()
+   {
+      double data[] = { 1.5, 2.5, 3.5, 4.5, -0.0, 6.5, 7.5 };
+      assertUnit(custom::find(data, data + 7, 0.0) == data + 4);
+      assertUnit(custom::count(data, data + 7, 0.0) == 1);
+   }
+
+   // NaN is never equal to anything, even itself
+   void test_find_doubleNaN()
+   {
+      double nan = std::numeric_limits<double>::quiet_NaN();
+      double data[] = { 1.0, nan, 3.0, nan, 5.0 };
+      assertUnit(custom::find(data, data + 5, nan) == data + 5);
+      assertUnit(custom::count(data, data + 5, nan) == 0);
+   }
+
+   // 2.5 is not an int, so it matches no int
+   void test_find_valueNotRepresentable()
+   {
+      int data[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+      assertUnit(custom::find(data, data + 10, 2.5) == data + 10);
+      assertUnit(custom::find(data, data + 10, 3.0) == data + 2);
+   }
+
+   // nothing to find in an empty range
+   void test_find_empty()
+   {
+      int * p = nullptr;
+      assertUnit(custom::find(p, p, 3) == p);
+      assertUnit(custom::count(p, p, 3) == 0);
+      assertUnit(!custom::contains(p, p, 3));
+   }
+
+   /***************************************
+    * COUNT
+    ***************************************/
+
+   // count matches the standard library
+   void test_count_int32()
+   {
+      int32_t data[101];
+      for (size_t i = 0; i < 101; i++)
+         data[i] = (int32_t)(i % 7);
+      bool same = true;
+      for (int level = 0; level <= custom::simd::cpu_level(); level++)
+         for (int32_t value = 0; value < 8; value++)
+            same = same && custom::simd::count(data, 101, value, (custom::simd::level)level) ==
+                           (size_t)std::count(data, data + 101, value);
+      assertUnit(same);
+   }
+
+   // count empty slots in a tag array
+   void test_count_uint8Tags()
+   {
+      uint8_t tags[64] = {};
+      tags[3] = 0x81;
+      tags[40] = 0x92;
+      tags[63] = 0xA3;
+      assertUnit(custom::count(tags, tags + 64, (uint8_t)0) == 61);
+      assertUnit(custom::contains(tags, tags + 64, (uint8_t)0x92));
+      assertUnit(!custom::contains(tags, tags + 64, (uint8_t)0x93));
+   }
+
+   /***************************************
+    * MIN and MAX
+    ***************************************/
+
+   // signed bytes: -128 is the smallest
+   void test_minElement_int8()
+   {
+      int8_t data[77];
+      for (size_t i = 0; i < 77; i++)
+         data[i] = (int8_t)(i + 1);
+      data[50] = -128;
+      assertUnit(custom::min_element(data, data + 77) == data + 50);
+      assertUnit(custom::max_element(data, data + 77) == data + 76);
+   }
+
+   // unsigned bytes: 0xFF is the largest, not -1
+   void test_minElement_uint8()
+   {
+      uint8_t data[77];
+      for (size_t i = 0; i < 77; i++)
+         data[i] = (uint8_t)(i + 10);
+      data[33] = 0xFF;
+      data[60] = 2;
+      bool same = true;
+      for (int level = 0; level <= custom::simd::cpu_level(); level++)
+      {
+         same = same && custom::simd::extreme<false>(data, 77, (custom::simd::level)level) == 60;
+         same = same && custom::simd::extreme<true>(data, 77, (custom::simd::level)level) == 33;
+      }
+      assertUnit(same);
+   }
+
+   // ties go to the first
+   void test_maxElement_int32First()
+   {
+      int32_t data[41];
+      for (size_t i = 0; i < 41; i++)
+         data[i] = (int32_t)(i % 10);
+      assertUnit(custom::max_element(data, data + 41) == data + 9);
+      assertUnit(custom::min_element(data, data + 41) == data + 0);
+   }
+
+   // unsigned 32-bit values above INT_MAX
+   void test_maxElement_uint32()
+   {
+      uint32_t data[23];
+      for (size_t i = 0; i < 23; i++)
+         data[i] = (uint32_t)i;
+      data[17] = 0x80000000u;
+      bool same = true;
+      for (int level = 0; level <= custom::simd::cpu_level(); level++)
+         same = same && custom::simd::extreme<true>(data, 23, (custom::simd::level)level) == 17;
+      assertUnit(same);
+      assertUnit(*std::max_element(data, data + 23) == *custom::max_element(data, data + 23));
+   }
+
+   // the smallest of nothing is the end
+   void test_minElement_empty()
+   {
+      int * p = nullptr;
+      assertUnit(custom::min_element(p, p) == p);
+      assertUnit(custom::max_element(p, p) == p);
+   }
+
+   /***************************************
+    * CONTAINERS
+    ***************************************/
+
+   // the vector overloads scan the buffer
+   void test_vector_find()
+   {  // setup
+      custom::vector<int> v;
+      for (int i = 0; i < 100; i++)
+         v.push_back(i * 3);
+      // exercise
+      custom::vector<int>::iterator it = custom::find(v, 81);
+      // verify
+      assertUnit(it != v.end());
+      assertUnit(*it == 81);
+      assertUnit(custom::find(v, 82) == v.end());
+      assertUnit(custom::count(v, 27) == 1);
+      assertUnit(custom::contains(v, 297));
+      assertUnit(!custom::contains(v, 298));
+   }  // teardown
+
+   // min and max of a vector
+   void test_vector_minMax()
+   {  // setup
+      custom::vector<short> v{ 26, 49, -67, 89, 12, 89 };
+      custom::vector<short> vEmpty;
+      // exercise and verify
+      assertUnit(*custom::min_element(v) == -67);
+      assertUnit(*custom::max_element(v) == 89);
+      assertUnit(custom::min_element(vEmpty) == vEmpty.end());
+   }  // teardown
+
+   // vector iterators are unwrapped to pointers and take the SIMD path
+   void test_vector_iterators()
+   {  // setup
+      custom::vector<int> v;
+      for (int i = 0; i < 100; i++)
+         v.push_back(i % 10 == 3 ? -1 : i);
+      custom::vector<int> vEmpty;
+      typedef custom::vector<int>::iterator Iterator;
+      // exercise
+      Iterator it = custom::find(v.begin(), v.end(), -1);
+      // verify
+      assertUnit(custom::simd::contiguous<Iterator>::value);
+      assertUnit(!custom::simd::contiguous<custom::list<int>::iterator>::value);
+      assertUnit(it != v.end());
+      assertUnit(to_address(it) == &v[3]);
+      assertUnit(custom::count(v.begin(), v.end(), -1) == 10);
+      assertUnit(custom::find(v.begin(), v.end(), 1000) == v.end());
+      assertUnit(to_address(custom::min_element(v.begin(), v.end())) == &v[3]);
+      assertUnit(to_address(custom::max_element(v.begin(), v.end())) == &v[99]);
+      assertUnit(custom::find(vEmpty.begin(), vEmpty.end(), 7) == vEmpty.end());
+      assertUnit(custom::max_element(vEmpty.begin(), vEmpty.end()) == vEmpty.end());
+   }  // teardown
+
+   // anything that is not contiguous gets the scalar loop
+   void test_list_scalar()
+   {  // setup
+      custom::list<int> l{ 26, 49, 67, 89 };
+      // exercise and verify
+      assertUnit(*custom::find(l.begin(), l.end(), 67) == 67);
+      assertUnit(custom::count(l.begin(), l.end(), 49) == 1);
+      assertUnit(*custom::min_element(l.begin(), l.end()) == 26);
+      assertUnit(*custom::max_element(l.begin(), l.end()) == 89);
+   }  // teardown
+};
+
+#endif // DEBUG
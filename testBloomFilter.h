@@ -0,0 +1,271 @@
+/***********************************************************************
+ * Header:
+ *    TEST BLOOM FILTER
+ * Summary:
+ *    Unit tests for blocked_bloom_filter and filtered_set
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "bloomFilter.h"
+#include "cuckooSet.h"
+#include "unitTest.h"
+
+class TestBloomFilter : public UnitTest
+{
+public:
+   typedef custom::blocked_bloom_filter<int> Filter;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_sized();
+      test_construct_badRate();
+
+      // Insert
+      test_insert_oneBlock();
+      test_insert_noFalseNegatives();
+      test_insert_falsePositiveRate();
+
+      // Kernels
+      test_kernels_agree();
+
+      // Remove
+      test_clear_standard();
+
+      // Filtered set
+      test_filtered_findHit();
+      test_filtered_findMissSkipsSet();
+      test_filtered_eraseThenRebuild();
+      test_filtered_cuckoo();
+
+      report("BloomFilter");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // 1000 elements at 1% is about 12,000 bits: 47 blocks of 256
+   void test_construct_sized()
+   {  // setup
+      // exercise
+      Filter f(1000, 0.01);
+      // verify
+      assertUnit(f.block_count() == 47);
+      assertUnit(f.bytes() == 47 * 32);
+      assertUnit(sizeof(Filter::Block) == 32);
+      assertUnit((size_t)&f.blocks[0] % 32 == 0);
+      assertUnit(countBits(f) == 0);
+   }  // teardown
+
+   // a rate of 0 or 1 makes no sense
+   void test_construct_badRate()
+   {  // setup
+      bool thrown = false;
+      // exercise
+      try
+      {
+         Filter f(1000, 0.0);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // one element sets one bit in each word of one block
+   void test_insert_oneBlock()
+   {  // setup
+      Filter f(1000, 0.01);
+      // exercise
+      f.insert(26);
+      // verify
+      assertUnit(countBits(f) == 8);
+      size_t iBlock = f.block_of(f.hash_of(26));
+      bool oneEach = true;
+      for (size_t i = 0; i < 8; i++)
+         oneEach = oneEach && countBits(f.blocks[iBlock].words[i]) == 1;
+      assertUnit(oneEach);
+      assertUnit(f.contains(26));
+   }  // teardown
+
+   // everything inserted is always found, on every level
+   void test_insert_noFalseNegatives()
+   {  // setup
+      Filter f(10000, 0.01);
+      // exercise
+      for (int i = 0; i < 10000; i++)
+         f.insert(i * 3);
+      // verify
+      bool all = true;
+      for (int level = 0; level <= custom::simd::cpu_level(); level++)
+         for (int i = 0; i < 10000; i++)
+            all = all && f.contains(i * 3, (custom::simd::level)level);
+      assertUnit(all);
+   }  // teardown
+
+   // the rate we get is near the rate we asked for
+   void test_insert_falsePositiveRate()
+   {  // setup
+      Filter f(10000, 0.01);
+      for (int i = 0; i < 10000; i++)
+         f.insert(i * 3);
+      // exercise
+      size_t numFalse = 0;
+      for (int i = 0; i < 100000; i++)
+         if (f.contains(i * 3 + 1))
+            numFalse++;
+      // verify
+      assertUnit(numFalse < 2000);
+      assertUnit(numFalse > 0);
+   }  // teardown
+
+   /***************************************
+    * KERNELS
+    ***************************************/
+
+   // the scalar and SIMD kernels set and test the same bits
+   void test_kernels_agree()
+   {  // setup
+      alignas(32) uint32_t scalar[8] = {};
+      alignas(32) uint32_t simd[8] = {};
+      bool same = true;
+      // exercise
+      for (uint32_t pattern = 1; pattern < 100000; pattern += 997)
+      {
+         custom::simd::bloom_insert_scalar(scalar, pattern);
+#ifdef CUSTOM_SIMD_X86
+         if (custom::simd::cpu_level() == custom::simd::AVX2)
+            custom::simd::bloom_insert_avx2(simd, pattern);
+         else
+#endif
+            custom::simd::bloom_insert_scalar(simd, pattern);
+      }
+      // verify
+      for (size_t i = 0; i < 8; i++)
+         same = same && scalar[i] == simd[i];
+      assertUnit(same);
+      assertUnit(custom::simd::bloom_contains_scalar(scalar, 997 + 1));
+      assertUnit(!custom::simd::bloom_contains_scalar(scalar, 0));
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // clear turns off every bit but keeps the blocks
+   void test_clear_standard()
+   {  // setup
+      Filter f(1000, 0.01);
+      for (int i = 0; i < 100; i++)
+         f.insert(i);
+      // exercise
+      f.clear();
+      // verify
+      assertUnit(countBits(f) == 0);
+      assertUnit(f.block_count() == 47);
+      assertUnit(!f.contains(26));
+   }  // teardown
+
+   /***************************************
+    * FILTERED SET
+    ***************************************/
+
+   // an element in the set is found through the filter
+   void test_filtered_findHit()
+   {  // setup
+      custom::filtered_set<int> s(100);
+      s.insert(26);
+      s.insert(49);
+      // exercise
+      custom::filtered_set<int>::iterator it = s.find(49);
+      // verify
+      assertUnit(it != s.end());
+      assertUnit(*it == 49);
+      assertUnit(s.size() == 2);
+      assertUnit(s.filtered() == 0);
+   }  // teardown
+
+   // misses mostly stop at the filter
+   void test_filtered_findMissSkipsSet()
+   {  // setup
+      custom::filtered_set<int> s(100, 0.01);
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      // exercise
+      size_t numFound = 0;
+      for (int i = 1000; i < 2000; i++)
+         numFound += s.count(i);
+      // verify
+      assertUnit(numFound == 0);
+      assertUnit(s.filtered() > 950);
+   }  // teardown
+
+   // an erased element stays in the filter until rebuild
+   void test_filtered_eraseThenRebuild()
+   {  // setup
+      custom::filtered_set<int> s(100);
+      s.insert(26);
+      s.insert(49);
+      s.erase(26);
+      assertUnit(s.filter.contains(26));
+      assertUnit(s.count(26) == 0);
+      // exercise
+      s.rebuild();
+      // verify
+      assertUnit(!s.filter.contains(26));
+      assertUnit(s.filter.contains(49));
+      assertUnit(s.count(49) == 1);
+   }  // teardown
+
+   // any set with find, insert and erase can sit behind the filter
+   void test_filtered_cuckoo()
+   {  // setup
+      custom::filtered_set<int, custom::cuckoo_set<int>> s(1000);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert(i * 7);
+      // verify
+      bool all = true;
+      for (int i = 0; i < 1000; i++)
+         all = all && s.count(i * 7) == 1;
+      assertUnit(all);
+      assertUnit(s.count(1) == 0);
+      assertUnit(s.size() == 1000);
+   }  // teardown
+
+   /****************************************************************
+    * COUNT BITS
+    * The bits set in a word, or in the whole filter
+    ****************************************************************/
+   size_t countBits(uint32_t word)
+   {
+      size_t num = 0;
+      for (; word; word &= word - 1)
+         num++;
+      return num;
+   }
+   size_t countBits(const Filter& f)
+   {
+      size_t num = 0;
+      for (size_t i = 0; i < f.blocks.size(); i++)
+         for (size_t j = 0; j < 8; j++)
+            num += countBits(f.blocks[i].words[j]);
+      return num;
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,490 @@
+/***********************************************************************
+ * Header:
+ *    TEST CUCKOO SET
+ * Summary:
+ *    Unit tests for cuckoo_set
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "cuckooSet.h"
+#include "unitTest.h"
+
+#include <string>
+#include <vector>
+
+class TestCuckooSet : public UnitTest
+{
+public:
+   typedef custom::cuckoo_set<int> Set;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_roundsBuckets();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+
+      // Hash
+      test_bucket_oneCacheLine();
+      test_alternate_symmetric();
+
+      // Insert
+      test_insert_standard();
+      test_insert_duplicate();
+      test_insert_displaceOne();
+      test_insert_displaceTwo();
+      test_insert_stash();
+      test_insert_grows();
+      test_insert_collideThrows();
+      test_insert_manyStrings();
+
+      // Iterate
+      test_iterate_includesStash();
+
+      // Remove
+      test_erase_bucket();
+      test_erase_stash();
+      test_erase_missing();
+      test_clear_standard();
+
+      report("CuckooSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // eight empty buckets
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Set s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.bucket_count() == 8);
+      assertUnit(s.stash.size() == 0);
+      assertUnit(countIn(s, 0) == 0);
+      assertUnit(s.begin() == s.end());
+   }  // teardown
+
+   // the bucket count is always a power of two
+   void test_construct_roundsBuckets()
+   {  // setup
+      // exercise
+      Set s(5);
+      // verify
+      assertUnit(s.bucket_count() == 8);
+   }  // teardown
+
+   // a copy puts every element in the same slot
+   void test_constructCopy_standard()
+   {  // setup
+      Set sSrc(4);
+      setupStandardFixture(sSrc);
+      // exercise
+      Set sDes(sSrc);
+      // verify
+      assertStandardFixture(sDes);
+      assertStandardFixture(sSrc);
+      assertUnit(sDes.find(26).iBucket == sSrc.find(26).iBucket);
+      assertUnit(sDes.find(26).iSlot == sSrc.find(26).iSlot);
+   }  // teardown
+
+   // a move takes the buckets
+   void test_constructMove_standard()
+   {  // setup
+      Set sSrc(4);
+      setupStandardFixture(sSrc);
+      const void * pBuckets = sSrc.buckets;
+      // exercise
+      Set sDes(std::move(sSrc));
+      // verify
+      assertStandardFixture(sDes);
+      assertUnit(sDes.buckets == pBuckets);
+      assertUnit(sSrc.empty());
+   }  // teardown
+
+   /***************************************
+    * HASH
+    ***************************************/
+
+   // four ints and their tags fit in one line, and each bucket starts one
+   void test_bucket_oneCacheLine()
+   {  // setup
+      Set s;
+      // exercise
+      size_t bytes = sizeof(Set::Bucket);
+      size_t address = (size_t)s.buckets;
+      // verify
+      assertUnit(bytes == custom::CACHE_LINE_BYTES);
+      assertUnit(address % custom::CACHE_LINE_BYTES == 0);
+   }  // teardown
+
+   // an element's other bucket's other bucket is where it started
+   void test_alternate_symmetric()
+   {  // setup
+      Set s(64);
+      bool symmetric = true;
+      // exercise
+      for (size_t i = 0; i < 64; i++)
+         for (int tag = 1; tag < 256; tag++)
+            symmetric = symmetric &&
+               s.alternate(s.alternate(i, (unsigned char)tag), (unsigned char)tag) == i;
+      // verify
+      assertUnit(symmetric);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // each element goes in one of its two buckets
+   void test_insert_standard()
+   {  // setup
+      Set s(4);
+      // exercise
+      custom::pair<Set::iterator, bool> result = s.insert(26);
+      s.insert(49);
+      s.insert(67);
+      // verify
+      assertUnit(result.second);
+      assertUnit(*result.first == 26);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // the same element twice is found, not added
+   void test_insert_duplicate()
+   {  // setup
+      Set s(4);
+      setupStandardFixture(s);
+      // exercise
+      custom::pair<Set::iterator, bool> result = s.insert(49);
+      // verify
+      assertUnit(!result.second);
+      assertUnit(*result.first == 49);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // both buckets full: one element moves to its other bucket
+   //    bucket 0: [a a a a] each a can go to 2
+   //    bucket 1: [b b b b] each b can go to 0
+   void test_insert_displaceOne()
+   {  // setup
+      Set s(4);
+      int next = 0;
+      std::vector<int> keys;
+      for (int i = 0; i < 4; i++)
+         keys.push_back(keyFor(s, 0, 2, next));
+      for (int i = 0; i < 4; i++)
+         keys.push_back(keyFor(s, 1, 0, next));
+      for (int key : keys)
+         s.insert(key);
+      assertUnit(countIn(s, 0) == 4 && countIn(s, 1) == 4);
+      int key = keyFor(s, 0, 1, next);
+      // exercise
+      custom::pair<Set::iterator, bool> result = s.insert(key);
+      // verify
+      assertUnit(result.second);
+      assertUnit(result.first.iBucket == 0);
+      assertUnit(countIn(s, 2) == 1);
+      assertUnit(s.stash.size() == 0);
+      keys.push_back(key);
+      assertUnit(allFound(s, keys));
+   }  // teardown
+
+   // the shortest chain is two moves long
+   //    bucket 0: [a a a a] each a can go to 2
+   //    bucket 1: [b b b b] each b can go to 0
+   //    bucket 2: [c c c c] each c can go to 3
+   void test_insert_displaceTwo()
+   {  // setup
+      Set s(4);
+      int next = 0;
+      std::vector<int> keys;
+      for (int i = 0; i < 4; i++)
+         keys.push_back(keyFor(s, 0, 2, next));
+      for (int i = 0; i < 4; i++)
+         keys.push_back(keyFor(s, 1, 0, next));
+      for (int i = 0; i < 4; i++)
+         keys.push_back(keyFor(s, 2, 3, next));
+      for (int key : keys)
+         s.insert(key);
+      int key = keyFor(s, 0, 1, next);
+      // exercise
+      custom::pair<Set::iterator, bool> result = s.insert(key);
+      // verify
+      assertUnit(result.first.iBucket == 0);
+      assertUnit(countIn(s, 0) == 4);
+      assertUnit(countIn(s, 2) == 4);
+      assertUnit(countIn(s, 3) == 1);
+      assertUnit(s.stash.size() == 0);
+      keys.push_back(key);
+      assertUnit(allFound(s, keys));
+   }  // teardown
+
+   // no chain leaves buckets 0 and 1, so the ninth goes to the stash
+   void test_insert_stash()
+   {  // setup
+      Set s(4);
+      int next = 0;
+      std::vector<int> keys;
+      for (int i = 0; i < 9; i++)
+         keys.push_back(keyFor(s, 0, 1, next));
+      // exercise
+      for (int key : keys)
+         s.insert(key);
+      // verify
+      assertUnit(s.stash.size() == 1);
+      assertUnit(s.bucket_count() == 4);
+      assertUnit(s.size() == 9);
+      assertUnit(s.find(keys[8]).iBucket == s.bucket_count());
+      assertUnit(allFound(s, keys));
+   }  // teardown
+
+   // a full stash doubles the buckets
+   void test_insert_grows()
+   {  // setup
+      Set s(4);
+      int next = 0;
+      std::vector<int> keys;
+      for (int i = 0; i < 13; i++)
+         keys.push_back(keyFor(s, 0, 1, next));
+      // exercise
+      for (int key : keys)
+         s.insert(key);
+      // verify
+      assertUnit(s.bucket_count() >= 8);
+      assertUnit(s.size() == 13);
+      assertUnit(allFound(s, keys));
+   }  // teardown
+
+   // with every hash the same, the thirteenth cannot fit at any
+   // size, so insert throws without growing and loses nothing
+   void test_insert_collideThrows()
+   {  // setup
+      struct Same
+      {
+         size_t operator()(int) const { return 42; }
+      };
+      custom::cuckoo_set<int, Same> s(4);
+      for (int i = 0; i < 12; i++)
+         s.insert(i);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         s.insert(12);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(s.bucket_count() == 4);
+      assertUnit(s.size() == 12);
+      bool all = true;
+      for (int i = 0; i < 12; i++)
+         all = all && s.count(i) == 1;
+      assertUnit(all);
+      assertUnit(s.count(12) == 0);
+   }  // teardown
+
+   // lots of elements which own memory
+   void test_insert_manyStrings()
+   {  // setup
+      custom::cuckoo_set<std::string> s;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert(std::to_string(i));
+      // verify
+      assertUnit(s.size() == 1000);
+      bool all = true;
+      for (int i = 0; i < 1000; i++)
+         all = all && s.count(std::to_string(i)) == 1;
+      assertUnit(all);
+      assertUnit(s.count("1000") == 0);
+      assertUnit(s.load_factor() > 0.45);
+   }  // teardown
+
+   /***************************************
+    * ITERATE
+    ***************************************/
+
+   // visit every element once, the stash last
+   void test_iterate_includesStash()
+   {  // setup
+      Set s(4);
+      int next = 0;
+      int sum = 0;
+      for (int i = 0; i < 10; i++)
+      {
+         int key = keyFor(s, 0, 1, next);
+         s.insert(key);
+         sum += key;
+      }
+      assertUnit(s.stash.size() == 2);
+      // exercise
+      int total = 0;
+      int count = 0;
+      for (Set::iterator it = s.begin(); it != s.end(); ++it)
+      {
+         total += *it;
+         count++;
+      }
+      // verify
+      assertUnit(count == 10);
+      assertUnit(total == sum);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erasing from a bucket clears the tag
+   void test_erase_bucket()
+   {  // setup
+      Set s(4);
+      setupStandardFixture(s);
+      Set::iterator it = s.find(49);
+      // exercise
+      s.erase(49);
+      // verify
+      assertUnit(s.size() == 2);
+      assertUnit(s.buckets[it.iBucket].tags[it.iSlot] == 0);
+      assertUnit(s.count(49) == 0);
+      assertUnit(s.count(26) == 1);
+      assertUnit(s.count(67) == 1);
+   }  // teardown
+
+   // erasing from the stash fills the hole with the last one
+   void test_erase_stash()
+   {  // setup
+      Set s(4);
+      int next = 0;
+      std::vector<int> keys;
+      for (int i = 0; i < 10; i++)
+      {
+         keys.push_back(keyFor(s, 0, 1, next));
+         s.insert(keys.back());
+      }
+      int inStash = s.stash[0];
+      // exercise
+      s.erase(inStash);
+      // verify
+      assertUnit(s.stash.size() == 1);
+      assertUnit(s.size() == 9);
+      assertUnit(s.count(inStash) == 0);
+      bool rest = true;
+      for (int key : keys)
+         rest = rest && (key == inStash || s.count(key) == 1);
+      assertUnit(rest);
+   }  // teardown
+
+   // nothing to erase
+   void test_erase_missing()
+   {  // setup
+      Set s(4);
+      setupStandardFixture(s);
+      // exercise
+      Set::iterator it = s.erase(99);
+      // verify
+      assertUnit(it == s.end());
+      assertStandardFixture(s);
+   }  // teardown
+
+   // clear keeps the buckets
+   void test_clear_standard()
+   {  // setup
+      Set s(4);
+      setupStandardFixture(s);
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.bucket_count() == 4);
+      assertUnit(s.count(26) == 0);
+      assertUnit(s.begin() == s.end());
+   }  // teardown
+
+   /****************************************************************
+    * KEY FOR
+    * The next int, from next on, whose first bucket is home
+    * and whose second is other
+    ****************************************************************/
+   int keyFor(Set& s, size_t home, size_t other, int& next)
+   {
+      while (true)
+      {
+         int key = next++;
+         size_t hash = s.hash_of(key);
+         size_t i1 = s.index_of(hash);
+         if (i1 == home && s.alternate(i1, s.tag_of(hash)) == other)
+            return key;
+      }
+   }
+
+   /****************************************************************
+    * COUNT IN
+    * How many slots of a bucket are in use
+    ****************************************************************/
+   size_t countIn(Set& s, size_t iBucket)
+   {
+      size_t num = 0;
+      for (size_t i = 0; i < Set::SLOTS; i++)
+         if (s.buckets[iBucket].tags[i])
+            num++;
+      return num;
+   }
+
+   /****************************************************************
+    * ALL FOUND
+    * Is every key found in one of its own two buckets, or
+    * in the stash?
+    ****************************************************************/
+   bool allFound(Set& s, const std::vector<int>& keys)
+   {
+      for (int key : keys)
+      {
+         Set::iterator it = s.find(key);
+         if (it == s.end() || *it != key)
+            return false;
+         size_t hash = s.hash_of(key);
+         size_t i1 = s.index_of(hash);
+         size_t i2 = s.alternate(i1, s.tag_of(hash));
+         if (it.iBucket != i1 && it.iBucket != i2 && it.iBucket != s.bucket_count())
+            return false;
+      }
+      return true;
+   }
+
+   /****************************************************************
+    * Setup Standard Fixture
+    ****************************************************************/
+   void setupStandardFixture(Set& s)
+   {
+      s.insert(26);
+      s.insert(49);
+      s.insert(67);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    ****************************************************************/
+   void assertStandardFixtureParameters(Set& s, int line, const char* function)
+   {
+      assertIndirect(s.size() == 3);
+      assertIndirect(allFound(s, { 26, 49, 67 }));
+      assertIndirect(s.count(99) == 0);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,453 @@
+/***********************************************************************
+ * Header:
+ *    TEST DEQUE
+ * Summary:
+ *    Unit tests for deque
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "deque.h"
+#include "unitTest.h"
+
+#include <algorithm>   // for std::sort
+#include <string>
+
+class TestDeque : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_fill();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+
+      // Insert
+      test_pushback_empty();
+      test_pushfront_empty();
+      test_pushback_crossesBlock();
+      test_pushfront_crossesBlock();
+      test_push_addressesStable();
+      test_emplace_string();
+      test_emplace_throwsGivesBlockBack();
+
+      // Remove
+      test_popback_freesBlock();
+      test_popfront_freesBlock();
+      test_pop_empty();
+      test_queue_mapStaysSmall();
+      test_pop_keepsSpare();
+
+      // Iterator
+      test_iterator_standard();
+      test_iterator_randomAccess();
+      test_iterator_sort();
+
+      // Chunk
+      test_chunk_standard();
+
+      report("Deque");
+   }
+
+   static const size_t B = custom::deque<int>::BLOCK;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor, nothing allocated
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::deque<int> d;
+      // verify
+      assertEmptyFixture(d);
+      assertUnit(d.map.size() == 0);
+   }  // teardown
+
+   // fill constructor
+   void test_construct_fill()
+   {  // setup
+      // exercise
+      custom::deque<int> d(3, 99);
+      // verify
+      assertUnit(d.size() == 3);
+      assertUnit(d[0] == 99);
+      assertUnit(d[2] == 99);
+   }  // teardown
+
+   // copy an deque which spans two blocks
+   void test_constructCopy_standard()
+   {  // setup
+      custom::deque<int> dSrc;
+      setupStandardFixture(dSrc);
+      // exercise
+      custom::deque<int> dDes(dSrc);
+      // verify
+      assertStandardFixture(dDes);
+      assertStandardFixture(dSrc);
+      assertUnit(&dDes[0] != &dSrc[0]);
+   }  // teardown
+
+   // move steals the blocks
+   void test_constructMove_standard()
+   {  // setup
+      custom::deque<int> dSrc;
+      setupStandardFixture(dSrc);
+      int * pFront = &dSrc.front();
+      // exercise
+      custom::deque<int> dDes(std::move(dSrc));
+      // verify
+      assertStandardFixture(dDes);
+      assertEmptyFixture(dSrc);
+      assertUnit(&dDes.front() == pFront);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first push_back makes a map and one block, centered
+   void test_pushback_empty()
+   {  // setup
+      custom::deque<int> d;
+      // exercise
+      d.push_back(26);
+      // verify
+      assertUnit(d.size() == 1);
+      assertUnit(d.map.size() == 8);
+      assertUnit(d.iFront == 4 * B);
+      assertUnit(d.map[4] != nullptr);
+      assertUnit(numBlocks(d) == 1);
+      assertUnit(d.front() == 26);
+      assertUnit(d.back() == 26);
+   }  // teardown
+
+   // the first push_front goes into the block before the middle
+   void test_pushfront_empty()
+   {  // setup
+      custom::deque<int> d;
+      // exercise
+      d.push_front(26);
+      // verify
+      assertUnit(d.size() == 1);
+      assertUnit(d.iFront == 4 * B - 1);
+      assertUnit(d.map[3] != nullptr);
+      assertUnit(numBlocks(d) == 1);
+      assertUnit(d[0] == 26);
+   }  // teardown
+
+   // the element after a full block starts a new one
+   void test_pushback_crossesBlock()
+   {  // setup
+      custom::deque<int> d;
+      for (size_t i = 0; i < B; i++)
+         d.push_back((int)i);
+      assertUnit(numBlocks(d) == 1);
+      // exercise
+      d.push_back(-1);
+      // verify
+      assertUnit(numBlocks(d) == 2);
+      assertUnit(d.back() == -1);
+      assertUnit(d[B - 1] == (int)B - 1);
+   }  // teardown
+
+   // push_front past the front of the map grows the map
+   void test_pushfront_crossesBlock()
+   {  // setup
+      custom::deque<int> d;
+      // exercise
+      for (size_t i = 0; i < 5 * B; i++)
+         d.push_front((int)i);
+      // verify
+      assertUnit(d.size() == 5 * B);
+      assertUnit(d.map.size() == 16);
+      assertUnit(d.front() == (int)(5 * B - 1));
+      assertUnit(d.back() == 0);
+      bool same = true;
+      for (size_t i = 0; i < d.size(); i++)
+         same = same && d[i] == (int)(5 * B - 1 - i);
+      assertUnit(same);
+   }  // teardown
+
+   // growing at either end never moves an element
+   void test_push_addressesStable()
+   {  // setup
+      custom::deque<int> d;
+      d.push_back(26);
+      int * p = &d.front();
+      // exercise
+      for (size_t i = 0; i < 20 * B; i++)
+      {
+         d.push_back(1);
+         d.push_front(2);
+      }
+      // verify
+      assertUnit(&d[20 * B] == p);
+      assertUnit(*p == 26);
+   }  // teardown
+
+   // emplace constructs in place
+   void test_emplace_string()
+   {  // setup
+      custom::deque<std::string> d;
+      // exercise
+      d.emplace_back(3, 'b');
+      d.emplace_front("aa");
+      d.push_back(std::string("cc"));
+      // verify
+      assertUnit(d.size() == 3);
+      assertUnit(d[0] == "aa");
+      assertUnit(d[1] == "bbb");
+      assertUnit(d[2] == "cc");
+   }  // teardown
+
+   // a constructor which throws does not leave an empty block behind
+   void test_emplace_throwsGivesBlockBack()
+   {  // setup
+      struct Positive
+      {
+         Positive(int value) : value(value)
+         {
+            if (value < 0)
+               throw "ERROR: not positive";
+         }
+         int value;
+      };
+      custom::deque<Positive> d;
+      // exercise
+      bool thrown = false;
+      try
+      {
+         d.emplace_back(-1);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(d.empty());
+      bool anyBlock = false;
+      for (size_t i = 0; i < d.map.size(); i++)
+         anyBlock = anyBlock || d.map[i] != nullptr;
+      assertUnit(!anyBlock);
+      assertUnit(d.pSpare != nullptr);
+      assertUnit(d.emplace_front(5).value == 5);
+      assertUnit(d.pSpare == nullptr);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // popping the only element of the last block frees it
+   void test_popback_freesBlock()
+   {  // setup
+      custom::deque<int> d;
+      setupStandardFixture(d);
+      assertUnit(numBlocks(d) == 2);
+      // exercise
+      d.pop_back();
+      // verify
+      assertUnit(numBlocks(d) == 1);
+      assertUnit(d.size() == 2);
+      assertUnit(d.back() == 49);
+   }  // teardown
+
+   // back and forth across a block boundary reuses one block
+   void test_pop_keepsSpare()
+   {  // setup
+      custom::deque<int> d;
+      setupStandardFixture(d);
+      int * pBlock = d.map[d.iFront / B + 1];
+      // exercise
+      d.pop_back();
+      bool spare = d.pSpare == pBlock;
+      d.push_back(67);
+      // verify
+      assertUnit(spare);
+      assertUnit(d.pSpare == nullptr);
+      assertUnit(d.map[d.iFront / B + 1] == pBlock);
+      assertUnit(numBlocks(d) == 2);
+      assertStandardFixture(d);
+   }  // teardown
+
+   // popping the last element of the first block frees it
+   void test_popfront_freesBlock()
+   {  // setup
+      custom::deque<int> d;
+      setupStandardFixture(d);
+      // exercise
+      d.pop_front();
+      d.pop_front();
+      // verify
+      assertUnit(numBlocks(d) == 1);
+      assertUnit(d.size() == 1);
+      assertUnit(d.front() == 67);
+   }  // teardown
+
+   // nothing to pop, nothing to free
+   void test_pop_empty()
+   {  // setup
+      custom::deque<int> d;
+      d.push_back(26);
+      d.pop_front();
+      // exercise
+      d.pop_front();
+      d.pop_back();
+      // verify
+      assertEmptyFixture(d);
+      assertUnit(numBlocks(d) == 0);
+   }  // teardown
+
+   // a queue that drifts toward the back recenters rather than growing
+   void test_queue_mapStaysSmall()
+   {  // setup
+      custom::deque<int> d;
+      // exercise
+      for (size_t i = 0; i < 100 * B; i++)
+      {
+         d.push_back((int)i);
+         if (d.size() > 10)
+            d.pop_front();
+      }
+      // verify
+      assertUnit(d.size() == 10);
+      assertUnit(d.map.size() == 8);
+      assertUnit(numBlocks(d) <= 2);
+      assertUnit(d.back() == (int)(100 * B - 1));
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walk the standard fixture across the block boundary
+   void test_iterator_standard()
+   {  // setup
+      custom::deque<int> d;
+      setupStandardFixture(d);
+      // exercise
+      int sum = 0;
+      int count = 0;
+      for (auto it = d.begin(); it != d.end(); ++it)
+      {
+         sum += *it;
+         count++;
+      }
+      // verify
+      assertUnit(count == 3);
+      assertUnit(sum == 26 + 49 + 67);
+   }  // teardown
+
+   // jump around
+   void test_iterator_randomAccess()
+   {  // setup
+      custom::deque<int> d{ 11, 26, 31, 49, 67 };
+      // exercise
+      custom::deque<int>::iterator it = d.begin() + 3;
+      // verify
+      assertUnit(*it == 49);
+      assertUnit(it[-2] == 26);
+      assertUnit(d.end() - it == 2);
+      assertUnit(it > d.begin());
+      it -= 3;
+      assertUnit(it == d.begin());
+   }  // teardown
+
+   // random access iterators work with the standard algorithms
+   void test_iterator_sort()
+   {  // setup
+      custom::deque<int> d;
+      for (size_t i = 0; i < 3 * B; i++)
+         d.push_front((int)((i * 7919) % (3 * B)));
+      // exercise
+      std::sort(d.begin(), d.end());
+      // verify
+      bool sorted = true;
+      for (size_t i = 0; i < d.size(); i++)
+         sorted = sorted && d[i] == (int)i;
+      assertUnit(sorted);
+   }  // teardown
+
+   /***************************************
+    * CHUNK
+    ***************************************/
+
+   // each chunk is one block's worth of the deque
+   void test_chunk_standard()
+   {  // setup
+      custom::deque<int> d;
+      setupStandardFixture(d);
+      // exercise
+      size_t num = d.chunk_count();
+      custom::span<int> first = d.chunk(0);
+      custom::span<int> second = d.chunk(1);
+      // verify
+      assertUnit(num == 2);
+      assertUnit(first.size() == 2);
+      assertUnit(first[0] == 26);
+      assertUnit(first[1] == 49);
+      assertUnit(second.size() == 1);
+      assertUnit(second[0] == 67);
+   }  // teardown
+
+   /****************************************************************
+    * NUM BLOCKS
+    * How many blocks are allocated
+    ****************************************************************/
+   size_t numBlocks(const custom::deque<int>& d)
+   {
+      size_t num = 0;
+      for (size_t i = 0; i < d.map.size(); i++)
+         if (d.map[i])
+            num++;
+      return num;
+   }
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *   map[3]: [ ... | 26 | 49 ]   map[4]: [ 67 | ... ]
+    ****************************************************************/
+   void setupStandardFixture(custom::deque<int>& d)
+   {
+      d.push_back(67);
+      d.push_front(49);
+      d.push_front(26);
+   }
+
+   /****************************************************************
+    * Verify Empty Fixture
+    ****************************************************************/
+   void assertEmptyFixtureParameters(const custom::deque<int>& d, int line, const char* function)
+   {
+      assertIndirect(d.numElements == 0);
+      assertIndirect(d.size() == 0);
+      assertIndirect(d.empty());
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    ****************************************************************/
+   void assertStandardFixtureParameters(const custom::deque<int>& d, int line, const char* function)
+   {
+      assertIndirect(d.numElements == 3);
+      if (d.numElements == 3)
+      {
+         assertIndirect(d[0] == 26);
+         assertIndirect(d[1] == 49);
+         assertIndirect(d[2] == 67);
+      }
+   }
+};
+
+#endif // DEBUG
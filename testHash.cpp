@@ -11,11 +11,36 @@
 #define DEBUG   
 #endif
  //#undef DEBUG  // Remove this comment to disable unit tests
+ //#define BENCHMARK  // Remove this comment to run the benchmarks
+ //#define CUSTOM_HASH_STATS  // Remove this comment to count hash probes and comparisons
+ //#define CUSTOM_INSTRUMENT  // Remove this comment to record per-operation probes, allocations and latency
 
 #include "testSpy.h"       // for the pair unit tests
 #include "testPair.h"       // for the pair unit tests
 #include "testHash.h"       // for the hash unit tests
 #include "testList.h"       // for the list unit tests
+#include "testVector.h"     // for the vector unit tests
+#include "testMappedVector.h" // for the mapped vector unit tests
+#include "testAlgorithm.h"  // for the SIMD scan unit tests
+#include "testSoaVector.h"  // for the structure of arrays unit tests
+#include "testUnrolledList.h" // for the unrolled list unit tests
+#include "testIntrusive.h"  // for the intrusive container unit tests
+#include "testMpscQueue.h"  // for the MPSC queue unit tests
+#include "testSpscRing.h"   // for the SPSC ring unit tests
+#include "testDeque.h"      // for the deque unit tests
+#include "testLruCache.h"   // for the LRU cache unit tests
+#include "testShardedCache.h" // for the sharded cache unit tests
+#include "testSmallSet.h"   // for the small set unit tests
+#include "testCuckooSet.h"  // for the cuckoo set unit tests
+#include "testBloomFilter.h" // for the Bloom filter unit tests
+#include "testHashFunction.h" // for the hash function unit tests
+#include "testTreeBucket.h" // for the tree bucket unit tests
+#include "testMultiHash.h"  // for the multiset and multimap unit tests
+#include "testMappedSet.h"  // for the mapped set unit tests
+#include "testInstrument.h" // for the instrumentation unit tests
+#include "benchAllocator.h" // for the allocator benchmarks
+#include "benchQueue.h"     // for the queue benchmarks
+#include "benchHash.h"      // for the hash function benchmarks
 int Spy::counters[] = {};
 
 /**********************************************************************
@@ -29,8 +54,39 @@ int main()
    TestSpy().run();
    TestPair().run();
    TestList().run();
+   TestVector().run();
+   TestMappedVector().run();
+   TestAlgorithm().run();
+   TestSoaVector().run();
+   TestUnrolledList().run();
+   TestIntrusive().run();
+   TestMpscQueue().run();
+   TestSpscRing().run();
+   TestDeque().run();
+   TestLruCache().run();
+   TestShardedCache().run();
+   TestSmallSet().run();
+   TestCuckooSet().run();
+   TestBloomFilter().run();
+   TestHashFunction().run();
+   TestTreeBucket().run();
+   TestMultiHash().run();
+   TestMappedSet().run();
+   TestInstrument().run();
    TestHash().run();
 #endif // DEBUG
+
+#ifdef BENCHMARK
+   // benchmarks
+   BenchAllocator().run();
+   BenchQueue().run();
+   BenchHash().run();
+#endif // BENCHMARK
+
+#ifdef CUSTOM_INSTRUMENT
+   // what the containers did along the way
+   custom::instrument::dump(std::cout);
+#endif // CUSTOM_INSTRUMENT
    
    // driver
    return 0;
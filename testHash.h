@@ -12,12 +12,17 @@
 #ifdef DEBUG
 
 #include "hash.h"
+#include "hashFunction.h"
+#include "treeBucket.h"
+#include "unrolledList.h"
 #include "unitTest.h"
 
 #include <cassert>
 #include <memory>
 #include <unordered_set>
+#include <cstring>
 #include <functional>
+#include <sstream>
 #include <vector>
 
 using std::cout;
@@ -99,6 +104,41 @@ public:
       test_insert_standard3();
       test_insert_standard77();
       test_insert_standardDuplicate();
+      
+      // Allocator
+      test_allocator_alignedBuckets();
+      test_allocator_moveSteals();
+
+      // Bucket
+      test_bucket_unrolled();
+      test_bucket_unrolledCopy();
+      test_bucket_unrolledErase();
+      test_bucket_unrolledEraseMerges();
+      test_bucket_tree();
+      test_bucket_seeded();
+      test_bucket_mask();
+      test_bucket_fastrange();
+
+      // Save
+      test_save_size();
+      test_saveLoad_buffer();
+      test_saveLoad_stream();
+      test_saveLoad_seeded();
+      test_saveLoad_otherBucketCount();
+      test_saveLoad_otherReduce();
+      test_load_replaces();
+      test_load_notASet();
+      test_load_otherHasher();
+      test_load_truncated();
+      test_load_headerTooBig();
+      test_load_wrongCount();
+
+      // Stats
+      test_stats_empty();
+      test_stats_standard();
+      test_stats_longChain();
+      test_stats_unrolledBytes();
+      test_stats_counters();
      
       // Remove
       test_clear_empty();
@@ -1727,6 +1767,630 @@ public:
       assertUnit(p.second == false);
    }
    
+   /***************************************
+    * ALLOCATOR
+    ***************************************/
+   
+   // the bucket array comes from the allocator
+   void test_allocator_alignedBuckets()
+   {  // setup
+      custom::unordered_set<std::size_t, custom::aligned_allocator<std::size_t>> us;
+      // exercise
+      us.insert(31);
+      us.insert(67);
+      us.insert(59);
+      us.insert(49);
+      // verify
+      //      h[1] --> 31
+      //      h[7] --> 67
+      //      h[9] --> 59 49
+      assertUnit((std::size_t)us.buckets % custom::CACHE_LINE_BYTES == 0);
+      assertUnit(us.numElements == 4);
+      assertUnit(us.buckets[1].size() == 1);
+      assertUnit(us.buckets[7].size() == 1);
+      assertUnit(us.buckets[9].size() == 2);
+   }  // teardown
+   
+   // moving a set hands over its bucket array
+   void test_allocator_moveSteals()
+   {  // setup
+      custom::unordered_set<std::size_t> usSrc;
+      setupStandardFixture(usSrc);
+      custom::list<std::size_t> * pBuckets = usSrc.buckets;
+      // exercise
+      custom::unordered_set<std::size_t> usDes(std::move(usSrc));
+      // verify
+      assertUnit(usDes.buckets == pBuckets);
+      assertUnit(usSrc.buckets != pBuckets);
+      assertStandardFixture(usDes);
+      assertEmptyFixture(usSrc);
+   }  // teardown
+   
+   /***************************************
+    * BUCKET
+    ***************************************/
+
+   // unrolled buckets hold the colliding elements side by side
+   void test_bucket_unrolled()
+   {  // setup
+      custom::unordered_set<std::size_t, std::allocator<std::size_t>,
+                            custom::unrolled_list<std::size_t>> us;
+      // exercise
+      for (std::size_t i = 0; i < 100; i++)
+         us.insert(i);
+      us.insert(42);
+      us.erase(59);
+      // verify
+      assertUnit(us.size() == 99);
+      assertUnit(us.bucket_size(9) == 9);
+      assertUnit(us.bucket_size(2) == 10);
+      assertUnit(us.find(42) != us.end());
+      assertUnit(*us.find(42) == 42);
+      assertUnit(us.find(59) == us.end());
+      std::size_t count = 0;
+      std::size_t sum = 0;
+      for (auto it = us.begin(); it != us.end(); ++it)
+      {
+         count++;
+         sum += *it;
+      }
+      assertUnit(count == 99);
+      assertUnit(sum == 4950 - 59);
+   }  // teardown
+
+   // copying a set copies its unrolled buckets
+   void test_bucket_unrolledCopy()
+   {  // setup
+      custom::unordered_set<std::size_t, std::allocator<std::size_t>,
+                            custom::unrolled_list<std::size_t>> usSrc;
+      usSrc.insert(31);
+      usSrc.insert(49);
+      usSrc.insert(59);
+      // exercise
+      custom::unordered_set<std::size_t, std::allocator<std::size_t>,
+                            custom::unrolled_list<std::size_t>> usDes(usSrc);
+      // verify
+      //      h[1] --> 31
+      //      h[9] --> 49 59
+      assertUnit(usDes.size() == 3);
+      assertUnit(usDes.bucket_size(1) == 1);
+      assertUnit(usDes.bucket_size(9) == 2);
+      assertUnit(usDes.buckets[9].front() == 49);
+      assertUnit(usDes.buckets[9].back() == 59);
+      assertUnit(usSrc.bucket_size(9) == 2);
+   }  // teardown
+
+   // erase hands back the element that followed, even though an
+   // unrolled_list slides the rest of its node down to fill the gap
+   void test_bucket_unrolledErase()
+   {  // setup
+      //      h[3] --> [ 3 13 23 33 ]
+      //      h[4] --> [ 4 ]
+      custom::unordered_set<std::size_t, std::allocator<std::size_t>,
+                            custom::unrolled_list<std::size_t>> us;
+      us.insert(3);
+      us.insert(13);
+      us.insert(23);
+      us.insert(33);
+      us.insert(4);
+      // exercise
+      auto it = us.erase(13);
+      auto itLast = us.erase(33);
+      // verify
+      assertUnit(it != us.end());
+      assertUnit(*it == 23);
+      assertUnit(itLast != us.end());
+      assertUnit(*itLast == 4);
+      assertUnit(us.size() == 3);
+      assertUnit(us.erase(4) == us.end());
+   }  // teardown
+
+   // small nodes merge and borrow as they empty; the iterator returned
+   // still points at a live element
+   void test_bucket_unrolledEraseMerges()
+   {  // setup
+      //      h[0] --> [ 0 10 20 30 ] [ 40 50 ]
+      custom::unordered_set<std::size_t, std::allocator<std::size_t>,
+                            custom::unrolled_list<std::size_t, 4>> us;
+      for (std::size_t i = 0; i <= 50; i += 10)
+         us.insert(i);
+      // exercise
+      auto it0 = us.erase(0);
+      assertUnit(*it0 == 10);
+      auto it10 = us.erase(10);
+      assertUnit(*it10 == 20);
+      auto it30 = us.erase(30);
+      // verify
+      assertUnit(it30 != us.end());
+      assertUnit(*it30 == 40);
+      ++it30;
+      assertUnit(it30 != us.end());
+      assertUnit(*it30 == 50);
+      ++it30;
+      assertUnit(it30 == us.end());
+      assertUnit(us.size() == 3);
+   }  // teardown
+
+   // keys which all collide still find through a tree
+   void test_bucket_tree()
+   {  // setup
+      custom::unordered_set<int, std::allocator<int>, custom::tree_bucket<int>> us;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         us.insert(i * 10);
+      us.insert(420);
+      us.erase(590);
+      // verify
+      assertUnit(us.size() == 99);
+      assertUnit(us.bucket_size(0) == 99);
+      assertUnit(us.buckets[0].is_tree());
+      assertUnit(us.find(420) != us.end());
+      assertUnit(*us.find(420) == 420);
+      assertUnit(us.find(590) == us.end());
+      assertUnit(us.find(5) == us.end());
+      assertUnit(us.buckets[0].front() == 0);
+      assertUnit(us.buckets[0].back() == 990);
+   }  // teardown
+
+   // a seeded hash spreads keys which std::hash piles up
+   void test_bucket_seeded()
+   {  // setup
+      custom::unordered_set<int, std::allocator<int>, custom::list<int>,
+                            custom::seeded_hash<int>> us(custom::seeded_hash<int>(7));
+      // exercise
+      for (int i = 0; i < 100; i++)
+         us.insert(i * 10);
+      // verify
+      assertUnit(us.size() == 100);
+      assertUnit(us.bucket_size(0) < 30);
+      size_t numUsed = 0;
+      for (size_t i = 0; i < us.bucket_count(); i++)
+         if (us.bucket_size(i))
+            numUsed++;
+      assertUnit(numUsed == 10);
+      for (int i = 0; i < 100; i++)
+         assertUnit(us.find(i * 10) != us.end());
+   }  // teardown
+
+   // 16 buckets picked by a mask, after mixing
+   void test_bucket_mask()
+   {  // setup
+      custom::unordered_set<int, std::allocator<int>, custom::list<int>,
+                            std::hash<int>, custom::reduce_mask<16>> us;
+      // exercise
+      for (int i = 0; i < 160; i++)
+         us.insert(i * 16);
+      // verify
+      assertUnit(us.bucket_count() == 16);
+      assertUnit(us.size() == 160);
+      assertUnit(us.bucket(32) == (custom::mix_int(32) & 15));
+      for (size_t i = 0; i < 16; i++)
+      {
+         assertUnit(us.bucket_size(i) > 0);
+         assertUnit(us.bucket_size(i) < 30);
+      }
+      size_t count = 0;
+      for (auto it = us.begin(); it != us.end(); ++it)
+         count++;
+      assertUnit(count == 160);
+      assertUnit(us.find(16 * 77) != us.end());
+      assertUnit(us.find(16 * 77 + 1) == us.end());
+   }  // teardown
+
+   // 13 buckets picked by a multiply, after mixing
+   void test_bucket_fastrange()
+   {  // setup
+      custom::unordered_set<int, std::allocator<int>, custom::list<int>,
+                            std::hash<int>, custom::reduce_fastrange<13>> us;
+      // exercise
+      for (int i = 0; i < 130; i++)
+         us.insert(i * 13);
+      us.erase(13 * 5);
+      // verify
+      assertUnit(us.bucket_count() == 13);
+      assertUnit(us.size() == 129);
+      for (size_t i = 0; i < 13; i++)
+      {
+         assertUnit(us.bucket_size(i) > 0);
+         assertUnit(us.bucket_size(i) < 25);
+      }
+      assertUnit(us.find(13 * 5) == us.end());
+      assertUnit(us.find(13 * 6) != us.end());
+      assertUnit(custom::reduce_fastrange<13>::index((size_t)-1) < 13);
+   }  // teardown
+
+   /***************************************
+    * SAVE
+    ***************************************/
+
+   // a header, the hasher, a count per bucket and the elements
+   void test_save_size()
+   {  // setup
+      custom::unordered_set<int> us;
+      us.insert(31);
+      us.insert(49);
+      // exercise
+      size_t size = us.save_size();
+      std::vector<unsigned char> buffer(size);
+      size_t numWritten = us.save(buffer.data());
+      // verify
+      assertUnit(size == 40 + sizeof(std::hash<int>) + 10 * 8 + 2 * sizeof(int));
+      assertUnit(numWritten == size);
+   }  // teardown
+
+   // a loaded set has the same buckets in the same order
+   void test_saveLoad_buffer()
+   {  // setup
+      custom::unordered_set<int> usSrc;
+      for (int i = 0; i < 100; i += 3)
+         usSrc.insert(i);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      custom::unordered_set<int> usDes;
+      // exercise
+      usDes.load(buffer.data(), buffer.size());
+      // verify
+      assertUnit(usDes.size() == usSrc.size());
+      for (size_t i = 0; i < 10; i++)
+      {
+         assertUnit(usDes.bucket_size(i) == usSrc.bucket_size(i));
+         auto itSrc = usSrc.buckets[i].begin();
+         for (auto itDes = usDes.buckets[i].begin(); itDes != usDes.buckets[i].end(); ++itDes, ++itSrc)
+            assertUnit(*itDes == *itSrc);
+      }
+      assertUnit(usDes.find(99) != usDes.end());
+      assertUnit(usDes.find(98) == usDes.end());
+   }  // teardown
+
+   // through a stream and back
+   void test_saveLoad_stream()
+   {  // setup
+      custom::unordered_set<double> usSrc;
+      usSrc.insert(1.5);
+      usSrc.insert(-2.25);
+      usSrc.insert(1e100);
+      std::stringstream stream;
+      usSrc.save(stream);
+      custom::unordered_set<double> usDes;
+      // exercise
+      usDes.load(stream);
+      // verify
+      assertUnit(usDes.size() == 3);
+      assertUnit(usDes.find(1.5) != usDes.end());
+      assertUnit(usDes.find(-2.25) != usDes.end());
+      assertUnit(usDes.find(1e100) != usDes.end());
+      assertUnit(usDes.find(2.0) == usDes.end());
+   }  // teardown
+
+   // a seeded set comes back with its seed, so find still works
+   void test_saveLoad_seeded()
+   {  // setup
+      typedef custom::unordered_set<int, std::allocator<int>, custom::list<int>,
+                                    custom::seeded_hash<int>> Seeded;
+      Seeded usSrc;
+      for (int i = 0; i < 50; i++)
+         usSrc.insert(i * 10);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      Seeded usDes;
+      assertUnit(usDes.hasher.get_seed() != usSrc.hasher.get_seed());
+      // exercise
+      usDes.load(buffer.data(), buffer.size());
+      // verify
+      assertUnit(usDes.hasher.get_seed() == usSrc.hasher.get_seed());
+      for (int i = 0; i < 50; i++)
+         assertUnit(usDes.find(i * 10) != usDes.end());
+   }  // teardown
+
+   // saved with 10 buckets, loaded into 16: everything is hashed again
+   void test_saveLoad_otherBucketCount()
+   {  // setup
+      custom::unordered_set<int> usSrc;
+      for (int i = 0; i < 40; i++)
+         usSrc.insert(i);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      custom::unordered_set<int, std::allocator<int>, custom::list<int>,
+                            std::hash<int>, custom::reduce_mask<16>> usDes;
+      // exercise
+      usDes.load(buffer.data(), buffer.size());
+      // verify
+      assertUnit(usDes.size() == 40);
+      for (int i = 0; i < 40; i++)
+         assertUnit(usDes.find(i) != usDes.end());
+   }  // teardown
+
+   // the same ten buckets, but fastrange puts things elsewhere
+   void test_saveLoad_otherReduce()
+   {  // setup
+      custom::unordered_set<int> usSrc;
+      for (int i = 0; i < 40; i++)
+         usSrc.insert(i * 7);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      custom::unordered_set<int, std::allocator<int>, custom::list<int>,
+                            std::hash<int>, custom::reduce_fastrange<10>> usDes;
+      // exercise
+      usDes.load(buffer.data(), buffer.size());
+      // verify
+      assertUnit(usDes.size() == 40);
+      for (int i = 0; i < 40; i++)
+         assertUnit(usDes.find(i * 7) != usDes.end());
+   }  // teardown
+
+   // whatever was there before is gone
+   void test_load_replaces()
+   {  // setup
+      custom::unordered_set<int> usSrc;
+      usSrc.insert(1);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      custom::unordered_set<int> usDes;
+      usDes.insert(2);
+      usDes.insert(3);
+      // exercise
+      usDes.load(buffer.data(), buffer.size());
+      // verify
+      assertUnit(usDes.size() == 1);
+      assertUnit(usDes.find(1) != usDes.end());
+      assertUnit(usDes.find(2) == usDes.end());
+   }  // teardown
+
+   // the wrong bytes, or the wrong type, are refused
+   void test_load_notASet()
+   {  // setup
+      custom::unordered_set<int> usSrc;
+      usSrc.insert(1);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      custom::unordered_set<int> usDes;
+      custom::unordered_set<long long> usWrongType;
+      std::vector<unsigned char> garbage(buffer.size(), 0x5a);
+      bool thrownGarbage = false;
+      bool thrownType = false;
+      // exercise
+      try
+      {
+         usDes.load(garbage.data(), garbage.size());
+      }
+      catch (const char *)
+      {
+         thrownGarbage = true;
+      }
+      try
+      {
+         usWrongType.load(buffer.data(), buffer.size());
+      }
+      catch (const char *)
+      {
+         thrownType = true;
+      }
+      // verify
+      assertUnit(thrownGarbage);
+      assertUnit(thrownType);
+   }  // teardown
+
+   // a hasher of the same size but another type is refused
+   void test_load_otherHasher()
+   {  // setup
+      custom::unordered_set<int> usSrc;
+      usSrc.insert(1);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      custom::unordered_set<int, std::allocator<int>, custom::list<int>,
+                            custom::hash<int>> usDes;
+      usDes.insert(2);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         usDes.load(buffer.data(), buffer.size());
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(sizeof(custom::hash<int>) == sizeof(std::hash<int>));
+      assertUnit(thrown);
+      assertUnit(usDes.size() == 1);
+   }  // teardown
+
+   // a short buffer throws and leaves the set empty
+   void test_load_truncated()
+   {  // setup
+      custom::unordered_set<int> usSrc;
+      for (int i = 0; i < 20; i++)
+         usSrc.insert(i);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      custom::unordered_set<int> usDes;
+      usDes.insert(7);
+      std::stringstream stream;
+      stream.write((const char *)buffer.data(), (std::streamsize)buffer.size() - 4);
+      bool thrownBuffer = false;
+      bool thrownStream = false;
+      // exercise
+      try
+      {
+         usDes.load(buffer.data(), buffer.size() - 4);
+      }
+      catch (const char *)
+      {
+         thrownBuffer = true;
+      }
+      try
+      {
+         usDes.load(stream);
+      }
+      catch (const char *)
+      {
+         thrownStream = true;
+      }
+      // verify
+      assertUnit(thrownBuffer);
+      assertUnit(thrownStream);
+      assertUnit(usDes.empty());
+   }  // teardown
+
+   // a header claiming more than the stream holds is refused before
+   // anything is allocated for it
+   void test_load_headerTooBig()
+   {  // setup
+      custom::unordered_set<int> usSrc;
+      usSrc.insert(1);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      uint64_t numHuge = (uint64_t)1 << 60;
+      std::memcpy(buffer.data() + 24, &numHuge, sizeof(numHuge));   // numBuckets
+      std::stringstream stream;
+      stream.write((const char *)buffer.data(), (std::streamsize)buffer.size());
+      custom::unordered_set<int> usDes;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         usDes.load(stream);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(usDes.empty());
+   }  // teardown
+
+   // the buckets must add up to the count in the header
+   void test_load_wrongCount()
+   {  // setup
+      custom::unordered_set<int> usSrc;
+      usSrc.insert(1);
+      usSrc.insert(2);
+      std::vector<unsigned char> buffer(usSrc.save_size());
+      usSrc.save(buffer.data());
+      uint64_t numWrong = 1;
+      std::memcpy(buffer.data() + 32, &numWrong, sizeof(numWrong));   // numElements
+      custom::unordered_set<int> usDes;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         usDes.load(buffer.data(), buffer.size());
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(usDes.empty());
+   }  // teardown
+
+   /***************************************
+    * STATS
+    ***************************************/
+
+   // every bucket empty, nothing used but the array
+   void test_stats_empty()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      // exercise
+      custom::hash_stats s = us.stats();
+      // verify
+      assertUnit(s.size == 0);
+      assertUnit(s.buckets == 10);
+      assertUnit(s.load_factor == 0.0);
+      assertUnit(s.max_chain == 0);
+      assertUnit(s.mean_chain == 0.0);
+      assertUnit(s.empty_ratio == 1.0);
+      assertUnit(s.histogram[0] == 10);
+      assertUnit(s.bytes_buckets == 10 * sizeof(custom::list<std::size_t>));
+      assertUnit(s.bytes_nodes == 0);
+      assertUnit(s.rehashes == 0);
+   }  // teardown
+
+   // the standard fixture: three buckets used, one of them twice
+   void test_stats_standard()
+   {  // setup
+      //      h[1] --> 31
+      //      h[7] --> 67
+      //      h[9] --> 59 49
+      custom::unordered_set<std::size_t> us;
+      setupStandardFixture(us);
+      // exercise
+      custom::hash_stats s = us.stats();
+      // verify
+      assertUnit(s.size == 4);
+      assertUnit(s.load_factor == 0.4);
+      assertUnit(s.max_chain == 2);
+      assertUnit(s.mean_chain == 4.0 / 3.0);
+      assertUnit(s.empty_ratio == 0.7);
+      assertUnit(s.histogram[0] == 7);
+      assertUnit(s.histogram[1] == 2);
+      assertUnit(s.histogram[2] == 1);
+      assertUnit(s.histogram[3] == 0);
+      assertUnit(s.bytes_nodes == 4 * custom::list<std::size_t>::Node::stride());
+      assertStandardFixture(us);
+   }  // teardown
+
+   // a bucket longer than the histogram lands in its last bin
+   void test_stats_longChain()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      for (std::size_t i = 0; i < 20; i++)
+         us.insert(i * 10);
+      us.insert(1);
+      // exercise
+      custom::hash_stats s = us.stats();
+      // verify
+      assertUnit(s.max_chain == 20);
+      assertUnit(s.histogram[custom::hash_stats::HISTOGRAM - 1] == 1);
+      assertUnit(s.histogram[1] == 1);
+      assertUnit(s.histogram[0] == 8);
+      assertUnit(s.mean_chain == 10.5);
+   }  // teardown
+
+   // an unrolled bucket says what its nodes take, which is less than a
+   // list node per element
+   void test_stats_unrolledBytes()
+   {  // setup
+      custom::unordered_set<std::size_t, std::allocator<std::size_t>,
+                            custom::unrolled_list<std::size_t>> us;
+      for (std::size_t i = 0; i < 100; i++)
+         us.insert(i);
+      // exercise
+      custom::hash_stats s = us.stats();
+      // verify
+      size_t bytes = 0;
+      for (size_t i = 0; i < us.bucket_count(); i++)
+         bytes += us.buckets[i].bytes_nodes();
+      assertUnit(s.bytes_nodes == bytes);
+      assertUnit(s.bytes_nodes > 100 * sizeof(std::size_t));
+      assertUnit(s.bytes_nodes < 100 * custom::list<std::size_t>::Node::stride());
+   }  // teardown
+
+   // probes and comparisons are only counted when asked for
+   void test_stats_counters()
+   {  // setup
+      custom::unordered_set<std::size_t> us;
+      us.insert(9);
+      us.insert(19);
+      // exercise
+      us.find(19);
+      us.find(29);
+      custom::hash_stats s = us.stats();
+      // verify
+#ifdef CUSTOM_HASH_STATS
+      //    insert 9: 0, insert 19: 1, find 19: 2, find 29: 2
+      assertUnit(s.probes == 4);
+      assertUnit(s.comparisons == 5);
+#else
+      assertUnit(s.probes == 0);
+      assertUnit(s.comparisons == 0);
+#endif
+   }  // teardown
+
    /***************************************
     * REMOVE
     ***************************************/
@@ -0,0 +1,392 @@
+/***********************************************************************
+ * Header:
+ *    TEST HASH FUNCTION
+ * Summary:
+ *    Unit tests for the mixers, hash_bytes, seeded_hash and hash
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "hashFunction.h"
+#include "hash.h"
+#include "unitTest.h"
+
+#include <string>
+#include <tuple>
+#include <utility>
+
+class TestHashFunction : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Mix
+      test_mix64_zero();
+      test_mix64_avalanche();
+      test_mixInt_distinct();
+      test_mixInt_spreadsMultiples();
+
+      // Bytes
+      test_hashBytes_empty();
+      test_hashBytes_lengths();
+      test_hashBytes_everyByte();
+      test_hashBytes_unaligned();
+      test_hashBytes_seed();
+
+      // Seed
+      test_randomSeed_differs();
+
+      // Seeded hash
+      test_seeded_construct();
+      test_seeded_deterministic();
+      test_seeded_seedMatters();
+      test_seeded_copyShares();
+      test_seeded_spreadsMultiples();
+
+      // Hash
+      test_hash_integer();
+      test_hash_pointer();
+      test_hash_string();
+      test_hash_span();
+      test_hash_pairOrder();
+      test_hash_tuple();
+      test_hash_customPair();
+      test_hash_inSet();
+
+      report("HashFunction");
+   }
+
+   /***************************************
+    * MIX
+    ***************************************/
+
+   // zero is a fixed point of the finalizer
+   void test_mix64_zero()
+   {  // setup
+      // exercise
+      uint64_t h = custom::mix64(0);
+      // verify
+      assertUnit(h == 0);
+   }  // teardown
+
+   // flipping one input bit flips about half the output bits
+   void test_mix64_avalanche()
+   {  // setup
+      size_t flipped = 0;
+      // exercise
+      for (int bit = 0; bit < 64; bit++)
+      {
+         uint64_t diff = custom::mix64(12345) ^ custom::mix64(12345 ^ (1ull << bit));
+         for (; diff; diff &= diff - 1)
+            flipped++;
+      }
+      // verify
+      //    64 bits * 64 outputs / 2 = 2048
+      assertUnit(flipped > 1800);
+      assertUnit(flipped < 2300);
+   }  // teardown
+
+   // no two of the first 10,000 integers mix to the same value
+   void test_mixInt_distinct()
+   {  // setup
+      custom::unordered_set<uint64_t> seen;
+      // exercise
+      for (uint64_t i = 0; i < 10000; i++)
+         seen.insert(custom::mix_int(i));
+      // verify
+      assertUnit(seen.size() == 10000);
+   }  // teardown
+
+   // multiples of 10 do not all end in the same digit
+   void test_mixInt_spreadsMultiples()
+   {  // setup
+      size_t counts[10] = {};
+      // exercise
+      for (uint64_t i = 0; i < 1000; i++)
+         counts[custom::mix_int(i * 10) % 10]++;
+      // verify
+      for (int i = 0; i < 10; i++)
+      {
+         assertUnit(counts[i] > 60);
+         assertUnit(counts[i] < 140);
+      }
+   }  // teardown
+
+   /***************************************
+    * BYTES
+    ***************************************/
+
+   // nothing still hashes to something, and the same thing
+   void test_hashBytes_empty()
+   {  // setup
+      // exercise
+      uint64_t h1 = custom::hash_bytes(nullptr, 0);
+      uint64_t h2 = custom::hash_bytes("abc", 0);
+      // verify
+      assertUnit(h1 == h2);
+      assertUnit(h1 != custom::hash_bytes("", 1));
+   }  // teardown
+
+   // every prefix of a buffer hashes differently, across every code path
+   void test_hashBytes_lengths()
+   {  // setup
+      unsigned char buffer[200] = {};
+      custom::unordered_set<uint64_t> seen;
+      // exercise
+      for (size_t len = 0; len <= 200; len++)
+         seen.insert(custom::hash_bytes(buffer, len));
+      // verify
+      assertUnit(seen.size() == 201);
+   }  // teardown
+
+   // changing any one byte changes the hash
+   void test_hashBytes_everyByte()
+   {  // setup
+      unsigned char buffer[100];
+      for (int i = 0; i < 100; i++)
+         buffer[i] = (unsigned char)i;
+      size_t numSame = 0;
+      // exercise
+      for (size_t len = 1; len <= 100; len++)
+      {
+         uint64_t h = custom::hash_bytes(buffer, len);
+         for (size_t i = 0; i < len; i++)
+         {
+            buffer[i] ^= 0x01;
+            if (custom::hash_bytes(buffer, len) == h)
+               numSame++;
+            buffer[i] ^= 0x01;
+         }
+      }
+      // verify
+      assertUnit(numSame == 0);
+   }  // teardown
+
+   // where the bytes sit in memory does not matter
+   void test_hashBytes_unaligned()
+   {  // setup
+      const char text[] = "the quick brown fox jumps over the lazy dog";
+      char buffer[64];
+      std::memcpy(buffer + 3, text, sizeof(text));
+      // exercise
+      uint64_t hAligned = custom::hash_bytes(text, sizeof(text));
+      uint64_t hUnaligned = custom::hash_bytes(buffer + 3, sizeof(text));
+      // verify
+      assertUnit(hAligned == hUnaligned);
+   }  // teardown
+
+   // the same bytes under another seed hash differently
+   void test_hashBytes_seed()
+   {  // setup
+      const char text[] = "seed";
+      // exercise
+      uint64_t h0 = custom::hash_bytes(text, 4);
+      uint64_t h1 = custom::hash_bytes(text, 4, 1);
+      // verify
+      assertUnit(h0 != h1);
+      assertUnit(h0 == custom::hash_bytes(text, 4, 0));
+   }  // teardown
+
+   /***************************************
+    * SEED
+    ***************************************/
+
+   // two seeds in a row are not the same
+   void test_randomSeed_differs()
+   {  // setup
+      // exercise
+      uint64_t a = custom::random_seed();
+      uint64_t b = custom::random_seed();
+      // verify
+      assertUnit(a != b);
+   }  // teardown
+
+   /***************************************
+    * SEEDED HASH
+    ***************************************/
+
+   // default hashers each get their own seed
+   void test_seeded_construct()
+   {  // setup
+      // exercise
+      custom::seeded_hash<int> h1;
+      custom::seeded_hash<int> h2;
+      // verify
+      assertUnit(h1.seed != h2.seed);
+      assertUnit(h1.get_seed() == h1.seed);
+      assertUnit(h1(42) != h2(42));
+   }  // teardown
+
+   // the same seed gives the same hash, every time
+   void test_seeded_deterministic()
+   {  // setup
+      custom::seeded_hash<int> h1(99);
+      custom::seeded_hash<int> h2(99);
+      // exercise
+      size_t a = h1(42);
+      size_t b = h2(42);
+      // verify
+      assertUnit(a == b);
+      assertUnit(a == h1(42));
+      assertUnit(a == (size_t)custom::mix64(42 ^ 99));
+   }  // teardown
+
+   // a different seed gives a different hash
+   void test_seeded_seedMatters()
+   {  // setup
+      custom::seeded_hash<int> h1(1);
+      custom::seeded_hash<int> h2(2);
+      // exercise
+      size_t numSame = 0;
+      for (int i = 0; i < 100; i++)
+         if (h1(i) == h2(i))
+            numSame++;
+      // verify
+      assertUnit(numSame == 0);
+   }  // teardown
+
+   // a copy hashes just like the original
+   void test_seeded_copyShares()
+   {  // setup
+      custom::seeded_hash<int> hSrc;
+      // exercise
+      custom::seeded_hash<int> hDes(hSrc);
+      // verify
+      assertUnit(hDes.seed == hSrc.seed);
+      assertUnit(hDes(7) == hSrc(7));
+   }  // teardown
+
+   // multiples of 10 all go to bucket 0 with std::hash, but not here
+   void test_seeded_spreadsMultiples()
+   {  // setup
+      custom::seeded_hash<int> h(12345);
+      size_t counts[10] = {};
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         counts[h(i * 10) % 10]++;
+      // verify
+      //    1000 / 10 = 100 each, give or take
+      for (int i = 0; i < 10; i++)
+      {
+         assertUnit(counts[i] > 60);
+         assertUnit(counts[i] < 140);
+      }
+   }  // teardown
+
+   /***************************************
+    * HASH
+    ***************************************/
+
+   // integers of every width go through the mixer
+   void test_hash_integer()
+   {  // setup
+      // exercise
+      size_t hInt = custom::hash<int>()(42);
+      size_t hLong = custom::hash<long long>()(42);
+      size_t hChar = custom::hash<unsigned char>()(42);
+      // verify
+      assertUnit(hInt == (size_t)custom::mix_int(42));
+      assertUnit(hLong == hInt);
+      assertUnit(hChar == hInt);
+      assertUnit(hInt != 42);
+   }  // teardown
+
+   // a pointer hashes by its address
+   void test_hash_pointer()
+   {  // setup
+      int array[2];
+      // exercise
+      size_t h0 = custom::hash<int *>()(array);
+      size_t h1 = custom::hash<int *>()(array + 1);
+      // verify
+      assertUnit(h0 != h1);
+      assertUnit(h0 == (size_t)custom::mix_int((uint64_t)(uintptr_t)array));
+   }  // teardown
+
+   // a string and a view of it agree
+   void test_hash_string()
+   {  // setup
+      std::string s("Hello, hash");
+      // exercise
+      size_t hString = custom::hash<std::string>()(s);
+      size_t hView = custom::hash<std::string_view>()(std::string_view(s));
+      // verify
+      assertUnit(hString == hView);
+      assertUnit(hString == (size_t)custom::hash_bytes(s.data(), s.size()));
+      assertUnit(hString != custom::hash<std::string>()("Hello, Hash"));
+   }  // teardown
+
+   // a span of plain integers hashes its bytes
+   void test_hash_span()
+   {  // setup
+      int array[] = { 1, 2, 3, 4 };
+      custom::span<int> s(array);
+      // exercise
+      size_t h = custom::hash<custom::span<int>>()(s);
+      // verify
+      assertUnit(h == (size_t)custom::hash_bytes(array, sizeof(array)));
+      array[3] = 5;
+      assertUnit(h != custom::hash<custom::span<int>>()(s));
+   }  // teardown
+
+   // (1, 2) is not (2, 1)
+   void test_hash_pairOrder()
+   {  // setup
+      custom::hash<std::pair<int, int>> h;
+      // exercise
+      size_t h12 = h(std::make_pair(1, 2));
+      size_t h21 = h(std::make_pair(2, 1));
+      // verify
+      assertUnit(h12 != h21);
+      assertUnit(h12 == h(std::make_pair(1, 2)));
+   }  // teardown
+
+   // every member of a tuple counts
+   void test_hash_tuple()
+   {  // setup
+      typedef std::tuple<int, std::string, char> Tuple;
+      custom::hash<Tuple> h;
+      // exercise
+      size_t hBase = h(Tuple(1, "one", 'a'));
+      // verify
+      assertUnit(hBase == h(Tuple(1, "one", 'a')));
+      assertUnit(hBase != h(Tuple(2, "one", 'a')));
+      assertUnit(hBase != h(Tuple(1, "two", 'a')));
+      assertUnit(hBase != h(Tuple(1, "one", 'b')));
+   }  // teardown
+
+   // custom::pair equality ignores second, so its hash must as well
+   void test_hash_customPair()
+   {  // setup
+      custom::hash<custom::pair<int, std::string>> h;
+      // exercise
+      size_t hA = h(custom::pair<int, std::string>(7, std::string("a")));
+      size_t hB = h(custom::pair<int, std::string>(7, std::string("b")));
+      // verify
+      assertUnit(hA == hB);
+      assertUnit(hA == custom::hash<int>()(7));
+   }  // teardown
+
+   // an unordered_set can take it in place of std::hash
+   void test_hash_inSet()
+   {  // setup
+      custom::unordered_set<std::string, std::allocator<std::string>,
+                            custom::list<std::string>, custom::hash<std::string>> us;
+      // exercise
+      us.insert(std::string("alpha"));
+      us.insert(std::string("beta"));
+      us.insert(std::string("alpha"));
+      // verify
+      assertUnit(us.size() == 2);
+      assertUnit(us.find(std::string("beta")) != us.end());
+      assertUnit(us.find(std::string("gamma")) == us.end());
+   }  // teardown
+};
+
+#endif // DEBUG
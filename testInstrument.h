@@ -0,0 +1,375 @@
+/***********************************************************************
+ * Header:
+ *    TEST INSTRUMENT
+ * Summary:
+ *    Unit tests for the instrumentation layer. The hooks in the
+ *    containers only record when CUSTOM_INSTRUMENT is defined, so
+ *    those tests expect counts with it and nothing without it.
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "instrument.h"
+#include "hash.h"
+#include "vector.h"
+#include "unitTest.h"
+
+#include <cstdint>    // for UINT64_MAX
+#include <sstream>    // for std::ostringstream
+#include <string>
+#include <thread>
+
+class TestInstrument : public UnitTest
+{
+public:
+   typedef custom::instrument::histogram Histogram;
+
+   void run()
+   {
+      reset();
+
+      // Histogram
+      test_histogram_exactBelowSub();
+      test_histogram_withinAnEighth();
+      test_histogram_percentile();
+      test_histogram_addClear();
+
+      // Scope
+      test_scope_records();
+      test_scope_nested();
+      test_scope_threads();
+
+      // Dump
+      test_dump_onlyCalled();
+
+      // Hooks
+      test_hooks_set();
+      test_hooks_setErase();
+      test_hooks_setBuckets();
+      test_hooks_list();
+      test_hooks_vector();
+
+      custom::instrument::reset();
+      report("Instrument");
+   }
+
+   /***************************************
+    * HISTOGRAM
+    ***************************************/
+
+   // below eight every value has a counter of its own
+   void test_histogram_exactBelowSub()
+   {  // setup
+      // exercise
+      // verify
+      for (uint64_t v = 0; v < Histogram::SUB * 2; v++)
+      {
+         assertUnit(Histogram::index(v) == v);
+         assertUnit(Histogram::lowest(v) == v);
+      }
+      assertUnit(Histogram::index(16) == 16);
+      assertUnit(Histogram::index(17) == 16);
+      assertUnit(Histogram::index(18) == 17);
+   }  // teardown
+
+   // any value lands where the lowest value is no more than 1/8 under it
+   void test_histogram_withinAnEighth()
+   {  // setup
+      size_t iPrev = 0;
+      bool ordered = true;
+      bool close = true;
+      // exercise
+      for (uint64_t v = 1; v < (uint64_t(1) << 40); v = v + v / 3 + 1)
+      {
+         size_t i = Histogram::index(v);
+         uint64_t low = Histogram::lowest(i);
+         if (i < iPrev)
+            ordered = false;
+         if (low > v || v - low > low / 8)
+            close = false;
+         iPrev = i;
+      }
+      // verify
+      assertUnit(ordered);
+      assertUnit(close);
+      assertUnit(Histogram::index(UINT64_MAX) == Histogram::NUM - 1);
+      assertUnit(Histogram::lowest(Histogram::NUM - 1) == (uint64_t)15 << 60);
+   }  // teardown
+
+   // percentiles come back within the resolution of the histogram
+   void test_histogram_percentile()
+   {  // setup
+      Histogram * pH = new Histogram;
+      // exercise
+      for (uint64_t v = 1; v <= 1000; v++)
+         pH->record(v);
+      // verify
+      assertUnit(pH->count() == 1000);
+      assertUnit(pH->sum() == 500500);
+      assertUnit(pH->max() == 1000);
+      uint64_t p50 = pH->percentile(50);
+      uint64_t p99 = pH->percentile(99);
+      assertUnit(p50 <= 501 && p50 >= 501 - 501 / 8);
+      assertUnit(p99 <= 991 && p99 >= 991 - 991 / 8);
+      assertUnit(pH->percentile(100) <= 1000);
+      delete pH;
+   }  // teardown
+
+   // merging adds the counts and keeps the larger maximum
+   void test_histogram_addClear()
+   {  // setup
+      Histogram * pA = new Histogram;
+      Histogram * pB = new Histogram;
+      pA->record(3);
+      pA->record(3);
+      pB->record(3);
+      pB->record(700);
+      // exercise
+      pA->add(*pB);
+      // verify
+      assertUnit(pA->count() == 4);
+      assertUnit(pA->count_at(3) == 3);
+      assertUnit(pA->max() == 700);
+      assertUnit(pA->sum() == 709);
+      pA->clear();
+      assertUnit(pA->count() == 0);
+      assertUnit(pA->count_at(3) == 0);
+      assertUnit(pA->percentile(50) == 0);
+      delete pA;
+      delete pB;
+   }  // teardown
+
+   /***************************************
+    * SCOPE
+    ***************************************/
+
+   // one call, its probes and its allocations
+   void test_scope_records()
+   {  // setup
+      custom::instrument::reset();
+      // exercise
+      {
+         custom::instrument::scope s(custom::instrument::SET_FIND);
+         custom::instrument::local().probes += 3;
+         custom::instrument::local().allocs += 2;
+      }
+      // verify
+      custom::instrument::recorder & r = custom::instrument::local_recorder();
+      assertUnit(r.latency[custom::instrument::SET_FIND].count() == 1);
+      assertUnit(r.probes[custom::instrument::SET_FIND].max() == 3);
+      assertUnit(r.allocs[custom::instrument::SET_FIND].load() == 2);
+      assertUnit(r.latency[custom::instrument::SET_INSERT].count() == 0);
+   }  // teardown
+
+   // an outer call is charged for what the calls inside it did
+   void test_scope_nested()
+   {  // setup
+      custom::instrument::reset();
+      // exercise
+      {
+         custom::instrument::scope outer(custom::instrument::SET_ERASE);
+         custom::instrument::local().probes += 1;
+         {
+            custom::instrument::scope inner(custom::instrument::SET_FIND);
+            custom::instrument::local().probes += 4;
+         }
+      }
+      // verify
+      custom::instrument::recorder & r = custom::instrument::local_recorder();
+      assertUnit(r.probes[custom::instrument::SET_FIND].max() == 4);
+      assertUnit(r.probes[custom::instrument::SET_ERASE].max() == 5);
+      assertUnit(r.latency[custom::instrument::SET_ERASE].max() >=
+                 r.latency[custom::instrument::SET_FIND].max());
+   }  // teardown
+
+   // each thread records on its own and the merge sees them all
+   void test_scope_threads()
+   {  // setup
+      custom::instrument::reset();
+      std::thread threads[4];
+      // exercise
+      for (int i = 0; i < 4; i++)
+         threads[i] = std::thread([i]()
+         {
+            for (int j = 0; j < 100; j++)
+            {
+               custom::instrument::scope s(custom::instrument::LIST_ERASE);
+               custom::instrument::local().probes += i;
+            }
+         });
+      for (int i = 0; i < 4; i++)
+         threads[i].join();
+      // verify
+      custom::instrument::summary * pSummary = new custom::instrument::summary;
+      custom::instrument::merge(custom::instrument::LIST_ERASE, *pSummary);
+      assertUnit(pSummary->latency.count() == 400);
+      assertUnit(pSummary->probes.count() == 400);
+      assertUnit(pSummary->probes.max() == 3);
+      assertUnit(pSummary->probes.sum() == 100 * (0 + 1 + 2 + 3));
+      delete pSummary;
+   }  // teardown
+
+   /***************************************
+    * DUMP
+    ***************************************/
+
+   // only the operations which were called are printed
+   void test_dump_onlyCalled()
+   {  // setup
+      custom::instrument::reset();
+      {
+         custom::instrument::scope s(custom::instrument::VECTOR_RESERVE);
+         custom::instrument::local().allocs++;
+      }
+      std::ostringstream out;
+      // exercise
+      custom::instrument::dump(out);
+      // verify
+      std::string text = out.str();
+      assertUnit(text.find("vector::reserve:\t1 calls\t1 allocs/call") == 0);
+      assertUnit(text.find(custom::instrument::tick_units()) != std::string::npos);
+      assertUnit(text.find("list::erase") == std::string::npos);
+      assertUnit(text.find('\n') == text.size() - 1);
+   }  // teardown
+
+   /***************************************
+    * HOOKS
+    ***************************************/
+
+   // insert and find report how far they walked the bucket
+   void test_hooks_set()
+   {  // setup
+      custom::unordered_set<int> s;
+      custom::instrument::reset();
+      // exercise
+      s.insert(3);
+      s.insert(13);
+      s.find(13);
+      // verify
+      //    h[3] --> [ 3 ] [ 13 ]
+      custom::instrument::summary * pInsert = new custom::instrument::summary;
+      custom::instrument::summary * pFind = new custom::instrument::summary;
+      custom::instrument::merge(custom::instrument::SET_INSERT, *pInsert);
+      custom::instrument::merge(custom::instrument::SET_FIND, *pFind);
+#ifdef CUSTOM_INSTRUMENT
+      assertUnit(pInsert->latency.count() == 2);
+      assertUnit(pInsert->allocs == 2);
+      assertUnit(pInsert->probes.max() == 1);
+      assertUnit(pFind->latency.count() == 1);
+      assertUnit(pFind->probes.max() == 2);
+      assertUnit(pFind->allocs == 0);
+#else
+      assertUnit(pInsert->latency.count() == 0);
+      assertUnit(pFind->latency.count() == 0);
+#endif // CUSTOM_INSTRUMENT
+      delete pInsert;
+      delete pFind;
+   }  // teardown
+
+   // erase looks in the bucket itself, so no find is recorded
+   void test_hooks_setErase()
+   {  // setup
+      custom::unordered_set<int> s;
+      s.insert(3);
+      s.insert(13);
+      custom::instrument::reset();
+      // exercise
+      s.erase(13);
+      s.erase(23);
+      // verify
+      custom::instrument::summary * pErase = new custom::instrument::summary;
+      custom::instrument::summary * pFind = new custom::instrument::summary;
+      custom::instrument::merge(custom::instrument::SET_ERASE, *pErase);
+      custom::instrument::merge(custom::instrument::SET_FIND, *pFind);
+#ifdef CUSTOM_INSTRUMENT
+      assertUnit(pErase->latency.count() == 2);
+      assertUnit(pErase->probes.max() == 2);
+      assertUnit(pFind->latency.count() == 0);
+#else
+      assertUnit(pErase->latency.count() == 0);
+      assertUnit(pFind->latency.count() == 0);
+#endif // CUSTOM_INSTRUMENT
+      assertUnit(s.size() == 1);
+      delete pErase;
+      delete pFind;
+   }  // teardown
+
+   // the bucket array is an allocation too
+   void test_hooks_setBuckets()
+   {  // setup
+      custom::instrument::reset();
+      // exercise
+      {
+         custom::instrument::scope scope(custom::instrument::SET_INSERT);
+         custom::unordered_set<int> s;
+      }
+      // verify
+      custom::instrument::summary * pSummary = new custom::instrument::summary;
+      custom::instrument::merge(custom::instrument::SET_INSERT, *pSummary);
+#ifdef CUSTOM_INSTRUMENT
+      assertUnit(pSummary->allocs == 1);
+#else
+      assertUnit(pSummary->allocs == 0);
+#endif // CUSTOM_INSTRUMENT
+      delete pSummary;
+   }  // teardown
+
+   // each push makes one node
+   void test_hooks_list()
+   {  // setup
+      custom::list<int> l;
+      custom::instrument::reset();
+      // exercise
+      for (int i = 0; i < 10; i++)
+         l.push_back(i);
+      l.pop_front();
+      // verify
+      custom::instrument::summary * pPush = new custom::instrument::summary;
+      custom::instrument::summary * pPop = new custom::instrument::summary;
+      custom::instrument::merge(custom::instrument::LIST_PUSH_BACK, *pPush);
+      custom::instrument::merge(custom::instrument::LIST_POP_FRONT, *pPop);
+#ifdef CUSTOM_INSTRUMENT
+      assertUnit(pPush->latency.count() == 10);
+      assertUnit(pPush->allocs == 10);
+      assertUnit(pPop->latency.count() == 1);
+      assertUnit(pPop->allocs == 0);
+#else
+      assertUnit(pPush->latency.count() == 0);
+      assertUnit(pPop->latency.count() == 0);
+#endif // CUSTOM_INSTRUMENT
+      delete pPush;
+      delete pPop;
+   }  // teardown
+
+   // a push_back only allocates when the vector has to grow
+   void test_hooks_vector()
+   {  // setup
+      custom::vector<int> v;
+      custom::instrument::reset();
+      // exercise
+      for (int i = 0; i < 10; i++)
+         v.push_back(i);
+      // verify
+      custom::instrument::summary * pPush = new custom::instrument::summary;
+      custom::instrument::summary * pReserve = new custom::instrument::summary;
+      custom::instrument::merge(custom::instrument::VECTOR_PUSH_BACK, *pPush);
+      custom::instrument::merge(custom::instrument::VECTOR_RESERVE, *pReserve);
+#ifdef CUSTOM_INSTRUMENT
+      assertUnit(pPush->latency.count() == 10);
+      assertUnit(pPush->allocs == pReserve->allocs);
+      assertUnit(pReserve->allocs >= 1);
+      assertUnit(pReserve->allocs < 10);
+#else
+      assertUnit(pPush->latency.count() == 0);
+      assertUnit(pReserve->allocs == 0);
+#endif // CUSTOM_INSTRUMENT
+      delete pPush;
+      delete pReserve;
+   }  // teardown
+};
+
+#endif // DEBUG
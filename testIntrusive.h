@@ -0,0 +1,346 @@
+/***********************************************************************
+ * Header:
+ *    TEST INTRUSIVE
+ * Summary:
+ *    Unit tests for intrusive_list and intrusive_unordered_set
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "intrusive.h"
+#include "unitTest.h"
+
+#include <vector>
+
+class TestIntrusive : public UnitTest
+{
+public:
+   /*****************************************
+    * ORDER
+    * An object which can be in a list and a set at once
+    ****************************************/
+   struct Order
+   {
+      Order(int id = 0) : id(id) {}
+      int id;
+      custom::list_hook byTime;
+      custom::set_hook  byId;
+   };
+   struct OrderHash
+   {
+      size_t operator()(int id)            const { return (size_t)id;    }
+      size_t operator()(const Order & o)   const { return (size_t)o.id;  }
+   };
+   struct OrderEqual
+   {
+      bool operator()(const Order & o, int id)            const { return o.id == id;   }
+      bool operator()(const Order & o, const Order & rhs) const { return o.id == rhs.id; }
+   };
+   typedef custom::intrusive_list<Order, &Order::byTime> List;
+   typedef custom::intrusive_unordered_set<Order, &Order::byId, OrderHash, OrderEqual> Set;
+
+   void run()
+   {
+      reset();
+
+      // List
+      test_list_pushback();
+      test_list_pushfront();
+      test_list_eraseSelf();
+      test_list_eraseIterator();
+      test_list_alreadyLinked();
+      test_list_clearLeavesObjects();
+      test_list_copyIsUnlinked();
+
+      // Set
+      test_set_insert();
+      test_set_insertDuplicate();
+      test_set_grow();
+      test_set_eraseSelf();
+      test_set_iterate();
+      test_set_listAndSet();
+
+      report("Intrusive");
+   }
+
+   /***************************************
+    * LIST
+    ***************************************/
+
+   // push_back links the object itself
+   void test_list_pushback()
+   {  // setup
+      Order orders[3] = { 11, 26, 31 };
+      List l;
+      // exercise
+      for (Order & o : orders)
+         l.push_back(o);
+      // verify
+      assertUnit(isLinked(l, { 11, 26, 31 }));
+      assertUnit(&l.front() == orders + 0);
+      assertUnit(&l.back() == orders + 2);
+      assertUnit(orders[1].byTime.is_linked());
+      // teardown
+      l.clear();
+   }
+
+   // push_front puts it at the head
+   void test_list_pushfront()
+   {  // setup
+      Order orders[3] = { 11, 26, 31 };
+      List l;
+      // exercise
+      for (Order & o : orders)
+         l.push_front(o);
+      // verify
+      assertUnit(isLinked(l, { 31, 26, 11 }));
+      // teardown
+      l.clear();
+   }
+
+   // an object can unlink itself from the middle without a search
+   void test_list_eraseSelf()
+   {  // setup
+      Order orders[3] = { 11, 26, 31 };
+      List l;
+      for (Order & o : orders)
+         l.push_back(o);
+      // exercise
+      l.erase(orders[1]);
+      // verify
+      assertUnit(isLinked(l, { 11, 31 }));
+      assertUnit(!orders[1].byTime.is_linked());
+      assertUnit(orders[1].byTime.pNext == nullptr);
+      // teardown
+      l.clear();
+   }
+
+   // erase by iterator returns the next one
+   void test_list_eraseIterator()
+   {  // setup
+      Order orders[3] = { 11, 26, 31 };
+      List l;
+      for (Order & o : orders)
+         l.push_back(o);
+      // exercise
+      List::iterator it = l.erase(l.begin());
+      // verify
+      assertUnit(isLinked(l, { 26, 31 }));
+      assertUnit(it->id == 26);
+      assertUnit(l.iterator_to(orders[2]) != l.end());
+      // teardown
+      l.clear();
+   }
+
+   // one hook means one list at a time
+   void test_list_alreadyLinked()
+   {  // setup
+      Order order(11);
+      List l1;
+      List l2;
+      l1.push_back(order);
+      // exercise
+      bool thrown = false;
+      try
+      {
+         l2.push_back(order);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l1.size() == 1);
+      assertUnit(l2.empty());
+      // teardown
+      l1.clear();
+   }
+
+   // clear unlinks, it does not destroy
+   void test_list_clearLeavesObjects()
+   {  // setup
+      Order orders[3] = { 11, 26, 31 };
+      List l;
+      for (Order & o : orders)
+         l.push_back(o);
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.pHead == nullptr);
+      assertUnit(!orders[0].byTime.is_linked());
+      assertUnit(orders[2].id == 31);
+   }  // teardown
+
+   // a copy of a linked object is not linked
+   void test_list_copyIsUnlinked()
+   {  // setup
+      Order order(11);
+      List l;
+      l.push_back(order);
+      // exercise
+      Order copy(order);
+      // verify
+      assertUnit(copy.id == 11);
+      assertUnit(!copy.byTime.is_linked());
+      assertUnit(l.size() == 1);
+      // teardown
+      l.clear();
+   }
+
+   /***************************************
+    * SET
+    ***************************************/
+
+   // insert caches the hash in the hook
+   void test_set_insert()
+   {  // setup
+      Order orders[3] = { 11, 26, 31 };
+      Set s;
+      // exercise
+      for (Order & o : orders)
+         assertUnit(s.insert(o).second);
+      // verify
+      assertUnit(s.size() == 3);
+      assertUnit(orders[1].byId.hash == 26);
+      assertUnit(&*s.find(26) == orders + 1);
+      assertUnit(s.find(49) == s.end());
+      // teardown
+      s.clear();
+   }
+
+   // an equal object is not linked
+   void test_set_insertDuplicate()
+   {  // setup
+      Order order(11);
+      Order same(11);
+      Set s;
+      s.insert(order);
+      // exercise
+      custom::pair<Set::iterator, bool> result = s.insert(same);
+      // verify
+      assertUnit(!result.second);
+      assertUnit(&*result.first == &order);
+      assertUnit(!same.byId.is_linked());
+      assertUnit(s.size() == 1);
+      // teardown
+      s.clear();
+   }
+
+   // the bucket array doubles; the objects never move
+   void test_set_grow()
+   {  // setup
+      std::vector<Order> orders(100);
+      for (int i = 0; i < 100; i++)
+         orders[i].id = i * 7;
+      Set s(4);
+      // exercise
+      for (Order & o : orders)
+         s.insert(o);
+      // verify
+      assertUnit(s.size() == 100);
+      assertUnit(s.bucket_count() == 128);
+      bool same = true;
+      for (int i = 0; i < 100; i++)
+         same = same && &*s.find(i * 7) == &orders[i];
+      assertUnit(same);
+      // teardown
+      s.clear();
+   }
+
+   // an object can unlink itself from the middle of a chain
+   void test_set_eraseSelf()
+   {  // setup
+      Order orders[3] = { 1, 9, 17 };    // all in bucket 1 of 8
+      Set s;
+      for (Order & o : orders)
+         s.insert(o);
+      assertUnit(s.bucket_size(1) == 3);
+      // exercise
+      s.erase(orders[1]);
+      // verify
+      assertUnit(s.size() == 2);
+      assertUnit(s.bucket_size(1) == 2);
+      assertUnit(!orders[1].byId.is_linked());
+      assertUnit(s.find(9) == s.end());
+      assertUnit(&*s.find(1) == orders + 0);
+      assertUnit(&*s.find(17) == orders + 2);
+      // teardown
+      s.clear();
+   }
+
+   // iterate over every object once, erasing as we go
+   void test_set_iterate()
+   {  // setup
+      Order orders[5] = { 3, 11, 19, 4, 30 };
+      Set s;
+      for (Order & o : orders)
+         s.insert(o);
+      // exercise
+      int sum = 0;
+      int count = 0;
+      for (Set::iterator it = s.begin(); it != s.end(); )
+      {
+         sum += it->id;
+         count++;
+         it = s.erase(it);
+      }
+      // verify
+      assertUnit(count == 5);
+      assertUnit(sum == 3 + 11 + 19 + 4 + 30);
+      assertUnit(s.empty());
+   }  // teardown
+
+   // one object, two containers, no allocations per object
+   void test_set_listAndSet()
+   {  // setup
+      Order orders[3] = { 11, 26, 31 };
+      List l;
+      Set s;
+      for (Order & o : orders)
+      {
+         l.push_back(o);
+         s.insert(o);
+      }
+      // exercise: cancel order 26 found by id
+      Order & cancel = *s.find(26);
+      s.erase(cancel);
+      l.erase(cancel);
+      // verify
+      assertUnit(isLinked(l, { 11, 31 }));
+      assertUnit(s.size() == 2);
+      assertUnit(!cancel.byTime.is_linked());
+      assertUnit(!cancel.byId.is_linked());
+      // teardown
+      l.clear();
+      s.clear();
+   }
+
+   /****************************************************************
+    * IS LINKED
+    * Are these the ids in the list, with the links agreeing
+    * in both directions?
+    ****************************************************************/
+   bool isLinked(const List& l, const std::vector<int>& ids)
+   {
+      if (l.numElements != ids.size())
+         return false;
+      const custom::list_hook* pPrevious = nullptr;
+      const custom::list_hook* p = l.pHead;
+      for (size_t i = 0; i < ids.size(); i++, p = p->pNext)
+      {
+         if (p == nullptr || p->pPrev != pPrevious || !p->is_linked() ||
+             custom::owner_of<Order>(const_cast<custom::list_hook*>(p))->id != ids[i])
+            return false;
+         pPrevious = p;
+      }
+      return p == nullptr && l.pTail == pPrevious;
+   }
+};
+
+#endif // DEBUG
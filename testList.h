@@ -16,9 +16,12 @@
 #include "unitTest.h"
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <iostream>
+#include <iterator>
+#include <sstream>
 
 class TestList : public UnitTest
 {
@@ -99,6 +102,14 @@ public:
       test_insertMove_empty();
       test_insertMove_standardFront();
       test_insertMove_standardMiddle();
+      test_insertRange_empty();
+      test_insertRange_standardMiddle();
+      test_insertRange_standardEnd();
+      test_insertRange_throws();
+      test_insertRange_oneBlock();
+      test_insertRange_blockThrows();
+      test_insertRange_inputOnePerNode();
+      test_assign_growsInOnePass();
 
       // Remove
       test_clear_empty();
@@ -114,6 +125,19 @@ public:
       test_erase_standardMiddle();
       test_erase_standardEnd();
 
+      // Reorder
+      test_splice_wholeList();
+      test_splice_empty();
+      test_splice_oneNode();
+      test_splice_range();
+      test_merge_standard();
+      test_sort_empty();
+      test_sort_standard();
+      test_sort_stable();
+      test_sort_large();
+      test_reverse_standard();
+      test_unique_standard();
+
       // Status
       test_size_empty();
       test_size_three();
@@ -2348,6 +2372,359 @@ public:
       teardownStandardFixture(l);
    }
 
+   /***************************************
+    * INSERT - Range
+    ***************************************/
+
+   // insert a range into an empty list
+   void test_insertRange_empty()
+   {  // setup
+      custom::list<int> l;
+      std::vector<int> v{ 11, 26, 31 };
+      // exercise
+      custom::list<int>::iterator it = l.insert(l.end(), v.begin(), v.end());
+      // verify
+      assertUnit(it.p == l.pHead);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // insert a range between 11 and 26
+   void test_insertRange_standardMiddle()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      std::vector<int> v{ 97, 98, 99 };
+      custom::list<int>::iterator it = l.begin();
+      ++it;
+      // exercise
+      custom::list<int>::iterator itReturn = l.insert(it, v.begin(), v.end());
+      // verify
+      assertUnit(isLinked(l, { 11, 97, 98, 99, 26, 31 }));
+      assertUnit(*itReturn == 97);
+      // teardown
+      l.clear();
+   }
+
+   // inserting an empty range at the end changes nothing
+   void test_insertRange_standardEnd()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      std::vector<int> v;
+      // exercise
+      custom::list<int>::iterator itReturn = l.insert(l.end(), v.begin(), v.end());
+      // verify
+      assertUnit(itReturn == l.end());
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // a copy that throws leaves the list as it was
+   void test_insertRange_throws()
+   {  // setup
+      struct ThrowAt
+      {
+         const int* p;
+         const int* pBad;
+         int operator * () const { if (p == pBad) throw "ERROR: bad copy"; return *p; }
+         ThrowAt& operator ++ () { ++p; return *this; }
+         bool operator != (const ThrowAt& rhs) const { return p != rhs.p; }
+      };
+      custom::list<int> l;
+      setupStandardFixture(l);
+      int values[] = { 97, 98, 99 };
+      // exercise
+      bool thrown = false;
+      try
+      {
+         l.insert(l.begin(), ThrowAt{ values, values + 2 }, ThrowAt{ values + 3, values + 2 });
+      }
+      catch (const char*)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // a range we can count comes out of one block, which lives as
+   // long as any of its nodes does
+   void test_insertRange_oneBlock()
+   {  // setup
+      custom::list<int> l;
+      int values[] = { 11, 26, 31, 49 };
+      // exercise
+      l.insert(l.end(), values, values + 4);
+      // verify
+      typedef custom::list<int>::Node Node;
+      custom::list<int>::Block* pBlock = Node::blockOf(l.pHead);
+      assertUnit(pBlock != nullptr);
+      assertUnit(Node::blockOf(l.pHead->pNext) == pBlock);
+      assertUnit(Node::blockOf(l.pTail) == pBlock);
+      assertUnit(pBlock->numLive == 4);
+      l.pop_front();
+      l.erase(++l.begin());
+      assertUnit(pBlock->numLive == 2);
+      assertUnit(isLinked(l, { 26, 49 }));
+      l.push_back(67);
+      assertUnit(Node::blockOf(l.pTail) == nullptr);
+      // teardown
+      l.clear();
+   }
+
+   // a copy throwing part way through a block frees every node made so far
+   void test_insertRange_blockThrows()
+   {  // setup
+      struct Tally
+      {
+         Tally(int value, int* pLive) : value(value), pLive(pLive) { (*pLive)++; }
+         Tally(const Tally& rhs) : value(rhs.value), pLive(rhs.pLive)
+         {
+            if (value < 0)
+               throw "ERROR: bad copy";
+            (*pLive)++;
+         }
+         ~Tally() { (*pLive)--; }
+         int value;
+         int* pLive;
+      };
+      int numLive = 0;
+      Tally values[] = { Tally(1, &numLive), Tally(2, &numLive),
+                         Tally(-3, &numLive), Tally(4, &numLive) };
+      custom::list<Tally> l;
+      // exercise
+      bool thrown = false;
+      try
+      {
+         l.insert(l.end(), values, values + 4);
+      }
+      catch (const char*)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l.empty());
+      assertUnit(numLive == 4);
+   }  // teardown
+
+   // a range that can only be read once gets a node at a time
+   void test_insertRange_inputOnePerNode()
+   {  // setup
+      std::istringstream in("11 26 31");
+      custom::list<int> l;
+      // exercise
+      l.insert(l.end(), std::istream_iterator<int>(in), std::istream_iterator<int>());
+      // verify
+      assertUnit(isLinked(l, { 11, 26, 31 }));
+      assertUnit(custom::list<int>::Node::blockOf(l.pHead) == nullptr);
+      assertUnit(custom::list<int>::Node::blockOf(l.pTail) == nullptr);
+      // teardown
+      l.clear();
+   }
+
+   // assigning a longer list reuses our nodes then copies the rest in bulk
+   void test_assign_growsInOnePass()
+   {  // setup
+      custom::list<int> lSrc{ 11, 26, 31, 49, 67 };
+      custom::list<int> lDes{ 1, 2 };
+      custom::list<int>::Node* pHead = lDes.pHead;
+      // exercise
+      lDes = lSrc;
+      // verify
+      assertUnit(isLinked(lDes, { 11, 26, 31, 49, 67 }));
+      assertUnit(lDes.pHead == pHead);
+      assertUnit(isLinked(lSrc, { 11, 26, 31, 49, 67 }));
+      // teardown
+      lDes.clear();
+      lSrc.clear();
+   }
+
+   /***************************************
+    * REORDER
+    ***************************************/
+
+   // splice a whole list onto the end; the nodes move, they are not copied
+   void test_splice_wholeList()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int> lRHS{ 49, 67 };
+      custom::list<int>::Node* pFirst = lRHS.pHead;
+      // exercise
+      l.splice(l.end(), lRHS);
+      // verify
+      assertUnit(isLinked(l, { 11, 26, 31, 49, 67 }));
+      assertUnit(l.pTail->pPrev == pFirst);
+      assertEmptyFixture(lRHS);
+      // teardown
+      l.clear();
+   }
+
+   // splicing an empty list changes nothing
+   void test_splice_empty()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int> lRHS;
+      // exercise
+      l.splice(l.begin(), lRHS);
+      // verify
+      assertStandardFixture(l);
+      assertEmptyFixture(lRHS);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // move one node from the middle of one list to the front of another
+   void test_splice_oneNode()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int> lRHS{ 49, 67, 89 };
+      custom::list<int>::iterator itRHS = lRHS.begin();
+      ++itRHS;
+      // exercise
+      l.splice(l.begin(), lRHS, itRHS);
+      // verify
+      assertUnit(isLinked(l, { 67, 11, 26, 31 }));
+      assertUnit(isLinked(lRHS, { 49, 89 }));
+      // teardown
+      l.clear();
+   }
+
+   // move the tail of one list into the middle of another
+   void test_splice_range()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int> lRHS{ 49, 67, 89 };
+      custom::list<int>::iterator it = l.begin();
+      ++it;
+      custom::list<int>::iterator first = lRHS.begin();
+      ++first;
+      // exercise
+      l.splice(it, lRHS, first, lRHS.end());
+      // verify
+      assertUnit(isLinked(l, { 11, 67, 89, 26, 31 }));
+      assertUnit(isLinked(lRHS, { 49 }));
+      // teardown
+      l.clear();
+   }
+
+   // merge two sorted lists into one
+   void test_merge_standard()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int> lRHS{ 5, 26, 30, 99 };
+      // exercise
+      l.merge(lRHS);
+      // verify
+      assertUnit(isLinked(l, { 5, 11, 26, 26, 30, 31, 99 }));
+      assertEmptyFixture(lRHS);
+      // teardown
+      l.clear();
+   }
+
+   // sorting nothing does nothing
+   void test_sort_empty()
+   {  // setup
+      custom::list<int> l;
+      // exercise
+      l.sort();
+      // verify
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // sort relinks the nodes rather than copying the values
+   void test_sort_standard()
+   {  // setup
+      custom::list<int> l{ 31, 11, 26 };
+      custom::list<int>::Node* p31 = l.pHead;
+      // exercise
+      l.sort();
+      // verify
+      assertStandardFixture(l);
+      assertUnit(l.pTail == p31);
+      // teardown
+      l.clear();
+   }
+
+   // equal elements keep their original order
+   void test_sort_stable()
+   {  // setup
+      custom::list<int> l{ 21, 12, 22, 11, 23 };
+      custom::list<int>::Node* pNodes[5];
+      custom::list<int>::Node* p = l.pHead;
+      for (int i = 0; i < 5; i++, p = p->pNext)
+         pNodes[i] = p;
+      // exercise: compare by tens digit only
+      l.sort([](int lhs, int rhs) { return lhs / 10 < rhs / 10; });
+      // verify
+      assertUnit(isLinked(l, { 12, 11, 21, 22, 23 }));
+      assertUnit(l.pHead == pNodes[1]);
+      assertUnit(l.pTail == pNodes[4]);
+      // teardown
+      l.clear();
+   }
+
+   // sort a list long enough to use many runs
+   void test_sort_large()
+   {  // setup
+      custom::list<int> l;
+      std::vector<int> values;
+      unsigned int seed = 12345;
+      for (int i = 0; i < 1000; i++)
+      {
+         seed = seed * 1103515245 + 12345;
+         l.push_back((int)(seed >> 16) % 500);
+         values.push_back(l.back());
+      }
+      std::sort(values.begin(), values.end());
+      // exercise
+      l.sort();
+      // verify
+      assertUnit(isLinked(l, values));
+      // teardown
+      l.clear();
+   }
+
+   // reverse turns the links around
+   void test_reverse_standard()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::Node* pHead = l.pHead;
+      // exercise
+      l.reverse();
+      // verify
+      assertUnit(isLinked(l, { 31, 26, 11 }));
+      assertUnit(l.pTail == pHead);
+      // teardown
+      l.reverse();
+      teardownStandardFixture(l);
+   }
+
+   // unique removes adjacent duplicates only
+   void test_unique_standard()
+   {  // setup
+      custom::list<int> l{ 11, 11, 26, 26, 26, 31, 11 };
+      // exercise
+      size_t numRemoved = l.unique();
+      // verify
+      assertUnit(numRemoved == 3);
+      assertUnit(isLinked(l, { 11, 26, 31, 11 }));
+      // teardown
+      l.clear();
+   }
+
    /****************************************************************
     * Setup Standard Fixture
     *        pHead             pTail
@@ -2405,6 +2782,26 @@ public:
       }
    }
 
+   /****************************************************************
+    * IS LINKED
+    * Do the nodes hold these values, with every pNext and pPrev
+    * agreeing, pTail on the last node, and the right count?
+    ****************************************************************/
+   bool isLinked(const custom::list<int>& l, const std::vector<int>& values)
+   {
+      if (l.numElements != values.size())
+         return false;
+      const custom::list<int>::Node* pPrevious = nullptr;
+      const custom::list<int>::Node* p = l.pHead;
+      for (size_t i = 0; i < values.size(); i++, p = p->pNext)
+      {
+         if (p == nullptr || p->data != values[i] || p->pPrev != pPrevious)
+            return false;
+         pPrevious = p;
+      }
+      return p == nullptr && l.pTail == pPrevious;
+   }
+
    /****************************************************************
     * Verify Empty Fixture
     ****************************************************************/
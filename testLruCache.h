@@ -0,0 +1,357 @@
+/***********************************************************************
+ * Header:
+ *    TEST LRU CACHE
+ * Summary:
+ *    Unit tests for lru_cache
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "lruCache.h"
+#include "unitTest.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class TestLruCache : public UnitTest
+{
+public:
+   typedef custom::lru_cache<int, std::string> Cache;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_count();
+
+      // Access
+      test_get_missing();
+      test_get_makesRecent();
+      test_peek_leavesOrder();
+
+      // Insert
+      test_put_standard();
+      test_put_replace();
+      test_put_evictsLeastRecent();
+      test_put_callback();
+      test_put_weight();
+      test_put_tooHeavy();
+
+      // Recycle
+      test_recycle_sameEntry();
+      test_recycle_destroysValue();
+      test_recycle_valueThrows();
+
+      // Remove
+      test_erase_standard();
+      test_clear_keepsSpares();
+
+      report("LruCache");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // the index starts small whatever the capacity and grows with the entries
+   void test_construct_count()
+   {  // setup
+      // exercise
+      Cache c(100);
+      // verify
+      assertUnit(c.empty());
+      assertUnit(c.capacity() == 100);
+      assertUnit(c.weight() == 0);
+      assertUnit(c.index.bucket_count() == 8);
+      for (int i = 0; i < 100; i++)
+         c.put(i, std::to_string(i));
+      assertUnit(c.size() == 100);
+      assertUnit(c.index.bucket_count() >= 100);
+      assertUnit(*c.get(42) == "42");
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // nothing there
+   void test_get_missing()
+   {  // setup
+      Cache c(3);
+      setupStandardFixture(c);
+      // exercise
+      std::string * p = c.get(99);
+      // verify
+      assertUnit(p == nullptr);
+      assertStandardFixture(c);
+   }  // teardown
+
+   // get moves the key to the front
+   void test_get_makesRecent()
+   {  // setup
+      Cache c(3);
+      setupStandardFixture(c);
+      // exercise
+      std::string * p = c.get(11);
+      // verify
+      assertUnit(p && *p == "eleven");
+      assertUnit(isRecent(c, { 11, 31, 26 }));
+   }  // teardown
+
+   // peek finds the value without touching the order
+   void test_peek_leavesOrder()
+   {  // setup
+      Cache c(3);
+      setupStandardFixture(c);
+      // exercise
+      std::string * p = c.peek(11);
+      // verify
+      assertUnit(p && *p == "eleven");
+      assertUnit(c.contains(26));
+      assertUnit(!c.contains(99));
+      assertStandardFixture(c);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // put adds to the front
+   void test_put_standard()
+   {  // setup
+      Cache c(3);
+      // exercise
+      setupStandardFixture(c);
+      // verify
+      assertStandardFixture(c);
+      assertUnit(c.weight() == 3);
+   }  // teardown
+
+   // putting a cached key replaces its value and makes it recent
+   void test_put_replace()
+   {  // setup
+      Cache c(3);
+      setupStandardFixture(c);
+      // exercise
+      c.put(11, "ELEVEN");
+      // verify
+      assertUnit(isRecent(c, { 11, 31, 26 }));
+      assertUnit(*c.peek(11) == "ELEVEN");
+      assertUnit(c.weight() == 3);
+   }  // teardown
+
+   // a full cache forgets the least recent
+   void test_put_evictsLeastRecent()
+   {  // setup
+      Cache c(3);
+      setupStandardFixture(c);
+      c.get(11);
+      // exercise
+      c.put(49, "forty-nine");
+      // verify
+      assertUnit(isRecent(c, { 49, 11, 31 }));
+      assertUnit(!c.contains(26));
+   }  // teardown
+
+   // the callback sees every eviction, but not erase
+   void test_put_callback()
+   {  // setup
+      Cache c(2);
+      std::vector<int> evicted;
+      c.on_evict([&evicted](const int & key, std::string &)
+      {
+         evicted.push_back(key);
+      });
+      c.put(11, "eleven");
+      c.put(26, "twenty-six");
+      // exercise
+      c.put(31, "thirty-one");
+      c.put(49, "forty-nine");
+      c.erase(31);
+      // verify
+      assertUnit(evicted.size() == 2 && evicted[0] == 11 && evicted[1] == 26);
+      assertUnit(isRecent(c, { 49 }));
+   }  // teardown
+
+   // weighed by the length of the value
+   void test_put_weight()
+   {  // setup
+      Cache c(10, [](const int &, const std::string & value)
+      {
+         return value.size();
+      });
+      c.put(1, "aaaa");
+      c.put(2, "bbbb");
+      // exercise
+      c.put(3, "cccccc");
+      // verify
+      assertUnit(isRecent(c, { 3, 2 }));
+      assertUnit(c.weight() == 10);
+   }  // teardown
+
+   // an entry heavier than the capacity is kept alone
+   void test_put_tooHeavy()
+   {  // setup
+      Cache c(4, [](const int &, const std::string & value)
+      {
+         return value.size();
+      });
+      c.put(1, "a");
+      c.put(2, "b");
+      // exercise
+      c.put(3, "cccccc");
+      // verify
+      assertUnit(isRecent(c, { 3 }));
+      assertUnit(c.weight() == 6);
+   }  // teardown
+
+   /***************************************
+    * RECYCLE
+    ***************************************/
+
+   // the evicted entry is the one the new key goes into
+   void test_recycle_sameEntry()
+   {  // setup
+      Cache c(3);
+      setupStandardFixture(c);
+      const void * pLeast = &c.recent.back();
+      // exercise
+      c.put(49, "forty-nine");
+      // verify
+      assertUnit(&c.recent.front() == pLeast);
+      assertUnit(c.spares.empty());
+      assertUnit(c.index.bucket_count() == 8);
+   }  // teardown
+
+   // an evicted value is destroyed right away, not when reused
+   void test_recycle_destroysValue()
+   {  // setup
+      custom::lru_cache<int, std::shared_ptr<int>> c(1);
+      std::shared_ptr<int> p = std::make_shared<int>(26);
+      std::weak_ptr<int> watch = p;
+      c.put(26, std::move(p));
+      // exercise
+      c.erase(26);
+      // verify
+      assertUnit(watch.expired());
+      assertUnit(c.spares.size() == 1);
+   }  // teardown
+
+   // a value which throws as it is copied leaves the entry with the spares
+   void test_recycle_valueThrows()
+   {  // setup
+      struct Fussy
+      {
+         Fussy(int value) : value(value) {}
+         Fussy(const Fussy & rhs) : value(rhs.value)
+         {
+            if (value < 0)
+               throw "ERROR: bad copy";
+         }
+         Fussy & operator = (const Fussy &) = default;
+         int value;
+      };
+      custom::lru_cache<int, Fussy> c(1);
+      c.put(11, Fussy(11));
+      const void * pEntry = &c.recent.front();
+      Fussy bad(-26);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         c.put(26, bad);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(c.size() == 0);
+      assertUnit(c.get(26) == nullptr);
+      assertUnit(c.spares.size() == 1);
+      assertUnit(&c.spares.front() == pEntry);
+      c.put(31, Fussy(31));
+      assertUnit(&c.recent.front() == pEntry);
+      assertUnit(c.get(31)->value == 31);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erase from the middle
+   void test_erase_standard()
+   {  // setup
+      Cache c(3);
+      setupStandardFixture(c);
+      // exercise
+      bool erased = c.erase(26);
+      bool again  = c.erase(26);
+      // verify
+      assertUnit(erased);
+      assertUnit(!again);
+      assertUnit(isRecent(c, { 31, 11 }));
+      assertUnit(c.weight() == 2);
+   }  // teardown
+
+   // clear empties the cache but keeps the entries to reuse
+   void test_clear_keepsSpares()
+   {  // setup
+      Cache c(3);
+      setupStandardFixture(c);
+      // exercise
+      c.clear();
+      // verify
+      assertUnit(c.empty());
+      assertUnit(c.weight() == 0);
+      assertUnit(c.index.empty());
+      assertUnit(c.spares.size() == 3);
+   }  // teardown
+
+   /****************************************************************
+    * IS RECENT
+    * Are these the keys, most recent first, and is each in
+    * the index?
+    ****************************************************************/
+   template <class C>
+   bool isRecent(C & c, const std::vector<int>& keys)
+   {
+      if (c.size() != keys.size() || c.index.size() != keys.size())
+         return false;
+      size_t i = 0;
+      for (auto it = c.recent.begin(); it != c.recent.end(); ++it, i++)
+         if (it->key() != keys[i] || &*c.index.find(keys[i]) != &*it)
+            return false;
+      return true;
+   }
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *   recent: 31 26 11
+    ****************************************************************/
+   void setupStandardFixture(Cache& c)
+   {
+      c.put(11, "eleven");
+      c.put(26, "twenty-six");
+      c.put(31, "thirty-one");
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    ****************************************************************/
+   void assertStandardFixtureParameters(Cache& c, int line, const char* function)
+   {
+      assertIndirect(isRecent(c, { 31, 26, 11 }));
+      assertIndirect(c.weight() == 3);
+      assertIndirect(c.spares.empty());
+   }
+};
+
+#endif // DEBUG
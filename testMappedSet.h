@@ -0,0 +1,312 @@
+/***********************************************************************
+ * Header:
+ *    TEST MAPPED SET
+ * Summary:
+ *    Unit tests for mapped_set
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "mappedSet.h"
+#include "unitTest.h"
+
+#include <cstdio>     // for std::remove
+#include <fstream>    // for std::ofstream and std::ifstream
+#include <iterator>   // for std::istreambuf_iterator
+#include <string>
+#include <vector>
+
+class TestMappedSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Write
+      test_write_layout();
+      test_write_duplicates();
+      test_write_empty();
+
+      // Open
+      test_open_notASet();
+      test_open_wrongType();
+      test_open_truncated();
+      test_open_moved();
+      test_move_leavesEmpty();
+
+      // Access
+      test_contains_integers();
+      test_find_pointsIntoMapping();
+      test_find_strings();
+      test_find_seed();
+
+      std::remove(FILE_NAME);
+      std::remove(FILE_NAME_COPY);
+      report("MappedSet");
+   }
+
+   /***************************************
+    * WRITE
+    ***************************************/
+
+   // header, tags and slots each start a cache line, no more than 3/4 full
+   void test_write_layout()
+   {  // setup
+      std::vector<int> keys;
+      for (int i = 0; i < 100; i++)
+         keys.push_back(i * 10);
+      // exercise
+      custom::mapped_set<int>::write(FILE_NAME, keys.begin(), keys.end());
+      // verify
+      custom::mapped_set<int> s = custom::mapped_set<int>::open(FILE_NAME);
+      assertUnit(s.size() == 100);
+      assertUnit(s.slot_count() == 256);
+      assertUnit(s.pHeader->offsetTags == 128);
+      assertUnit(s.pHeader->offsetSlots == 128 + 256);
+      assertUnit(s.pHeader->sizeHeap == 0);
+      assertUnit((size_t)s.pSlots % 64 == 0);
+      size_t numFull = 0;
+      for (size_t i = 0; i < s.slot_count(); i++)
+         if (s.pTags[i])
+         {
+            assertUnit(s.pTags[i] & 0x80);
+            numFull++;
+         }
+      assertUnit(numFull == 100);
+   }  // teardown
+
+   // each key is stored once however often it is given
+   void test_write_duplicates()
+   {  // setup
+      int keys[] = { 5, 7, 5, 5, 9, 7 };
+      // exercise
+      custom::mapped_set<int>::write(FILE_NAME, keys, keys + 6);
+      // verify
+      custom::mapped_set<int> s(FILE_NAME);
+      assertUnit(s.size() == 3);
+      assertUnit(s.contains(5));
+      assertUnit(s.contains(7));
+      assertUnit(s.contains(9));
+   }  // teardown
+
+   // no keys is still a valid file
+   void test_write_empty()
+   {  // setup
+      std::vector<int> keys;
+      // exercise
+      custom::mapped_set<int>::write(FILE_NAME, keys.begin(), keys.end());
+      // verify
+      custom::mapped_set<int> s(FILE_NAME);
+      assertUnit(s.is_open());
+      assertUnit(s.empty());
+      assertUnit(s.slot_count() == 8);
+      assertUnit(!s.contains(0));
+   }  // teardown
+
+   /***************************************
+    * OPEN
+    ***************************************/
+
+   // a file of something else is refused
+   void test_open_notASet()
+   {  // setup
+      {
+         std::ofstream fout(FILE_NAME, std::ios::binary | std::ios::trunc);
+         std::string junk(200, 'x');
+         fout.write(junk.data(), junk.size());
+      }
+      // exercise
+      bool thrown = openThrows<int>(FILE_NAME);
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // a set of ints cannot be opened as a set of long longs
+   void test_open_wrongType()
+   {  // setup
+      int keys[] = { 1, 2, 3 };
+      custom::mapped_set<int>::write(FILE_NAME, keys, keys + 3);
+      // exercise
+      bool thrownWrong = openThrows<long long>(FILE_NAME);
+      bool thrownRight = openThrows<int>(FILE_NAME);
+      // verify
+      assertUnit(thrownWrong);
+      assertUnit(!thrownRight);
+   }  // teardown
+
+   // a file cut short is refused before anything is read from it
+   void test_open_truncated()
+   {  // setup
+      std::vector<std::string> keys = { "alpha", "beta", "gamma" };
+      custom::mapped_set<std::string>::write(FILE_NAME, keys.begin(), keys.end());
+      std::string bytes = readFile(FILE_NAME);
+      {
+         std::ofstream fout(FILE_NAME_COPY, std::ios::binary | std::ios::trunc);
+         fout.write(bytes.data(), bytes.size() - 1);
+      }
+      // exercise
+      bool thrown = openThrows<std::string>(FILE_NAME_COPY);
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // the file has no pointers in it, so a copy works anywhere
+   void test_open_moved()
+   {  // setup
+      std::vector<std::string> keys = { "north", "south", "east", "west" };
+      custom::mapped_set<std::string>::write(FILE_NAME, keys.begin(), keys.end());
+      std::string bytes = readFile(FILE_NAME);
+      {
+         std::ofstream fout(FILE_NAME_COPY, std::ios::binary | std::ios::trunc);
+         fout.write(bytes.data(), bytes.size());
+      }
+      custom::mapped_set<std::string> s1(FILE_NAME);
+      // exercise
+      custom::mapped_set<std::string> s2(FILE_NAME_COPY);
+      // verify
+      assertUnit(s1.pHeader != s2.pHeader);
+      assertUnit(s2.size() == 4);
+      assertUnit(s2.find("east") == "east");
+      assertUnit(s1.find("west") == s2.find("west"));
+   }  // teardown
+
+   // a move takes the mapping and leaves nothing pointing into it
+   void test_move_leavesEmpty()
+   {  // setup
+      std::vector<int> keys = { 2, 3, 5, 7 };
+      custom::mapped_set<int>::write(FILE_NAME, keys.begin(), keys.end());
+      custom::mapped_set<int> sSrc(FILE_NAME);
+      const void * pHeader = sSrc.pHeader;
+      // exercise
+      custom::mapped_set<int> sDes(std::move(sSrc));
+      // verify
+      assertUnit(sDes.pHeader == pHeader);
+      assertUnit(sDes.contains(5));
+      assertUnit(!sSrc.is_open());
+      assertUnit(sSrc.pTags == nullptr);
+      assertUnit(sSrc.pSlots == nullptr);
+      assertUnit(sSrc.pHeap == nullptr);
+      assertUnit(!sSrc.contains(5));
+      sSrc = std::move(sDes);
+      assertUnit(sSrc.contains(7));
+      assertUnit(sDes.size() == 0);
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // every key written is there, nothing else is
+   void test_contains_integers()
+   {  // setup
+      std::vector<long long> keys;
+      for (long long i = 0; i < 1000; i++)
+         keys.push_back(i * 7);
+      custom::mapped_set<long long>::write(FILE_NAME, keys.begin(), keys.end());
+      custom::mapped_set<long long> s(FILE_NAME);
+      // exercise
+      size_t numHit = 0;
+      size_t numFalse = 0;
+      for (long long i = 0; i < 7000; i++)
+      {
+         bool hit = s.contains(i);
+         if (hit && i % 7 == 0)
+            numHit++;
+         else if (hit)
+            numFalse++;
+      }
+      // verify
+      assertUnit(numHit == 1000);
+      assertUnit(numFalse == 0);
+   }  // teardown
+
+   // find hands back the key where it lies in the file
+   void test_find_pointsIntoMapping()
+   {  // setup
+      double keys[] = { 1.5, 2.5, 3.5 };
+      custom::mapped_set<double>::write(FILE_NAME, keys, keys + 3);
+      custom::mapped_set<double> s(FILE_NAME);
+      // exercise
+      const double * p = s.find(2.5);
+      const double * pMissing = s.find(4.5);
+      // verify
+      assertUnit(p != nullptr);
+      assertUnit(*p == 2.5);
+      assertUnit((const char *)p >= (const char *)s.file.data());
+      assertUnit((const char *)p < (const char *)s.file.data() + s.file.size());
+      assertUnit(pMissing == nullptr);
+   }  // teardown
+
+   // strings live in the heap and come back as views of it
+   void test_find_strings()
+   {  // setup
+      std::vector<std::string> keys = { "", "a", "tag:red", "tag:green", "a much longer tag than the rest" };
+      custom::mapped_set<std::string>::write(FILE_NAME, keys.begin(), keys.end());
+      custom::mapped_set<std::string> s(FILE_NAME);
+      // exercise
+      std::string_view found = s.find(std::string("tag:green"));
+      // verify
+      assertUnit(s.size() == 5);
+      assertUnit(found == "tag:green");
+      assertUnit(found.data() >= s.pHeap);
+      assertUnit(found.data() < s.pHeap + s.pHeader->sizeHeap);
+      assertUnit(s.pHeader->sizeHeap == 0 + 1 + 7 + 9 + 31);
+      assertUnit(s.contains(""));
+      assertUnit(s.contains("a much longer tag than the rest"));
+      assertUnit(!s.contains("tag:blue"));
+      assertUnit(s.find("tag:blue").data() == nullptr);
+   }  // teardown
+
+   // another seed lays the keys out differently but finds them all
+   void test_find_seed()
+   {  // setup
+      std::vector<int> keys;
+      for (int i = 0; i < 50; i++)
+         keys.push_back(i);
+      custom::mapped_set<int>::write(FILE_NAME, keys.begin(), keys.end(), 0);
+      std::string bytes0 = readFile(FILE_NAME);
+      // exercise
+      custom::mapped_set<int>::write(FILE_NAME, keys.begin(), keys.end(), 12345);
+      // verify
+      custom::mapped_set<int> s(FILE_NAME);
+      assertUnit(s.pHeader->seed == 12345);
+      assertUnit(readFile(FILE_NAME) != bytes0);
+      for (int i = 0; i < 50; i++)
+         assertUnit(s.contains(i));
+      assertUnit(!s.contains(50));
+   }  // teardown
+
+   /***************************************
+    * HELPERS
+    ***************************************/
+
+   template <class T>
+   bool openThrows(const char * fileName)
+   {
+      try
+      {
+         custom::mapped_set<T> s(fileName);
+      }
+      catch (const char *)
+      {
+         return true;
+      }
+      return false;
+   }
+
+   std::string readFile(const char * fileName)
+   {
+      std::ifstream fin(fileName, std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+   }
+
+   const char * FILE_NAME = "testMappedSet.tmp";
+   const char * FILE_NAME_COPY = "testMappedSetCopy.tmp";
+};
+
+#endif // DEBUG
@@ -0,0 +1,346 @@
+/***********************************************************************
+ * Header:
+ *    TEST MAPPED VECTOR
+ * Summary:
+ *    Unit tests for mapped_vector
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "mappedVector.h"
+#include "unitTest.h"
+
+#include <cstdio>     // for std::remove
+#include <fstream>    // for std::ofstream
+
+class TestMappedVector : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_open_new();
+      test_open_existing();
+      test_open_readOnly();
+      test_open_readOnlyShrunk();
+      test_open_readOnlyWrite();
+      test_open_partialRecord();
+
+      // Insert
+      test_pushback_empty();
+      test_pushback_grow();
+      test_resize_grow();
+
+      // Remove
+      test_close_trims();
+      test_close_explicit();
+      test_shrink_standard();
+
+      // Iterator
+      test_iterator_standard();
+
+      std::remove(FILE_NAME);
+      report("MappedVector");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // a new file is an empty vector
+   void test_open_new()
+   {  // setup
+      std::remove(FILE_NAME);
+      // exercise
+      custom::mapped_vector<int> v(FILE_NAME);
+      // verify
+      assertUnit(v.numElements == 0);
+      assertUnit(v.numCapacity == 0);
+      assertUnit(v.file.is_open());
+      assertUnit(v.file.data() == nullptr);
+   }  // teardown
+
+   // every record in an existing file is an element
+   void test_open_existing()
+   {  // setup
+      writeStandardFile();
+      // exercise
+      custom::mapped_vector<int> v(FILE_NAME);
+      // verify
+      assertStandardFixture(v);
+   }  // teardown
+
+   // a read-only file can be read but not grown
+   void test_open_readOnly()
+   {  // setup
+      writeStandardFile();
+      custom::mapped_vector<int> v(FILE_NAME, true /*readOnly*/);
+      // exercise
+      bool thrown = false;
+      try
+      {
+         v.push_back(99);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(v.read_only());
+      assertStandardFixture(v);
+   }  // teardown
+
+   // a read-only file cannot be shrunk either, so there is never room to write
+   void test_open_readOnlyShrunk()
+   {  // setup
+      writeStandardFile();
+      custom::mapped_vector<int> v(FILE_NAME, true /*readOnly*/);
+      // exercise
+      bool thrownPop = false;
+      bool thrownClear = false;
+      bool thrownResize = false;
+      try
+      {
+         v.pop_back();
+      }
+      catch (const char *)
+      {
+         thrownPop = true;
+      }
+      try
+      {
+         v.clear();
+      }
+      catch (const char *)
+      {
+         thrownClear = true;
+      }
+      try
+      {
+         v.resize(2);
+      }
+      catch (const char *)
+      {
+         thrownResize = true;
+      }
+      // verify
+      assertUnit(thrownPop);
+      assertUnit(thrownClear);
+      assertUnit(thrownResize);
+      assertStandardFixture(v);
+   }  // teardown
+
+   // writing into a read-only vector never reaches the file
+   void test_open_readOnlyWrite()
+   {  // setup
+      writeStandardFile();
+      {
+         custom::mapped_vector<int> v(FILE_NAME, true /*readOnly*/);
+         // exercise
+         v[0] = 99;
+         *v.begin() += 1;
+         v.back() = 11;
+         assertUnit(v[0] == 100);
+      }
+      // verify
+      custom::mapped_vector<int> v(FILE_NAME);
+      assertStandardFixture(v);
+   }  // teardown
+
+   // a file which is not a whole number of records is rejected
+   void test_open_partialRecord()
+   {  // setup
+      {
+         std::ofstream fout(FILE_NAME, std::ios::binary | std::ios::trunc);
+         fout.write("abcdef", 6);
+      }
+      custom::mapped_vector<int> v;
+      // exercise
+      bool thrown = false;
+      try
+      {
+         v.open(FILE_NAME);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(v.numElements == 0);
+      assertUnit(!v.file.is_open());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first push_back lengthens the file to a cache line
+   void test_pushback_empty()
+   {  // setup
+      std::remove(FILE_NAME);
+      custom::mapped_vector<int> v(FILE_NAME);
+      // exercise
+      v.push_back(26);
+      // verify
+      assertUnit(v.numElements == 1);
+      assertUnit(v.numCapacity == 16);
+      assertUnit(v.file.size() == 16 * sizeof(int));
+      assertUnit(v[0] == 26);
+   }  // teardown
+
+   // values survive the file growing and being mapped again
+   void test_pushback_grow()
+   {  // setup
+      std::remove(FILE_NAME);
+      custom::mapped_vector<int> v(FILE_NAME);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         v.push_back(i);
+      // verify
+      assertUnit(v.numElements == 1000);
+      assertUnit(v.numCapacity >= 1000);
+      assertUnit(v.file.size() == v.numCapacity * sizeof(int));
+      bool same = true;
+      for (int i = 0; i < 1000; i++)
+         same = same && v[i] == i;
+      assertUnit(same);
+   }  // teardown
+
+   // resize fills the new records
+   void test_resize_grow()
+   {  // setup
+      writeStandardFile();
+      custom::mapped_vector<int> v(FILE_NAME);
+      // exercise
+      v.resize(6, 99);
+      // verify
+      assertUnit(v.numElements == 6);
+      assertUnit(v.numCapacity == 6);
+      assertUnit(v[3] == 89);
+      assertUnit(v[4] == 99);
+      assertUnit(v[5] == 99);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // closing drops the unused capacity so reopening sees only the elements
+   void test_close_trims()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_vector<int> v(FILE_NAME);
+         v.push_back(26);
+         v.push_back(49);
+         v.push_back(67);
+         v.push_back(89);
+         assertUnit(v.numCapacity == 16);
+      }
+      // exercise
+      custom::mapped_vector<int> v(FILE_NAME);
+      // verify
+      assertStandardFixture(v);
+   }  // teardown
+
+   // close() trims too, and leaves the vector empty and closed
+   void test_close_explicit()
+   {  // setup
+      std::remove(FILE_NAME);
+      custom::mapped_vector<int> v(FILE_NAME);
+      v.push_back(26);
+      v.push_back(49);
+      v.push_back(67);
+      v.push_back(89);
+      // exercise
+      v.close();
+      v.close();
+      // verify
+      assertUnit(v.size() == 0);
+      assertUnit(v.capacity() == 0);
+      assertUnit(!v.file.is_open());
+      v.open(FILE_NAME);
+      assertStandardFixture(v);
+   }  // teardown
+
+   // shrink_to_fit gives back the extra records
+   void test_shrink_standard()
+   {  // setup
+      writeStandardFile();
+      custom::mapped_vector<int> v(FILE_NAME);
+      v.pop_back();
+      // exercise
+      v.shrink_to_fit();
+      // verify
+      assertUnit(v.numElements == 3);
+      assertUnit(v.numCapacity == 3);
+      assertUnit(v.file.size() == 3 * sizeof(int));
+      assertUnit(v.back() == 67);
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walk the mapped records
+   void test_iterator_standard()
+   {  // setup
+      writeStandardFile();
+      custom::mapped_vector<int> v(FILE_NAME);
+      // exercise
+      int sum = 0;
+      int count = 0;
+      for (auto it = v.begin(); it != v.end(); ++it)
+      {
+         sum += *it;
+         count++;
+      }
+      // verify
+      assertUnit(count == 4);
+      assertUnit(sum == 26 + 49 + 67 + 89);
+   }  // teardown
+
+   /*************************************************************
+    * WRITE STANDARD FILE
+    *      0    1    2    3
+    *    +----+----+----+----+
+    *    | 26 | 49 | 67 | 89 |
+    *    +----+----+----+----+
+    *************************************************************/
+   void writeStandardFile()
+   {
+      int records[] = { 26, 49, 67, 89 };
+      std::ofstream fout(FILE_NAME, std::ios::binary | std::ios::trunc);
+      fout.write((const char *)records, sizeof(records));
+   }
+
+   /*************************************************************
+    * VERIFY STANDARD FIXTURE PARAMETERS
+    *************************************************************/
+   void assertStandardFixtureParameters(const custom::mapped_vector<int>& v, int line, const char* function)
+   {
+      assertIndirect(v.numElements == 4);
+      assertIndirect(v.numCapacity == 4);
+      assertIndirect(v.file.size() == 4 * sizeof(int));
+
+      if (v.numElements == 4)
+      {
+         assertIndirect(v[0] == 26);
+         assertIndirect(v[1] == 49);
+         assertIndirect(v[2] == 67);
+         assertIndirect(v[3] == 89);
+      }
+   }
+
+   const char * FILE_NAME = "testMappedVector.tmp";
+};
+
+#endif // DEBUG
@@ -0,0 +1,238 @@
+/***********************************************************************
+ * Header:
+ *    TEST MPSC QUEUE
+ * Summary:
+ *    Unit tests for mpsc_queue
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "mpscQueue.h"
+#include "unitTest.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestMpscQueue : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Push and pop
+      test_pop_empty();
+      test_push_one();
+      test_push_fifo();
+      test_push_string();
+
+      // Pool
+      test_pool_reuse();
+      test_pool_limit();
+
+      // Destruct
+      test_destructor_leftovers();
+
+      // Threads
+      test_threads_producers();
+
+      report("MpscQueue");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // a new queue is just the stub
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::mpsc_queue<int> q;
+      // verify
+      assertUnit(q.pTail != nullptr);
+      assertUnit(q.pHead.load() == q.pTail);
+      assertUnit(q.pTail->pNext.load() == nullptr);
+      assertUnit(q.pPool == nullptr);
+      assertUnit(q.empty());
+   }  // teardown
+
+   /***************************************
+    * PUSH and POP
+    ***************************************/
+
+   // nothing to pop leaves the output alone
+   void test_pop_empty()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      int value = 99;
+      // exercise
+      bool popped = q.pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+   }  // teardown
+
+   // push links a node after the stub
+   void test_push_one()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      custom::mpsc_queue<int>::Node * pStub = q.pTail;
+      // exercise
+      q.push(26);
+      // verify
+      assertUnit(!q.empty());
+      assertUnit(q.pTail == pStub);
+      assertUnit(q.pTail->pNext.load() == q.pHead.load());
+      assertUnit(*q.pHead.load()->data() == 26);
+   }  // teardown
+
+   // first in, first out
+   void test_push_fifo()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      q.push(11);
+      q.push(26);
+      q.push(31);
+      // exercise
+      int a = 0;
+      int b = 0;
+      int c = 0;
+      int d = 0;
+      bool popped = q.pop(a) && q.pop(b) && q.pop(c);
+      // verify
+      assertUnit(popped);
+      assertUnit(a == 11);
+      assertUnit(b == 26);
+      assertUnit(c == 31);
+      assertUnit(!q.pop(d));
+      assertUnit(q.empty());
+   }  // teardown
+
+   // values which own memory are moved through
+   void test_push_string()
+   {  // setup
+      custom::mpsc_queue<std::string> q;
+      std::string s(100, 'x');
+      // exercise
+      q.push(std::move(s));
+      q.push(std::string("short"));
+      std::string first;
+      std::string second;
+      q.pop(first);
+      q.pop(second);
+      // verify
+      assertUnit(first == std::string(100, 'x'));
+      assertUnit(second == "short");
+   }  // teardown
+
+   /***************************************
+    * POOL
+    ***************************************/
+
+   // a popped node is handed to the next push
+   void test_pool_reuse()
+   {  // setup
+      custom::mpsc_queue<int> q;
+      int value = 0;
+      q.push(11);
+      custom::mpsc_queue<int>::Node * pStub = q.pTail;
+      q.pop(value);
+      assertUnit(q.pPool == pStub);
+      assertUnit(q.numPool == 1);
+      // exercise
+      q.push(26);
+      // verify
+      assertUnit(q.pHead.load() == pStub);
+      assertUnit(q.pPool == nullptr);
+      assertUnit(q.numPool == 0);
+      assertUnit(q.pop(value) && value == 26);
+   }  // teardown
+
+   // the pool never grows past its limit
+   void test_pool_limit()
+   {  // setup
+      custom::mpsc_queue<int> q(2);
+      for (int i = 0; i < 5; i++)
+         q.push(i);
+      // exercise
+      int value = 0;
+      while (q.pop(value))
+         ;
+      // verify
+      assertUnit(q.numPool == 2);
+      assertUnit(value == 4);
+   }  // teardown
+
+   /***************************************
+    * DESTRUCT
+    ***************************************/
+
+   // values never popped are destroyed with the queue
+   void test_destructor_leftovers()
+   {  // setup
+      std::weak_ptr<int> watch;
+      {
+         custom::mpsc_queue<std::shared_ptr<int>> q;
+         std::shared_ptr<int> p = std::make_shared<int>(26);
+         watch = p;
+         q.push(std::move(p));
+         assertUnit(!watch.expired());
+         // exercise
+      }
+      // verify
+      assertUnit(watch.expired());
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // four producers; every value arrives once and each producer's in order
+   void test_threads_producers()
+   {  // setup
+      const int numProducers = 4;
+      const int numEach = 20000;
+      custom::mpsc_queue<int> q;
+      std::vector<std::thread> producers;
+      // exercise
+      for (int p = 0; p < numProducers; p++)
+         producers.push_back(std::thread([&q, p]()
+         {
+            for (int i = 0; i < numEach; i++)
+               q.push(p * numEach + i);
+         }));
+      std::vector<int> next(numProducers, 0);
+      bool inOrder = true;
+      int numPopped = 0;
+      while (numPopped < numProducers * numEach)
+      {
+         int value;
+         if (!q.pop(value))
+            continue;
+         int p = value / numEach;
+         inOrder = inOrder && value % numEach == next[p];
+         next[p]++;
+         numPopped++;
+      }
+      for (std::thread & t : producers)
+         t.join();
+      // verify
+      assertUnit(inOrder);
+      assertUnit(q.empty());
+      bool all = true;
+      for (int p = 0; p < numProducers; p++)
+         all = all && next[p] == numEach;
+      assertUnit(all);
+   }  // teardown
+};
+
+#endif // DEBUG
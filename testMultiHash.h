@@ -0,0 +1,403 @@
+/***********************************************************************
+ * Header:
+ *    TEST MULTI HASH
+ * Summary:
+ *    Unit tests for unordered_multiset and unordered_multimap
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "multiHash.h"
+#include "unitTest.h"
+
+#include <string>
+
+class TestMultiHash : public UnitTest
+{
+public:
+   typedef custom::unordered_multiset<int> Set;
+   typedef custom::unordered_multimap<int, std::string> Map;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_initializerList();
+      test_construct_copy();
+      test_construct_move();
+
+      // Insert
+      test_insert_duplicates();
+      test_insert_newGroupAtFront();
+      test_insert_groupsAdjacent();
+      test_insert_oneHeadPerKey();
+
+      // Access
+      test_count_missing();
+      test_equalRange_middle();
+      test_equalRange_endOfBucket();
+      test_equalRange_missing();
+
+      // Iterator
+      test_iterator_everyElement();
+
+      // Remove
+      test_erase_iterator();
+      test_erase_iteratorLastOfGroup();
+      test_erase_iteratorMiddle();
+      test_erase_group();
+      test_clear_standard();
+
+      // Map
+      test_map_manyValues();
+      test_map_erase();
+
+      report("MultiHash");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // an empty multiset has ten empty buckets
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Set s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.bucket_count() == 10);
+      assertUnit(s.begin() == s.end());
+   }  // teardown
+
+   // every duplicate in the list is kept
+   void test_construct_initializerList()
+   {  // setup
+      // exercise
+      Set s{ 3, 13, 3, 3 };
+      // verify
+      //    h[3] --> [ 3 3 3 ] [ 13 ]
+      assertUnit(s.size() == 4);
+      assertUnit(s.bucket_size(3) == 4);
+      assertUnit(s.count(3) == 3);
+      assertUnit(s.count(13) == 1);
+   }  // teardown
+
+   // a copy has the same groups in the same order
+   void test_construct_copy()
+   {  // setup
+      Set sSrc{ 3, 13, 3 };
+      // exercise
+      Set sDes(sSrc);
+      // verify
+      assertUnit(sDes.size() == 3);
+      assertUnit(sDes.buckets != sSrc.buckets);
+      assertUnit(sDes.buckets[3].front() == sSrc.buckets[3].front());
+      assertUnit(sDes.buckets[3].back() == sSrc.buckets[3].back());
+      assertUnit(sDes.count(3) == 2);
+      assertUnit(sDes.heads[3].size() == 2);
+      assertUnit(sDes.heads[3].front() == sDes.buckets[3].begin());
+      assertUnit(sSrc.size() == 3);
+   }  // teardown
+
+   // a move takes the buckets
+   void test_construct_move()
+   {  // setup
+      Set sSrc{ 3, 3, 4 };
+      custom::list<int> * pBuckets = sSrc.buckets;
+      // exercise
+      Set sDes(std::move(sSrc));
+      // verify
+      assertUnit(sDes.buckets == pBuckets);
+      assertUnit(sDes.size() == 3);
+      assertUnit(sSrc.size() == 0);
+      assertUnit(sSrc.begin() == sSrc.end());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // insert never refuses
+   void test_insert_duplicates()
+   {  // setup
+      Set s;
+      // exercise
+      for (int i = 0; i < 5; i++)
+         s.insert(7);
+      // verify
+      assertUnit(s.size() == 5);
+      assertUnit(s.count(7) == 5);
+      assertUnit(*s.insert(7) == 7);
+      assertUnit(s.count(7) == 6);
+   }  // teardown
+
+   // a key new to its bucket goes in at the front
+   void test_insert_newGroupAtFront()
+   {  // setup
+      Set s{ 3, 13 };
+      // exercise
+      Set::iterator it = s.insert(23);
+      // verify
+      //    h[3] --> [ 23 ] [ 13 ] [ 3 ]
+      assertUnit(*it == 23);
+      assertUnit(it.itList == s.buckets[3].begin());
+      assertUnit(s.buckets[3].front() == 23);
+      assertUnit(s.buckets[3].back() == 3);
+   }  // teardown
+
+   // however they arrive, equal elements end up side by side
+   void test_insert_groupsAdjacent()
+   {  // setup
+      Set s;
+      int keys[] = { 3, 13, 23, 13, 3, 23, 13, 3 };
+      // exercise
+      for (int k : keys)
+         s.insert(k);
+      // verify
+      //    h[3] --> [ 23 23 ] [ 13 13 13 ] [ 3 3 3 ]
+      int expected[] = { 23, 23, 13, 13, 13, 3, 3, 3 };
+      size_t i = 0;
+      for (auto it = s.buckets[3].begin(); it != s.buckets[3].end(); ++it)
+         assertUnit(*it == expected[i++]);
+      assertUnit(i == 8);
+   }  // teardown
+
+   // duplicates never add a group head, only a new key does
+   void test_insert_oneHeadPerKey()
+   {  // setup
+      Set s;
+      for (int i = 0; i < 100; i++)
+         s.insert(3);
+      // exercise
+      Set::iterator it = s.insert(13);
+      s.insert(3);
+      // verify
+      //    h[3] --> [ 13 ] [ 3 x 101 ]
+      //    heads[3] --> [ 13 ] [ 3 ]
+      assertUnit(s.heads[3].size() == 2);
+      assertUnit(s.heads[3].front() == it.itList);
+      assertUnit(*s.heads[3].back() == 3);
+      assertUnit(s.count(3) == 101);
+      assertUnit(s.count(13) == 1);
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // nothing to count
+   void test_count_missing()
+   {  // setup
+      Set s{ 3, 3 };
+      // exercise
+      size_t num = s.count(13);
+      // verify
+      assertUnit(num == 0);
+      assertUnit(s.find(13) == s.end());
+   }  // teardown
+
+   // a group in the middle of its bucket
+   void test_equalRange_middle()
+   {  // setup
+      Set s{ 3, 13, 13, 23 };
+      // exercise
+      auto range = s.equal_range(13);
+      // verify
+      //    h[3] --> [ 23 ] [ 13 13 ] [ 3 ]
+      size_t num = 0;
+      for (auto it = range.first; it != range.second; ++it)
+      {
+         assertUnit(*it == 13);
+         num++;
+      }
+      assertUnit(num == 2);
+      assertUnit(*range.second == 3);
+   }  // teardown
+
+   // a group at the back of its bucket ends at the next bucket
+   void test_equalRange_endOfBucket()
+   {  // setup
+      Set s{ 3, 3, 13, 5 };
+      // exercise
+      auto range = s.equal_range(3);
+      // verify
+      //    h[3] --> [ 13 ] [ 3 3 ]
+      //    h[5] --> [ 5 ]
+      assertUnit(*range.first == 3);
+      assertUnit(range.second != s.end());
+      assertUnit(*range.second == 5);
+      assertUnit(range.second.pBucket == s.buckets + 5);
+      auto rangeLast = s.equal_range(5);
+      assertUnit(rangeLast.second == s.end());
+   }  // teardown
+
+   // a missing key is an empty range
+   void test_equalRange_missing()
+   {  // setup
+      Set s{ 3 };
+      // exercise
+      auto range = s.equal_range(13);
+      // verify
+      assertUnit(range.first == s.end());
+      assertUnit(range.second == s.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // every copy of every element is visited once
+   void test_iterator_everyElement()
+   {  // setup
+      Set s;
+      for (int i = 0; i < 30; i++)
+      {
+         s.insert(i);
+         s.insert(i);
+      }
+      int sum = 0;
+      size_t num = 0;
+      // exercise
+      for (auto it = s.begin(); it != s.end(); it++)
+      {
+         sum += *it;
+         num++;
+      }
+      // verify
+      assertUnit(num == 60);
+      assertUnit(sum == 2 * 435);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // one copy goes, the rest of the group stays
+   void test_erase_iterator()
+   {  // setup
+      Set s{ 3, 3, 3 };
+      // exercise
+      Set::iterator it = s.erase(s.find(3));
+      // verify
+      assertUnit(s.size() == 2);
+      assertUnit(s.count(3) == 2);
+      assertUnit(*it == 3);
+      assertUnit(s.heads[3].front() == s.buckets[3].begin());
+   }  // teardown
+
+   // erasing the only element of a group drops the group's head
+   void test_erase_iteratorLastOfGroup()
+   {  // setup
+      Set s{ 3, 3, 13, 23 };
+      // exercise
+      s.erase(s.find(13));
+      // verify
+      //    h[3] --> [ 23 ] [ 3 3 ]
+      assertUnit(s.heads[3].size() == 2);
+      assertUnit(s.count(13) == 0);
+      assertUnit(s.count(3) == 2);
+      assertUnit(s.count(23) == 1);
+      s.insert(13);
+      assertUnit(s.count(13) == 1);
+   }  // teardown
+
+   // erasing behind the head leaves the head alone
+   void test_erase_iteratorMiddle()
+   {  // setup
+      Set s{ 3, 3, 3 };
+      Set::iterator it = s.find(3);
+      ++it;
+      // exercise
+      s.erase(it);
+      // verify
+      assertUnit(s.heads[3].size() == 1);
+      assertUnit(s.heads[3].front() == s.buckets[3].begin());
+      assertUnit(s.count(3) == 2);
+   }  // teardown
+
+   // erasing a key takes its whole group
+   void test_erase_group()
+   {  // setup
+      Set s{ 3, 13, 13, 13, 23 };
+      // exercise
+      size_t num = s.erase(13);
+      // verify
+      assertUnit(num == 3);
+      assertUnit(s.size() == 2);
+      assertUnit(s.count(13) == 0);
+      assertUnit(s.count(3) == 1);
+      assertUnit(s.count(23) == 1);
+      assertUnit(s.erase(13) == 0);
+   }  // teardown
+
+   // clear empties every bucket
+   void test_clear_standard()
+   {  // setup
+      Set s{ 1, 1, 2, 3 };
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.begin() == s.end());
+      for (size_t i = 0; i < s.bucket_count(); i++)
+         assertUnit(s.bucket_size(i) == 0);
+   }  // teardown
+
+   /***************************************
+    * MAP
+    ***************************************/
+
+   // one key, several values, all in one group
+   void test_map_manyValues()
+   {  // setup
+      Map m;
+      // exercise
+      m.insert(4, std::string("red"));
+      m.insert(14, std::string("green"));
+      m.insert(4, std::string("blue"));
+      m.insert(4, std::string("red"));
+      // verify
+      assertUnit(m.size() == 4);
+      assertUnit(m.count(4) == 3);
+      assertUnit(m.count(14) == 1);
+      auto range = m.equal_range(4);
+      size_t num = 0;
+      size_t numRed = 0;
+      for (auto it = range.first; it != range.second; ++it)
+      {
+         assertUnit((*it).first == 4);
+         if ((*it).second == "red")
+            numRed++;
+         num++;
+      }
+      assertUnit(num == 3);
+      assertUnit(numRed == 2);
+      assertUnit((*m.find(14)).second == "green");
+   }  // teardown
+
+   // erasing a key takes all its values
+   void test_map_erase()
+   {  // setup
+      Map m;
+      m.insert(4, std::string("red"));
+      m.insert(4, std::string("blue"));
+      m.insert(5, std::string("five"));
+      // exercise
+      size_t num = m.erase(4);
+      // verify
+      assertUnit(num == 2);
+      assertUnit(m.size() == 1);
+      assertUnit(m.find(4) == m.end());
+      assertUnit((*m.begin()).second == "five");
+   }  // teardown
+};
+
+#endif // DEBUG
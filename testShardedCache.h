@@ -0,0 +1,277 @@
+/***********************************************************************
+ * Header:
+ *    TEST SHARDED CACHE
+ * Summary:
+ *    Unit tests for sharded_cache
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "shardedCache.h"
+#include "unitTest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestShardedCache : public UnitTest
+{
+public:
+   typedef custom::sharded_cache<int, std::string> Cache;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_roundsShards();
+      test_construct_oneShard();
+
+      // Access
+      test_get_missing();
+      test_get_hit();
+
+      // Insert
+      test_put_replace();
+      test_put_secondChance();
+      test_put_sweepsAll();
+      test_put_spreadsShards();
+
+      // Remove
+      test_erase_reusesSlot();
+
+      // Threads
+      test_threads_mixed();
+
+      report("ShardedCache");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // shards round up to a power of two and share the capacity
+   void test_construct_roundsShards()
+   {  // setup
+      // exercise
+      Cache c(100, 5);
+      // verify
+      assertUnit(c.shard_count() == 8);
+      assertUnit(c.shardBits == 3);
+      assertUnit(c.numSlots == 13);
+      assertUnit(c.capacity() == 104);
+      assertUnit(c.size() == 0);
+      assertUnit(c.shards[7].spare.size() == 13);
+   }  // teardown
+
+   // one shard means one ring holding everything
+   void test_construct_oneShard()
+   {  // setup
+      // exercise
+      Cache c(3, 1);
+      // verify
+      assertUnit(c.shard_count() == 1);
+      assertUnit(c.shardBits == 0);
+      assertUnit(c.capacity() == 3);
+      assertUnit(&c.shard_of(26) == c.shards);
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // a miss is counted and leaves the output alone
+   void test_get_missing()
+   {  // setup
+      Cache c(3, 1);
+      std::string value = "unchanged";
+      // exercise
+      bool found = c.get(26, value);
+      // verify
+      assertUnit(!found);
+      assertUnit(value == "unchanged");
+      custom::cache_stats s = c.stats(0);
+      assertUnit(s.misses == 1);
+      assertUnit(s.hits == 0);
+   }  // teardown
+
+   // a hit copies the value out and sets the referenced bit
+   void test_get_hit()
+   {  // setup
+      Cache c(3, 1);
+      setupStandardFixture(c);
+      std::string value;
+      // exercise
+      bool found = c.get(26, value);
+      // verify
+      assertUnit(found);
+      assertUnit(value == "twenty-six");
+      assertUnit(isReferenced(c, 26));
+      assertUnit(!isReferenced(c, 11));
+      assertUnit(c.stats().hits == 1);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // putting a cached key replaces its value in its slot
+   void test_put_replace()
+   {  // setup
+      Cache c(3, 1);
+      setupStandardFixture(c);
+      // exercise
+      c.put(26, "TWENTY-SIX");
+      // verify
+      std::string value;
+      assertUnit(c.get(26, value) && value == "TWENTY-SIX");
+      assertUnit(c.size() == 3);
+      assertUnit(c.stats().evictions == 0);
+   }  // teardown
+
+   // the hand skips a referenced slot once
+   void test_put_secondChance()
+   {  // setup
+      Cache c(3, 1);
+      setupStandardFixture(c);
+      std::string value;
+      c.get(11, value);
+      // exercise
+      c.put(49, "forty-nine");
+      // verify
+      assertUnit(!isReferenced(c, 11));
+      assertUnit(!isReferenced(c, 49));
+      assertUnit(c.shards[0].hand == 2);
+      assertUnit(c.stats().evictions == 1);
+      assertUnit(c.get(11, value));
+      assertUnit(!c.get(26, value));
+      assertUnit(c.get(31, value));
+      assertUnit(c.get(49, value));
+   }  // teardown
+
+   // when every slot is referenced the hand goes all the way round
+   void test_put_sweepsAll()
+   {  // setup
+      Cache c(3, 1);
+      setupStandardFixture(c);
+      std::string value;
+      c.get(11, value);
+      c.get(26, value);
+      c.get(31, value);
+      // exercise
+      c.put(49, "forty-nine");
+      // verify
+      assertUnit(!c.get(11, value));
+      assertUnit(!isReferenced(c, 26));
+      assertUnit(!isReferenced(c, 31));
+      assertUnit(c.shards[0].hand == 1);
+      assertUnit(c.size() == 3);
+   }  // teardown
+
+   // many keys land in every shard, and the counts add up
+   void test_put_spreadsShards()
+   {  // setup
+      Cache c(1000, 4);
+      // exercise
+      for (int i = 0; i < 400; i++)
+         c.put(i, "x");
+      // verify
+      bool everyShard = true;
+      for (size_t i = 0; i < c.shard_count(); i++)
+         everyShard = everyShard && c.stats(i).size > 50;
+      assertUnit(everyShard);
+      assertUnit(c.size() == 400);
+      assertUnit(c.stats().size == 400);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // an erased slot is filled before anything is evicted
+   void test_erase_reusesSlot()
+   {  // setup
+      Cache c(3, 1);
+      setupStandardFixture(c);
+      // exercise
+      bool erased = c.erase(26);
+      bool again = c.erase(26);
+      c.put(49, "forty-nine");
+      // verify
+      assertUnit(erased);
+      assertUnit(!again);
+      assertUnit(c.size() == 3);
+      assertUnit(c.stats().evictions == 0);
+      assertUnit(c.shards[0].index.find(49)->used);
+      assertUnit(&*c.shards[0].index.find(49) == c.shards[0].slots + 1);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // four threads reading and writing; every get is a hit or a miss
+   void test_threads_mixed()
+   {  // setup
+      const int numThreads = 4;
+      const int numEach = 20000;
+      custom::sharded_cache<int, int> c(256, 8);
+      std::vector<std::thread> threads;
+      bool right[numThreads] = {};
+      // exercise
+      for (int t = 0; t < numThreads; t++)
+         threads.push_back(std::thread([&c, &right, t]()
+         {
+            bool ok = true;
+            for (int i = 0; i < numEach; i++)
+            {
+               int key = (i * 7 + t) % 512;
+               int value = -1;
+               if (c.get(key, value))
+                  ok = ok && value == key * 10;
+               else
+                  c.put(key, key * 10);
+               if (i % 100 == 0)
+                  c.erase(key);
+            }
+            right[t] = ok;
+         }));
+      for (std::thread & t : threads)
+         t.join();
+      // verify
+      custom::cache_stats s = c.stats();
+      assertUnit(right[0] && right[1] && right[2] && right[3]);
+      assertUnit(s.hits + s.misses == numThreads * numEach);
+      assertUnit(s.size <= c.capacity());
+      assertUnit(s.evictions > 0);
+   }  // teardown
+
+   /****************************************************************
+    * IS REFERENCED
+    * Is this key cached with its referenced bit set?
+    ****************************************************************/
+   template <class C>
+   bool isReferenced(C & c, int key)
+   {
+      auto & shard = c.shard_of(key);
+      auto it = shard.index.find(key);
+      return it != shard.index.end() && it->referenced.load();
+   }
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *   slots: [11][26][31]  hand at 0, nothing referenced
+    ****************************************************************/
+   void setupStandardFixture(Cache& c)
+   {
+      c.put(11, "eleven");
+      c.put(26, "twenty-six");
+      c.put(31, "thirty-one");
+   }
+};
+
+#endif // DEBUG
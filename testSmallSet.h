@@ -0,0 +1,374 @@
+/***********************************************************************
+ * Header:
+ *    TEST SMALL SET
+ * Summary:
+ *    Unit tests for small_unordered_set
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "smallSet.h"
+#include "unitTest.h"
+
+#include <string>
+
+class TestSmallSet : public UnitTest
+{
+public:
+   typedef custom::small_unordered_set<int, 4> Set;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_initializerList();
+      test_constructCopy_small();
+      test_constructCopy_big();
+      test_constructMove_small();
+      test_constructMove_big();
+
+      // Insert
+      test_insert_inline();
+      test_insert_duplicate();
+      test_insert_promotes();
+      test_insert_string();
+
+      // Find and iterate
+      test_find_small();
+      test_find_big();
+      test_iterate_small();
+      test_iterate_big();
+
+      // Remove
+      test_erase_lastFillsHole();
+      test_erase_missing();
+      test_clear_demotes();
+
+      report("SmallSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // an empty set has nothing on the heap
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Set s;
+      // verify
+      assertEmptyFixture(s);
+      assertUnit(s.pBig == nullptr);
+      assertUnit(sizeof(Set) == 4 * sizeof(int) + sizeof(size_t) + sizeof(void *));
+   }  // teardown
+
+   // a short list stays inline
+   void test_construct_initializerList()
+   {  // setup
+      // exercise
+      Set s{ 26, 49, 67 };
+      // verify
+      assertStandardFixture(s);
+   }  // teardown
+
+   // copy the inline elements
+   void test_constructCopy_small()
+   {  // setup
+      Set sSrc;
+      setupStandardFixture(sSrc);
+      // exercise
+      Set sDes(sSrc);
+      // verify
+      assertStandardFixture(sDes);
+      assertStandardFixture(sSrc);
+   }  // teardown
+
+   // copy the hash
+   void test_constructCopy_big()
+   {  // setup
+      Set sSrc;
+      setupComplexFixture(sSrc);
+      // exercise
+      Set sDes(sSrc);
+      // verify
+      assertComplexFixture(sDes);
+      assertComplexFixture(sSrc);
+      assertUnit(sDes.pBig != sSrc.pBig);
+   }  // teardown
+
+   // move the inline elements one at a time
+   void test_constructMove_small()
+   {  // setup
+      Set sSrc;
+      setupStandardFixture(sSrc);
+      // exercise
+      Set sDes(std::move(sSrc));
+      // verify
+      assertStandardFixture(sDes);
+      assertEmptyFixture(sSrc);
+   }  // teardown
+
+   // take the hash
+   void test_constructMove_big()
+   {  // setup
+      Set sSrc;
+      setupComplexFixture(sSrc);
+      const void * pBig = sSrc.pBig;
+      // exercise
+      Set sDes(std::move(sSrc));
+      // verify
+      assertComplexFixture(sDes);
+      assertUnit(sDes.pBig == pBig);
+      assertEmptyFixture(sSrc);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first N go into the array in order
+   void test_insert_inline()
+   {  // setup
+      Set s;
+      // exercise
+      custom::pair<Set::iterator, bool> result = s.insert(26);
+      s.insert(49);
+      s.insert(67);
+      // verify
+      assertUnit(result.second);
+      assertUnit(*result.first == 26);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // a duplicate is found by the scan
+   void test_insert_duplicate()
+   {  // setup
+      Set s;
+      setupStandardFixture(s);
+      // exercise
+      custom::pair<Set::iterator, bool> result = s.insert(49);
+      // verify
+      assertUnit(!result.second);
+      assertUnit(*result.first == 49);
+      assertStandardFixture(s);
+   }  // teardown
+
+   // the fifth element moves everything into a hash
+   void test_insert_promotes()
+   {  // setup
+      Set s;
+      for (int i = 1; i <= 4; i++)
+         s.insert(i * 10);
+      assertUnit(s.is_small());
+      // exercise
+      custom::pair<Set::iterator, bool> result = s.insert(50);
+      // verify
+      assertUnit(result.second);
+      assertUnit(!s.is_small());
+      assertUnit(s.numInline == 0);
+      assertUnit(s.size() == 5);
+      assertUnit(s.pBig->size() == 5);
+      bool all = true;
+      for (int i = 1; i <= 5; i++)
+         all = all && s.count(i * 10) == 1;
+      assertUnit(all);
+   }  // teardown
+
+   // elements which own memory are constructed and destroyed in place
+   void test_insert_string()
+   {  // setup
+      custom::small_unordered_set<std::string, 2> s;
+      // exercise
+      s.insert(std::string(100, 'a'));
+      s.insert("b");
+      s.erase(std::string(100, 'a'));
+      s.insert("c");
+      s.insert("d");
+      // verify
+      assertUnit(s.size() == 3);
+      assertUnit(!s.is_small());
+      assertUnit(s.count("b") == 1);
+      assertUnit(s.count(std::string(100, 'a')) == 0);
+   }  // teardown
+
+   /***************************************
+    * FIND and ITERATE
+    ***************************************/
+
+   // find points into the array
+   void test_find_small()
+   {  // setup
+      Set s;
+      setupStandardFixture(s);
+      // exercise
+      Set::iterator it = s.find(49);
+      // verify
+      assertUnit(it.p == s.data() + 1);
+      assertUnit(s.find(99) == s.end());
+   }  // teardown
+
+   // find goes through the hash
+   void test_find_big()
+   {  // setup
+      Set s;
+      setupComplexFixture(s);
+      // exercise
+      Set::iterator it = s.find(67);
+      // verify
+      assertUnit(it != s.end());
+      assertUnit(*it == 67);
+      assertUnit(it.p == nullptr);
+      assertUnit(s.find(99) == s.end());
+   }  // teardown
+
+   // visit the inline elements in order
+   void test_iterate_small()
+   {  // setup
+      Set s;
+      setupStandardFixture(s);
+      // exercise
+      int sum = 0;
+      int count = 0;
+      for (Set::iterator it = s.begin(); it != s.end(); ++it)
+      {
+         sum += *it;
+         count++;
+      }
+      // verify
+      assertUnit(count == 3);
+      assertUnit(sum == 26 + 49 + 67);
+   }  // teardown
+
+   // visit every element in the hash
+   void test_iterate_big()
+   {  // setup
+      Set s;
+      setupComplexFixture(s);
+      // exercise
+      int sum = 0;
+      int count = 0;
+      for (Set::iterator it = s.begin(); it != s.end(); ++it)
+      {
+         sum += *it;
+         count++;
+      }
+      // verify
+      assertUnit(count == 6);
+      assertUnit(sum == 11 + 26 + 31 + 49 + 58 + 67);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // the last element moves into the hole
+   void test_erase_lastFillsHole()
+   {  // setup
+      Set s;
+      setupStandardFixture(s);
+      // exercise
+      Set::iterator it = s.erase(26);
+      // verify
+      assertUnit(s.size() == 2);
+      assertUnit(s.data()[0] == 67);
+      assertUnit(s.data()[1] == 49);
+      assertUnit(*it == 67);
+   }  // teardown
+
+   // nothing to erase
+   void test_erase_missing()
+   {  // setup
+      Set s;
+      setupStandardFixture(s);
+      // exercise
+      Set::iterator it = s.erase(99);
+      // verify
+      assertUnit(it == s.end());
+      assertStandardFixture(s);
+   }  // teardown
+
+   // clear frees the hash and the set starts small again
+   void test_clear_demotes()
+   {  // setup
+      Set s;
+      setupComplexFixture(s);
+      // exercise
+      s.clear();
+      s.insert(26);
+      // verify
+      assertUnit(s.is_small());
+      assertUnit(s.size() == 1);
+      assertUnit(s.data()[0] == 26);
+   }  // teardown
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *   inline: [26][49][67][  ]
+    ****************************************************************/
+   void setupStandardFixture(Set& s)
+   {
+      s.insert(26);
+      s.insert(49);
+      s.insert(67);
+   }
+
+   /****************************************************************
+    * Setup Complex Fixture
+    *   more than fit inline: 11 26 31 49 58 67
+    ****************************************************************/
+   void setupComplexFixture(Set& s)
+   {
+      s.insert(11);
+      s.insert(26);
+      s.insert(31);
+      s.insert(49);
+      s.insert(58);
+      s.insert(67);
+   }
+
+   /****************************************************************
+    * Verify Empty Fixture
+    ****************************************************************/
+   void assertEmptyFixtureParameters(const Set& s, int line, const char* function)
+   {
+      assertIndirect(s.numInline == 0);
+      assertIndirect(s.pBig == nullptr);
+      assertIndirect(s.empty());
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    ****************************************************************/
+   void assertStandardFixtureParameters(Set& s, int line, const char* function)
+   {
+      assertIndirect(s.pBig == nullptr);
+      assertIndirect(s.numInline == 3);
+      if (s.numInline == 3)
+      {
+         assertIndirect(s.data()[0] == 26);
+         assertIndirect(s.data()[1] == 49);
+         assertIndirect(s.data()[2] == 67);
+      }
+   }
+
+   /****************************************************************
+    * Verify Complex Fixture
+    ****************************************************************/
+   void assertComplexFixtureParameters(Set& s, int line, const char* function)
+   {
+      assertIndirect(s.pBig != nullptr);
+      assertIndirect(s.numInline == 0);
+      assertIndirect(s.size() == 6);
+      assertIndirect(s.count(11) == 1);
+      assertIndirect(s.count(58) == 1);
+      assertIndirect(s.count(67) == 1);
+   }
+};
+
+#endif // DEBUG
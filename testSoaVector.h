@@ -0,0 +1,285 @@
+/***********************************************************************
+ * Header:
+ *    TEST SOA VECTOR
+ * Summary:
+ *    Unit tests for soa_vector
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "soaVector.h"
+#include "unitTest.h"
+
+#include <string>    // for std::string
+
+class TestSoaVector : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Insert
+      test_pushback_tuple();
+      test_emplaceback_fields();
+      test_reserve_everyColumn();
+      test_resize_grow();
+      test_pushback_throwsStaysAligned();
+
+      // Access
+      test_column_contiguous();
+      test_column_sum();
+      test_row_update();
+
+      // Remove
+      test_popback_standard();
+      test_clear_standard();
+
+      report("SoaVector");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // no records, no columns allocated
+   void test_construct_default()
+   {  // exercise
+      custom::soa_vector<long, int, std::string> v;
+      // verify
+      assertUnit(v.numElements == 0);
+      assertUnit(v.empty());
+      assertUnit(std::get<0>(v.columns).size() == 0);
+      assertUnit(std::get<2>(v.columns).size() == 0);
+      assertUnit(v.column<1>().empty());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // push a whole record; each field goes to its column
+   void test_pushback_tuple()
+   {  // setup
+      custom::soa_vector<long, int, std::string> v;
+      // exercise
+      v.push_back(std::make_tuple(1000L, 26, std::string("alpha")));
+      // verify
+      assertUnit(v.numElements == 1);
+      assertUnit(std::get<0>(v.columns).size() == 1);
+      assertUnit(std::get<1>(v.columns).size() == 1);
+      assertUnit(std::get<2>(v.columns).size() == 1);
+      assertUnit(v.get<0>(0) == 1000L);
+      assertUnit(v.get<1>(0) == 26);
+      assertUnit(v.get<2>(0) == "alpha");
+   }  // teardown
+
+   // emplace takes one argument per field
+   void test_emplaceback_fields()
+   {  // setup
+      custom::soa_vector<long, int, std::string> v;
+      // exercise
+      setupStandardFixture(v);
+      // verify
+      assertStandardFixture(v);
+   }  // teardown
+
+   // reserve grows every column together
+   void test_reserve_everyColumn()
+   {  // setup
+      custom::soa_vector<long, int, std::string> v;
+      // exercise
+      v.reserve(10);
+      // verify
+      assertUnit(v.capacity() == 10);
+      assertUnit(std::get<1>(v.columns).capacity() == 10);
+      assertUnit(std::get<2>(v.columns).capacity() == 10);
+      assertUnit(v.numElements == 0);
+   }  // teardown
+
+   // resize adds default records
+   void test_resize_grow()
+   {  // setup
+      custom::soa_vector<long, int, std::string> v;
+      setupStandardFixture(v);
+      // exercise
+      v.resize(6);
+      // verify
+      assertUnit(v.numElements == 6);
+      assertUnit(v.get<0>(3) == 4000L);
+      assertUnit(v.get<0>(5) == 0L);
+      assertUnit(v.get<2>(5) == "");
+   }  // teardown
+
+   // a field whose copy throws when told to
+   struct Fussy
+   {
+      Fussy(int value = 0) : value(value) {}
+      Fussy(const Fussy & rhs) : value(rhs.value) { check(); }
+      Fussy & operator = (const Fussy & rhs)
+      {
+         check();
+         value = rhs.value;
+         return *this;
+      }
+      static void check()
+      {
+         if (refuse)
+            throw "ERROR: refused";
+      }
+      int value;
+      static inline bool refuse = false;
+   };
+
+   // a column that throws part way through a push leaves no column longer
+   void test_pushback_throwsStaysAligned()
+   {  // setup
+      custom::soa_vector<int, Fussy, long> v;
+      v.push_back(std::make_tuple(1, Fussy(10), 100L));
+      std::tuple<int, Fussy, long> record(2, Fussy(20), 200L);
+      bool thrown = false;
+      // exercise
+      Fussy::refuse = true;
+      try
+      {
+         v.push_back(record);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      Fussy::refuse = false;
+      v.push_back(std::make_tuple(3, Fussy(30), 300L));
+      // verify
+      assertUnit(thrown);
+      assertUnit(v.size() == 2);
+      assertUnit(std::get<0>(v.columns).size() == 2);
+      assertUnit(std::get<1>(v.columns).size() == 2);
+      assertUnit(std::get<2>(v.columns).size() == 2);
+      assertUnit(v.get<0>(1) == 3);
+      assertUnit(v.get<1>(1).value == 30);
+      assertUnit(v.get<2>(1) == 300L);
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // a column is one contiguous array
+   void test_column_contiguous()
+   {  // setup
+      custom::soa_vector<long, int, std::string> v;
+      setupStandardFixture(v);
+      // exercise
+      custom::span<int> ages = v.column<1>();
+      // verify
+      assertUnit(ages.size() == 4);
+      assertUnit(ages.data() == &v.get<1>(0));
+      assertUnit(ages.data() + 3 == &v.get<1>(3));
+      assertUnit(ages[2] == 67);
+   }  // teardown
+
+   // sum a single field without touching the others
+   void test_column_sum()
+   {  // setup
+      custom::soa_vector<long, int, std::string> v;
+      setupStandardFixture(v);
+      // exercise
+      long sum = 0;
+      for (long timestamp : v.column<0>())
+         sum += timestamp;
+      // verify
+      assertUnit(sum == 10000L);
+   }  // teardown
+
+   // a row is references into the columns
+   void test_row_update()
+   {  // setup
+      custom::soa_vector<long, int, std::string> v;
+      setupStandardFixture(v);
+      // exercise
+      std::get<1>(v[2]) = 99;
+      std::get<2>(v[2]) = "gamma!";
+      // verify
+      assertUnit(v.get<1>(2) == 99);
+      assertUnit(v.get<2>(2) == "gamma!");
+      assertUnit(v.get<0>(2) == 3000L);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // pop the last record from every column
+   void test_popback_standard()
+   {  // setup
+      custom::soa_vector<long, int, std::string> v;
+      setupStandardFixture(v);
+      // exercise
+      v.pop_back();
+      // verify
+      assertUnit(v.numElements == 3);
+      assertUnit(std::get<0>(v.columns).size() == 3);
+      assertUnit(std::get<2>(v.columns).size() == 3);
+      assertUnit(v.column<2>().back() == "gamma");
+   }  // teardown
+
+   // clear every column
+   void test_clear_standard()
+   {  // setup
+      custom::soa_vector<long, int, std::string> v;
+      setupStandardFixture(v);
+      // exercise
+      v.clear();
+      // verify
+      assertUnit(v.numElements == 0);
+      assertUnit(std::get<1>(v.columns).size() == 0);
+      assertUnit(v.column<0>().empty());
+   }  // teardown
+
+   /*************************************************************
+    * SETUP STANDARD FIXTURE
+    *    timestamp  age  name
+    *    1000       26   alpha
+    *    2000       49   beta
+    *    3000       67   gamma
+    *    4000       89   delta
+    *************************************************************/
+   void setupStandardFixture(custom::soa_vector<long, int, std::string> & v)
+   {
+      v.emplace_back(1000L, 26, "alpha");
+      v.emplace_back(2000L, 49, "beta");
+      v.emplace_back(3000L, 67, "gamma");
+      v.emplace_back(4000L, 89, "delta");
+   }
+
+   /*************************************************************
+    * VERIFY STANDARD FIXTURE PARAMETERS
+    *************************************************************/
+   void assertStandardFixtureParameters(const custom::soa_vector<long, int, std::string> & v,
+                                        int line, const char* function)
+   {
+      assertIndirect(v.numElements == 4);
+      assertIndirect(std::get<0>(v.columns).size() == 4);
+      assertIndirect(std::get<1>(v.columns).size() == 4);
+      assertIndirect(std::get<2>(v.columns).size() == 4);
+      if (v.numElements == 4)
+      {
+         assertIndirect(v.get<0>(0) == 1000L);
+         assertIndirect(v.get<1>(1) == 49);
+         assertIndirect(v.get<2>(2) == "gamma");
+         assertIndirect(v.get<0>(3) == 4000L);
+         assertIndirect(v.get<1>(3) == 89);
+         assertIndirect(v.get<2>(3) == "delta");
+      }
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,221 @@
+/***********************************************************************
+ * Header:
+ *    TEST SPSC RING
+ * Summary:
+ *    Unit tests for spsc_ring
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "spscRing.h"
+#include "unitTest.h"
+
+#include <string>
+#include <thread>
+
+class TestSpscRing : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_powerOfTwo();
+      test_construct_layout();
+
+      // Push and pop
+      test_pop_empty();
+      test_push_full();
+      test_push_wraps();
+      test_push_string();
+
+      // Batch
+      test_pushN_partial();
+      test_popN_partial();
+
+      // Threads
+      test_threads_pipeline();
+
+      report("SpscRing");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // the capacity is rounded up to a power of two
+   void test_construct_powerOfTwo()
+   {  // setup
+      // exercise
+      custom::spsc_ring<int> r(100);
+      custom::spsc_ring<int> rExact(64);
+      // verify
+      assertUnit(r.capacity() == 128);
+      assertUnit(r.mask == 127);
+      assertUnit(r.slots.size() == 128);
+      assertUnit(rExact.capacity() == 64);
+      assertUnit(r.empty());
+   }  // teardown
+
+   // the two indices never share a cache line
+   void test_construct_layout()
+   {  // setup
+      custom::spsc_ring<int> r(8);
+      // exercise
+      size_t tail = (size_t)&r.tail;
+      size_t head = (size_t)&r.head;
+      // verify
+      assertUnit(tail % custom::CACHE_LINE_BYTES == 0);
+      assertUnit(head % custom::CACHE_LINE_BYTES == 0);
+      assertUnit(head - tail >= custom::CACHE_LINE_BYTES);
+      assertUnit((size_t)&r.slots[0] % custom::CACHE_LINE_BYTES == 0);
+   }  // teardown
+
+   /***************************************
+    * PUSH and POP
+    ***************************************/
+
+   // nothing to pop leaves the output alone
+   void test_pop_empty()
+   {  // setup
+      custom::spsc_ring<int> r(4);
+      int value = 99;
+      // exercise
+      bool popped = r.pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+   }  // teardown
+
+   // a full ring refuses the next push
+   void test_push_full()
+   {  // setup
+      custom::spsc_ring<int> r(4);
+      // exercise
+      bool pushed = r.push(11) && r.push(26) && r.push(31) && r.push(49);
+      bool pushedFifth = r.push(67);
+      // verify
+      assertUnit(pushed);
+      assertUnit(!pushedFifth);
+      assertUnit(r.size() == 4);
+      assertUnit(r.tail == 4);
+      assertUnit(r.head == 0);
+   }  // teardown
+
+   // the indices keep counting while the slots wrap around
+   void test_push_wraps()
+   {  // setup
+      custom::spsc_ring<int> r(4);
+      int value = 0;
+      bool same = true;
+      // exercise
+      for (int i = 0; i < 10; i++)
+      {
+         same = same && r.push(i);
+         same = same && r.pop(value) && value == i;
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(r.tail == 10);
+      assertUnit(r.head == 10);
+      assertUnit(r.slots[9 & r.mask] == 9);
+   }  // teardown
+
+   // values which own memory are moved in and out
+   void test_push_string()
+   {  // setup
+      custom::spsc_ring<std::string> r(2);
+      std::string s(100, 'x');
+      // exercise
+      r.push(std::move(s));
+      std::string out;
+      r.pop(out);
+      // verify
+      assertUnit(out == std::string(100, 'x'));
+   }  // teardown
+
+   /***************************************
+    * BATCH
+    ***************************************/
+
+   // push_n takes as many as fit
+   void test_pushN_partial()
+   {  // setup
+      custom::spsc_ring<int> r(4);
+      int values[] = { 11, 26, 31, 49, 67, 89 };
+      r.push(5);
+      // exercise
+      size_t num = r.push_n(values, 6);
+      // verify
+      assertUnit(num == 3);
+      assertUnit(r.size() == 4);
+      assertUnit(r.slots[3] == 31);
+   }  // teardown
+
+   // pop_n takes as many as are waiting, across the wrap
+   void test_popN_partial()
+   {  // setup
+      custom::spsc_ring<int> r(4);
+      int values[] = { 11, 26, 31 };
+      int out[8] = {};
+      r.push_n(values, 3);
+      r.pop_n(out, 2);
+      r.push_n(values, 3);     // slots 3, 0, 1
+      // exercise
+      size_t num = r.pop_n(out, 8);
+      // verify
+      assertUnit(num == 4);
+      assertUnit(out[0] == 31);
+      assertUnit(out[1] == 11);
+      assertUnit(out[2] == 26);
+      assertUnit(out[3] == 31);
+      assertUnit(r.empty());
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // a producer and a consumer on their own threads, in batches
+   void test_threads_pipeline()
+   {  // setup
+      const int numItems = 100000;
+      custom::spsc_ring<int> r(64);
+      // exercise
+      std::thread producer([&r]()
+      {
+         int batch[7];
+         for (int i = 0; i < numItems; )
+         {
+            int num = 0;
+            for (; num < 7 && i + num < numItems; num++)
+               batch[num] = i + num;
+            size_t done = 0;
+            while (done < (size_t)num)
+               done += r.push_n(batch + done, num - done);
+            i += num;
+         }
+      });
+      bool inOrder = true;
+      int next = 0;
+      int batch[5];
+      while (next < numItems)
+      {
+         size_t num = r.pop_n(batch, 5);
+         for (size_t i = 0; i < num; i++)
+            inOrder = inOrder && batch[i] == next++;
+      }
+      producer.join();
+      // verify
+      assertUnit(inOrder);
+      assertUnit(next == numItems);
+      assertUnit(r.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
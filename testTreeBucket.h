@@ -0,0 +1,262 @@
+/***********************************************************************
+ * Header:
+ *    TEST TREE BUCKET
+ * Summary:
+ *    Unit tests for tree_bucket
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "treeBucket.h"
+#include "unitTest.h"
+
+class TestTreeBucket : public UnitTest
+{
+public:
+   typedef custom::tree_bucket<int> Bucket;
+
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_copyTree();
+      test_construct_move();
+
+      // Insert
+      test_pushBack_staysList();
+      test_pushBack_treeifies();
+      test_pushBack_balanced();
+
+      // Access
+      test_find_list();
+      test_find_tree();
+
+      // Remove
+      test_erase_tree();
+      test_erase_untreeifies();
+      test_clear_tree();
+
+      report("TreeBucket");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // an empty bucket has neither elements nor tree
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Bucket b;
+      // verify
+      assertUnit(b.empty());
+      assertUnit(b.size() == 0);
+      assertUnit(!b.is_tree());
+      assertUnit(b.begin() == b.end());
+   }  // teardown
+
+   // a copy of a long bucket gets its own tree
+   void test_construct_copyTree()
+   {  // setup
+      Bucket bSrc;
+      fill(bSrc, 20);
+      // exercise
+      Bucket bDes(bSrc);
+      // verify
+      assertUnit(bDes.size() == 20);
+      assertUnit(bDes.is_tree());
+      assertUnit(bDes.pRoot != bSrc.pRoot);
+      assertUnit(bDes.find(70) != bDes.end());
+      assertUnit(*bDes.find(70) == 70);
+      assertUnit(countNodes(bDes.pRoot) == 20);
+      assertUnit(bSrc.size() == 20);
+   }  // teardown
+
+   // moving takes the list and the tree
+   void test_construct_move()
+   {  // setup
+      Bucket bSrc;
+      fill(bSrc, 20);
+      // exercise
+      Bucket bDes(std::move(bSrc));
+      // verify
+      assertUnit(bDes.size() == 20);
+      assertUnit(bDes.is_tree());
+      assertUnit(bSrc.empty());
+      assertUnit(!bSrc.is_tree());
+      assertUnit(*bDes.find(190) == 190);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // up to the threshold a bucket is just a list
+   void test_pushBack_staysList()
+   {  // setup
+      Bucket b;
+      // exercise
+      fill(b, 8);
+      // verify
+      assertUnit(b.size() == 8);
+      assertUnit(!b.is_tree());
+      assertUnit(b.front() == 0);
+      assertUnit(b.back() == 70);
+   }  // teardown
+
+   // one past the threshold, every node is indexed
+   void test_pushBack_treeifies()
+   {  // setup
+      Bucket b;
+      fill(b, 8);
+      // exercise
+      b.push_back(80);
+      b.push_back(90);
+      // verify
+      assertUnit(b.size() == 10);
+      assertUnit(b.is_tree());
+      assertUnit(countNodes(b.pRoot) == 10);
+      assertUnit(b.front() == 0);
+      assertUnit(b.back() == 90);
+   }  // teardown
+
+   // in-order insertion still gives a tree of height log n
+   void test_pushBack_balanced()
+   {  // setup
+      Bucket b;
+      // exercise
+      fill(b, 1000);
+      // verify
+      //    an AVL tree of 1000 nodes is at most 1.44 log2(1000) = 14 high
+      assertUnit(b.pRoot->height <= 14);
+      assertUnit(isBalanced(b.pRoot));
+      assertUnit(countNodes(b.pRoot) == 1000);
+   }  // teardown
+
+   /***************************************
+    * ACCESS
+    ***************************************/
+
+   // a short bucket walks its list
+   void test_find_list()
+   {  // setup
+      Bucket b;
+      fill(b, 5);
+      // exercise
+      Bucket::iterator itHit = b.find(30);
+      Bucket::iterator itMiss = b.find(35);
+      // verify
+      assertUnit(itHit != b.end());
+      assertUnit(*itHit == 30);
+      assertUnit(itMiss == b.end());
+   }  // teardown
+
+   // a long bucket searches its tree, and returns the list node
+   void test_find_tree()
+   {  // setup
+      Bucket b;
+      fill(b, 100);
+      // exercise
+      Bucket::iterator itHit = b.find(500);
+      Bucket::iterator itMiss = b.find(505);
+      // verify
+      assertUnit(b.is_tree());
+      assertUnit(itHit != b.end());
+      assertUnit(*itHit == 500);
+      ++itHit;
+      assertUnit(*itHit == 510);
+      assertUnit(itMiss == b.end());
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erasing from a tree takes the node out too
+   void test_erase_tree()
+   {  // setup
+      Bucket b;
+      fill(b, 100);
+      // exercise
+      Bucket::iterator it = b.erase(b.find(500));
+      // verify
+      assertUnit(*it == 510);
+      assertUnit(b.size() == 99);
+      assertUnit(b.is_tree());
+      assertUnit(countNodes(b.pRoot) == 99);
+      assertUnit(isBalanced(b.pRoot));
+      assertUnit(b.find(500) == b.end());
+      assertUnit(*b.find(490) == 490);
+   }  // teardown
+
+   // shrinking to half the threshold drops the tree
+   void test_erase_untreeifies()
+   {  // setup
+      Bucket b;
+      fill(b, 9);
+      assertUnit(b.is_tree());
+      // exercise
+      b.erase(b.find(0));
+      b.erase(b.find(10));
+      b.erase(b.find(20));
+      bool treeAtSix = b.is_tree();
+      b.erase(b.find(30));
+      b.erase(b.find(40));
+      // verify
+      assertUnit(treeAtSix);
+      assertUnit(b.size() == 4);
+      assertUnit(!b.is_tree());
+      assertUnit(*b.find(80) == 80);
+      assertUnit(b.front() == 50);
+   }  // teardown
+
+   // clear frees the tree along with the list
+   void test_clear_tree()
+   {  // setup
+      Bucket b;
+      fill(b, 50);
+      // exercise
+      b.clear();
+      // verify
+      assertUnit(b.empty());
+      assertUnit(!b.is_tree());
+      b.push_back(7);
+      assertUnit(*b.find(7) == 7);
+   }  // teardown
+
+   /***************************************
+    * HELPERS
+    ***************************************/
+
+   // 0, 10, 20, ... in that order
+   void fill(Bucket & b, int num)
+   {
+      for (int i = 0; i < num; i++)
+         b.push_back(i * 10);
+   }
+
+   size_t countNodes(Bucket::Node * p)
+   {
+      return p ? 1 + countNodes(p->pLeft) + countNodes(p->pRight) : 0;
+   }
+
+   // every height is right and no node leans by more than one
+   bool isBalanced(Bucket::Node * p)
+   {
+      if (p == nullptr)
+         return true;
+      int l = Bucket::height(p->pLeft);
+      int r = Bucket::height(p->pRight);
+      return p->height == 1 + (l > r ? l : r) &&
+             l - r <= 1 && r - l <= 1 &&
+             isBalanced(p->pLeft) && isBalanced(p->pRight);
+   }
+};
+
+#endif // DEBUG
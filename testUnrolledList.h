@@ -0,0 +1,413 @@
+/***********************************************************************
+ * Header:
+ *    TEST UNROLLED LIST
+ * Summary:
+ *    Unit tests for unrolled_list
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "unrolledList.h"
+#include "unitTest.h"
+
+#include <string>
+#include <vector>
+
+class TestUnrolledList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_fill();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+
+      // Insert
+      test_pushback_fillsNode();
+      test_pushback_newNode();
+      test_pushfront_standard();
+      test_insert_splitsFullNode();
+      test_insert_string();
+
+      // Remove
+      test_erase_middle();
+      test_erase_freesNode();
+      test_erase_everything();
+      test_popback_standard();
+      test_erase_borrowsNext();
+      test_erase_borrowsPrevious();
+      test_erase_mergesNext();
+      test_erase_staysHalfFull();
+
+      // Iterator
+      test_iterator_backward();
+      test_find_standard();
+
+      // Status
+      test_capacity_default();
+
+      report("UnrolledList");
+   }
+
+   // four elements to a node keeps the fixtures small
+   typedef custom::unrolled_list<int, 4> List;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor, no nodes
+   void test_construct_default()
+   {  // setup
+      // exercise
+      List l;
+      // verify
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // ten copies make three nodes: 4, 4, and 2
+   void test_construct_fill()
+   {  // setup
+      // exercise
+      List l(10, 7);
+      // verify
+      assertUnit(isPacked(l, { 7, 7, 7, 7, 7, 7, 7, 7, 7, 7 }, { 4, 4, 2 }));
+   }  // teardown
+
+   // a copy has the same nodes as the original
+   void test_constructCopy_standard()
+   {  // setup
+      List lSrc;
+      setupStandardFixture(lSrc);
+      // exercise
+      List lDes(lSrc);
+      // verify
+      assertStandardFixture(lDes);
+      assertStandardFixture(lSrc);
+      assertUnit(lDes.pHead != lSrc.pHead);
+   }  // teardown
+
+   // a move steals the nodes
+   void test_constructMove_standard()
+   {  // setup
+      List lSrc;
+      setupStandardFixture(lSrc);
+      // exercise
+      List lDes(std::move(lSrc));
+      // verify
+      assertStandardFixture(lDes);
+      assertEmptyFixture(lSrc);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first four elements share a node
+   void test_pushback_fillsNode()
+   {  // setup
+      List l;
+      // exercise
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      l.push_back(49);
+      // verify
+      assertUnit(isPacked(l, { 11, 26, 31, 49 }, { 4 }));
+   }  // teardown
+
+   // appending to a full last node starts a new one
+   void test_pushback_newNode()
+   {  // setup
+      List l{ 11, 26, 31, 49 };
+      // exercise
+      l.push_back(67);
+      // verify
+      assertStandardFixture(l);
+   }  // teardown
+
+   // push_front into a full first node splits it
+   void test_pushfront_standard()
+   {  // setup
+      List l;
+      setupStandardFixture(l);
+      // exercise
+      l.push_front(5);
+      // verify
+      assertUnit(isPacked(l, { 5, 11, 26, 31, 49, 67 }, { 3, 2, 1 }));
+   }  // teardown
+
+   // inserting into the first half of a full node
+   void test_insert_splitsFullNode()
+   {  // setup
+      List l{ 11, 26, 31, 49 };
+      List::iterator it = l.begin();
+      ++it;
+      // exercise
+      List::iterator itReturn = l.insert(it, 99);
+      // verify
+      assertUnit(isPacked(l, { 11, 99, 26, 31, 49 }, { 3, 2 }));
+      assertUnit(*itReturn == 99);
+      assertUnit(itReturn.p == l.pHead);
+      assertUnit(itReturn.index == 1);
+   }  // teardown
+
+   // elements with their own allocations survive the shifts
+   void test_insert_string()
+   {  // setup
+      custom::unrolled_list<std::string, 3> l;
+      // exercise
+      l.push_back("b");
+      l.push_back("d");
+      l.push_front("a");
+      auto it = l.begin();
+      ++it;
+      ++it;
+      l.insert(it, "c");
+      l.push_back("e");
+      // verify
+      std::string joined;
+      for (auto itJoin = l.begin(); itJoin != l.end(); ++itJoin)
+         joined += *itJoin;
+      assertUnit(joined == "abcde");
+      assertUnit(l.size() == 5);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erase shifts the rest of the node down
+   void test_erase_middle()
+   {  // setup
+      List l;
+      setupStandardFixture(l);
+      List::iterator it = l.begin();
+      ++it;
+      // exercise
+      List::iterator itReturn = l.erase(it);
+      // verify
+      assertUnit(isPacked(l, { 11, 31, 49, 67 }, { 3, 1 }));
+      assertUnit(*itReturn == 31);
+   }  // teardown
+
+   // erasing the only element of a node frees it
+   void test_erase_freesNode()
+   {  // setup
+      List l;
+      setupStandardFixture(l);
+      // exercise
+      List::iterator itReturn = l.erase(l.find(67));
+      // verify
+      assertUnit(isPacked(l, { 11, 26, 31, 49 }, { 4 }));
+      assertUnit(itReturn == l.end());
+   }  // teardown
+
+   // erasing every element leaves no nodes
+   void test_erase_everything()
+   {  // setup
+      List l;
+      setupStandardFixture(l);
+      // exercise
+      for (List::iterator it = l.begin(); it != l.end(); )
+         it = l.erase(it);
+      // verify
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // pop_back takes from the last node
+   void test_popback_standard()
+   {  // setup
+      List l;
+      setupStandardFixture(l);
+      // exercise
+      l.pop_back();
+      l.pop_back();
+      // verify
+      assertUnit(isPacked(l, { 11, 26, 31 }, { 3 }));
+      assertUnit(l.back() == 31);
+   }  // teardown
+
+   // a node under half full takes the first element of the next
+   void test_erase_borrowsNext()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6, 7, 8 };
+      l.erase(l.begin());
+      l.erase(l.begin());
+      // exercise
+      List::iterator itReturn = l.erase(l.begin());
+      // verify
+      assertUnit(isPacked(l, { 4, 5, 6, 7, 8 }, { 2, 3 }));
+      assertUnit(*itReturn == 4);
+   }  // teardown
+
+   // the last node takes the last element of the one before it
+   void test_erase_borrowsPrevious()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6, 7, 8 };
+      l.erase(l.find(5));
+      l.erase(l.find(6));
+      // exercise
+      List::iterator itReturn = l.erase(l.find(7));
+      // verify
+      assertUnit(isPacked(l, { 1, 2, 3, 4, 8 }, { 3, 2 }));
+      assertUnit(*itReturn == 8);
+   }  // teardown
+
+   // two nodes which fit in one become one
+   void test_erase_mergesNext()
+   {  // setup
+      List l{ 1, 2, 3, 4, 5, 6, 7, 8 };
+      l.erase(l.begin());
+      l.erase(l.begin());
+      l.erase(l.find(5));
+      // exercise
+      List::iterator itReturn = l.erase(l.begin());
+      // verify
+      assertUnit(isPacked(l, { 4, 6, 7, 8 }, { 4 }));
+      assertUnit(*itReturn == 4);
+   }  // teardown
+
+   // however the elements go, no node but the last is under half full
+   void test_erase_staysHalfFull()
+   {  // setup
+      List l;
+      std::vector<int> expected;
+      for (int i = 0; i < 200; i++)
+      {
+         l.push_back(i);
+         expected.push_back(i);
+      }
+      bool halfFull = true;
+      bool same = true;
+      // exercise
+      for (size_t step = 0; !expected.empty(); step++)
+      {
+         size_t index = (step * 37) % expected.size();
+         List::iterator it = l.begin();
+         for (size_t i = 0; i < index; i++)
+            ++it;
+         List::iterator itReturn = l.erase(it);
+         expected.erase(expected.begin() + index);
+         if (index < expected.size())
+            same = same && itReturn != l.end() && *itReturn == expected[index];
+         else
+            same = same && itReturn == l.end();
+         for (List::Node* p = l.pHead; p && p->pNext; p = p->pNext)
+            halfFull = halfFull && p->num >= List::node_capacity() / 2;
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(halfFull);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walk backward across the node boundary
+   void test_iterator_backward()
+   {  // setup
+      List l;
+      setupStandardFixture(l);
+      List::iterator it(l.pTail, l.pTail->num - 1);
+      // exercise
+      std::vector<int> values;
+      for (int i = 0; i < 5; i++, --it)
+         values.push_back(*it);
+      // verify
+      assertUnit(values == std::vector<int>({ 67, 49, 31, 26, 11 }));
+      assertUnit(it == l.end());
+   }  // teardown
+
+   // find looks in every node
+   void test_find_standard()
+   {  // setup
+      List l;
+      setupStandardFixture(l);
+      // exercise
+      List::iterator it = l.find(49);
+      // verify
+      assertUnit(it.p == l.pHead);
+      assertUnit(it.index == 3);
+      assertUnit(l.find(99) == l.end());
+   }  // teardown
+
+   /***************************************
+    * STATUS
+    ***************************************/
+
+   // the default node holds two cache lines of elements
+   void test_capacity_default()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit(custom::unrolled_list<int>::node_capacity() == (128 - 3 * sizeof(void *)) / sizeof(int));
+      assertUnit(custom::unrolled_list<char[200]>::node_capacity() == 2);
+   }  // teardown
+
+   /****************************************************************
+    * IS PACKED
+    * Does the list hold these values in nodes of these sizes,
+    * with the links in both directions agreeing?
+    ****************************************************************/
+   bool isPacked(const List& l, const std::vector<int>& values, const std::vector<size_t>& nodes)
+   {
+      if (l.numElements != values.size())
+         return false;
+      size_t iValue = 0;
+      size_t iNode = 0;
+      const List::Node* pPrevious = nullptr;
+      for (List::Node* p = l.pHead; p; p = p->pNext, iNode++)
+      {
+         if (iNode == nodes.size() || p->num != nodes[iNode] || p->pPrev != pPrevious)
+            return false;
+         for (size_t i = 0; i < p->num; i++)
+            if (p->data()[i] != values[iValue++])
+               return false;
+         pPrevious = p;
+      }
+      return iNode == nodes.size() && l.pTail == pPrevious;
+   }
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *        pHead                  pTail
+    *       +----+----+----+----+   +----+
+    *       | 11 | 26 | 31 | 49 | - | 67 |
+    *       +----+----+----+----+   +----+
+    ****************************************************************/
+   void setupStandardFixture(List& l)
+   {
+      l = { 11, 26, 31, 49, 67 };
+   }
+
+   /****************************************************************
+    * Verify Empty Fixture
+    ****************************************************************/
+   void assertEmptyFixtureParameters(const List& l, int line, const char* function)
+   {
+      assertIndirect(l.numElements == 0);
+      assertIndirect(l.pHead == nullptr);
+      assertIndirect(l.pTail == nullptr);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    ****************************************************************/
+   void assertStandardFixtureParameters(const List& l, int line, const char* function)
+   {
+      assertIndirect(isPacked(l, { 11, 26, 31, 49, 67 }, { 4, 1 }));
+   }
+};
+
+#endif // DEBUG
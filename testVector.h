@@ -100,6 +100,19 @@ public:
       test_reserve_standardZero();
       test_reserve_standardTen();
 
+      // Growth
+      test_growth_halfFirst();
+      test_growth_halfGrow();
+      test_growth_halfLargeElement();
+      test_growth_sizeClassSmall();
+      test_growth_sizeClassPage();
+      test_growth_sizeClassGrow();
+
+      // Allocator
+      test_allocator_aligned();
+      test_allocator_hugePage();
+      test_allocator_hugePageSmall();
+
       // Remove
       test_popback_empty();
       test_popback_full();
@@ -1817,6 +1830,131 @@ public:
    }
    
    
+   /***************************************
+    * GROWTH
+    ***************************************/
+   
+   // the first allocation of a 1.5x vector fills a cache line
+   void test_growth_halfFirst()
+   {  // setup
+      custom::vector<int, custom::growth_half> v;
+      // exercise
+      v.push_back(26);
+      // verify
+      assertUnit(v.numCapacity == 16);
+      assertUnit(v.numElements == 1);
+      if (v.data)
+         assertUnit(v.data[0] == 26);
+   }  // teardown
+   
+   // a full 1.5x vector grows by half
+   void test_growth_halfGrow()
+   {  // setup
+      custom::vector<int, custom::growth_half> v;
+      for (int i = 0; i < 16; i++)
+         v.push_back(i);
+      assertUnit(v.numCapacity == 16);
+      // exercise
+      v.push_back(16);
+      // verify
+      assertUnit(v.numCapacity == 24);
+      assertUnit(v.numElements == 17);
+      for (size_t i = 0; i < v.numElements; i++)
+         assertUnit(v.data[i] == int(i));
+   }  // teardown
+   
+   // large elements still get at least one slot
+   void test_growth_halfLargeElement()
+   {
+      assertUnit(custom::growth_half::grow(0, 1000) == 1);
+      assertUnit(custom::growth_half::grow(1, 1000) == 2);
+      assertUnit(custom::growth_half::grow(2, 1000) == 3);
+   }
+   
+   // size classes below a page: four per power of two
+   void test_growth_sizeClassSmall()
+   {
+      assertUnit(custom::growth_size_class::roundBytes(1)   == 64);
+      assertUnit(custom::growth_size_class::roundBytes(64)  == 64);
+      assertUnit(custom::growth_size_class::roundBytes(65)  == 80);
+      assertUnit(custom::growth_size_class::roundBytes(144) == 160);
+      assertUnit(custom::growth_size_class::roundBytes(3000) == 3072);
+   }
+   
+   // size classes above a page: whole pages
+   void test_growth_sizeClassPage()
+   {
+      assertUnit(custom::growth_size_class::roundBytes(4096) == 4096);
+      assertUnit(custom::growth_size_class::roundBytes(4097) == 8192);
+      // 1000 ints -> 1500 ints = 6000 bytes -> 8192 bytes
+      assertUnit(custom::growth_size_class::grow(1000, sizeof(int)) == 2048);
+   }
+   
+   // a size-class vector fills the whole block it is given
+   void test_growth_sizeClassGrow()
+   {  // setup
+      custom::vector<int, custom::growth_size_class> v;
+      // exercise
+      for (int i = 0; i < 25; i++)
+         v.push_back(i);
+      // verify
+      //   16 -> 24 (96 bytes) -> 36 (144 bytes rounds to 160) = 40
+      assertUnit(v.numCapacity == 40);
+      assertUnit(v.numElements == 25);
+      for (size_t i = 0; i < v.numElements; i++)
+         assertUnit(v.data[i] == int(i));
+   }  // teardown
+   
+   
+   /***************************************
+    * ALLOCATOR
+    ***************************************/
+   
+   // an aligned vector starts on a cache line
+   void test_allocator_aligned()
+   {  // setup
+      custom::vector<int, custom::growth_double, custom::aligned_allocator<int>> v;
+      // exercise
+      v.push_back(26);
+      v.push_back(49);
+      v.push_back(67);
+      // verify
+      assertUnit((size_t)v.data % custom::CACHE_LINE_BYTES == 0);
+      assertUnit(v.numCapacity == 4);
+      assertUnit(v.numElements == 3);
+      if (v.numElements == 3)
+      {
+         assertUnit(v.data[0] == 26);
+         assertUnit(v.data[1] == 49);
+         assertUnit(v.data[2] == 67);
+      }
+   }  // teardown
+   
+   // a huge buffer is aligned to a huge page
+   void test_allocator_hugePage()
+   {  // setup
+      custom::vector<size_t, custom::growth_double, custom::huge_page_allocator<size_t>> v;
+      // exercise
+      v.resize(custom::HUGE_PAGE_BYTES / sizeof(size_t) + 1, 99);
+      // verify
+      assertUnit((size_t)v.data % custom::HUGE_PAGE_BYTES == 0);
+      assertUnit(v.numElements == custom::HUGE_PAGE_BYTES / sizeof(size_t) + 1);
+      assertUnit(v.back() == 99);
+   }  // teardown
+   
+   // a small buffer from the huge page allocator is cache line aligned
+   void test_allocator_hugePageSmall()
+   {  // setup
+      custom::vector<int, custom::growth_double, custom::huge_page_allocator<int>> v;
+      // exercise
+      v.reserve(10);
+      // verify
+      assertUnit((size_t)v.data % custom::CACHE_LINE_BYTES == 0);
+      assertUnit(v.numCapacity == 10);
+      assertUnit(v.numElements == 0);
+   }  // teardown
+   
+   
    /***************************************
     * ITERATOR
     ***************************************/
@@ -0,0 +1,401 @@
+/***********************************************************************
+ * Header:
+ *    TREE BUCKET
+ * Summary:
+ *    A bucket for unordered_set which cannot be forced into an O(n)
+ *    scan. It is a list, and behaves exactly like one, until it holds
+ *    more than TreeifyAt elements. Then it also builds a balanced
+ *    (AVL) tree over its list nodes, ordered by Compare, and find()
+ *    searches the tree instead of walking the list:
+ *
+ *        items:  [31] <--> [11] <--> [71] <--> [51] <--> ...
+ *                  ^         ^         ^         ^
+ *        tree:          +---[31]---+
+ *                    [11]        [51]
+ *                               /    \
+ *                           (..)      [71]
+ *
+ *    Iteration, erase(iterator) and the element order all still come
+ *    from the list; the tree only holds list iterators. When the
+ *    bucket shrinks to half the threshold the tree is thrown away.
+ *
+ *    The elements of a bucket must be distinct, as they are in a set,
+ *    and T needs an ordering as well as ==.
+ *
+ *    This will contain the class definition of:
+ *        tree_bucket            : A list with a tree index when long
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "list.h"       // for the elements themselves
+#include <cassert>      // because I am paranoid
+#include <functional>   // for std::less
+#include <utility>      // for std::swap
+
+class TestTreeBucket;   // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * TREE BUCKET
+ * The list interface unordered_set uses, plus a find()
+ * which is O(log n) once the bucket is long
+ ************************************************/
+template <typename T, typename Compare = std::less<T>, size_t TreeifyAt = 8>
+class tree_bucket
+{
+   friend class ::TestTreeBucket;   // give unit tests access to the privates
+public:
+   typedef typename list<T>::iterator iterator;
+
+   //
+   // Construct
+   //
+   tree_bucket() : pRoot(nullptr) {}
+   tree_bucket(const tree_bucket & rhs) : pRoot(nullptr)
+   {
+      *this = rhs;
+   }
+   tree_bucket(tree_bucket && rhs) : pRoot(nullptr)
+   {
+      swap(rhs);
+   }
+  ~tree_bucket()
+   {
+      destroy(pRoot);
+   }
+
+   //
+   // Assign
+   //
+   tree_bucket & operator = (const tree_bucket & rhs)
+   {
+      if (this != &rhs)
+      {
+         destroy(pRoot);
+         pRoot = nullptr;
+         // list's assignment takes a non-const reference, but only reads it
+         items = const_cast<list<T> &>(rhs.items);
+         if (items.size() > TreeifyAt)
+            treeify();
+      }
+      return *this;
+   }
+   tree_bucket & operator = (tree_bucket && rhs)
+   {
+      clear();
+      swap(rhs);
+      return *this;
+   }
+   void swap(tree_bucket & rhs)
+   {
+      items.swap(rhs.items);
+      std::swap(pRoot, rhs.pRoot);
+      std::swap(compare, rhs.compare);
+   }
+
+   //
+   // Iterator
+   //
+   iterator begin() { return items.begin(); }
+   iterator end()   { return items.end();   }
+
+   //
+   // Access
+   //
+   iterator find(const T & t);
+   T & front() { return items.front(); }
+   T & back()  { return items.back();  }
+
+   //
+   // Insert
+   //
+   void push_back(const T & t);
+
+   //
+   // Remove
+   //
+   iterator erase(const iterator & it);
+   void clear()
+   {
+      destroy(pRoot);
+      pRoot = nullptr;
+      items.clear();
+   }
+
+   //
+   // Status
+   //
+   bool   empty()   const { return items.empty();   }
+   size_t size()    const { return items.size();    }
+   bool   is_tree() const { return pRoot != nullptr; }
+   size_t bytes_nodes() const
+   {
+      // once there is a tree, every element has a node in it
+      return items.bytes_nodes() + (pRoot ? items.size() * sizeof(Node) : 0);
+   }
+
+private:
+   /*************************************************
+    * NODE
+    * One element of the list, by iterator, in an AVL
+    * tree. height is 1 for a leaf.
+    *************************************************/
+   struct Node
+   {
+      Node(const iterator & it) : it(it), pLeft(nullptr), pRight(nullptr), height(1) {}
+      iterator it;
+      Node * pLeft;
+      Node * pRight;
+      int height;
+   };
+
+   static int height(Node * p)  { return p ? p->height : 0; }
+   static void update(Node * p)
+   {
+      int l = height(p->pLeft);
+      int r = height(p->pRight);
+      p->height = 1 + (l > r ? l : r);
+   }
+   static Node * rotateLeft(Node * p);
+   static Node * rotateRight(Node * p);
+   static Node * balance(Node * p);
+   static void destroy(Node * p);
+   Node * insert(Node * p, iterator it);
+   Node * remove(Node * p, const T & t);
+   static Node * removeMin(Node * p, Node *& pMin);
+   void treeify();
+
+   list<T> items;       // every element, in the order they came
+   Node * pRoot;        // nullptr until the bucket is long
+   Compare compare;
+};
+
+/*****************************************
+ * TREE BUCKET :: FIND
+ * Search the tree if there is one, else the list
+ *    COST   : O(log n) as a tree, O(n) as a list
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+typename tree_bucket <T, Compare, TreeifyAt> ::iterator
+tree_bucket <T, Compare, TreeifyAt> ::find(const T & t)
+{
+   if (pRoot == nullptr)
+      return items.find(t);
+
+   Node * p = pRoot;
+   while (p)
+   {
+      if (compare(t, *p->it))
+         p = p->pLeft;
+      else if (compare(*p->it, t))
+         p = p->pRight;
+      else
+         return p->it;
+   }
+   return end();
+}
+
+/*****************************************
+ * TREE BUCKET :: PUSH BACK
+ * Append to the list; index it if we have a tree, or
+ * build the tree if the list just got too long
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+void tree_bucket <T, Compare, TreeifyAt> ::push_back(const T & t)
+{
+   items.push_back(t);
+   if (pRoot)
+      pRoot = insert(pRoot, items.rbegin());
+   else if (items.size() > TreeifyAt)
+      treeify();
+}
+
+/*****************************************
+ * TREE BUCKET :: ERASE
+ * Take the element out of the tree, if any, then out of
+ * the list. A tree which has shrunk to half the threshold
+ * goes away.
+ *    OUTPUT : the element after the one erased
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+typename tree_bucket <T, Compare, TreeifyAt> ::iterator
+tree_bucket <T, Compare, TreeifyAt> ::erase(const iterator & it)
+{
+   if (pRoot)
+   {
+      iterator itErase(it);   // list's operator * is not const
+      pRoot = remove(pRoot, *itErase);
+   }
+   iterator itNext = items.erase(it);
+   if (pRoot && items.size() <= TreeifyAt / 2)
+   {
+      destroy(pRoot);
+      pRoot = nullptr;
+   }
+   return itNext;
+}
+
+/*****************************************
+ * TREE BUCKET :: TREEIFY
+ * Index every list node
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+void tree_bucket <T, Compare, TreeifyAt> ::treeify()
+{
+   assert(pRoot == nullptr);
+   for (iterator it = items.begin(); it != items.end(); ++it)
+      pRoot = insert(pRoot, it);
+}
+
+/*****************************************
+ * TREE BUCKET :: ROTATE LEFT
+ *      p                r
+ *     / \              / \
+ *    a   r    -->     p   c
+ *       / \          / \
+ *      b   c        a   b
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+typename tree_bucket <T, Compare, TreeifyAt> ::Node *
+tree_bucket <T, Compare, TreeifyAt> ::rotateLeft(Node * p)
+{
+   Node * r = p->pRight;
+   p->pRight = r->pLeft;
+   r->pLeft = p;
+   update(p);
+   update(r);
+   return r;
+}
+
+/*****************************************
+ * TREE BUCKET :: ROTATE RIGHT
+ * The mirror image of rotateLeft
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+typename tree_bucket <T, Compare, TreeifyAt> ::Node *
+tree_bucket <T, Compare, TreeifyAt> ::rotateRight(Node * p)
+{
+   Node * l = p->pLeft;
+   p->pLeft = l->pRight;
+   l->pRight = p;
+   update(p);
+   update(l);
+   return l;
+}
+
+/*****************************************
+ * TREE BUCKET :: BALANCE
+ * Restore the AVL property at p, whose subtrees are
+ * balanced and differ in height by at most two
+ *    OUTPUT : the new root of this subtree
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+typename tree_bucket <T, Compare, TreeifyAt> ::Node *
+tree_bucket <T, Compare, TreeifyAt> ::balance(Node * p)
+{
+   update(p);
+   int lean = height(p->pRight) - height(p->pLeft);
+   if (lean > 1)
+   {
+      if (height(p->pRight->pLeft) > height(p->pRight->pRight))
+         p->pRight = rotateRight(p->pRight);
+      return rotateLeft(p);
+   }
+   if (lean < -1)
+   {
+      if (height(p->pLeft->pRight) > height(p->pLeft->pLeft))
+         p->pLeft = rotateLeft(p->pLeft);
+      return rotateRight(p);
+   }
+   return p;
+}
+
+/*****************************************
+ * TREE BUCKET :: INSERT
+ * Add a node for it below p
+ *    OUTPUT : the new root of this subtree
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+typename tree_bucket <T, Compare, TreeifyAt> ::Node *
+tree_bucket <T, Compare, TreeifyAt> ::insert(Node * p, iterator it)
+{
+   if (p == nullptr)
+      return new Node(it);
+   if (compare(*it, *p->it))
+      p->pLeft = insert(p->pLeft, it);
+   else
+      p->pRight = insert(p->pRight, it);
+   return balance(p);
+}
+
+/*****************************************
+ * TREE BUCKET :: REMOVE MIN
+ * Unhook the leftmost node below p
+ *    OUTPUT : the new root of this subtree; pMin is
+ *             the node unhooked
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+typename tree_bucket <T, Compare, TreeifyAt> ::Node *
+tree_bucket <T, Compare, TreeifyAt> ::removeMin(Node * p, Node *& pMin)
+{
+   if (p->pLeft == nullptr)
+   {
+      pMin = p;
+      return p->pRight;
+   }
+   p->pLeft = removeMin(p->pLeft, pMin);
+   return balance(p);
+}
+
+/*****************************************
+ * TREE BUCKET :: REMOVE
+ * Delete the node for t below p; its place is taken by
+ * the smallest node to its right
+ *    OUTPUT : the new root of this subtree
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+typename tree_bucket <T, Compare, TreeifyAt> ::Node *
+tree_bucket <T, Compare, TreeifyAt> ::remove(Node * p, const T & t)
+{
+   if (p == nullptr)
+      return nullptr;
+   if (compare(t, *p->it))
+      p->pLeft = remove(p->pLeft, t);
+   else if (compare(*p->it, t))
+      p->pRight = remove(p->pRight, t);
+   else
+   {
+      Node * pLeft = p->pLeft;
+      Node * pRight = p->pRight;
+      delete p;
+      if (pRight == nullptr)
+         return pLeft;
+      Node * pMin;
+      pRight = removeMin(pRight, pMin);
+      pMin->pLeft = pLeft;
+      pMin->pRight = pRight;
+      return balance(pMin);
+   }
+   return balance(p);
+}
+
+/*****************************************
+ * TREE BUCKET :: DESTROY
+ * Free every node below p, leaving the list alone
+ ****************************************/
+template <typename T, typename Compare, size_t TreeifyAt>
+void tree_bucket <T, Compare, TreeifyAt> ::destroy(Node * p)
+{
+   if (p == nullptr)
+      return;
+   destroy(p->pLeft);
+   destroy(p->pRight);
+   delete p;
+}
+
+} // namespace custom
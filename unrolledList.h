@@ -0,0 +1,571 @@
+/***********************************************************************
+ * Header:
+ *    UNROLLED LIST
+ * Summary:
+ *    A doubly linked list whose nodes each hold a small array of
+ *    elements rather than just one. Walking the list touches one
+ *    node (and so one or two cache lines) per K elements instead of
+ *    per element, and the two link pointers are shared by the whole
+ *    array.
+ *
+ *    The interface matches custom::list so an unordered_set can use
+ *    it as its bucket chain:
+ *        unordered_set <T, A, unrolled_list <T>>
+ *
+ *    This will contain the class definition of:
+ *        unrolled_list           : A list of arrays of elements
+ *        unrolled_list::iterator : An iterator through the elements
+ * Author
+ *    Sam Heaven, Abram Hansen
+ ************************************************************************/
+
+#pragma once
+
+#include "allocator.h"  // for CACHE_LINE_BYTES
+#include <cassert>      // because I am paranoid
+#include <initializer_list>
+#include <iterator>     // for std::iterator_traits
+#include <new>          // for placement new
+#include <utility>      // for std::move and std::swap
+
+class TestUnrolledList;  // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************
+ * UNROLLED CAPACITY
+ * The default number of elements in a node: as many as fit
+ * in two cache lines after the links and the count, but
+ * never fewer than two
+ ****************************************/
+template <typename T>
+constexpr size_t unrolled_capacity()
+{
+   return (2 * CACHE_LINE_BYTES - 3 * sizeof(void *)) / sizeof(T) > 2 ?
+          (2 * CACHE_LINE_BYTES - 3 * sizeof(void *)) / sizeof(T) : 2;
+}
+
+/**************************************************
+ * UNROLLED LIST
+ * Just like list, but each node holds up to K elements.
+ * A full node is split in half to make room in its
+ * middle; a node that falls below half full borrows
+ * from a neighbour or merges with it, so every node but
+ * the last stays at least half full however many
+ * elements are erased. Inserting into a node invalidates
+ * the iterators into that node; erasing invalidates
+ * those into the node and its neighbours.
+ **************************************************/
+template <typename T, size_t K = unrolled_capacity<T>()>
+class unrolled_list
+{
+   friend class ::TestUnrolledList; // give unit tests access to the privates
+   static_assert(K >= 2, "an unrolled node must hold at least two elements");
+public:
+   //
+   // Construct
+   //
+
+   unrolled_list() : numElements(0), pHead(nullptr), pTail(nullptr) {}
+   unrolled_list(const unrolled_list & rhs) : unrolled_list()
+   {
+      *this = rhs;
+   }
+   unrolled_list(unrolled_list && rhs) : unrolled_list()
+   {
+      swap(rhs);
+   }
+   unrolled_list(size_t num, const T & t) : unrolled_list()
+   {
+      for (size_t i = 0; i < num; i++)
+         push_back(t);
+   }
+   unrolled_list(size_t num) : unrolled_list(num, T()) {}
+   unrolled_list(const std::initializer_list<T> & il) : unrolled_list(il.begin(), il.end()) {}
+   template <class Iterator,
+             class = typename std::iterator_traits<Iterator>::value_type>
+   unrolled_list(Iterator first, Iterator last) : unrolled_list()
+   {
+      for (Iterator it = first; it != last; ++it)
+         push_back(*it);
+   }
+  ~unrolled_list()
+   {
+      clear();
+   }
+
+   //
+   // Assign
+   //
+
+   unrolled_list & operator = (const unrolled_list & rhs);
+   unrolled_list & operator = (unrolled_list && rhs)
+   {
+      clear();
+      swap(rhs);
+      return *this;
+   }
+   unrolled_list & operator = (const std::initializer_list<T> & il)
+   {
+      clear();
+      for (const T & t : il)
+         push_back(t);
+      return *this;
+   }
+   void swap(unrolled_list & rhs)
+   {
+      std::swap(numElements, rhs.numElements);
+      std::swap(pHead, rhs.pHead);
+      std::swap(pTail, rhs.pTail);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() { return iterator(pHead, 0); }
+   iterator end()   { return iterator(nullptr, 0); }
+   iterator find(const T & t);
+
+   //
+   // Access
+   //
+
+   T & front()
+   {
+      if (empty())
+         throw "ERROR: unable to access data from an empty list";
+      return pHead->data()[0];
+   }
+   T & back()
+   {
+      if (empty())
+         throw "ERROR: unable to access data from an empty list";
+      return pTail->data()[pTail->num - 1];
+   }
+
+   //
+   // Insert
+   //
+
+   void push_back(const T & t)  { insert(end(), t);              }
+   void push_back(T && t)       { insert(end(), std::move(t));   }
+   void push_front(const T & t) { insert(begin(), t);            }
+   void push_front(T && t)      { insert(begin(), std::move(t)); }
+   iterator insert(iterator it, const T & t) { T copy(t); return insert(it, std::move(copy)); }
+   iterator insert(iterator it, T && t);
+
+   //
+   // Remove
+   //
+
+   void pop_back()  { if (!empty()) erase(iterator(pTail, pTail->num - 1)); }
+   void pop_front() { if (!empty()) erase(begin()); }
+   void clear();
+   iterator erase(const iterator & it);
+
+   //
+   // Status
+   //
+
+   bool   empty() const { return numElements == 0; }
+   size_t size()  const { return numElements;      }
+   size_t bytes_nodes() const
+   {
+      size_t num = 0;
+      for (Node * p = pHead; p; p = p->pNext)
+         num++;
+      return num * sizeof(Node);
+   }
+   static constexpr size_t node_capacity() { return K; }
+
+private:
+   class Node;
+
+   Node * split(Node * p);
+   void merge(Node * pInto, Node * pFrom);
+   void unlink(Node * p);
+
+   size_t numElements;   // the number of elements, not nodes
+   Node * pHead;         // the first node
+   Node * pTail;         // the last node
+};
+
+/*************************************************
+ * UNROLLED LIST NODE
+ * Up to K elements in raw storage; only the first
+ * num of them are constructed
+ *************************************************/
+template <typename T, size_t K>
+class unrolled_list <T, K> ::Node
+{
+public:
+   Node() : pNext(nullptr), pPrev(nullptr), num(0) {}
+  ~Node()
+   {
+      for (size_t i = 0; i < num; i++)
+         data()[i].~T();
+   }
+
+   T * data() { return reinterpret_cast<T *>(storage); }
+   bool full() const { return num == K; }
+
+   /*************************************************
+    * NODE :: INSERT
+    * Put t at index, shifting the rest up one
+    *************************************************/
+   void insert(size_t index, T && t)
+   {
+      assert(!full() && index <= num);
+      T * d = data();
+      if (index == num)
+         new (d + num) T(std::move(t));
+      else
+      {
+         new (d + num) T(std::move(d[num - 1]));
+         for (size_t i = num - 1; i > index; i--)
+            d[i] = std::move(d[i - 1]);
+         d[index] = std::move(t);
+      }
+      num++;
+   }
+
+   /*************************************************
+    * NODE :: ERASE
+    * Remove the element at index, shifting the rest down
+    *************************************************/
+   void erase(size_t index)
+   {
+      assert(index < num);
+      T * d = data();
+      for (size_t i = index; i + 1 < num; i++)
+         d[i] = std::move(d[i + 1]);
+      d[--num].~T();
+   }
+
+   Node * pNext;          // the next node
+   Node * pPrev;          // the previous node
+   size_t num;            // the constructed elements in storage
+   alignas(T) unsigned char storage[K * sizeof(T)];
+};
+
+/*************************************************
+ * UNROLLED LIST ITERATOR
+ * A node and an index within it. The end is the
+ * null node, just like list's
+ ************************************************/
+template <typename T, size_t K>
+class unrolled_list <T, K> ::iterator
+{
+   friend class ::TestUnrolledList; // give unit tests access to the privates
+   template <typename TT, size_t KK>
+   friend class custom::unrolled_list;
+public:
+   iterator() : p(nullptr), index(0) {}
+   iterator(Node * p, size_t index) : p(p), index(index) {}
+
+   bool operator == (const iterator & rhs) const { return p == rhs.p && index == rhs.index; }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs);               }
+
+   T & operator * ()
+   {
+      if (p == nullptr)
+         throw "ERROR: Trying to dereference a nullptr pointer";
+      return p->data()[index];
+   }
+
+   // the next element is usually in the same node
+   iterator & operator ++ ()
+   {
+      if (p && ++index == p->num)
+      {
+         p = p->pNext;
+         index = 0;
+      }
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator old(*this);
+      ++(*this);
+      return old;
+   }
+
+   iterator & operator -- ()
+   {
+      if (p == nullptr)
+         return *this;
+      if (index > 0)
+         index--;
+      else
+      {
+         p = p->pPrev;
+         index = p ? p->num - 1 : 0;
+      }
+      return *this;
+   }
+   iterator operator -- (int postfix)
+   {
+      iterator old(*this);
+      --(*this);
+      return old;
+   }
+
+private:
+   Node * p;         // the node, nullptr at the end
+   size_t index;     // which element of the node
+};
+
+/*****************************************
+ * UNROLLED LIST :: ASSIGNMENT
+ * Copy rhs node for node, so the copy is as densely
+ * packed as the original
+ ****************************************/
+template <typename T, size_t K>
+unrolled_list <T, K> & unrolled_list <T, K> ::operator = (const unrolled_list & rhs)
+{
+   if (this == &rhs)
+      return *this;
+   clear();
+   for (Node * pRHS = rhs.pHead; pRHS; pRHS = pRHS->pNext)
+   {
+      Node * pNew = new Node;
+      for (size_t i = 0; i < pRHS->num; i++)
+      {
+         new (pNew->data() + i) T(pRHS->data()[i]);
+         pNew->num++;
+      }
+      pNew->pPrev = pTail;
+      if (pTail)
+         pTail->pNext = pNew;
+      else
+         pHead = pNew;
+      pTail = pNew;
+   }
+   numElements = rhs.numElements;
+   return *this;
+}
+
+/*****************************************
+ * UNROLLED LIST :: CLEAR
+ * Free every node
+ ****************************************/
+template <typename T, size_t K>
+void unrolled_list <T, K> ::clear()
+{
+   while (pHead)
+   {
+      Node * pNext = pHead->pNext;
+      delete pHead;
+      pHead = pNext;
+   }
+   pTail = nullptr;
+   numElements = 0;
+}
+
+/*****************************************
+ * UNROLLED LIST :: FIND
+ * Walk the arrays looking for t
+ ****************************************/
+template <typename T, size_t K>
+typename unrolled_list <T, K> ::iterator unrolled_list <T, K> ::find(const T & t)
+{
+   for (Node * p = pHead; p; p = p->pNext)
+      for (size_t i = 0; i < p->num; i++)
+         if (p->data()[i] == t)
+            return iterator(p, i);
+   return end();
+}
+
+/*****************************************
+ * UNROLLED LIST :: SPLIT
+ * Move the top half of a full node into a new node
+ * right after it
+ *    OUTPUT : the new node
+ ****************************************/
+template <typename T, size_t K>
+typename unrolled_list <T, K> ::Node * unrolled_list <T, K> ::split(Node * p)
+{
+   assert(p->full());
+   Node * pNew = new Node;
+   size_t half = K / 2;
+   for (size_t i = half; i < K; i++)
+   {
+      new (pNew->data() + pNew->num++) T(std::move(p->data()[i]));
+      p->data()[i].~T();
+   }
+   p->num = half;
+
+   pNew->pPrev = p;
+   pNew->pNext = p->pNext;
+   if (p->pNext)
+      p->pNext->pPrev = pNew;
+   else
+      pTail = pNew;
+   p->pNext = pNew;
+   return pNew;
+}
+
+/*****************************************
+ * UNROLLED LIST :: MERGE
+ * Move every element of pFrom onto the end of pInto,
+ * its neighbour, and free pFrom
+ ****************************************/
+template <typename T, size_t K>
+void unrolled_list <T, K> ::merge(Node * pInto, Node * pFrom)
+{
+   assert(pInto->num + pFrom->num <= K);
+   for (size_t i = 0; i < pFrom->num; i++)
+   {
+      new (pInto->data() + pInto->num++) T(std::move(pFrom->data()[i]));
+      pFrom->data()[i].~T();
+   }
+   pFrom->num = 0;
+   unlink(pFrom);
+}
+
+/*****************************************
+ * UNROLLED LIST :: UNLINK
+ * Take an empty node out of the chain and free it
+ ****************************************/
+template <typename T, size_t K>
+void unrolled_list <T, K> ::unlink(Node * p)
+{
+   assert(p->num == 0);
+   if (p->pPrev)
+      p->pPrev->pNext = p->pNext;
+   else
+      pHead = p->pNext;
+   if (p->pNext)
+      p->pNext->pPrev = p->pPrev;
+   else
+      pTail = p->pPrev;
+   delete p;
+}
+
+/*****************************************
+ * UNROLLED LIST :: INSERT
+ * Put t in front of it. Inserting at the end appends
+ * to the last node; a full node is split in half first
+ *    OUTPUT : the new element
+ ****************************************/
+template <typename T, size_t K>
+typename unrolled_list <T, K> ::iterator unrolled_list <T, K> ::insert(iterator it, T && t)
+{
+   Node * p = it.p;
+   size_t index = it.index;
+
+   // the end is one past the last element of the last node
+   if (p == nullptr)
+   {
+      if (pTail == nullptr)
+         pHead = pTail = new Node;
+      p = pTail;
+      index = p->num;
+   }
+
+   // appending to a full node starts a new one so that filling
+   // the list front to back leaves every node full
+   if (p->full() && index == K)
+   {
+      Node * pNew = new Node;
+      pNew->pPrev = p;
+      pNew->pNext = p->pNext;
+      if (p->pNext)
+         p->pNext->pPrev = pNew;
+      else
+         pTail = pNew;
+      p->pNext = pNew;
+      p = pNew;
+      index = 0;
+   }
+   else if (p->full())
+   {
+      Node * pNew = split(p);
+      if (index > p->num)
+      {
+         index -= p->num;
+         p = pNew;
+      }
+   }
+
+   p->insert(index, std::move(t));
+   numElements++;
+   return iterator(p, index);
+}
+
+/*****************************************
+ * UNROLLED LIST :: ERASE
+ * Remove one element, freeing its node if it was the last.
+ * A node left less than half full takes an element from
+ * its neighbour, or merges with it when the two fit in one
+ * node. The next node is preferred; the last node leans
+ * on the one before it.
+ *    OUTPUT : the element after it
+ ****************************************/
+template <typename T, size_t K>
+typename unrolled_list <T, K> ::iterator unrolled_list <T, K> ::erase(const iterator & it)
+{
+   Node * p = it.p;
+   if (p == nullptr)
+      return end();
+
+   p->erase(it.index);
+   numElements--;
+
+   Node * pNext = p->pNext;
+   if (p->num == 0)
+   {
+      unlink(p);
+      return iterator(pNext, 0);
+   }
+
+   // where the element after the erased one is now
+   Node * pAfter = p;
+   size_t index = it.index;
+
+   if (p->num < K / 2 && pNext)
+   {
+      if (p->num + pNext->num <= K)
+         merge(p, pNext);
+      else
+      {
+         p->insert(p->num, std::move(pNext->data()[0]));
+         pNext->erase(0);
+      }
+   }
+   else if (p->num < K / 2 && p->pPrev)
+   {
+      Node * pPrev = p->pPrev;
+      if (pPrev->num + p->num <= K)
+      {
+         index += pPrev->num;
+         pAfter = pPrev;
+         merge(pPrev, p);
+      }
+      else
+      {
+         p->insert(0, std::move(pPrev->data()[pPrev->num - 1]));
+         pPrev->erase(pPrev->num - 1);
+         index++;
+      }
+   }
+
+   if (index == pAfter->num)
+      return iterator(pAfter->pNext, 0);
+   return iterator(pAfter, index);
+}
+
+/*****************************************
+ * SWAP
+ * Stand-alone unrolled list swap
+ ****************************************/
+template <typename T, size_t K>
+void swap(unrolled_list <T, K> & lhs, unrolled_list <T, K> & rhs)
+{
+   lhs.swap(rhs);
+}
+
+} // namespace custom
@@ -13,6 +13,8 @@
  *    This will contain the class definition of:
  *        vector                 : A class that represents a Vector
  *        vector::iterator       : An iterator through Vector
+ *        growth_*               : How a Vector grows when it is full
+ *    The buffer comes from the allocator A (see allocator.h).
  * Author
  *    Br. Helfrich
  ************************************************************************/
@@ -22,6 +24,9 @@
 #include <cassert>  // because I am paranoid
 #include <new>      // std::bad_alloc
 #include <memory>   // for std::allocator
+#include <initializer_list> // for std::initializer_list
+#include "allocator.h" // for CACHE_LINE_BYTES and PAGE_BYTES
+#include "instrument.h" // for CUSTOM_INSTRUMENT
 
 class TestVector; // forward declaration for unit tests
 class TestStack;
@@ -31,11 +36,74 @@ class TestHash;
 namespace custom
 {
 
+/*****************************************
+ * GROWTH DOUBLE
+ * 1, 2, 4, 8, ... : the classic policy
+ ****************************************/
+struct growth_double
+{
+   static size_t grow(size_t numCapacity, size_t /* sizeElement */)
+   {
+      return numCapacity == 0 ? 1 : numCapacity * 2;
+   }
+};
+
+/*****************************************
+ * GROWTH HALF
+ * Start with a cache line worth of elements and grow
+ * by 1.5x thereafter. Wastes at most a third of the buffer
+ ****************************************/
+struct growth_half
+{
+   static size_t first(size_t sizeElement)
+   {
+      size_t num = CACHE_LINE_BYTES / sizeElement;
+      return num ? num : 1;
+   }
+   static size_t grow(size_t numCapacity, size_t sizeElement)
+   {
+      if (numCapacity == 0)
+         return first(sizeElement);
+      return numCapacity + (numCapacity / 2 ? numCapacity / 2 : 1);
+   }
+};
+
+/*****************************************
+ * GROWTH SIZE CLASS
+ * Grow by 1.5x, then round the buffer up to the block the
+ * allocator would hand out anyway so the slack becomes capacity:
+ *    under a page : four size classes per power of two
+ *    over a page  : a whole number of pages
+ ****************************************/
+struct growth_size_class
+{
+   static size_t roundBytes(size_t bytes)
+   {
+      if (bytes <= CACHE_LINE_BYTES)
+         return CACHE_LINE_BYTES;
+      if (bytes >= PAGE_BYTES)
+         return (bytes + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+
+      // find the largest power of two not above bytes
+      size_t power = CACHE_LINE_BYTES;
+      while (power * 2 <= bytes)
+         power *= 2;
+      size_t spacing = power / 4;
+      return (bytes + spacing - 1) / spacing * spacing;
+   }
+   static size_t grow(size_t numCapacity, size_t sizeElement)
+   {
+      size_t num = growth_half::grow(numCapacity, sizeElement);
+      num = roundBytes(num * sizeElement) / sizeElement;
+      return num > numCapacity ? num : numCapacity + 1;
+   }
+};
+
 /*****************************************
  * VECTOR
  * Just like the std :: vector <T> class
  ****************************************/
-template <typename T>
+template <typename T, typename Growth = growth_double, typename A = std::allocator<T>>
 class vector
 {
    friend class ::TestVector; // give unit tests access to the privates
@@ -65,6 +133,7 @@ public:
       std::swap(data, rhs.data);
       std::swap(numElements, rhs.numElements);
       std::swap(numCapacity, rhs.numCapacity);
+      std::swap(alloc, rhs.alloc);
    }
    vector & operator = (const vector & rhs);
    vector & operator = (vector&& rhs);
@@ -123,6 +192,10 @@ public:
 
 private:
 
+   T * allocate(size_t num);
+   void deallocate(T * p, size_t num);
+
+   A    alloc;            // where the array comes from
    T *  data;             // user data, a dynamically-allocated array
    size_t  numCapacity;   // the capacity of the array
    size_t  numElements;   // the number of items currently used
@@ -139,8 +212,8 @@ private:
  * This particular iterator is a bi-directional meaning
  * that ++ and -- both work.  Not all iterators are that way.
  *************************************************/
-template <typename T>
-class vector <T> ::iterator
+template <typename T, typename Growth, typename A>
+class vector <T, Growth, A> ::iterator
 {
    friend class ::TestVector; // give unit tests access to the privates
    friend class ::TestStack;
@@ -151,7 +224,7 @@ public:
    iterator() : p(nullptr)              {                     }
    iterator(T* p) : p(p)                {                     }
    iterator(const iterator& rhs)        { *this = rhs;        }
-   iterator(size_t index, vector<T>& v) { p = v.data + index; }
+   iterator(size_t index, vector& v)    { p = v.data + index; }
    iterator& operator = (const iterator& rhs)
    {
       this->p = rhs.p;
@@ -162,6 +235,9 @@ public:
    bool operator != (const iterator& rhs) const { return rhs.p != this->p; }
    bool operator == (const iterator& rhs) const { return rhs.p == this->p; }
 
+   // the element's address, so a scan can use the raw buffer
+   friend T* to_address(const iterator& it) { return it.p; }
+
    // dereference operator
    T& operator * ()
    {
@@ -210,15 +286,15 @@ private:
  * non-default constructor: set the number of elements,
  * construct each element, and copy the values over
  ****************************************/
-template <typename T>
-vector <T> :: vector(size_t num, const T & t) :
+template <typename T, typename Growth, typename A>
+vector <T, Growth, A> :: vector(size_t num, const T & t) :
 data(nullptr), numElements(0), numCapacity(0)
 {
    // do nothing if there is nothing to do
    if (num > 0)
    {
       // allocate memory
-      data = new T[num];
+      data = allocate(num);
       numCapacity = num;
       numElements = num;
 
@@ -233,14 +309,14 @@ data(nullptr), numElements(0), numCapacity(0)
  * VECTOR :: INITIALIZATION LIST constructors
  * Create a vector with an initialization list.
  ****************************************/
-template <typename T>
-vector <T> :: vector(const std::initializer_list<T> & l) :
+template <typename T, typename Growth, typename A>
+vector <T, Growth, A> :: vector(const std::initializer_list<T> & l) :
       data(nullptr), numElements(0), numCapacity(0)
 {
    if (l.size())
    {
       // allocate memory
-      data = new T[l.size()];
+      data = allocate(l.size());
 
       // copy the value
       size_t i = size_t(0);
@@ -256,8 +332,8 @@ vector <T> :: vector(const std::initializer_list<T> & l) :
  * non-default constructor: set the number of elements,
  * construct each element, and copy the values over
  ****************************************/
-template <typename T>
-vector <T> :: vector(size_t num):
+template <typename T, typename Growth, typename A>
+vector <T, Growth, A> :: vector(size_t num):
       data(nullptr), numElements(0), numCapacity(0)
 {
    // do nothing if there is nothing to do
@@ -265,7 +341,7 @@ vector <T> :: vector(size_t num):
    {
       numElements = num;
       numCapacity = num;
-      data = new T[num];
+      data = allocate(num);
       for (size_t i = size_t(0); i < num; i++)
          data[i] = T();
    }
@@ -276,8 +352,8 @@ vector <T> :: vector(size_t num):
  * Allocate the space for numElements and
  * call the copy constructor on each element
  ****************************************/
-template <typename T>
-vector <T> :: vector (const vector & rhs) : data(nullptr), numElements(0), numCapacity(0)
+template <typename T, typename Growth, typename A>
+vector <T, Growth, A> :: vector (const vector & rhs) : data(nullptr), numElements(0), numCapacity(0)
 {
    *this = rhs;
 }
@@ -286,8 +362,8 @@ vector <T> :: vector (const vector & rhs) : data(nullptr), numElements(0), numCa
  * VECTOR :: MOVE CONSTRUCTOR
  * Steal the values from the RHS and set it to zero.
  ****************************************/
-template <typename T>
-vector <T> :: vector (vector && rhs) : data(nullptr), numElements(0), numCapacity(0)
+template <typename T, typename Growth, typename A>
+vector <T, Growth, A> :: vector (vector && rhs) : data(nullptr), numElements(0), numCapacity(0)
 {
    *this = std::move(rhs);
 }
@@ -297,16 +373,61 @@ vector <T> :: vector (vector && rhs) : data(nullptr), numElements(0), numCapacit
  * Call the destructor for each element from 0..numElements
  * and then free the memory
  ****************************************/
-template <typename T>
-vector <T> :: ~vector()
+template <typename T, typename Growth, typename A>
+vector <T, Growth, A> :: ~vector()
 {
    if (numCapacity > 0)
    {
       assert(nullptr != data);
-      delete [] data;
+      deallocate(data, numCapacity);
    }
 }
 
+/***************************************
+ * VECTOR :: ALLOCATE
+ * Get num elements worth of memory from the
+ * allocator and default-construct every one,
+ * just as new T[num] would
+ *     INPUT  : num the size of the new buffer
+ *     OUTPUT : the new buffer
+ **************************************/
+template <typename T, typename Growth, typename A>
+T * vector <T, Growth, A> :: allocate(size_t num)
+{
+   T * p = alloc.allocate(num);
+   CUSTOM_INSTRUMENT_ALLOC();
+   size_t i = 0;
+   try
+   {
+      for (; i < num; i++)
+         new (p + i) T();
+   }
+   catch (...)
+   {
+      while (i > 0)
+         p[--i].~T();
+      alloc.deallocate(p, num);
+      throw;
+   }
+   return p;
+}
+
+/***************************************
+ * VECTOR :: DEALLOCATE
+ * Destroy every element of a buffer made by
+ * allocate() and give it back, as delete [] would
+ *     INPUT  : p the buffer, num its size
+ **************************************/
+template <typename T, typename Growth, typename A>
+void vector <T, Growth, A> :: deallocate(T * p, size_t num)
+{
+   if (p == nullptr)
+      return;
+   for (size_t i = 0; i < num; i++)
+      p[i].~T();
+   alloc.deallocate(p, num);
+}
+
 /***************************************
  * VECTOR :: RESIZE
  * This method will adjust the size to newElements.
@@ -314,9 +435,10 @@ vector <T> :: ~vector()
  *     INPUT  : newCapacity the size of the new buffer
  *     OUTPUT :
  **************************************/
-template <typename T>
-void vector <T> :: resize(size_t newElements)
+template <typename T, typename Growth, typename A>
+void vector <T, Growth, A> :: resize(size_t newElements)
 {
+   CUSTOM_INSTRUMENT_SCOPE(VECTOR_RESIZE);
    assert(newElements >= 0);
 
    // grow as necessary
@@ -336,9 +458,10 @@ void vector <T> :: resize(size_t newElements)
 
 }
 
-template <typename T>
-void vector <T> :: resize(size_t newElements, const T & t)
+template <typename T, typename Growth, typename A>
+void vector <T, Growth, A> :: resize(size_t newElements, const T & t)
 {
+   CUSTOM_INSTRUMENT_SCOPE(VECTOR_RESIZE);
    assert(newElements >= 0);
 
    // grow as necessary
@@ -365,22 +488,23 @@ void vector <T> :: resize(size_t newElements, const T & t)
  *     INPUT  : newCapacity the size of the new buffer
  *     OUTPUT :
  **************************************/
-template <typename T>
-void vector <T> :: reserve(size_t newCapacity)
+template <typename T, typename Growth, typename A>
+void vector <T, Growth, A> :: reserve(size_t newCapacity)
 {
+   CUSTOM_INSTRUMENT_SCOPE(VECTOR_RESERVE);
    // do nothing if we are already big enough
    if (newCapacity <= numCapacity)
       return;
    assert(newCapacity > 0 && newCapacity > numCapacity);
 
    // allocate the new array
-   T* pNew = new T[newCapacity];
+   T* pNew = allocate(newCapacity);
 
    // copy over the data from the old array
    for (size_t i = 0; i < numElements; i++)
       pNew[i] = std::move(data[i]);
 
-   delete[] data;
+   deallocate(data, numCapacity);
 
    data = pNew;
    numCapacity = newCapacity;
@@ -393,9 +517,10 @@ void vector <T> :: reserve(size_t newCapacity)
  *     INPUT  :
  *     OUTPUT :
  **************************************/
-template <typename T>
-void vector <T> :: shrink_to_fit()
+template <typename T, typename Growth, typename A>
+void vector <T, Growth, A> :: shrink_to_fit()
 {
+   CUSTOM_INSTRUMENT_SCOPE(VECTOR_SHRINK);
    // do nothing if we have no space
    if (numCapacity == numElements)
       return;
@@ -404,7 +529,7 @@ void vector <T> :: shrink_to_fit()
    T * pNew;
    if (numElements != 0)
    {
-      pNew = new T[numElements];
+      pNew = allocate(numElements);
       for (size_t i = 0; i < numElements; i++)
          pNew[i] = data[i];
    }
@@ -415,7 +540,7 @@ void vector <T> :: shrink_to_fit()
    // delete the old and assign the new
    if (nullptr != data)
    {
-      delete[] data;
+      deallocate(data, numCapacity);
    }
    data = pNew;
    numCapacity = numElements;
@@ -427,8 +552,8 @@ void vector <T> :: shrink_to_fit()
  * VECTOR :: SUBSCRIPT
  * Read-Write access
  ****************************************/
-template <typename T>
-T & vector <T> :: operator [] (size_t index)
+template <typename T, typename Growth, typename A>
+T & vector <T, Growth, A> :: operator [] (size_t index)
 {
    // sanity check. Note that we do not do error-checking with []
    assert (index >= 0 && index < numElements);
@@ -440,8 +565,8 @@ T & vector <T> :: operator [] (size_t index)
  * VECTOR :: SUBSCRIPT
  * Read-Write access
  *****************************************/
-template <typename T>
-const T & vector <T> :: operator [] (size_t index) const
+template <typename T, typename Growth, typename A>
+const T & vector <T, Growth, A> :: operator [] (size_t index) const
 {
    // sanity check
    assert (index >= 0 && index < numElements);
@@ -452,8 +577,8 @@ const T & vector <T> :: operator [] (size_t index) const
  * VECTOR :: FRONT
  * Read-Write access
  ****************************************/
-template <typename T>
-T & vector <T> :: front ()
+template <typename T, typename Growth, typename A>
+T & vector <T, Growth, A> :: front ()
 {
    // sanity check. Note that we do not do error-checking with front
    assert(numElements > 0);
@@ -464,8 +589,8 @@ T & vector <T> :: front ()
  * VECTOR :: FRONT
  * Read-Write access
  *****************************************/
-template <typename T>
-const T & vector <T> :: front () const
+template <typename T, typename Growth, typename A>
+const T & vector <T, Growth, A> :: front () const
 {
    // sanity check
    assert(numElements > 0);
@@ -476,8 +601,8 @@ const T & vector <T> :: front () const
  * VECTOR :: FRONT
  * Read-Write access
  ****************************************/
-template <typename T>
-T & vector <T> :: back()
+template <typename T, typename Growth, typename A>
+T & vector <T, Growth, A> :: back()
 {
    // sanity check. Note that we do not do error-checking with back
    assert(numElements > 0);
@@ -488,8 +613,8 @@ T & vector <T> :: back()
  * VECTOR :: FRONT
  * Read-Write access
  *****************************************/
-template <typename T>
-const T & vector <T> :: back() const
+template <typename T, typename Growth, typename A>
+const T & vector <T, Growth, A> :: back() const
 {
    // sanity check
    assert(numElements > 0);
@@ -504,32 +629,30 @@ const T & vector <T> :: back() const
  *     INPUT  : 't' the new element to be added
  *     OUTPUT : *this
  **************************************/
-template <typename T>
-void vector <T> :: push_back (const T & t)
+template <typename T, typename Growth, typename A>
+void vector <T, Growth, A> :: push_back (const T & t)
 {
+   CUSTOM_INSTRUMENT_SCOPE(VECTOR_PUSH_BACK);
    assert(numElements <= numCapacity);
 
    // grow if necessary
-   if (numCapacity == 0)
-      reserve(1);
-   else if (numElements == numCapacity)
-      reserve(numCapacity * 2);   // could throw ERROR: Unable to allocate ...
+   if (numElements == numCapacity)
+      reserve(Growth::grow(numCapacity, sizeof(T)));   // could throw ERROR: Unable to allocate ...
    assert(numElements < numCapacity);
 
    // actually add on to the end of the list
    data[numElements++] = t;
 }
 
-template <typename T>
-void vector <T> ::push_back(T && t)
+template <typename T, typename Growth, typename A>
+void vector <T, Growth, A> ::push_back(T && t)
 {
+   CUSTOM_INSTRUMENT_SCOPE(VECTOR_PUSH_BACK);
    assert(numElements <= numCapacity);
 
    // grow if necessary
-   if (numCapacity == 0)
-      reserve(1);
-   else if (numElements == numCapacity)
-      reserve(numCapacity * 2);   // could throw ERROR: Unable to allocate ...
+   if (numElements == numCapacity)
+      reserve(Growth::grow(numCapacity, sizeof(T)));   // could throw ERROR: Unable to allocate ...
    assert(numElements < numCapacity);
 
    // actually add on to the end of the list
@@ -544,8 +667,8 @@ void vector <T> ::push_back(T && t)
  *     INPUT  : rhs the vector to copy from
  *     OUTPUT : *this
  **************************************/
-template <typename T>
-vector <T> & vector <T> :: operator = (const vector & rhs)
+template <typename T, typename Growth, typename A>
+vector <T, Growth, A> & vector <T, Growth, A> :: operator = (const vector & rhs)
 {
    // clear out the old data
    clear();
@@ -562,8 +685,8 @@ vector <T> & vector <T> :: operator = (const vector & rhs)
    // return self
    return *this;
 }
-template <typename T>
-vector <T>& vector <T> :: operator = (vector&& rhs)
+template <typename T, typename Growth, typename A>
+vector <T, Growth, A>& vector <T, Growth, A> :: operator = (vector&& rhs)
 {
    clear();
    shrink_to_fit();